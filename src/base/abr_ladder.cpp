@@ -0,0 +1,136 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/abr_ladder.h"
+
+#include <string>
+
+#include <json-c/json_object.h>
+#include <json-c/json_tokener.h>
+
+#include <common/sprintf.h>
+
+#define ABR_RENDITION_SIZE_FIELD "size"
+#define ABR_RENDITION_VIDEO_BITRATE_FIELD "video_bitrate"
+
+namespace iptv_cloud {
+
+AbrRendition::AbrRendition() : AbrRendition(common::draw::Size(), 0) {}
+
+AbrRendition::AbrRendition(const common::draw::Size& size, int video_bitrate)
+    : size_(size), video_bitrate_(video_bitrate) {}
+
+bool AbrRendition::IsValid() const {
+  return size_.IsValid() && video_bitrate_ > 0;
+}
+
+bool AbrRendition::Equals(const AbrRendition& rend) const {
+  return size_ == rend.size_ && video_bitrate_ == rend.video_bitrate_;
+}
+
+std::string AbrRendition::GetName() const {
+  return common::MemSPrintf("%dp", size_.height);
+}
+
+common::draw::Size AbrRendition::GetSize() const {
+  return size_;
+}
+
+void AbrRendition::SetSize(const common::draw::Size& size) {
+  size_ = size;
+}
+
+int AbrRendition::GetVideoBitrate() const {
+  return video_bitrate_;
+}
+
+void AbrRendition::SetVideoBitrate(int video_bitrate) {
+  video_bitrate_ = video_bitrate;
+}
+
+}  // namespace iptv_cloud
+
+namespace common {
+
+std::string ConvertToString(const iptv_cloud::abr_ladder_t& value) {
+  std::string result = "[";
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (i != 0) {
+      result += ",";
+    }
+    result += common::MemSPrintf("{ \"" ABR_RENDITION_SIZE_FIELD "\": \"%s\",\"" ABR_RENDITION_VIDEO_BITRATE_FIELD
+                                 "\": %d }",
+                                 common::ConvertToString(value[i].GetSize()), value[i].GetVideoBitrate());
+  }
+  result += "]";
+  return result;
+}
+
+bool ConvertFromString(const std::string& from, iptv_cloud::abr_ladder_t* out) {
+  if (!out) {
+    return false;
+  }
+
+  json_object* obj = json_tokener_parse(from.c_str());
+  if (!obj) {
+    return false;
+  }
+
+  if (!json_object_is_type(obj, json_type_array)) {
+    json_object_put(obj);
+    return false;
+  }
+
+  iptv_cloud::abr_ladder_t res;
+  const size_t len = json_object_array_length(obj);
+  for (size_t i = 0; i < len; ++i) {
+    json_object* jrend = json_object_array_get_idx(obj, i);
+    iptv_cloud::AbrRendition rend;
+    json_object* jsize = nullptr;
+    json_bool jsize_exists = json_object_object_get_ex(jrend, ABR_RENDITION_SIZE_FIELD, &jsize);
+    if (jsize_exists) {
+      common::draw::Size size;
+      if (common::ConvertFromString(json_object_get_string(jsize), &size)) {
+        rend.SetSize(size);
+      }
+    }
+
+    json_object* jbitrate = nullptr;
+    json_bool jbitrate_exists = json_object_object_get_ex(jrend, ABR_RENDITION_VIDEO_BITRATE_FIELD, &jbitrate);
+    if (jbitrate_exists) {
+      rend.SetVideoBitrate(json_object_get_int(jbitrate));
+    }
+
+    // variants are named by height, so it should be unique
+    bool is_unique = true;
+    for (const iptv_cloud::AbrRendition& prev : res) {
+      if (prev.GetSize().height == rend.GetSize().height) {
+        is_unique = false;
+        break;
+      }
+    }
+
+    if (!rend.IsValid() || !is_unique) {
+      json_object_put(obj);
+      return false;
+    }
+    res.push_back(rend);
+  }
+
+  json_object_put(obj);
+  *out = res;
+  return true;
+}
+
+}  // namespace common
@@ -0,0 +1,62 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <common/draw/types.h>
+
+namespace iptv_cloud {
+
+// One rendition of abr ladder, encoded from shared decoded video and published as own hls variant.
+class AbrRendition {
+ public:
+  AbrRendition();
+  AbrRendition(const common::draw::Size& size, int video_bitrate);
+
+  bool IsValid() const;
+
+  bool Equals(const AbrRendition& rend) const;
+
+  std::string GetName() const;  // variant name, like 720p
+
+  common::draw::Size GetSize() const;
+  void SetSize(const common::draw::Size& size);
+
+  int GetVideoBitrate() const;  // kbps
+  void SetVideoBitrate(int video_bitrate);
+
+ private:
+  common::draw::Size size_;
+  int video_bitrate_;
+};
+
+inline bool operator==(const AbrRendition& left, const AbrRendition& right) {
+  return left.Equals(right);
+}
+
+inline bool operator!=(const AbrRendition& left, const AbrRendition& right) {
+  return !operator==(left, right);
+}
+
+typedef std::vector<AbrRendition> abr_ladder_t;
+
+}  // namespace iptv_cloud
+
+namespace common {
+std::string ConvertToString(const iptv_cloud::abr_ladder_t& value);  // json
+bool ConvertFromString(const std::string& from, iptv_cloud::abr_ladder_t* out);
+}  // namespace common
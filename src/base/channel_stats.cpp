@@ -18,6 +18,37 @@
 
 namespace iptv_cloud {
 
+uint64_t GetLatencyBucketLowerBound(size_t bucket) {
+  if (bucket < 8) {
+    return bucket;
+  }
+
+  const size_t octave = 3 + (bucket - 8) / 4;
+  return static_cast<uint64_t>(4 + (bucket - 8) % 4) << (octave - 2);
+}
+
+uint64_t CalcLatencyPercentile(const uint64_t* counts, double percent) {
+  uint64_t total = 0;
+  for (size_t i = 0; i < CHANNEL_LATENCY_BUCKETS; ++i) {
+    total += counts[i];
+  }
+
+  if (!total) {
+    return 0;
+  }
+
+  const uint64_t rank = static_cast<uint64_t>(total * percent / 100.0);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < CHANNEL_LATENCY_BUCKETS; ++i) {
+    seen += counts[i];
+    if (seen > rank) {
+      return i + 1 < CHANNEL_LATENCY_BUCKETS ? GetLatencyBucketLowerBound(i + 1) - 1 : GetLatencyBucketLowerBound(i);
+    }
+  }
+
+  return GetLatencyBucketLowerBound(CHANNEL_LATENCY_BUCKETS - 1);
+}
+
 ChannelStats::ChannelStats() : ChannelStats(0) {}
 
 ChannelStats::ChannelStats(channel_id_t cid)
@@ -26,7 +57,15 @@ ChannelStats::ChannelStats(channel_id_t cid)
       total_bytes_(0),
       prev_total_bytes_(0),
       bytes_per_second_(0),
-      desire_bytes_per_second_() {}
+      desire_bytes_per_second_(),
+      buffers_count_(0),
+      size_histogram_(),
+      interval_histogram_(),
+      latency_p50_(0),
+      latency_p95_(0),
+      latency_p99_(0),
+      kernel_drops_(0),
+      cc_errors_(0) {}
 
 channel_id_t ChannelStats::GetID() const {
   return id_;
@@ -89,4 +128,62 @@ common::media::DesireBytesPerSec ChannelStats::GetDesireBytesPerSecond() const {
   return desire_bytes_per_second_;
 }
 
+size_t ChannelStats::GetBuffersCount() const {
+  return buffers_count_;
+}
+
+void ChannelStats::SetBuffersCount(size_t count) {
+  buffers_count_ = count;
+}
+
+const channel_histogram_t& ChannelStats::GetSizeHistogram() const {
+  return size_histogram_;
+}
+
+void ChannelStats::SetSizeHistogram(const channel_histogram_t& hist) {
+  size_histogram_ = hist;
+}
+
+const channel_histogram_t& ChannelStats::GetIntervalHistogram() const {
+  return interval_histogram_;
+}
+
+void ChannelStats::SetIntervalHistogram(const channel_histogram_t& hist) {
+  interval_histogram_ = hist;
+}
+
+size_t ChannelStats::GetLatencyP50() const {
+  return latency_p50_;
+}
+
+size_t ChannelStats::GetLatencyP95() const {
+  return latency_p95_;
+}
+
+size_t ChannelStats::GetLatencyP99() const {
+  return latency_p99_;
+}
+
+void ChannelStats::SetLatency(size_t p50, size_t p95, size_t p99) {
+  latency_p50_ = p50;
+  latency_p95_ = p95;
+  latency_p99_ = p99;
+}
+
+size_t ChannelStats::GetKernelDrops() const {
+  return kernel_drops_;
+}
+
+void ChannelStats::SetKernelDrops(size_t drops) {
+  kernel_drops_ = drops;
+}
+
+size_t ChannelStats::GetContinuityErrors() const {
+  return cc_errors_;
+}
+
+void ChannelStats::SetContinuityErrors(size_t errors) {
+  cc_errors_ = errors;
+}
+
 }  // namespace iptv_cloud
@@ -14,12 +14,47 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <array>
+
 #include <common/media/bandwidth_estimation.h>
 
 #include "base/types.h"
 
+#define CHANNEL_HISTOGRAM_BUCKETS 32
+#define CHANNEL_LATENCY_BUCKETS 64
+
 namespace iptv_cloud {
 
+// log2 buckets, bucket i counts values in [2^i, 2^(i+1)), zero goes to first and overflow to last bucket
+typedef std::array<uint64_t, CHANNEL_HISTOGRAM_BUCKETS> channel_histogram_t;
+
+inline size_t GetHistogramBucket(uint64_t value) {
+  if (!value) {
+    return 0;
+  }
+
+  const size_t bucket = 63 - __builtin_clzll(value);
+  return bucket < CHANNEL_HISTOGRAM_BUCKETS ? bucket : CHANNEL_HISTOGRAM_BUCKETS - 1;
+}
+
+// msec, exact up to 8 msec, then 4 buckets per octave (~25% precision) up to 2 minutes
+inline size_t GetLatencyBucket(uint64_t msec) {
+  if (msec < 8) {
+    return msec;
+  }
+
+  const size_t octave = 63 - __builtin_clzll(msec);
+  const size_t bucket = 8 + (octave - 3) * 4 + ((msec >> (octave - 2)) & 3);
+  return bucket < CHANNEL_LATENCY_BUCKETS ? bucket : CHANNEL_LATENCY_BUCKETS - 1;
+}
+
+uint64_t GetLatencyBucketLowerBound(size_t bucket);  // msec
+
+// value of bucket where percent of counts is reached, 0 if histogram is empty
+uint64_t CalcLatencyPercentile(const uint64_t* counts, double percent);
+
 class ChannelStats {  // only compile time size fields
  public:
   ChannelStats();
@@ -47,6 +82,27 @@ class ChannelStats {  // only compile time size fields
   void SetDesireBytesPerSecond(const common::media::DesireBytesPerSec& bps);
   common::media::DesireBytesPerSec GetDesireBytesPerSecond() const;
 
+  size_t GetBuffersCount() const;
+  void SetBuffersCount(size_t count);
+
+  const channel_histogram_t& GetSizeHistogram() const;  // buffer sizes, bytes
+  void SetSizeHistogram(const channel_histogram_t& hist);
+
+  const channel_histogram_t& GetIntervalHistogram() const;  // buffers inter-arrival time, usec
+  void SetIntervalHistogram(const channel_histogram_t& hist);
+
+  // buffers latency from ingest, msec, over last report period
+  size_t GetLatencyP50() const;
+  size_t GetLatencyP95() const;
+  size_t GetLatencyP99() const;
+  void SetLatency(size_t p50, size_t p95, size_t p99);
+
+  size_t GetKernelDrops() const;  // udp inputs, datagrams dropped by kernel socket
+  void SetKernelDrops(size_t drops);
+
+  size_t GetContinuityErrors() const;  // ts continuity counter errors
+  void SetContinuityErrors(size_t errors);
+
  private:
   channel_id_t id_;
 
@@ -56,6 +112,17 @@ class ChannelStats {  // only compile time size fields
   size_t bytes_per_second_;                // bps
 
   common::media::DesireBytesPerSec desire_bytes_per_second_;
+
+  size_t buffers_count_;
+  channel_histogram_t size_histogram_;
+  channel_histogram_t interval_histogram_;
+
+  size_t latency_p50_;
+  size_t latency_p95_;
+  size_t latency_p99_;
+
+  size_t kernel_drops_;
+  size_t cc_errors_;
 };
 
 }  // namespace iptv_cloud
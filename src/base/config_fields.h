@@ -30,6 +30,8 @@
 #define VOLUME_FIELD "volume"
 #define VIDEO_PARSER_FIELD "video_parser"
 #define AUDIO_PARSER_FIELD "audio_parser"
+#define PASSTHROUGH_FIELD "passthrough"
+#define PIDS_FIELD "pids"
 #define VIDEO_CODEC_FIELD "video_codec"
 #define AUDIO_CODEC_FIELD "audio_codec"
 #define AUDIO_SELECT_FIELD "audio_select"
@@ -37,9 +39,17 @@
 #define TIMESHIFT_CHUNK_LIFE_TIME_FIELD "timeshift_chunk_life_time"
 #define TIMESHIFT_DELAY_FIELD "timeshift_delay"
 #define TIMESHIFT_CHUNK_DURATION_FIELD "timeshift_chunk_duration"
+#define TIMESHIFT_RING_SIZE_FIELD "timeshift_ring_size"  // megabytes, ring storage instead of file per chunk
+#define CATCHUP_ARCHIVE_DIR_FIELD "catchup_archive_dir"  // timeshift recorder archive catchup is cut from
+#define CATCHUP_START_FIELD "catchup_start"              // utc seconds
+#define CATCHUP_STOP_FIELD "catchup_stop"                // utc seconds
 #define CLEANUP_TS_FIELD "cleanup_ts"
 #define LOGO_FIELD "logo"
+#define ABR_LADDER_FIELD "abr_ladder"
 #define LOOP_FIELD "loop"
+#define PLAYLIST_BLOCK_SIZE_FIELD "playlist_block_size"  // kilobytes, appsrc buffers of playlist streams
+#define PLAYLIST_ZERO_COPY_FIELD "playlist_zero_copy"    // mmap files, they must not be truncated while played
+#define HOT_STANDBY_FIELD "hot_standby"
 #define AVFORMAT_FIELD "avformat"
 #define RESTART_ATTEMPTS_FIELD "restart_attempts"
 #define DELAY_TIME_FIELD "delay_time"
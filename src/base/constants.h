@@ -21,6 +21,9 @@
 #define DEFAULT_CHUNK_LIFE_TIME 12 * 3600
 
 #define DEFAULT_LOOP false
+#define DEFAULT_PLAYLIST_BLOCK_SIZE 1024 * 1024
+#define DEFAULT_PLAYLIST_ZERO_COPY false
+#define DEFAULT_HOT_STANDBY false
 #define DEFAULT_AVFORMAT false
 
 #define TEST_URL "test"
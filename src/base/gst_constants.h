@@ -32,6 +32,7 @@
 #define AC3_PARSE "ac3parse"
 #define MPEG_AUDIO_PARSE "mpegaudioparse"
 #define TEE "tee"
+#define INPUT_SELECTOR "input-selector"
 #define FLV_MUX "flvmux"
 #define MPEGTS_MUX "mpegtsmux"
 #define FILE_SINK "filesink"
@@ -46,6 +47,7 @@
 #define ALSA_SRC "alsasrc"
 #define MULTIFILE_SRC "multifilesrc"
 #define APP_SRC "appsrc"
+#define APP_SINK "appsink"
 #define FILE_SRC "filesrc"
 #define IMAGE_FREEZE "imagefreeze"
 #define CAPS_FILTER "capsfilter"
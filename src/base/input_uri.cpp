@@ -24,13 +24,22 @@
 #define FIELD_INPUT_ID "id"
 #define FIELD_INPUT_URI "uri"
 #define FIELD_USER_AGENT "user_agent"
+#define FIELD_RECV_BUFFER_SIZE "rcvbuf_size"
+#define FIELD_MULTICAST_IFACE "multicast_iface"
+#define FIELD_MULTICAST_SOURCE "multicast_source"
 
 namespace iptv_cloud {
 
 InputUri::InputUri() : InputUri(0, common::uri::Url()) {}
 
 InputUri::InputUri(uri_id_t id, const common::uri::Url& input, user_agent_t ua)
-    : base_class(), id_(id), input_(input), user_agent_(ua) {}
+    : base_class(),
+      id_(id),
+      input_(input),
+      user_agent_(ua),
+      recv_buffer_size_(0),
+      multicast_iface_(),
+      multicast_source_() {}
 
 InputUri::uri_id_t InputUri::GetID() const {
   return id_;
@@ -56,6 +65,30 @@ void InputUri::SetUserAgent(user_agent_t agent) {
   user_agent_ = agent;
 }
 
+int InputUri::GetRecvBufferSize() const {
+  return recv_buffer_size_;
+}
+
+void InputUri::SetRecvBufferSize(int size) {
+  recv_buffer_size_ = size;
+}
+
+std::string InputUri::GetMulticastIface() const {
+  return multicast_iface_;
+}
+
+void InputUri::SetMulticastIface(const std::string& iface) {
+  multicast_iface_ = iface;
+}
+
+std::string InputUri::GetMulticastSource() const {
+  return multicast_source_;
+}
+
+void InputUri::SetMulticastSource(const std::string& source) {
+  multicast_source_ = source;
+}
+
 bool InputUri::Equals(const InputUri& inf) const {
   return id_ == inf.id_ && input_ == inf.input_;
 }
@@ -81,6 +114,26 @@ common::Error InputUri::DoDeSerialize(json_object* serialized) {
     res.SetUserAgent(agent);
   }
 
+  json_object* jrecv_buffer_size = nullptr;
+  json_bool jrecv_buffer_size_exists =
+      json_object_object_get_ex(serialized, FIELD_RECV_BUFFER_SIZE, &jrecv_buffer_size);
+  if (jrecv_buffer_size_exists) {
+    res.SetRecvBufferSize(json_object_get_int(jrecv_buffer_size));
+  }
+
+  json_object* jmulticast_iface = nullptr;
+  json_bool jmulticast_iface_exists = json_object_object_get_ex(serialized, FIELD_MULTICAST_IFACE, &jmulticast_iface);
+  if (jmulticast_iface_exists) {
+    res.SetMulticastIface(json_object_get_string(jmulticast_iface));
+  }
+
+  json_object* jmulticast_source = nullptr;
+  json_bool jmulticast_source_exists =
+      json_object_object_get_ex(serialized, FIELD_MULTICAST_SOURCE, &jmulticast_source);
+  if (jmulticast_source_exists) {
+    res.SetMulticastSource(json_object_get_string(jmulticast_source));
+  }
+
   *this = res;
   return common::Error();
 }
@@ -90,6 +143,16 @@ common::Error InputUri::SerializeFields(json_object* out) const {
   std::string url_str = common::ConvertToString(GetInput());
   json_object_object_add(out, FIELD_INPUT_URI, json_object_new_string(url_str.c_str()));
   json_object_object_add(out, FIELD_USER_AGENT, json_object_new_int(user_agent_));
+  // udp options are optional, most of inputs do not have them
+  if (recv_buffer_size_) {
+    json_object_object_add(out, FIELD_RECV_BUFFER_SIZE, json_object_new_int(recv_buffer_size_));
+  }
+  if (!multicast_iface_.empty()) {
+    json_object_object_add(out, FIELD_MULTICAST_IFACE, json_object_new_string(multicast_iface_.c_str()));
+  }
+  if (!multicast_source_.empty()) {
+    json_object_object_add(out, FIELD_MULTICAST_SOURCE, json_object_new_string(multicast_source_.c_str()));
+  }
 
   return common::Error();
 }
@@ -42,6 +42,16 @@ class InputUri : public common::serializer::JsonSerializer<InputUri> {
   user_agent_t GetUserAgent() const;
   void SetUserAgent(user_agent_t agent);
 
+  // udp inputs
+  int GetRecvBufferSize() const;  // bytes, 0 means default
+  void SetRecvBufferSize(int size);
+
+  std::string GetMulticastIface() const;  // interface name to join multicast group on, empty means any
+  void SetMulticastIface(const std::string& iface);
+
+  std::string GetMulticastSource() const;  // source address for source specific multicast, empty means any
+  void SetMulticastSource(const std::string& source);
+
   bool Equals(const InputUri& inf) const;
 
  protected:
@@ -52,6 +62,9 @@ class InputUri : public common::serializer::JsonSerializer<InputUri> {
   uri_id_t id_;
   common::uri::Url input_;
   user_agent_t user_agent_;
+  int recv_buffer_size_;
+  std::string multicast_iface_;
+  std::string multicast_source_;
 };
 
 inline bool operator==(const InputUri& left, const InputUri& right) {
@@ -19,18 +19,22 @@
 #include <json-c/json_object.h>
 #include <json-c/json_tokener.h>
 
+#include <common/convert2string.h>
+
 #include "base/constants.h"
 
 #define FIELD_OUTPUT_ID "id"
 #define FIELD_OUTPUT_URI "uri"
 #define FIELD_OUTPUT_HTTP_ROOT "http_root"
+#define FIELD_OUTPUT_UDP_MODE "udp_mode"
+#define FIELD_OUTPUT_MUX_RATE "muxrate"
 
 namespace iptv_cloud {
 
 OutputUri::OutputUri() : OutputUri(0, common::uri::Url()) {}
 
 OutputUri::OutputUri(uri_id_t id, const common::uri::Url& output)
-    : base_class(), id_(id), output_(output), http_root_() {}
+    : base_class(), id_(id), output_(output), http_root_(), udp_mode_(RTP_ES), mux_rate_(0) {}
 
 OutputUri::uri_id_t OutputUri::GetID() const {
   return id_;
@@ -56,8 +60,25 @@ void OutputUri::SetHttpRoot(const http_root_t& root) {
   http_root_ = root;
 }
 
+OutputUri::UdpMode OutputUri::GetUdpMode() const {
+  return udp_mode_;
+}
+
+void OutputUri::SetUdpMode(UdpMode mode) {
+  udp_mode_ = mode;
+}
+
+int OutputUri::GetMuxRate() const {
+  return mux_rate_;
+}
+
+void OutputUri::SetMuxRate(int rate) {
+  mux_rate_ = rate;
+}
+
 bool OutputUri::Equals(const OutputUri& inf) const {
-  return id_ == inf.id_ && output_ == inf.output_ && http_root_ == inf.http_root_;
+  return id_ == inf.id_ && output_ == inf.output_ && http_root_ == inf.http_root_ && udp_mode_ == inf.udp_mode_ &&
+         mux_rate_ == inf.mux_rate_;
 }
 
 common::Error OutputUri::DoDeSerialize(json_object* serialized) {
@@ -82,6 +103,26 @@ common::Error OutputUri::DoDeSerialize(json_object* serialized) {
     res.SetHttpRoot(http_root);
   }
 
+  json_object* judp_mode = nullptr;
+  json_bool judp_mode_exists = json_object_object_get_ex(serialized, FIELD_OUTPUT_UDP_MODE, &judp_mode);
+  if (judp_mode_exists) {
+    const int udp_mode = json_object_get_int(judp_mode);
+    if (udp_mode < RTP_ES || udp_mode > RTP_TS) {
+      return common::make_error("Invalid udp mode: " + common::ConvertToString(udp_mode));
+    }
+    res.SetUdpMode(static_cast<UdpMode>(udp_mode));
+  }
+
+  json_object* jmux_rate = nullptr;
+  json_bool jmux_rate_exists = json_object_object_get_ex(serialized, FIELD_OUTPUT_MUX_RATE, &jmux_rate);
+  if (jmux_rate_exists) {
+    const int mux_rate = json_object_get_int(jmux_rate);
+    if (mux_rate < 0) {
+      return common::make_error("Invalid mux rate: " + common::ConvertToString(mux_rate));
+    }
+    res.SetMuxRate(mux_rate);
+  }
+
   *this = res;
   return common::Error();
 }
@@ -94,6 +135,13 @@ common::Error OutputUri::SerializeFields(json_object* out) const {
   std::string url_str = common::ConvertToString(GetOutput());
   json_object_object_add(out, FIELD_OUTPUT_URI, json_object_new_string(url_str.c_str()));
   json_object_object_add(out, FIELD_OUTPUT_HTTP_ROOT, json_object_new_string(http_root_str.c_str()));
+  // udp options are optional, most of outputs do not have them
+  if (udp_mode_ != RTP_ES) {
+    json_object_object_add(out, FIELD_OUTPUT_UDP_MODE, json_object_new_int(udp_mode_));
+  }
+  if (mux_rate_) {
+    json_object_object_add(out, FIELD_OUTPUT_MUX_RATE, json_object_new_int(mux_rate_));
+  }
   return common::Error();
 }
 
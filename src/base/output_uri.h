@@ -27,6 +27,11 @@ class OutputUri : public common::serializer::JsonSerializer<OutputUri> {
   typedef JsonSerializer<OutputUri> base_class;
   typedef common::file_system::ascii_directory_string_path http_root_t;
   typedef channel_id_t uri_id_t;
+  enum UdpMode {
+    RTP_ES = 0,  // rtp payloaded elementary streams
+    RAW_TS,      // 7 ts packets per datagram
+    RTP_TS       // 7 ts packets per datagram behind rtp header (payload type 33)
+  };
   OutputUri();
   explicit OutputUri(uri_id_t id, const common::uri::Url& output);
 
@@ -39,6 +44,13 @@ class OutputUri : public common::serializer::JsonSerializer<OutputUri> {
   http_root_t GetHttpRoot() const;
   void SetHttpRoot(const http_root_t& root);
 
+  // udp outputs
+  UdpMode GetUdpMode() const;
+  void SetUdpMode(UdpMode mode);
+
+  int GetMuxRate() const;  // bits per second, 0 means no constant bitrate padding
+  void SetMuxRate(int rate);
+
   bool Equals(const OutputUri& inf) const;
 
  protected:
@@ -49,6 +61,8 @@ class OutputUri : public common::serializer::JsonSerializer<OutputUri> {
   uri_id_t id_;
   common::uri::Url output_;
   http_root_t http_root_;
+  UdpMode udp_mode_;
+  int mux_rate_;
 };
 
 inline bool operator==(const OutputUri& left, const OutputUri& right) {
@@ -0,0 +1,223 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/shared_hls_store.h"
+
+#include <string.h>
+
+#include <string>
+
+namespace iptv_cloud {
+
+namespace {
+void BeginUpdate(SharedHlsFile* file) {
+  file->sequence.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void EndUpdate(SharedHlsFile* file) {
+  file->sequence.fetch_add(1, std::memory_order_release);
+}
+}  // namespace
+
+void SharedHlsFile::Init() {
+  sequence.store(0, std::memory_order_relaxed);
+  offset.store(0, std::memory_order_relaxed);
+  size.store(0, std::memory_order_relaxed);
+  mtime.store(0, std::memory_order_relaxed);
+  memset(path, 0, sizeof(path));
+}
+
+SharedHlsStore::File::File() : data(nullptr), size(0), mtime(0), offset(0) {}
+
+SharedHlsStore::SharedHlsStore(size_t data_size)
+    : data_size_(data_size), writer_lock_(false), write_offset_(0), reclaimed_offset_(0) {
+  for (size_t i = 0; i < MAX_HLS_FILES_COUNT; ++i) {
+    files_[i].Init();
+  }
+}
+
+size_t SharedHlsStore::CalcSize(size_t data_size) {
+  return sizeof(SharedHlsStore) + data_size;
+}
+
+bool SharedHlsStore::IsValid() const {
+  return data_size_ != 0;
+}
+
+size_t SharedHlsStore::GetDataSize() const {
+  return data_size_;
+}
+
+common::ErrnoError SharedHlsStore::Publish(const std::string& path, const void* data, size_t size, time_t mtime) {
+  if (path.empty() || path.size() >= MAX_HLS_FILE_PATH_SIZE || (!data && size)) {
+    return common::make_errno_error_inval();
+  }
+
+  if (size > data_size_ / 2) {  // at least two files should fit, otherwise file can be reused while it is sent
+    return common::make_errno_error("File too big for hls store.", ENOSPC);
+  }
+
+  Lock();
+  uint64_t start = write_offset_.load(std::memory_order_relaxed);
+  const uint64_t pos = start % data_size_;
+  if (pos + size > data_size_) {  // file should be contiguous, skip ring tail
+    start += data_size_ - pos;
+  }
+  const uint64_t end = start + size;
+  write_offset_.store(end, std::memory_order_relaxed);
+  if (end > data_size_ && end - data_size_ > reclaimed_offset_.load(std::memory_order_relaxed)) {
+    reclaimed_offset_.store(end - data_size_, std::memory_order_relaxed);
+  }
+
+  SharedHlsFile* slot = nullptr;
+  for (size_t i = 0; i < MAX_HLS_FILES_COUNT; ++i) {
+    SharedHlsFile* file = &files_[i];
+    if (file->sequence.load(std::memory_order_relaxed) & 1) {  // reserved by other writer
+      continue;
+    }
+
+    if (!file->path[0]) {
+      slot = file;
+      break;
+    }
+
+    if (!slot || file->offset.load(std::memory_order_relaxed) < slot->offset.load(std::memory_order_relaxed)) {
+      slot = file;
+    }
+  }
+
+  if (!slot) {
+    UnLock();
+    return common::make_errno_error("No free slots in hls store.", EBUSY);
+  }
+
+  BeginUpdate(slot);  // readers skip slot until commit, also fences reclaimed offset before data overwrite
+  UnLock();
+
+  memcpy(GetData() + start % data_size_, data, size);
+
+  Lock();
+  slot->offset.store(start, std::memory_order_relaxed);
+  slot->size.store(size, std::memory_order_relaxed);
+  slot->mtime.store(mtime, std::memory_order_relaxed);
+  memset(slot->path, 0, sizeof(slot->path));
+  memcpy(slot->path, path.c_str(), path.size());
+  EndUpdate(slot);
+
+  // republished file (playlist), new copy is already visible
+  for (size_t i = 0; i < MAX_HLS_FILES_COUNT; ++i) {
+    SharedHlsFile* file = &files_[i];
+    if (file == slot || (file->sequence.load(std::memory_order_relaxed) & 1)) {
+      continue;
+    }
+
+    if (strncmp(file->path, slot->path, MAX_HLS_FILE_PATH_SIZE) == 0) {
+      BeginUpdate(file);
+      file->path[0] = 0;
+      EndUpdate(file);
+    }
+  }
+  UnLock();
+  return common::ErrnoError();
+}
+
+void SharedHlsStore::Remove(const std::string& path) {
+  if (path.empty() || path.size() >= MAX_HLS_FILE_PATH_SIZE) {
+    return;
+  }
+
+  Lock();
+  for (size_t i = 0; i < MAX_HLS_FILES_COUNT; ++i) {
+    SharedHlsFile* file = &files_[i];
+    if (file->sequence.load(std::memory_order_relaxed) & 1) {
+      continue;
+    }
+
+    if (strncmp(file->path, path.c_str(), MAX_HLS_FILE_PATH_SIZE) == 0) {
+      BeginUpdate(file);
+      file->path[0] = 0;
+      EndUpdate(file);
+    }
+  }
+  UnLock();
+}
+
+bool SharedHlsStore::Find(const std::string& path, File* file) const {
+  if (path.empty() || path.size() >= MAX_HLS_FILE_PATH_SIZE || !file) {
+    return false;
+  }
+
+  bool found = false;
+  File result;
+  for (size_t i = 0; i < MAX_HLS_FILES_COUNT; ++i) {
+    const SharedHlsFile* slot = &files_[i];
+    uint32_t seq = 0;
+    bool match = false;
+    File lfile;
+    do {
+      seq = slot->sequence.load(std::memory_order_acquire);
+      if (seq & 1) {  // writer in progress, previous copy if any lives in other slot
+        break;
+      }
+
+      match = strncmp(slot->path, path.c_str(), MAX_HLS_FILE_PATH_SIZE) == 0;
+      lfile.offset = slot->offset.load(std::memory_order_relaxed);
+      lfile.size = slot->size.load(std::memory_order_relaxed);
+      lfile.mtime = slot->mtime.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq != slot->sequence.load(std::memory_order_relaxed));
+
+    if ((seq & 1) || !match) {
+      continue;
+    }
+
+    if (!found || lfile.offset > result.offset) {
+      result = lfile;
+      found = true;
+    }
+  }
+
+  if (!found || result.offset < reclaimed_offset_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  result.data = GetData() + result.offset % data_size_;
+  *file = result;
+  return true;
+}
+
+bool SharedHlsStore::IsAlive(const File& file) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return file.offset >= reclaimed_offset_.load(std::memory_order_relaxed);
+}
+
+char* SharedHlsStore::GetData() {
+  return reinterpret_cast<char*>(this + 1);
+}
+
+const char* SharedHlsStore::GetData() const {
+  return reinterpret_cast<const char*>(this + 1);
+}
+
+void SharedHlsStore::Lock() {
+  while (writer_lock_.exchange(true, std::memory_order_acquire)) {
+  }
+}
+
+void SharedHlsStore::UnLock() {
+  writer_lock_.store(false, std::memory_order_release);
+}
+
+}  // namespace iptv_cloud
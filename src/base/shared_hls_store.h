@@ -0,0 +1,86 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <time.h>
+
+#include <atomic>
+#include <string>
+
+#include <common/error.h>
+
+#define MAX_HLS_FILE_PATH_SIZE 256
+#define MAX_HLS_FILES_COUNT 128
+
+namespace iptv_cloud {
+
+// Slot of published file (segment or playlist), all fields guarded by slot seqlock.
+struct SharedHlsFile {
+  void Init();
+
+  std::atomic<uint32_t> sequence;  // odd while writer updates slot
+  std::atomic<uint64_t> offset;    // absolute offset in data ring
+  std::atomic<uint64_t> size;
+  std::atomic<time_t> mtime;
+  char path[MAX_HLS_FILE_PATH_SIZE];  // full file path as hlssink would write it, empty if slot is free
+};
+
+// Lives in MAP_SHARED memory right before own data ring, must not own any heap pointers.
+// Writers (stream outputs) copy file into ring and publish slot, readers (daemon http thread) find file by path
+// and send it straight from ring, data of published file is never modified, only reused when ring wraps around.
+class SharedHlsStore {
+ public:
+  struct File {
+    File();
+
+    const char* data;
+    size_t size;
+    time_t mtime;
+    uint64_t offset;
+  };
+
+  explicit SharedHlsStore(size_t data_size);
+
+  static size_t CalcSize(size_t data_size);
+
+  bool IsValid() const;
+  size_t GetDataSize() const;
+
+  // writer side, stream process
+  common::ErrnoError Publish(const std::string& path, const void* data, size_t size, time_t mtime) WARN_UNUSED_RESULT;
+  void Remove(const std::string& path);
+
+  // reader side, any process, never blocks writers
+  bool Find(const std::string& path, File* file) const;
+  bool IsAlive(const File& file) const;  // false if ring already reused file data
+
+ private:
+  char* GetData();
+  const char* GetData() const;
+
+  void Lock();
+  void UnLock();
+
+  const uint64_t data_size_;
+
+  std::atomic<bool> writer_lock_;
+  std::atomic<uint64_t> write_offset_;      // writer lock
+  std::atomic<uint64_t> reclaimed_offset_;  // data before this absolute offset can be overwritten
+  SharedHlsFile files_[MAX_HLS_FILES_COUNT];
+
+  DISALLOW_COPY_AND_ASSIGN(SharedHlsStore);
+};
+
+}  // namespace iptv_cloud
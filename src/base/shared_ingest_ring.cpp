@@ -0,0 +1,196 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/shared_ingest_ring.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+namespace iptv_cloud {
+
+namespace {
+void CopyFromRing(const char* ring, uint64_t ring_size, uint64_t offset, char* out, size_t size) {
+  const uint64_t pos = offset % ring_size;
+  const size_t first = std::min<uint64_t>(size, ring_size - pos);
+  memcpy(out, ring + pos, first);
+  memcpy(out + first, ring, size - first);
+}
+}  // namespace
+
+SharedIngestRing::SharedIngestRing(size_t data_size)
+    : data_size_(data_size), write_offset_(0), reserved_offset_(0) {}
+
+size_t SharedIngestRing::CalcSize(size_t data_size) {
+  return sizeof(SharedIngestRing) + data_size;
+}
+
+bool SharedIngestRing::IsValid() const {
+  return data_size_ != 0;
+}
+
+size_t SharedIngestRing::GetDataSize() const {
+  return data_size_;
+}
+
+common::ErrnoError SharedIngestRing::Write(const void* data, size_t size) {
+  if (!data || !size) {
+    return common::make_errno_error_inval();
+  }
+
+  if (size > data_size_) {
+    return common::make_errno_error("Buffer too big for ingest ring.", ENOSPC);
+  }
+
+  const uint64_t start = write_offset_.load(std::memory_order_relaxed);
+  const uint64_t end = start + size;
+  reserved_offset_.store(end, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);  // readers of reclaimed data see reservation
+
+  const uint64_t pos = start % data_size_;
+  const size_t first = std::min<uint64_t>(size, data_size_ - pos);
+  memcpy(GetData() + pos, data, first);
+  memcpy(GetData(), static_cast<const char*>(data) + first, size - first);
+  write_offset_.store(end, std::memory_order_release);
+  return common::ErrnoError();
+}
+
+uint64_t SharedIngestRing::GetWriteOffset() const {
+  return write_offset_.load(std::memory_order_acquire);
+}
+
+size_t SharedIngestRing::Read(uint64_t* offset, void* out, size_t size, bool* lost) const {
+  if (!offset || !out || !lost) {
+    return 0;
+  }
+
+  *lost = false;
+  const uint64_t end = write_offset_.load(std::memory_order_acquire);
+  const uint64_t start = *offset;
+  if (start > end || end - start > data_size_) {  // hub restarted or reader lapped
+    *offset = end;
+    *lost = true;
+    return 0;
+  }
+
+  const size_t len = std::min<uint64_t>(size, end - start);
+  if (!len) {
+    return 0;
+  }
+
+  CopyFromRing(GetData(), data_size_, start, static_cast<char*>(out), len);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t reserved = reserved_offset_.load(std::memory_order_relaxed);
+  if (reserved > data_size_ && reserved - data_size_ > start) {  // overwritten while copied
+    *offset = write_offset_.load(std::memory_order_acquire);
+    *lost = true;
+    return 0;
+  }
+
+  *offset = start + len;
+  return len;
+}
+
+char* SharedIngestRing::GetData() {
+  return reinterpret_cast<char*>(this + 1);
+}
+
+const char* SharedIngestRing::GetData() const {
+  return reinterpret_cast<const char*>(this + 1);
+}
+
+std::string MakeIngestRingPath(const std::string& hub_name) {
+  return INGEST_RING_DIR INGEST_RING_PREFIX + hub_name;
+}
+
+common::ErrnoError CreateSharedIngestRing(const std::string& path, size_t data_size, SharedIngestRing** ring) {
+  if (path.empty() || !data_size || !ring) {
+    return common::make_errno_error_inval();
+  }
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd == -1) {
+    return common::make_errno_error(errno);
+  }
+
+  const size_t size = SharedIngestRing::CalcSize(data_size);
+  if (ftruncate(fd, size) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    return common::make_errno_error(errno);
+  }
+
+  *ring = new (mem) SharedIngestRing(data_size);
+  return common::ErrnoError();
+}
+
+common::ErrnoError MapSharedIngestRing(const std::string& path, const SharedIngestRing** ring) {
+  if (path.empty() || !ring) {
+    return common::make_errno_error_inval();
+  }
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return common::make_errno_error(errno);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  const size_t size = sb.st_size;
+  if (size < sizeof(SharedIngestRing)) {
+    close(fd);
+    return common::make_errno_error("Invalid ingest ring size.", EINVAL);
+  }
+
+  void* mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    return common::make_errno_error(errno);
+  }
+
+  const SharedIngestRing* lring = static_cast<const SharedIngestRing*>(mem);
+  if (!lring->IsValid() || SharedIngestRing::CalcSize(lring->GetDataSize()) != size) {
+    munmap(mem, size);
+    return common::make_errno_error("Ingest ring not ready.", EAGAIN);
+  }
+
+  *ring = lring;
+  return common::ErrnoError();
+}
+
+void FreeSharedIngestRing(const SharedIngestRing* ring) {
+  if (!ring) {
+    return;
+  }
+
+  munmap(const_cast<SharedIngestRing*>(ring), SharedIngestRing::CalcSize(ring->GetDataSize()));
+}
+
+}  // namespace iptv_cloud
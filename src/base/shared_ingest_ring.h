@@ -0,0 +1,71 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include <common/error.h>
+
+#define INGEST_RING_DIR "/dev/shm/"
+#define INGEST_RING_PREFIX "iptv_ingest_"
+#define INGEST_RING_DATA_SIZE (16 * 1024 * 1024)  // ~10 sec of 12 Mbit/s stream
+
+namespace iptv_cloud {
+
+// Byte ring of ingest hub, lives in shared file mapping right before own data ring, must not own any heap pointers.
+// Single writer (hub stream) appends muxed stream, any number of readers (subscribed streams) follow it with own
+// offsets, readers never block writer, reader lapped by writer skips to live edge.
+class SharedIngestRing {
+ public:
+  explicit SharedIngestRing(size_t data_size);
+
+  static size_t CalcSize(size_t data_size);
+
+  bool IsValid() const;
+  size_t GetDataSize() const;
+
+  // writer side, hub stream process
+  common::ErrnoError Write(const void* data, size_t size) WARN_UNUSED_RESULT;
+
+  // reader side, any process
+  uint64_t GetWriteOffset() const;  // live edge
+  // copies up to size bytes from absolute offset and moves it, returns 0 if no new data,
+  // lost is set if data at offset was overwritten (or hub restarted), offset is moved to live edge then
+  size_t Read(uint64_t* offset, void* out, size_t size, bool* lost) const;
+
+ private:
+  char* GetData();
+  const char* GetData() const;
+
+  const uint64_t data_size_;
+
+  std::atomic<uint64_t> write_offset_;     // absolute offset of committed data end
+  std::atomic<uint64_t> reserved_offset_;  // data before (reserved_offset_ - data_size_) can be overwritten
+
+  DISALLOW_COPY_AND_ASSIGN(SharedIngestRing);
+};
+
+std::string MakeIngestRingPath(const std::string& hub_name);
+
+// hub side, file is created if needed and ring is reset, file is never removed so readers survive hub restarts
+common::ErrnoError CreateSharedIngestRing(const std::string& path,
+                                          size_t data_size,
+                                          SharedIngestRing** ring) WARN_UNUSED_RESULT;
+// reader side, read only mapping, fails until hub created ring
+common::ErrnoError MapSharedIngestRing(const std::string& path, const SharedIngestRing** ring) WARN_UNUSED_RESULT;
+void FreeSharedIngestRing(const SharedIngestRing* ring);
+
+}  // namespace iptv_cloud
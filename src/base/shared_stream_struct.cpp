@@ -0,0 +1,383 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "base/shared_stream_struct.h"
+
+#include <string.h>
+
+#include <string>
+
+#include <common/time.h>
+
+namespace iptv_cloud {
+
+void SharedChannelStats::Init(channel_id_t cid) {
+  id = cid;
+  total_bytes.store(0, std::memory_order_relaxed);
+  last_update_time.store(0, std::memory_order_relaxed);
+  prev_total_bytes.store(0, std::memory_order_relaxed);
+  bytes_per_second.store(0, std::memory_order_relaxed);
+  desire_min.store(0, std::memory_order_relaxed);
+  desire_max.store(0, std::memory_order_relaxed);
+  buffers_count.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < CHANNEL_HISTOGRAM_BUCKETS; ++i) {
+    size_histogram[i].store(0, std::memory_order_relaxed);
+    interval_histogram[i].store(0, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < CHANNEL_LATENCY_BUCKETS; ++i) {
+    latency_histogram[i].store(0, std::memory_order_relaxed);
+    latency_checkpoint[i] = 0;
+  }
+  latency_p50.store(0, std::memory_order_relaxed);
+  latency_p95.store(0, std::memory_order_relaxed);
+  latency_p99.store(0, std::memory_order_relaxed);
+  kernel_drops.store(0, std::memory_order_relaxed);
+  cc_errors.store(0, std::memory_order_relaxed);
+}
+
+void SharedChannelStats::AddTotalBytes(size_t bytes) {
+  total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  last_update_time.store(common::time::current_utc_mstime(), std::memory_order_relaxed);
+}
+
+void SharedChannelStats::AddBuffer(size_t bytes) {
+  total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  buffers_count.fetch_add(1, std::memory_order_relaxed);
+  size_histogram[GetHistogramBucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedChannelStats::AddArrival(int64_t arrival_usec, int64_t interval_usec) {
+  last_update_time.store(arrival_usec / 1000, std::memory_order_relaxed);
+  if (interval_usec < 0) {
+    return;
+  }
+
+  interval_histogram[GetHistogramBucket(interval_usec)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedChannelStats::AddLatency(uint64_t latency_msec) {
+  latency_histogram[GetLatencyBucket(latency_msec)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedChannelStats::AddKernelDrops(uint64_t drops) {
+  kernel_drops.fetch_add(drops, std::memory_order_relaxed);
+}
+
+void SharedChannelStats::AddContinuityErrors(uint64_t errors) {
+  cc_errors.fetch_add(errors, std::memory_order_relaxed);
+}
+
+size_t SharedChannelStats::GetTotalBytes() const {
+  return total_bytes.load(std::memory_order_relaxed);
+}
+
+size_t SharedChannelStats::GetDiffTotalBytes() const {
+  return GetTotalBytes() - prev_total_bytes.load(std::memory_order_relaxed);
+}
+
+ChannelStats SharedChannelStats::MakeChannelStats() const {
+  ChannelStats stats(id);
+  stats.SetTotalBytes(total_bytes.load(std::memory_order_relaxed));
+  stats.SetLastUpdateTime(last_update_time.load(std::memory_order_relaxed));
+  stats.SetPrevTotalBytes(prev_total_bytes.load(std::memory_order_relaxed));
+  stats.SetBps(bytes_per_second.load(std::memory_order_relaxed));
+  common::media::DesireBytesPerSec desire;
+  desire.min = desire_min.load(std::memory_order_relaxed);
+  desire.max = desire_max.load(std::memory_order_relaxed);
+  stats.SetDesireBytesPerSecond(desire);
+  stats.SetBuffersCount(buffers_count.load(std::memory_order_relaxed));
+  channel_histogram_t size_hist;
+  channel_histogram_t interval_hist;
+  for (size_t i = 0; i < CHANNEL_HISTOGRAM_BUCKETS; ++i) {
+    size_hist[i] = size_histogram[i].load(std::memory_order_relaxed);
+    interval_hist[i] = interval_histogram[i].load(std::memory_order_relaxed);
+  }
+  stats.SetSizeHistogram(size_hist);
+  stats.SetIntervalHistogram(interval_hist);
+  stats.SetLatency(latency_p50.load(std::memory_order_relaxed), latency_p95.load(std::memory_order_relaxed),
+                   latency_p99.load(std::memory_order_relaxed));
+  stats.SetKernelDrops(kernel_drops.load(std::memory_order_relaxed));
+  stats.SetContinuityErrors(cc_errors.load(std::memory_order_relaxed));
+  return stats;
+}
+
+SharedStreamStruct::SharedStreamStruct(const StreamInfo& sha)
+    : type(sha.type),
+      start_time(common::time::current_utc_mstime()),
+      input_count(0),
+      output_count(0),
+      hls_store_offset(0),
+      segment_size(sizeof(SharedStreamStruct)),
+      sequence_(0),
+      loop_start_time_(0),
+      restarts_(0),
+      status_(NEW),
+      cpu_load_bits_(0),
+      rss_bytes_(0) {
+  memset(id, 0, sizeof(id));
+  if (!IsFitInfo(sha)) {
+    return;
+  }
+
+  memcpy(id, sha.id.c_str(), sha.id.size());
+  for (auto in : sha.input) {
+    input[input_count++].Init(in);
+  }
+  for (auto out : sha.output) {
+    output[output_count++].Init(out);
+  }
+}
+
+bool SharedStreamStruct::IsFitInfo(const StreamInfo& sha) {
+  return sha.id.size() < MAX_SHARED_STREAM_ID_SIZE && sha.input.size() <= MAX_SHARED_CHANNELS_COUNT &&
+         sha.output.size() <= MAX_SHARED_CHANNELS_COUNT;
+}
+
+bool SharedStreamStruct::IsValid() const {
+  return id[0] != 0;
+}
+
+stream_id_t SharedStreamStruct::GetID() const {
+  return stream_id_t(id);
+}
+
+size_t SharedStreamStruct::GetInputCount() const {
+  return input_count;
+}
+
+size_t SharedStreamStruct::GetOutputCount() const {
+  return output_count;
+}
+
+SharedChannelStats* SharedStreamStruct::GetInput(size_t index) {
+  if (index >= input_count) {
+    return nullptr;
+  }
+
+  return &input[index];
+}
+
+const SharedChannelStats* SharedStreamStruct::GetInput(size_t index) const {
+  if (index >= input_count) {
+    return nullptr;
+  }
+
+  return &input[index];
+}
+
+SharedChannelStats* SharedStreamStruct::GetOutput(size_t index) {
+  if (index >= output_count) {
+    return nullptr;
+  }
+
+  return &output[index];
+}
+
+const SharedChannelStats* SharedStreamStruct::GetOutput(size_t index) const {
+  if (index >= output_count) {
+    return nullptr;
+  }
+
+  return &output[index];
+}
+
+StreamStatus SharedStreamStruct::GetStatus() const {
+  return static_cast<StreamStatus>(status_.load(std::memory_order_relaxed));
+}
+
+void SharedStreamStruct::SetStatus(StreamStatus status) {
+  BeginUpdate();
+  status_.store(status, std::memory_order_relaxed);
+  EndUpdate();
+}
+
+size_t SharedStreamStruct::GetRestarts() const {
+  return restarts_.load(std::memory_order_relaxed);
+}
+
+void SharedStreamStruct::IncreaseRestarts() {
+  BeginUpdate();
+  restarts_.store(restarts_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  EndUpdate();
+}
+
+fastotv::timestamp_t SharedStreamStruct::GetLoopStartTime() const {
+  return loop_start_time_.load(std::memory_order_relaxed);
+}
+
+fastotv::timestamp_t SharedStreamStruct::WithoutRestartTime() const {
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  return current_time - GetLoopStartTime();
+}
+
+void SharedStreamStruct::StartLoop() {
+  BeginUpdate();
+  loop_start_time_.store(common::time::current_utc_mstime(), std::memory_order_relaxed);
+  UpdateCheckPoints();
+  EndUpdate();
+}
+
+void SharedStreamStruct::ResetDataWait() {
+  BeginUpdate();
+  UpdateCheckPoints();
+  EndUpdate();
+}
+
+void SharedStreamStruct::UpdateBps(size_t sec) {
+  if (!sec) {
+    return;
+  }
+
+  BeginUpdate();
+  for (size_t i = 0; i < input_count; ++i) {
+    input[i].bytes_per_second.store(input[i].GetDiffTotalBytes() / sec, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < output_count; ++i) {
+    output[i].bytes_per_second.store(output[i].GetDiffTotalBytes() / sec, std::memory_order_relaxed);
+  }
+  EndUpdate();
+}
+
+void SharedStreamStruct::UpdateLatency() {
+  BeginUpdate();
+  for (size_t i = 0; i < output_count; ++i) {
+    SharedChannelStats* out = &output[i];
+    uint64_t period[CHANNEL_LATENCY_BUCKETS];
+    for (size_t j = 0; j < CHANNEL_LATENCY_BUCKETS; ++j) {
+      const uint64_t count = out->latency_histogram[j].load(std::memory_order_relaxed);
+      period[j] = count - out->latency_checkpoint[j];
+      out->latency_checkpoint[j] = count;
+    }
+
+    out->latency_p50.store(CalcLatencyPercentile(period, 50), std::memory_order_relaxed);
+    out->latency_p95.store(CalcLatencyPercentile(period, 95), std::memory_order_relaxed);
+    out->latency_p99.store(CalcLatencyPercentile(period, 99), std::memory_order_relaxed);
+  }
+  EndUpdate();
+}
+
+common::media::DesireBytesPerSec SharedStreamStruct::GetDesireBytesPerSecond(size_t input_index) const {
+  common::media::DesireBytesPerSec desire;
+  const SharedChannelStats* in = GetInput(input_index);
+  if (!in) {
+    return desire;
+  }
+
+  desire.min = in->desire_min.load(std::memory_order_relaxed);
+  desire.max = in->desire_max.load(std::memory_order_relaxed);
+  return desire;
+}
+
+void SharedStreamStruct::SetDesireBytesPerSecond(size_t input_index, const common::media::DesireBytesPerSec& bps) {
+  SharedChannelStats* in = GetInput(input_index);
+  if (!in) {
+    return;
+  }
+
+  BeginUpdate();
+  in->desire_min.store(bps.min, std::memory_order_relaxed);
+  in->desire_max.store(bps.max, std::memory_order_relaxed);
+  EndUpdate();
+}
+
+void SharedStreamStruct::SetProcessStats(cpu_load_t cpu_load, rss_t rss_bytes) {
+  uint64_t cpu_load_bits = 0;
+  static_assert(sizeof(cpu_load_bits) == sizeof(cpu_load), "double should be 64 bit");
+  memcpy(&cpu_load_bits, &cpu_load, sizeof(cpu_load));
+
+  BeginUpdate();
+  cpu_load_bits_.store(cpu_load_bits, std::memory_order_relaxed);
+  rss_bytes_.store(rss_bytes, std::memory_order_relaxed);
+  EndUpdate();
+}
+
+bool SharedStreamStruct::GetSnapshot(StreamStruct* stream, cpu_load_t* cpu_load, rss_t* rss_bytes) const {
+  if (!stream || !cpu_load || !rss_bytes) {
+    return false;
+  }
+
+  input_channels_info_t linput;
+  output_channels_info_t loutput;
+  fastotv::timestamp_t lloop_start_time = 0;
+  size_t lrestarts = 0;
+  StreamStatus lstatus = NEW;
+  uint64_t lcpu_load_bits = 0;
+  rss_t lrss_bytes = 0;
+
+  uint32_t seq = 0;
+  size_t attempts = 0;
+  do {
+    if (attempts++ == MAX_SHARED_SNAPSHOT_ATTEMPTS) {
+      return false;
+    }
+
+    seq = sequence_.load(std::memory_order_acquire);
+    if (seq & 1) {  // writer in progress
+      continue;
+    }
+
+    linput.clear();
+    for (size_t i = 0; i < input_count; ++i) {
+      linput.push_back(input[i].MakeChannelStats());
+    }
+    loutput.clear();
+    for (size_t i = 0; i < output_count; ++i) {
+      loutput.push_back(output[i].MakeChannelStats());
+    }
+    lloop_start_time = loop_start_time_.load(std::memory_order_relaxed);
+    lrestarts = restarts_.load(std::memory_order_relaxed);
+    lstatus = static_cast<StreamStatus>(status_.load(std::memory_order_relaxed));
+    lcpu_load_bits = cpu_load_bits_.load(std::memory_order_relaxed);
+    lrss_bytes = rss_bytes_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != sequence_.load(std::memory_order_relaxed));
+
+  cpu_load_t lcpu_load = 0;
+  memcpy(&lcpu_load, &lcpu_load_bits, sizeof(lcpu_load));
+
+  *stream = StreamStruct(GetID(), type, lstatus, linput, loutput, start_time, lloop_start_time, lrestarts);
+  *cpu_load = lcpu_load;
+  *rss_bytes = lrss_bytes;
+  return true;
+}
+
+SharedHlsStore* SharedStreamStruct::GetHlsStore() {
+  if (!hls_store_offset) {
+    return nullptr;
+  }
+
+  return reinterpret_cast<SharedHlsStore*>(reinterpret_cast<char*>(this) + hls_store_offset);
+}
+
+void SharedStreamStruct::UpdateCheckPoints() {
+  for (size_t i = 0; i < input_count; ++i) {
+    input[i].prev_total_bytes.store(input[i].GetTotalBytes(), std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < output_count; ++i) {
+    output[i].prev_total_bytes.store(output[i].GetTotalBytes(), std::memory_order_relaxed);
+  }
+}
+
+void SharedStreamStruct::BeginUpdate() {
+  const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedStreamStruct::EndUpdate() {
+  const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(seq + 1, std::memory_order_release);
+}
+
+}  // namespace iptv_cloud
@@ -0,0 +1,145 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include <common/media/bandwidth_estimation.h>
+
+#include "base/shared_hls_store.h"
+#include "base/stream_struct.h"
+
+#define MAX_SHARED_STREAM_ID_SIZE 64
+#define MAX_SHARED_CHANNELS_COUNT 32
+#define MAX_SHARED_SNAPSHOT_ATTEMPTS 10000  // reader gives up if writer holds sequence odd longer
+
+namespace iptv_cloud {
+
+// Lives in MAP_SHARED memory, must not own any heap pointers.
+// Byte counters are updated lock free from any streaming thread,
+// all other fields have a single writer (stream main thread) and are guarded by the segment seqlock.
+struct SharedChannelStats {
+  typedef decltype(common::media::DesireBytesPerSec::min) bandwidth_t;
+
+  void Init(channel_id_t cid);
+
+  void AddTotalBytes(size_t bytes);
+  // pad probes, no locks and no clock reads, arrival time is taken once per buffer or buffer list by caller
+  void AddBuffer(size_t bytes);
+  void AddArrival(int64_t arrival_usec, int64_t interval_usec);  // utc usec, negative interval for first arrival
+  void AddLatency(uint64_t latency_msec);
+  void AddKernelDrops(uint64_t drops);
+  void AddContinuityErrors(uint64_t errors);
+  size_t GetTotalBytes() const;
+  size_t GetDiffTotalBytes() const;
+
+  ChannelStats MakeChannelStats() const;
+
+  channel_id_t id;
+
+  std::atomic<uint64_t> total_bytes;                   // received bytes
+  std::atomic<fastotv::timestamp_t> last_update_time;  // up_time
+  std::atomic<uint64_t> prev_total_bytes;              // checkpoint received bytes, seqlock
+  std::atomic<uint64_t> bytes_per_second;              // bps, seqlock
+  std::atomic<bandwidth_t> desire_min;                 // seqlock
+  std::atomic<bandwidth_t> desire_max;                 // seqlock
+
+  std::atomic<uint64_t> buffers_count;
+  std::atomic<uint64_t> size_histogram[CHANNEL_HISTOGRAM_BUCKETS];
+  std::atomic<uint64_t> interval_histogram[CHANNEL_HISTOGRAM_BUCKETS];
+
+  std::atomic<uint64_t> latency_histogram[CHANNEL_LATENCY_BUCKETS];
+  uint64_t latency_checkpoint[CHANNEL_LATENCY_BUCKETS];  // stream main thread only
+  std::atomic<uint64_t> latency_p50;                     // msec, seqlock
+  std::atomic<uint64_t> latency_p95;                     // msec, seqlock
+  std::atomic<uint64_t> latency_p99;                     // msec, seqlock
+  std::atomic<uint64_t> kernel_drops;                    // datagrams dropped by socket before source read them
+  std::atomic<uint64_t> cc_errors;                       // ts continuity counter errors
+};
+
+struct SharedStreamStruct {
+  typedef double cpu_load_t;
+  typedef uint64_t rss_t;
+
+  explicit SharedStreamStruct(const StreamInfo& sha);
+
+  static bool IsFitInfo(const StreamInfo& sha);
+
+  bool IsValid() const;
+  stream_id_t GetID() const;
+
+  size_t GetInputCount() const;
+  size_t GetOutputCount() const;
+  SharedChannelStats* GetInput(size_t index);
+  const SharedChannelStats* GetInput(size_t index) const;
+  SharedChannelStats* GetOutput(size_t index);
+  const SharedChannelStats* GetOutput(size_t index) const;
+
+  // writer side, stream main thread only
+  StreamStatus GetStatus() const;
+  void SetStatus(StreamStatus status);
+
+  size_t GetRestarts() const;
+  void IncreaseRestarts();
+
+  fastotv::timestamp_t GetLoopStartTime() const;
+  fastotv::timestamp_t WithoutRestartTime() const;
+  void StartLoop();  // set loop start time and reset data wait
+
+  void ResetDataWait();
+  void UpdateBps(size_t sec);
+  void UpdateLatency();  // percentiles of buffers latency since previous call
+
+  common::media::DesireBytesPerSec GetDesireBytesPerSecond(size_t input_index) const;
+  void SetDesireBytesPerSecond(size_t input_index, const common::media::DesireBytesPerSec& bps);
+
+  void SetProcessStats(cpu_load_t cpu_load, rss_t rss_bytes);
+
+  // reader side, any process, never blocks the writer,
+  // false if writer did not finish update in time (killed in the middle of it), stats are stale
+  bool GetSnapshot(StreamStruct* stream, cpu_load_t* cpu_load, rss_t* rss_bytes) const WARN_UNUSED_RESULT;
+
+  // in-memory hls files, placed in same segment after this struct, nullptr if stream has no store
+  SharedHlsStore* GetHlsStore();
+
+  char id[MAX_SHARED_STREAM_ID_SIZE];
+  StreamType type;
+  fastotv::timestamp_t start_time;
+
+  uint32_t input_count;
+  uint32_t output_count;
+  SharedChannelStats input[MAX_SHARED_CHANNELS_COUNT];
+  SharedChannelStats output[MAX_SHARED_CHANNELS_COUNT];
+
+  uint64_t hls_store_offset;  // page aligned, 0 if no store
+  uint64_t segment_size;      // whole mapped segment
+
+ private:
+  void UpdateCheckPoints();
+  void BeginUpdate();
+  void EndUpdate();
+
+  std::atomic<uint32_t> sequence_;
+
+  std::atomic<fastotv::timestamp_t> loop_start_time_;  // seqlock
+  std::atomic<uint64_t> restarts_;                     // seqlock
+  std::atomic<int> status_;                            // seqlock
+  std::atomic<uint64_t> cpu_load_bits_;                // seqlock
+  std::atomic<rss_t> rss_bytes_;                       // seqlock
+
+  DISALLOW_COPY_AND_ASSIGN(SharedStreamStruct);
+};
+
+}  // namespace iptv_cloud
@@ -42,8 +42,24 @@ protocol::request_t ChangedSourcesStreamBroadcast(protocol::serializet_params_t
   return protocol::request_t::MakeNotification(CHANGED_SOURCES_STREAM, params);
 }
 
-protocol::request_t StatisticStreamBroadcast(protocol::serializet_params_t params) {
-  return protocol::request_t::MakeNotification(STATISTIC_STREAM, params);
+protocol::PipeMessage RestartStreamPipeRequest(protocol::seq_id_t seq) {
+  return protocol::PipeMessage(protocol::PIPE_REQUEST, protocol::PIPE_RESTART_STREAM, seq);
+}
+
+protocol::PipeMessage RestartStreamPipeResponceSuccess(protocol::seq_id_t seq) {
+  return protocol::PipeMessage(protocol::PIPE_RESPONSE, protocol::PIPE_RESTART_STREAM, seq);
+}
+
+protocol::PipeMessage StopStreamPipeRequest(protocol::seq_id_t seq) {
+  return protocol::PipeMessage(protocol::PIPE_REQUEST, protocol::PIPE_STOP_STREAM, seq);
+}
+
+protocol::PipeMessage StopStreamPipeResponceSuccess(protocol::seq_id_t seq) {
+  return protocol::PipeMessage(protocol::PIPE_RESPONSE, protocol::PIPE_STOP_STREAM, seq);
+}
+
+protocol::PipeMessage ChangedSourcesStreamPipeNotification(const std::string& params) {
+  return protocol::PipeMessage(protocol::PIPE_NOTIFICATION, protocol::PIPE_CHANGED_SOURCES_STREAM, 0, params);
 }
 
 }  // namespace iptv_cloud
@@ -14,13 +14,15 @@
 
 #pragma once
 
+#include <string>
+
+#include "protocol/pipe_protocol.h"
 #include "protocol/types.h"
 
 #define STOP_STREAM "stop"
 #define RESTART_STREAM "restart"
 
 #define CHANGED_SOURCES_STREAM "changed_source_stream"
-#define STATISTIC_STREAM "statistic_stream"
 
 namespace iptv_cloud {
 
@@ -32,6 +34,14 @@ protocol::response_t StopStreamResponceSuccess(protocol::sequance_id_t id);
 
 // Broadcast
 protocol::request_t ChangedSourcesStreamBroadcast(protocol::serializet_params_t params);  // ChangedSouresInfo
-protocol::request_t StatisticStreamBroadcast(protocol::serializet_params_t params);       // StatisticInfo
+
+// Binary pipe protocol
+protocol::PipeMessage RestartStreamPipeRequest(protocol::seq_id_t seq);
+protocol::PipeMessage RestartStreamPipeResponceSuccess(protocol::seq_id_t seq);
+
+protocol::PipeMessage StopStreamPipeRequest(protocol::seq_id_t seq);
+protocol::PipeMessage StopStreamPipeResponceSuccess(protocol::seq_id_t seq);
+
+protocol::PipeMessage ChangedSourcesStreamPipeNotification(const std::string& params);  // ChangedSouresInfo
 
 }  // namespace iptv_cloud
@@ -0,0 +1,130 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "protocol/pipe_protocol.h"
+
+namespace iptv_cloud {
+namespace protocol {
+
+namespace {
+
+void PutUInt32(uint32_t value, uint8_t* out) {
+  out[0] = static_cast<uint8_t>(value >> 24);
+  out[1] = static_cast<uint8_t>(value >> 16);
+  out[2] = static_cast<uint8_t>(value >> 8);
+  out[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t GetUInt32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+void PutUInt64(uint64_t value, uint8_t* out) {
+  PutUInt32(static_cast<uint32_t>(value >> 32), out);
+  PutUInt32(static_cast<uint32_t>(value), out + 4);
+}
+
+uint64_t GetUInt64(const uint8_t* data) {
+  return (static_cast<uint64_t>(GetUInt32(data)) << 32) | GetUInt32(data + 4);
+}
+
+}  // namespace
+
+PipeMessage::PipeMessage() : type(PIPE_REQUEST), command(PIPE_STOP_STREAM), seq(0), payload() {}
+
+PipeMessage::PipeMessage(PipeMessageType type, PipeCommand command, seq_id_t seq, const std::string& payload)
+    : type(type), command(command), seq(seq), payload(payload) {}
+
+bool PipeMessage::IsRequest() const {
+  return type == PIPE_REQUEST;
+}
+
+bool PipeMessage::IsResponse() const {
+  return type == PIPE_RESPONSE || type == PIPE_RESPONSE_ERROR;
+}
+
+bool PipeMessage::IsNotification() const {
+  return type == PIPE_NOTIFICATION;
+}
+
+bool IsValidPipeProtocol(int protocol) {
+  return protocol == JSON_RPC_PIPE_PROTOCOL || protocol == BINARY_PIPE_PROTOCOL;
+}
+
+const char* PipeCommandToString(PipeCommand command) {
+  if (command == PIPE_STOP_STREAM) {
+    return "stop";
+  } else if (command == PIPE_RESTART_STREAM) {
+    return "restart";
+  } else if (command == PIPE_CHANGED_SOURCES_STREAM) {
+    return "changed_source_stream";
+  }
+
+  return "unknown";
+}
+
+common::ErrnoError EncodePipeMessage(const PipeMessage& msg, std::string* out) {
+  if (!out) {
+    return common::make_errno_error_inval();
+  }
+
+  if (msg.payload.size() > MAX_PIPE_MESSAGE_PAYLOAD_SIZE) {
+    return common::make_errno_error("Pipe message payload too big", EINVAL);
+  }
+
+  uint8_t header[PIPE_MESSAGE_HEADER_SIZE];
+  header[0] = PIPE_MESSAGE_MAGIC;
+  header[1] = BINARY_PIPE_PROTOCOL;
+  header[2] = msg.type;
+  header[3] = msg.command;
+  PutUInt32(static_cast<uint32_t>(msg.payload.size()), header + 4);
+  PutUInt64(static_cast<uint64_t>(msg.seq), header + 8);
+
+  std::string result;
+  result.reserve(sizeof(header) + msg.payload.size());
+  result.append(reinterpret_cast<const char*>(header), sizeof(header));
+  result.append(msg.payload);
+  *out = result;
+  return common::ErrnoError();
+}
+
+common::ErrnoError DecodePipeMessageHeader(const void* data, size_t size, PipeMessageHeader* hdr) {
+  if (!data || size < PIPE_MESSAGE_HEADER_SIZE || !hdr) {
+    return common::make_errno_error_inval();
+  }
+
+  const uint8_t* header = static_cast<const uint8_t*>(data);
+  if (header[0] != PIPE_MESSAGE_MAGIC || header[1] != BINARY_PIPE_PROTOCOL) {
+    return common::make_errno_error("Invalid pipe message header", EINVAL);
+  }
+
+  if (header[2] > PIPE_NOTIFICATION || header[3] > PIPE_CHANGED_SOURCES_STREAM) {
+    return common::make_errno_error("Unknown pipe message type", EINVAL);
+  }
+
+  const uint32_t payload_size = GetUInt32(header + 4);
+  if (payload_size > MAX_PIPE_MESSAGE_PAYLOAD_SIZE) {
+    return common::make_errno_error("Pipe message payload too big", EINVAL);
+  }
+
+  hdr->type = static_cast<PipeMessageType>(header[2]);
+  hdr->command = static_cast<PipeCommand>(header[3]);
+  hdr->payload_size = payload_size;
+  hdr->seq = static_cast<seq_id_t>(GetUInt64(header + 8));
+  return common::ErrnoError();
+}
+
+}  // namespace protocol
+}  // namespace iptv_cloud
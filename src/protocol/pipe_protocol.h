@@ -0,0 +1,69 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include <common/error.h>
+
+#include "protocol/types.h"
+
+#define PIPE_MESSAGE_MAGIC 0xFA
+#define PIPE_MESSAGE_HEADER_SIZE 16
+#define MAX_PIPE_MESSAGE_PAYLOAD_SIZE (1024 * 1024)
+
+namespace iptv_cloud {
+namespace protocol {
+
+// Internal daemon <-> stream child protocol, chosen by the daemon at fork time (cmd_args::pipe_protocol).
+// JSON-RPC stays for external clients only.
+enum PipeProtocol : uint8_t { JSON_RPC_PIPE_PROTOCOL = 0, BINARY_PIPE_PROTOCOL = 1 };
+
+enum PipeMessageType : uint8_t { PIPE_REQUEST = 0, PIPE_RESPONSE, PIPE_RESPONSE_ERROR, PIPE_NOTIFICATION };
+
+enum PipeCommand : uint8_t { PIPE_STOP_STREAM = 0, PIPE_RESTART_STREAM, PIPE_CHANGED_SOURCES_STREAM };
+
+// Frame: magic(1) protocol(1) type(1) command(1) payload_size(4) seq(8), integers in big endian
+struct PipeMessageHeader {
+  PipeMessageType type;
+  PipeCommand command;
+  uint32_t payload_size;
+  seq_id_t seq;
+};
+
+struct PipeMessage {
+  PipeMessage();
+  PipeMessage(PipeMessageType type, PipeCommand command, seq_id_t seq, const std::string& payload = std::string());
+
+  bool IsRequest() const;
+  bool IsResponse() const;
+  bool IsNotification() const;
+
+  PipeMessageType type;
+  PipeCommand command;
+  seq_id_t seq;
+  std::string payload;
+};
+
+bool IsValidPipeProtocol(int protocol);
+const char* PipeCommandToString(PipeCommand command);
+
+common::ErrnoError EncodePipeMessage(const PipeMessage& msg, std::string* out) WARN_UNUSED_RESULT;
+common::ErrnoError DecodePipeMessageHeader(const void* data, size_t size, PipeMessageHeader* hdr) WARN_UNUSED_RESULT;
+
+}  // namespace protocol
+}  // namespace iptv_cloud
@@ -14,10 +14,14 @@
 
 #pragma once
 
+#include <string>
+
 #include <common/protocols/json_rpc/protocol_client.h>
 
 #include <common/text_decoders/compress_zlib_edcoder.h>
 
+#include "protocol/pipe_protocol.h"
+
 namespace iptv_cloud {
 namespace protocol {
 
@@ -32,5 +36,92 @@ using ProtocolClient = common::protocols::json_rpc::ProtocolClient<Client, IptvC
 
 typedef ProtocolClient<common::libev::IoClient> protocol_client_t;
 
+// Daemon <-> stream child channel, speaks JSON-RPC or length-prefixed binary frames depending on pipe protocol.
+template <typename Client>
+class PipeProtocolClient : public ProtocolClient<Client> {
+ public:
+  typedef ProtocolClient<Client> base_class;
+
+  template <typename... Args>
+  explicit PipeProtocolClient(Args... args) : base_class(args...), pipe_protocol_(JSON_RPC_PIPE_PROTOCOL) {}
+
+  PipeProtocol GetPipeProtocol() const { return pipe_protocol_; }
+  void SetPipeProtocol(PipeProtocol protocol) { pipe_protocol_ = protocol; }
+  bool IsBinaryPipeProtocol() const { return pipe_protocol_ == BINARY_PIPE_PROTOCOL; }
+
+  common::ErrnoError WriteMessage(const PipeMessage& msg) WARN_UNUSED_RESULT {
+    std::string data;
+    common::ErrnoError err = EncodePipeMessage(msg, &data);
+    if (err) {
+      return err;
+    }
+
+    return WriteFully(data.data(), data.size());
+  }
+
+  common::ErrnoError ReadMessage(PipeMessage* msg) WARN_UNUSED_RESULT {
+    if (!msg) {
+      return common::make_errno_error_inval();
+    }
+
+    char header[PIPE_MESSAGE_HEADER_SIZE];
+    common::ErrnoError err = ReadFully(header, sizeof(header));
+    if (err) {
+      return err;
+    }
+
+    PipeMessageHeader hdr;
+    err = DecodePipeMessageHeader(header, sizeof(header), &hdr);
+    if (err) {
+      return err;
+    }
+
+    std::string payload(hdr.payload_size, 0);
+    if (hdr.payload_size) {
+      err = ReadFully(&payload[0], payload.size());
+      if (err) {
+        return err;
+      }
+    }
+
+    *msg = PipeMessage(hdr.type, hdr.command, hdr.seq, payload);
+    return common::ErrnoError();
+  }
+
+ private:
+  common::ErrnoError WriteFully(const char* data, size_t size) WARN_UNUSED_RESULT {
+    size_t total = 0;
+    while (total < size) {
+      size_t nwrite = 0;
+      common::ErrnoError err = this->SingleWrite(data + total, size - total, &nwrite);
+      if (err) {
+        return err;
+      }
+      total += nwrite;
+    }
+    return common::ErrnoError();
+  }
+
+  common::ErrnoError ReadFully(char* out, size_t size) WARN_UNUSED_RESULT {
+    size_t total = 0;
+    while (total < size) {
+      size_t nread = 0;
+      common::ErrnoError err = this->SingleRead(out + total, size - total, &nread);
+      if (err) {
+        return err;
+      }
+      if (nread == 0) {
+        return common::make_errno_error("Pipe closed", ECONNRESET);
+      }
+      total += nread;
+    }
+    return common::ErrnoError();
+  }
+
+  PipeProtocol pipe_protocol_;
+};
+
+typedef PipeProtocolClient<common::libev::IoClient> pipe_client_t;
+
 }  // namespace protocol
 }  // namespace iptv_cloud
@@ -0,0 +1,328 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/async_http_client.h"
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <common/sprintf.h>
+
+#define MAX_SENDFILE_CHUNK_SIZE (1024 * 1024)
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+namespace {
+const char* GetStatusText(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 206:
+      return "Partial Content";
+    case 304:
+      return "Not Modified";
+    case 400:
+      return "Bad Request";
+    case 403:
+      return "Forbidden";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 408:
+      return "Request Timeout";
+    case 413:
+      return "Payload Too Large";
+    case 416:
+      return "Range Not Satisfiable";
+    case 500:
+      return "Internal Server Error";
+    case 501:
+      return "Not Implemented";
+    case 503:
+      return "Service Unavailable";
+    default:
+      return "Unknown";
+  }
+}
+
+std::string MakeHttpDate(time_t t) {
+  char buf[64] = {0};
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return buf;
+}
+}  // namespace
+
+AsyncHttpClient::AsyncHttpClient(common::libev::IoLoop* server, const common::net::socket_info& info)
+    : base_class(server, info),
+      input_(),
+      read_deadline_(0),
+      parts_(),
+      current_part_(0),
+      body_file_(),
+      body_file_offset_(0),
+      body_data_(nullptr),
+      body_check_(),
+      sending_(false),
+      keep_alive_(false),
+      send_deadline_(0) {
+  const descriptor_t fd = GetFd();
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags != -1 && !(flags & O_NONBLOCK)) {
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  }
+}
+
+AsyncHttpClient::~AsyncHttpClient() {
+  ResetResponse();
+}
+
+common::ErrnoError AsyncHttpClient::ReadRequestData() {
+  char buff[BUF_SIZE];
+  size_t nread = 0;
+  common::ErrnoError err = SingleRead(buff, BUF_SIZE, &nread);
+  if (err) {
+    if (err->GetErrorCode() == EAGAIN) {
+      return common::ErrnoError();
+    }
+    return err;
+  }
+
+  if (nread == 0) {
+    return common::make_errno_error("Connection closed by peer.", ECONNRESET);
+  }
+
+  input_.append(buff, nread);
+  if (!read_deadline_) {
+    RestartReadDeadline();
+  }
+  if (input_.size() > MAX_HTTP_REQUEST_SIZE && input_.find("\r\n\r\n") == std::string::npos) {
+    return common::make_errno_error("Http request too big.", EMSGSIZE);
+  }
+  return common::ErrnoError();
+}
+
+bool AsyncHttpClient::PopRequest(std::string* request) {
+  if (!request) {
+    return false;
+  }
+
+  const size_t pos = input_.find("\r\n\r\n");
+  if (pos == std::string::npos) {
+    return false;
+  }
+
+  *request = input_.substr(0, pos + 4);
+  input_.erase(0, pos + 4);
+  RestartReadDeadline();
+  return true;
+}
+
+bool AsyncHttpClient::IsSending() const {
+  return sending_;
+}
+
+bool AsyncHttpClient::IsKeepAlive() const {
+  return keep_alive_;
+}
+
+bool AsyncHttpClient::IsSendExpired(common::time64_t current_time) const {
+  return sending_ && send_deadline_ < current_time;
+}
+
+bool AsyncHttpClient::IsReadExpired(common::time64_t current_time) const {
+  return !sending_ && read_deadline_ && read_deadline_ < current_time;
+}
+
+void AsyncHttpClient::QueueHeaders(common::http::http_protocol protocol,
+                                   common::http::http_status status,
+                                   const char* extra_header,
+                                   const char* mime_type,
+                                   const off_t* length,
+                                   const time_t* mod,
+                                   bool is_keep_alive,
+                                   const common::libev::http::HttpServerInfo& info) {
+  ResetResponse();
+  const int code = static_cast<int>(status);
+  const char* protocol_str = protocol == common::http::HP_1_0 ? "HTTP/1.0" : "HTTP/1.1";
+  std::string head = common::MemSPrintf("%s %d %s\r\n", protocol_str, code, GetStatusText(code));
+  head += "Server: " + info.server_name + "\r\n";
+  head += "Date: " + MakeHttpDate(time(nullptr)) + "\r\n";
+  if (extra_header) {
+    head += extra_header;
+    head += "\r\n";
+  }
+  if (mime_type) {
+    head += common::MemSPrintf("Content-Type: %s\r\n", mime_type);
+  }
+  if (length) {
+    head += common::MemSPrintf("Content-Length: %lld\r\n", static_cast<long long>(*length));
+  }
+  if (mod) {
+    head += "Last-Modified: " + MakeHttpDate(*mod) + "\r\n";
+  }
+  head += is_keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+  parts_.push_back({head, 0, 0, 0});
+
+  keep_alive_ = is_keep_alive;
+  sending_ = true;
+  send_deadline_ = common::time::current_utc_mstime() + SEND_TIMEOUT_MSEC;
+}
+
+void AsyncHttpClient::QueueError(common::http::http_protocol protocol,
+                                 common::http::http_status status,
+                                 const char* extra_header,
+                                 const char* text,
+                                 bool is_keep_alive,
+                                 const common::libev::http::HttpServerInfo& info) {
+  const int code = static_cast<int>(status);
+  const char* title = GetStatusText(code);
+  const std::string body = common::MemSPrintf(
+      "<html><head><title>%d %s</title></head><body><h4>%d %s</h4>%s</body></html>\n", code, title, code, title,
+      text ? text : "");
+  const off_t length = body.size();
+  QueueHeaders(protocol, status, extra_header, "text/html", &length, nullptr, is_keep_alive, info);
+  QueueTrailer(body);
+}
+
+void AsyncHttpClient::SetBodyFile(opened_file_t file, off_t file_offset, body_check_t check) {
+  body_file_ = file;
+  body_file_offset_ = file_offset;
+  body_data_ = nullptr;
+  body_check_ = check;
+}
+
+void AsyncHttpClient::SetBodyBuffer(const char* data, body_check_t check) {
+  body_file_.reset();
+  body_file_offset_ = 0;
+  body_data_ = data;
+  body_check_ = check;
+}
+
+void AsyncHttpClient::QueueBodyPart(const std::string& prefix, off_t offset, off_t size) {
+  parts_.push_back({prefix, 0, offset, offset + size});
+}
+
+void AsyncHttpClient::QueueTrailer(const std::string& trailer) {
+  parts_.push_back({trailer, 0, 0, 0});
+}
+
+common::ErrnoError AsyncHttpClient::Flush(bool* done) {
+  if (!done) {
+    return common::make_errno_error_inval();
+  }
+
+  *done = false;
+  if (!sending_) {
+    *done = true;
+    return common::ErrnoError();
+  }
+
+  const descriptor_t sock = GetFd();
+  bool progress = false;
+  while (current_part_ < parts_.size()) {
+    Part* part = &parts_[current_part_];
+    ssize_t nwrite = 0;
+    if (part->data_offset < part->data.size()) {
+      const bool more = part->offset < part->end || current_part_ + 1 < parts_.size();
+      nwrite = send(sock, part->data.data() + part->data_offset, part->data.size() - part->data_offset,
+                    MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      if (nwrite > 0) {
+        part->data_offset += nwrite;
+      }
+    } else if (part->offset < part->end) {
+      if (body_check_ && !body_check_()) {
+        return common::make_errno_error("Body data changed while sending.", EIO);
+      }
+
+      if (body_file_) {
+        const size_t chunk = std::min<off_t>(part->end - part->offset, MAX_SENDFILE_CHUNK_SIZE);
+        off_t file_offset = body_file_offset_ + part->offset;
+        nwrite = sendfile(sock, body_file_->GetFd(), &file_offset, chunk);
+        if (nwrite == 0) {
+          return common::make_errno_error("File truncated while sending.", EIO);
+        }
+        if (nwrite > 0) {
+          part->offset += nwrite;
+        }
+      } else if (!body_data_) {
+        return common::make_errno_error("Body source not set.", EINVAL);
+      } else {
+        nwrite = send(sock, body_data_ + part->offset, part->end - part->offset, MSG_NOSIGNAL);
+        if (nwrite > 0) {
+          part->offset += nwrite;
+        }
+      }
+    } else {
+      current_part_++;
+      continue;
+    }
+
+    if (nwrite < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (progress) {  // deadline counts from last progress, big files are fine for any alive client
+          send_deadline_ = common::time::current_utc_mstime() + SEND_TIMEOUT_MSEC;
+        }
+        WaitWritable();
+        return common::ErrnoError();
+      }
+      return common::make_errno_error(errno);
+    }
+    progress = true;
+  }
+
+  if (body_check_ && !body_check_()) {  // client sees truncated response and retries
+    return common::make_errno_error("Body data changed while sending.", EIO);
+  }
+
+  ResetResponse();
+  RestartReadDeadline();  // pipelined data was not read while sending
+  SetFlags(EV_READ);
+  *done = true;
+  return common::ErrnoError();
+}
+
+void AsyncHttpClient::WaitWritable() {
+  SetFlags(EV_WRITE);  // no reads until response sent
+}
+
+void AsyncHttpClient::ResetResponse() {
+  parts_.clear();
+  current_part_ = 0;
+  body_file_.reset();
+  body_file_offset_ = 0;
+  body_data_ = nullptr;
+  body_check_ = body_check_t();
+  sending_ = false;
+  send_deadline_ = 0;
+}
+
+void AsyncHttpClient::RestartReadDeadline() {
+  read_deadline_ = input_.empty() ? 0 : common::time::current_utc_mstime() + READ_TIMEOUT_MSEC;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
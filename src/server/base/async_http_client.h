@@ -0,0 +1,112 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <common/libev/http/http_client.h>
+#include <common/time.h>
+
+#include "server/base/open_files_cache.h"
+
+#define MAX_HTTP_REQUEST_SIZE 8192
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+// Http client with non blocking socket, requests are buffered until head is complete,
+// response is queued and sent piece by piece when socket is ready for write, so slow client never blocks loop.
+class AsyncHttpClient : public common::libev::http::HttpClient {
+ public:
+  enum { BUF_SIZE = 4096, SEND_TIMEOUT_MSEC = 30000, READ_TIMEOUT_MSEC = 10000 };
+  typedef common::libev::http::HttpClient base_class;
+  // called before every send of body and after whole body sent, false if body data was changed,
+  // connection is aborted then, part of response is already on the wire
+  typedef std::function<bool()> body_check_t;
+
+  AsyncHttpClient(common::libev::IoLoop* server, const common::net::socket_info& info);
+  ~AsyncHttpClient() override;
+
+  // error if peer closed connection or request head is too big
+  common::ErrnoError ReadRequestData() WARN_UNUSED_RESULT;
+  bool PopRequest(std::string* request);
+
+  // only one response in flight, next request processed after whole response sent
+  bool IsSending() const;
+  bool IsKeepAlive() const;
+  bool IsSendExpired(common::time64_t current_time) const;
+  // started request head is not completed in time, trickling bytes don't extend deadline
+  bool IsReadExpired(common::time64_t current_time) const;
+
+  void QueueHeaders(common::http::http_protocol protocol,
+                    common::http::http_status status,
+                    const char* extra_header,
+                    const char* mime_type,
+                    const off_t* length,
+                    const time_t* mod,
+                    bool is_keep_alive,
+                    const common::libev::http::HttpServerInfo& info);
+  void QueueError(common::http::http_protocol protocol,
+                  common::http::http_status status,
+                  const char* extra_header,
+                  const char* text,
+                  bool is_keep_alive,
+                  const common::libev::http::HttpServerInfo& info);
+  // body source for parts queued after headers, file is referenced until response sent,
+  // body offsets are relative to file_offset
+  void SetBodyFile(opened_file_t file, off_t file_offset = 0, body_check_t check = body_check_t());
+  void SetBodyBuffer(const char* data, body_check_t check = body_check_t());
+  void QueueBodyPart(const std::string& prefix, off_t offset, off_t size);  // prefix is sent before range
+  void QueueTrailer(const std::string& trailer);
+
+  // sends as much as socket accepts, done is true when whole response is sent
+  common::ErrnoError Flush(bool* done) WARN_UNUSED_RESULT;
+
+ private:
+  struct Part {
+    std::string data;  // sent before body range
+    size_t data_offset;
+    off_t offset;  // body range
+    off_t end;
+  };
+
+  void WaitWritable();
+  void ResetResponse();
+  void RestartReadDeadline();
+
+  std::string input_;
+  common::time64_t read_deadline_;  // 0 if no buffered request data
+
+  std::vector<Part> parts_;  // first part holds headers
+  size_t current_part_;
+
+  opened_file_t body_file_;
+  off_t body_file_offset_;
+  const char* body_data_;
+  body_check_t body_check_;
+
+  bool sending_;
+  bool keep_alive_;
+  common::time64_t send_deadline_;
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,129 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/http_range.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+namespace {
+std::string TrimSpaces(const std::string& str) {
+  const size_t first = str.find_first_not_of(" \t");
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  const size_t last = str.find_last_not_of(" \t");
+  return str.substr(first, last - first + 1);
+}
+
+bool ParseOffset(const std::string& str, off_t* out) {
+  if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+
+  char* end = nullptr;
+  errno = 0;
+  long long value = strtoll(str.c_str(), &end, 10);
+  if (errno == ERANGE) {
+    return false;
+  }
+
+  *out = value;
+  return true;
+}
+}  // namespace
+
+HttpRangeResult ParseHttpRange(const std::string& value, off_t size, std::vector<HttpRange>* ranges) {
+  if (!ranges) {
+    return HTTP_RANGE_NONE;
+  }
+
+  static const std::string bytes_unit = "bytes=";
+  if (value.compare(0, bytes_unit.size(), bytes_unit) != 0) {
+    return HTTP_RANGE_NONE;
+  }
+
+  std::vector<std::string> specs;
+  size_t start = bytes_unit.size();
+  while (start <= value.size()) {
+    size_t comma = value.find(',', start);
+    if (comma == std::string::npos) {
+      comma = value.size();
+    }
+    const std::string spec = TrimSpaces(value.substr(start, comma - start));
+    if (!spec.empty()) {
+      specs.push_back(spec);
+    }
+    start = comma + 1;
+  }
+
+  if (specs.empty() || specs.size() > MAX_HTTP_RANGES_COUNT) {
+    return HTTP_RANGE_NONE;
+  }
+
+  std::vector<HttpRange> result;
+  for (const std::string& spec : specs) {
+    const size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+      return HTTP_RANGE_NONE;
+    }
+
+    const std::string first_str = spec.substr(0, dash);
+    const std::string last_str = spec.substr(dash + 1);
+    off_t first = 0;
+    off_t last = 0;
+    if (first_str.empty()) {  // suffix, last n bytes
+      off_t suffix = 0;
+      if (!ParseOffset(last_str, &suffix)) {
+        return HTTP_RANGE_NONE;
+      }
+      if (suffix == 0 || size == 0) {
+        continue;
+      }
+      first = suffix < size ? size - suffix : 0;
+      last = size - 1;
+    } else {
+      if (!ParseOffset(first_str, &first)) {
+        return HTTP_RANGE_NONE;
+      }
+      if (last_str.empty()) {
+        last = size - 1;
+      } else if (!ParseOffset(last_str, &last) || last < first) {
+        return HTTP_RANGE_NONE;
+      }
+      if (first >= size) {
+        continue;
+      }
+      if (last >= size) {
+        last = size - 1;
+      }
+    }
+    result.push_back({first, last});
+  }
+
+  if (result.empty()) {
+    return HTTP_RANGE_NOT_SATISFIABLE;
+  }
+
+  *ranges = result;
+  return HTTP_RANGE_SATISFIABLE;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,44 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#define MAX_HTTP_RANGES_COUNT 16
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+struct HttpRange {
+  off_t first;
+  off_t last;  // inclusive
+};
+
+enum HttpRangeResult {
+  HTTP_RANGE_NONE = 0,        // no or malformed header, whole file should be sent
+  HTTP_RANGE_SATISFIABLE,     // ranges are clamped to file size and ordered as requested
+  HTTP_RANGE_NOT_SATISFIABLE  // valid header but no range overlaps file
+};
+
+// parses "Range: bytes=0-99,200-,-50" header value
+HttpRangeResult ParseHttpRange(const std::string& value, off_t size, std::vector<HttpRange>* ranges);
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
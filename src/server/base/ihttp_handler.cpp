@@ -0,0 +1,334 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/ihttp_handler.h"
+
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include <common/sprintf.h>
+
+#include "server/base/async_http_client.h"
+#include "server/base/http_range.h"
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+namespace {
+// statuses without names in common::http::http_status
+const common::http::http_status kHttpPartialContent = static_cast<common::http::http_status>(206);
+const common::http::http_status kHttpNotModified = static_cast<common::http::http_status>(304);
+const common::http::http_status kHttpRequestTimeout = static_cast<common::http::http_status>(408);
+const common::http::http_status kHttpRangeNotSatisfiable = static_cast<common::http::http_status>(416);
+
+std::string TrimSpaces(const std::string& str) {
+  const size_t first = str.find_first_not_of(" \t");
+  if (first == std::string::npos) {
+    return std::string();
+  }
+  const size_t last = str.find_last_not_of(" \t");
+  return str.substr(first, last - first + 1);
+}
+
+bool IsETagMatch(const std::string& value, const std::string& etag) {
+  size_t start = 0;
+  while (start <= value.size()) {
+    size_t comma = value.find(',', start);
+    if (comma == std::string::npos) {
+      comma = value.size();
+    }
+    std::string tag = TrimSpaces(value.substr(start, comma - start));
+    if (tag.compare(0, 2, "W/") == 0) {  // weak comparison for GET
+      tag = tag.substr(2);
+    }
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+    start = comma + 1;
+  }
+  return false;
+}
+
+bool ParseHttpDate(const std::string& value, time_t* out) {
+  struct tm tm = {};
+  const char* end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  if (!end) {
+    return false;
+  }
+  *out = timegm(&tm);
+  return true;
+}
+}  // namespace
+
+IHttpHandler::IHttpHandler()
+    : base_class(), send_timeout_timer_(INVALID_TIMER_ID), files_cache_(), boundary_id_(0) {}
+
+void IHttpHandler::PreLooped(common::libev::IoLoop* server) {
+  send_timeout_timer_ = server->CreateTimer(CHECK_TIMEOUTS_SECONDS, true);
+  base_class::PreLooped(server);
+}
+
+void IHttpHandler::TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) {
+  if (send_timeout_timer_ == id) {
+    static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
+    const common::time64_t current_time = common::time::current_utc_mstime();
+    std::vector<common::libev::IoClient*> clients = server->GetClients();
+    for (size_t i = 0; i < clients.size(); ++i) {
+      AsyncHttpClient* hclient = static_cast<AsyncHttpClient*>(clients[i]);
+      if (hclient->IsSendExpired(current_time)) {
+        WARNING_LOG() << "Http client " << hclient->GetFormatedName() << " send timeout, closing connection.";
+        hclient->Close();
+        delete hclient;
+      } else if (hclient->IsReadExpired(current_time)) {
+        WARNING_LOG() << "Http client " << hclient->GetFormatedName() << " request timeout, closing connection.";
+        hclient->QueueError(common::http::HP_1_1, kHttpRequestTimeout, nullptr, "Request timeout.", false, hinf);
+        FlushResponse(hclient);  // closed when sent, otherwise by send timeout
+      }
+    }
+  }
+  base_class::TimerEmited(server, id);
+}
+
+void IHttpHandler::DataReceived(common::libev::IoClient* client) {
+  AsyncHttpClient* hclient = static_cast<AsyncHttpClient*>(client);
+  common::ErrnoError err = hclient->ReadRequestData();
+  if (err) {
+    hclient->Close();
+    delete hclient;
+    return base_class::DataReceived(client);
+  }
+
+  ProcessRequests(hclient);
+  base_class::DataReceived(client);
+}
+
+void IHttpHandler::DataReadyToWrite(common::libev::IoClient* client) {
+  AsyncHttpClient* hclient = static_cast<AsyncHttpClient*>(client);
+  if (FlushResponse(hclient)) {
+    ProcessRequests(hclient);  // pipelined requests
+  }
+  base_class::DataReadyToWrite(client);
+}
+
+void IHttpHandler::ProcessRequests(AsyncHttpClient* hclient) {
+  std::string request;
+  while (!hclient->IsSending() && hclient->PopRequest(&request)) {
+    ProcessReceived(hclient, request.c_str(), request.size());
+    if (!hclient->IsSending()) {  // nothing to answer
+      hclient->Close();
+      delete hclient;
+      return;
+    }
+
+    if (!FlushResponse(hclient)) {
+      return;
+    }
+  }
+}
+
+void IHttpHandler::QueueFileContent(AsyncHttpClient* hclient,
+                                    const common::http::HttpRequest& hrequest,
+                                    const std::string& file_path,
+                                    const std::string& mime,
+                                    bool keep_alive,
+                                    const common::libev::http::HttpServerInfo& hinf) {
+  opened_file_t file;
+  if (!OpenFile(hclient, hrequest, file_path, keep_alive, hinf, &file)) {
+    return;
+  }
+
+  QueueContent(hclient, hrequest, file->GetSize(), file->GetMtime(), file->GetETag(), mime, keep_alive, hinf,
+               [file](AsyncHttpClient* client) { client->SetBodyFile(file); });
+}
+
+void IHttpHandler::QueueFilePartContent(AsyncHttpClient* hclient,
+                                        const common::http::HttpRequest& hrequest,
+                                        const std::string& file_path,
+                                        off_t offset,
+                                        off_t size,
+                                        const std::string& etag,
+                                        const std::string& mime,
+                                        bool keep_alive,
+                                        const common::libev::http::HttpServerInfo& hinf,
+                                        body_check_t check) {
+  opened_file_t file;
+  if (!OpenFile(hclient, hrequest, file_path, keep_alive, hinf, &file)) {
+    return;
+  }
+
+  QueueFilePartContent(hclient, hrequest, file, offset, size, file->GetMtime(), etag, mime, keep_alive, hinf, check);
+}
+
+void IHttpHandler::QueueFilePartContent(AsyncHttpClient* hclient,
+                                        const common::http::HttpRequest& hrequest,
+                                        opened_file_t file,
+                                        off_t offset,
+                                        off_t size,
+                                        time_t mtime,
+                                        const std::string& etag,
+                                        const std::string& mime,
+                                        bool keep_alive,
+                                        const common::libev::http::HttpServerInfo& hinf,
+                                        body_check_t check) {
+  QueueContent(hclient, hrequest, size, mtime, etag, mime, keep_alive, hinf,
+               [file, offset, check](AsyncHttpClient* client) { client->SetBodyFile(file, offset, check); });
+}
+
+bool IHttpHandler::OpenFile(AsyncHttpClient* hclient,
+                            const common::http::HttpRequest& hrequest,
+                            const std::string& file_path,
+                            bool keep_alive,
+                            const common::libev::http::HttpServerInfo& hinf,
+                            opened_file_t* file) {
+  common::ErrnoError err = files_cache_.Open(file_path, file);
+  if (!err) {
+    return true;
+  }
+
+  const common::http::http_protocol protocol = hrequest.GetProtocol();
+  const int code = err->GetErrorCode();
+  if (code == ENOENT || code == ENOTDIR) {
+    hclient->QueueError(protocol, common::http::HS_NOT_FOUND, nullptr, "File not found.", keep_alive, hinf);
+  } else if (code == EISDIR) {
+    hclient->QueueError(protocol, common::http::HS_BAD_REQUEST, nullptr, "Bad filename.", keep_alive, hinf);
+  } else {
+    hclient->QueueError(protocol, common::http::HS_FORBIDDEN, nullptr, "File is protected.", keep_alive, hinf);
+  }
+  return false;
+}
+
+void IHttpHandler::QueueContent(AsyncHttpClient* hclient,
+                                const common::http::HttpRequest& hrequest,
+                                off_t size,
+                                time_t mtime,
+                                const std::string& etag,
+                                const std::string& mime,
+                                bool keep_alive,
+                                const common::libev::http::HttpServerInfo& hinf,
+                                body_source_t set_source) {
+  const common::http::http_protocol protocol = hrequest.GetProtocol();
+  const std::string validators = "ETag: " + etag + "\r\nAccept-Ranges: bytes";
+
+  // conditional get, If-None-Match has precedence
+  common::http::header_t field;
+  bool not_modified = false;
+  if (hrequest.FindHeaderByKey("If-None-Match", false, &field)) {
+    not_modified = IsETagMatch(field.value, etag);
+  } else if (hrequest.FindHeaderByKey("If-Modified-Since", false, &field)) {
+    time_t since = 0;
+    not_modified = ParseHttpDate(field.value, &since) && mtime <= since;
+  }
+
+  if (not_modified) {
+    hclient->QueueHeaders(protocol, kHttpNotModified, validators.c_str(), nullptr, nullptr, &mtime, keep_alive, hinf);
+    return;
+  }
+
+  const bool is_get = hrequest.GetMethod() == common::http::http_method::HM_GET;
+  std::vector<HttpRange> ranges;
+  HttpRangeResult range_result = HTTP_RANGE_NONE;
+  if (is_get && hrequest.FindHeaderByKey("Range", false, &field)) {
+    const std::string range = field.value;
+    time_t if_range_time = 0;
+    bool if_range_ok = true;
+    if (hrequest.FindHeaderByKey("If-Range", false, &field)) {
+      const std::string if_range = TrimSpaces(field.value);
+      if_range_ok = if_range == etag || (ParseHttpDate(if_range, &if_range_time) && mtime <= if_range_time);
+    }
+    if (if_range_ok) {
+      range_result = ParseHttpRange(range, size, &ranges);
+    }
+  }
+
+  if (range_result == HTTP_RANGE_NOT_SATISFIABLE) {
+    const std::string extra =
+        validators + common::MemSPrintf("\r\nContent-Range: bytes */%lld", static_cast<long long>(size));
+    const off_t length = 0;
+    hclient->QueueHeaders(protocol, kHttpRangeNotSatisfiable, extra.c_str(), nullptr, &length, nullptr, keep_alive,
+                          hinf);
+    return;
+  }
+
+  if (range_result == HTTP_RANGE_NONE) {
+    hclient->QueueHeaders(protocol, common::http::HS_OK, validators.c_str(), mime.c_str(), &size, &mtime, keep_alive,
+                          hinf);
+    if (is_get) {
+      set_source(hclient);
+      hclient->QueueBodyPart(std::string(), 0, size);
+    }
+    return;
+  }
+
+  if (ranges.size() == 1) {
+    const HttpRange range = ranges[0];
+    const off_t length = range.last - range.first + 1;
+    const std::string extra =
+        validators + common::MemSPrintf("\r\nContent-Range: bytes %lld-%lld/%lld", static_cast<long long>(range.first),
+                                        static_cast<long long>(range.last), static_cast<long long>(size));
+    hclient->QueueHeaders(protocol, kHttpPartialContent, extra.c_str(), mime.c_str(), &length, &mtime, keep_alive,
+                          hinf);
+    set_source(hclient);
+    hclient->QueueBodyPart(std::string(), range.first, length);
+    return;
+  }
+
+  // multipart/byteranges, parts are sent in requested order
+  const std::string boundary = common::MemSPrintf("%016llx", static_cast<unsigned long long>(++boundary_id_));
+  std::vector<std::string> prefixes;
+  off_t length = 0;
+  for (const HttpRange& range : ranges) {
+    const std::string prefix =
+        common::MemSPrintf("\r\n--%s\r\nContent-Type: %s\r\nContent-Range: bytes %lld-%lld/%lld\r\n\r\n", boundary,
+                           mime, static_cast<long long>(range.first), static_cast<long long>(range.last),
+                           static_cast<long long>(size));
+    prefixes.push_back(prefix);
+    length += prefix.size() + (range.last - range.first + 1);
+  }
+  const std::string trailer = "\r\n--" + boundary + "--\r\n";
+  length += trailer.size();
+
+  const std::string content_type = "multipart/byteranges; boundary=" + boundary;
+  hclient->QueueHeaders(protocol, kHttpPartialContent, validators.c_str(), content_type.c_str(), &length, &mtime,
+                        keep_alive, hinf);
+  set_source(hclient);
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    hclient->QueueBodyPart(prefixes[i], ranges[i].first, ranges[i].last - ranges[i].first + 1);
+  }
+  hclient->QueueTrailer(trailer);
+}
+
+bool IHttpHandler::FlushResponse(AsyncHttpClient* hclient) {
+  bool done = false;
+  common::ErrnoError err = hclient->Flush(&done);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    hclient->Close();
+    delete hclient;
+    return false;
+  }
+
+  if (done && !hclient->IsKeepAlive()) {
+    hclient->Close();
+    delete hclient;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,113 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include <common/libev/http/http_client.h>
+
+#include "server/base/iserver_handler.h"
+#include "server/base/open_files_cache.h"
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+class AsyncHttpClient;
+
+// Drives request/response state machine of AsyncHttpClient: buffers partial requests, processes them one by one,
+// resumes sending on write readiness, drops clients which stopped reading response and answers 408 to clients
+// which didn't complete request head.
+// Static content is answered with conditional GET (ETag, If-Modified-Since) and byte ranges support.
+class IHttpHandler : public IServerHandler {
+ public:
+  enum { CHECK_TIMEOUTS_SECONDS = 5 };
+  typedef IServerHandler base_class;
+  IHttpHandler();
+
+  void PreLooped(common::libev::IoLoop* server) override;
+  void TimerEmited(common::libev::IoLoop* server, common::libev::timer_id_t id) override;
+
+  void DataReceived(common::libev::IoClient* client) override;
+  void DataReadyToWrite(common::libev::IoClient* client) override;
+
+ protected:
+  typedef std::function<void(AsyncHttpClient* hclient)> body_source_t;
+  typedef std::function<bool()> body_check_t;  // same as AsyncHttpClient::body_check_t
+
+  // request is complete http head, response (or error) should be queued into client
+  virtual void ProcessReceived(AsyncHttpClient* hclient, const char* request, size_t req_len) = 0;
+
+  // file from open files cache, answers not found/forbidden errors too
+  void QueueFileContent(AsyncHttpClient* hclient,
+                        const common::http::HttpRequest& hrequest,
+                        const std::string& file_path,
+                        const std::string& mime,
+                        bool keep_alive,
+                        const common::libev::http::HttpServerInfo& hinf);
+  // range of such file served as whole content, check is called before every send and after body sent
+  void QueueFilePartContent(AsyncHttpClient* hclient,
+                            const common::http::HttpRequest& hrequest,
+                            const std::string& file_path,
+                            off_t offset,
+                            off_t size,
+                            const std::string& etag,
+                            const std::string& mime,
+                            bool keep_alive,
+                            const common::libev::http::HttpServerInfo& hinf,
+                            body_check_t check);
+  // same for already opened file, like memory file
+  void QueueFilePartContent(AsyncHttpClient* hclient,
+                            const common::http::HttpRequest& hrequest,
+                            opened_file_t file,
+                            off_t offset,
+                            off_t size,
+                            time_t mtime,
+                            const std::string& etag,
+                            const std::string& mime,
+                            bool keep_alive,
+                            const common::libev::http::HttpServerInfo& hinf,
+                            body_check_t check);
+  // 200, 206, 304 or 416 answer for content, set_source called only if body should be sent
+  void QueueContent(AsyncHttpClient* hclient,
+                    const common::http::HttpRequest& hrequest,
+                    off_t size,
+                    time_t mtime,
+                    const std::string& etag,
+                    const std::string& mime,
+                    bool keep_alive,
+                    const common::libev::http::HttpServerInfo& hinf,
+                    body_source_t set_source);
+
+ private:
+  void ProcessRequests(AsyncHttpClient* hclient);
+  // false if error answer is queued
+  bool OpenFile(AsyncHttpClient* hclient,
+                const common::http::HttpRequest& hrequest,
+                const std::string& file_path,
+                bool keep_alive,
+                const common::libev::http::HttpServerInfo& hinf,
+                opened_file_t* file);
+  bool FlushResponse(AsyncHttpClient* hclient);  // false if client closed
+
+  common::libev::timer_id_t send_timeout_timer_;
+  OpenFilesCache files_cache_;
+  uint64_t boundary_id_;
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,249 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/base/open_files_cache.h"
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <common/sprintf.h>
+
+#define FILES_CACHE_INOTIFY_MASK                                                                           \
+  (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+   IN_DELETE_SELF | IN_MOVE_SELF)
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+namespace {
+std::string GetParentDir(const std::string& path) {
+  const size_t pos = path.find_last_of('/');
+  if (pos == std::string::npos) {
+    return std::string();
+  }
+  return path.substr(0, pos);
+}
+}  // namespace
+
+OpenedFile::OpenedFile(descriptor_t fd, off_t size, time_t mtime)
+    : fd_(fd),
+      size_(size),
+      mtime_(mtime),
+      etag_(common::MemSPrintf("\"%llx-%llx\"", static_cast<unsigned long long>(mtime),
+                               static_cast<unsigned long long>(size))) {}
+
+OpenedFile::~OpenedFile() {
+  ::close(fd_);
+}
+
+descriptor_t OpenedFile::GetFd() const {
+  return fd_;
+}
+
+off_t OpenedFile::GetSize() const {
+  return size_;
+}
+
+time_t OpenedFile::GetMtime() const {
+  return mtime_;
+}
+
+const std::string& OpenedFile::GetETag() const {
+  return etag_;
+}
+
+OpenFilesCache::OpenFilesCache(size_t max_files)
+    : max_files_(max_files),
+      inotify_fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      files_(),
+      lru_(),
+      dirs_(),
+      watches_() {
+  if (inotify_fd_ == INVALID_DESCRIPTOR) {
+    WARNING_LOG() << "Open files cache disabled, inotify error: " << common::common_strerror(errno);
+  }
+}
+
+OpenFilesCache::~OpenFilesCache() {
+  Clear();
+  if (inotify_fd_ != INVALID_DESCRIPTOR) {
+    ::close(inotify_fd_);
+  }
+}
+
+common::ErrnoError OpenFilesCache::Open(const std::string& path, opened_file_t* file) {
+  if (path.empty() || !file) {
+    return common::make_errno_error_inval();
+  }
+
+  ReadEvents();
+  auto it = files_.find(path);
+  if (it != files_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    *file = it->second.file;
+    return common::ErrnoError();
+  }
+
+  // watch before open, so change right after open is not lost
+  const std::string dir = GetParentDir(path);
+  const bool cacheable = inotify_fd_ != INVALID_DESCRIPTOR && max_files_ != 0 && WatchDir(dir);
+  descriptor_t fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    int err = errno;
+    UnWatchDirIfEmpty(dir);
+    return common::make_errno_error(err);
+  }
+
+  struct stat sb;
+  int err = fstat(fd, &sb) < 0 ? errno : (S_ISDIR(sb.st_mode) ? EISDIR : 0);
+  if (err) {
+    ::close(fd);
+    UnWatchDirIfEmpty(dir);
+    return common::make_errno_error(err);
+  }
+
+  opened_file_t opened = std::make_shared<OpenedFile>(fd, sb.st_size, sb.st_mtime);
+  if (cacheable) {
+    Insert(path, dir, opened);
+  }
+  *file = opened;
+  return common::ErrnoError();
+}
+
+void OpenFilesCache::Clear() {
+  for (auto it = dirs_.begin(); it != dirs_.end(); ++it) {
+    inotify_rm_watch(inotify_fd_, it->second.wd);
+  }
+  dirs_.clear();
+  watches_.clear();
+  files_.clear();
+  lru_.clear();
+}
+
+void OpenFilesCache::ReadEvents() {
+  if (inotify_fd_ == INVALID_DESCRIPTOR || files_.empty()) {
+    return;
+  }
+
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  while (true) {
+    ssize_t len = read(inotify_fd_, buf, sizeof(buf));
+    if (len <= 0) {
+      return;  // EAGAIN, all events consumed
+    }
+
+    for (char* ptr = buf; ptr < buf + len;) {
+      const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        Clear();
+        continue;
+      }
+
+      auto wit = watches_.find(event->wd);
+      if (wit == watches_.end()) {
+        continue;
+      }
+
+      const std::string dir = wit->second;
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        std::vector<std::string> paths;
+        for (auto fit = files_.begin(); fit != files_.end(); ++fit) {
+          if (fit->second.dir == dir) {
+            paths.push_back(fit->first);
+          }
+        }
+        for (const std::string& path : paths) {
+          Remove(path);
+        }
+        continue;
+      }
+
+      if (event->len) {
+        Remove(dir + "/" + event->name);
+      }
+    }
+  }
+}
+
+bool OpenFilesCache::WatchDir(const std::string& dir) {
+  if (dirs_.find(dir) != dirs_.end()) {
+    return true;
+  }
+
+  int wd = inotify_add_watch(inotify_fd_, dir.empty() ? "/" : dir.c_str(), FILES_CACHE_INOTIFY_MASK);
+  if (wd < 0) {
+    return false;
+  }
+
+  dirs_[dir] = {wd, 0};
+  watches_[wd] = dir;
+  return true;
+}
+
+void OpenFilesCache::UnWatchDirIfEmpty(const std::string& dir) {
+  auto dit = dirs_.find(dir);
+  if (dit == dirs_.end() || dit->second.files != 0) {
+    return;
+  }
+
+  inotify_rm_watch(inotify_fd_, dit->second.wd);
+  watches_.erase(dit->second.wd);
+  dirs_.erase(dit);
+}
+
+void OpenFilesCache::Insert(const std::string& path, const std::string& dir, opened_file_t file) {
+  while (files_.size() >= max_files_) {
+    const std::string oldest = lru_.back();
+    Remove(oldest);
+  }
+
+  auto dit = dirs_.find(dir);
+  if (dit == dirs_.end()) {  // evicted with last file
+    if (!WatchDir(dir)) {
+      return;
+    }
+    dit = dirs_.find(dir);
+  }
+
+  lru_.push_front(path);
+  files_[path] = {file, dir, lru_.begin()};
+  dit->second.files++;
+}
+
+void OpenFilesCache::Remove(const std::string& path) {
+  auto it = files_.find(path);
+  if (it == files_.end()) {
+    return;
+  }
+
+  const std::string dir = it->second.dir;
+  lru_.erase(it->second.lru);
+  files_.erase(it);
+
+  auto dit = dirs_.find(dir);
+  if (dit != dirs_.end()) {
+    dit->second.files--;
+    UnWatchDirIfEmpty(dir);
+  }
+}
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
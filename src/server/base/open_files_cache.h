@@ -0,0 +1,97 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <common/error.h>
+#include <common/types.h>
+
+namespace iptv_cloud {
+namespace server {
+namespace base {
+
+// Opened file with metadata taken at open time, descriptor is closed with last reference,
+// so cache can drop file while it is still being sent.
+class OpenedFile {
+ public:
+  OpenedFile(descriptor_t fd, off_t size, time_t mtime);
+  ~OpenedFile();
+
+  descriptor_t GetFd() const;
+  off_t GetSize() const;
+  time_t GetMtime() const;
+  const std::string& GetETag() const;
+
+ private:
+  const descriptor_t fd_;
+  const off_t size_;
+  const time_t mtime_;
+  const std::string etag_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpenedFile);
+};
+
+typedef std::shared_ptr<const OpenedFile> opened_file_t;
+
+// Bounded LRU of opened files, invalidated by inotify events of parent directories, not thread safe,
+// should be owned by one loop. Without inotify works as plain stat plus open.
+class OpenFilesCache {
+ public:
+  enum { MAX_FILES = 256 };
+  explicit OpenFilesCache(size_t max_files = MAX_FILES);
+  ~OpenFilesCache();
+
+  // errors: ENOENT not found, EISDIR directory, other open errors
+  common::ErrnoError Open(const std::string& path, opened_file_t* file) WARN_UNUSED_RESULT;
+  void Clear();
+
+ private:
+  typedef std::list<std::string> lru_t;
+  struct Entry {
+    opened_file_t file;
+    std::string dir;
+    lru_t::iterator lru;
+  };
+  struct WatchedDir {
+    int wd;
+    size_t files;
+  };
+
+  void ReadEvents();
+  bool WatchDir(const std::string& dir);
+  void UnWatchDirIfEmpty(const std::string& dir);
+  void Insert(const std::string& path, const std::string& dir, opened_file_t file);
+  void Remove(const std::string& path);
+
+  const size_t max_files_;
+  descriptor_t inotify_fd_;
+  std::unordered_map<std::string, Entry> files_;
+  lru_t lru_;  // front is most recently used
+  std::map<std::string, WatchedDir> dirs_;
+  std::map<int, std::string> watches_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpenFilesCache);
+};
+
+}  // namespace base
+}  // namespace server
+}  // namespace iptv_cloud
@@ -15,7 +15,7 @@
 #include "server/child_stream.h"
 
 #include "base/stream_commands.h"
-#include "base/stream_struct.h"
+#include "base/shared_stream_struct.h"
 
 namespace iptv_cloud {
 namespace server {
@@ -34,21 +34,29 @@ void Child::SetClient(client_t* pipe) {
   client_ = pipe;
 }
 
-common::ErrnoError Child::SendStop(protocol::sequance_id_t id) {
+common::ErrnoError Child::SendStop(protocol::seq_id_t seq) {
   if (!client_) {
     return common::make_errno_error_inval();
   }
 
-  protocol::request_t req = StopStreamRequest(id);
+  if (client_->IsBinaryPipeProtocol()) {
+    return client_->WriteMessage(StopStreamPipeRequest(seq));
+  }
+
+  protocol::request_t req = StopStreamRequest(common::protocols::json_rpc::MakeRequestID(seq));
   return client_->WriteRequest(req);
 }
 
-common::ErrnoError Child::SendRestart(protocol::sequance_id_t id) {
+common::ErrnoError Child::SendRestart(protocol::seq_id_t seq) {
   if (!client_) {
     return common::make_errno_error_inval();
   }
 
-  protocol::request_t req = RestartStreamRequest(id);
+  if (client_->IsBinaryPipeProtocol()) {
+    return client_->WriteMessage(RestartStreamPipeRequest(seq));
+  }
+
+  protocol::request_t req = RestartStreamRequest(common::protocols::json_rpc::MakeRequestID(seq));
   return client_->WriteRequest(req);
 }
 
@@ -58,15 +66,42 @@ stream_id_t ChildVod::GetStreamID() const {
   return vid_;
 }
 
-ChildStream::ChildStream(common::libev::IoLoop* server, StreamStruct* mem) : base_class(server, STREAM), mem_(mem) {}
+ChildStream::ChildStream(common::libev::IoLoop* server, SharedStreamStruct* mem)
+    : base_class(server, STREAM), mem_(mem), last_reported_status_(NEW), last_report_time_(0) {}
 
 stream_id_t ChildStream::GetStreamID() const {
-  return mem_->id;
+  return mem_->GetID();
 }
 
-StreamStruct* ChildStream::GetMem() const {
+SharedStreamStruct* ChildStream::GetMem() const {
   return mem_;
 }
 
+bool ChildStream::ReadStatistic(fastotv::timestamp_t current_time,
+                                fastotv::timestamp_t report_period,
+                                StatisticInfo* stat) {
+  if (!stat) {
+    return false;
+  }
+
+  const bool is_status_changed = mem_->GetStatus() != last_reported_status_;
+  if (!is_status_changed && current_time - last_report_time_ < report_period) {
+    return false;
+  }
+
+  StreamStruct stream;
+  SharedStreamStruct::cpu_load_t cpu_load = 0;
+  SharedStreamStruct::rss_t rss_bytes = 0;
+  if (!mem_->GetSnapshot(&stream, &cpu_load, &rss_bytes)) {
+    WARNING_LOG() << "Statistics of stream " << mem_->GetID() << " are stale, update was interrupted";
+    return false;
+  }
+
+  last_reported_status_ = stream.status;
+  last_report_time_ = current_time;
+  *stat = StatisticInfo(stream, cpu_load, rss_bytes, current_time);
+  return true;
+}
+
 }  // namespace server
 }  // namespace iptv_cloud
@@ -21,8 +21,10 @@
 
 #include "base/types.h"
 
+#include "stream_commands_info/statistic_info.h"
+
 namespace iptv_cloud {
-struct StreamStruct;
+struct SharedStreamStruct;
 namespace server {
 
 class Child : public common::libev::IoChild {
@@ -30,14 +32,14 @@ class Child : public common::libev::IoChild {
   enum Type : uint8_t { VOD = 0, STREAM };
 
   typedef common::libev::IoChild base_class;
-  typedef protocol::protocol_client_t client_t;
+  typedef protocol::pipe_client_t client_t;
   Child(common::libev::IoLoop* server, Type type);
 
   virtual stream_id_t GetStreamID() const = 0;
   Type GetType() const;
 
-  common::ErrnoError SendStop(protocol::sequance_id_t id) WARN_UNUSED_RESULT;
-  common::ErrnoError SendRestart(protocol::sequance_id_t id) WARN_UNUSED_RESULT;
+  common::ErrnoError SendStop(protocol::seq_id_t seq) WARN_UNUSED_RESULT;
+  common::ErrnoError SendRestart(protocol::seq_id_t seq) WARN_UNUSED_RESULT;
 
   client_t* GetClient() const;
   void SetClient(client_t* pipe);
@@ -61,14 +63,20 @@ class ChildVod : public Child {
 class ChildStream : public Child {
  public:
   typedef Child base_class;
-  ChildStream(common::libev::IoLoop* server, StreamStruct* mem);
+  ChildStream(common::libev::IoLoop* server, SharedStreamStruct* mem);
 
   stream_id_t GetStreamID() const override;
 
-  StreamStruct* GetMem() const;
+  SharedStreamStruct* GetMem() const;
+
+  // reads stats from shared memory, true if status changed or report period elapsed
+  bool ReadStatistic(fastotv::timestamp_t current_time, fastotv::timestamp_t report_period, StatisticInfo* stat);
 
  private:
-  StreamStruct* const mem_;
+  SharedStreamStruct* const mem_;
+
+  StreamStatus last_reported_status_;
+  fastotv::timestamp_t last_report_time_;
 
   DISALLOW_COPY_AND_ASSIGN(ChildStream);
 };
@@ -27,6 +27,8 @@
 #define SERVICE_SUBSCRIBERS_HOST_FIELD "subscribers_host"
 #define SERVICE_BANDWIDTH_HOST_FIELD "bandwidth_host"
 #define SERVICE_TTL_FILES_FIELD "ttl_files"
+#define SERVICE_HLS_STORE_SIZE_FIELD "hls_store_size"
+#define SERVICE_HTTP_WORKERS_FIELD "http_workers"
 
 #define DUMMY_LOG_FILE_PATH "/dev/null"
 
@@ -65,6 +67,10 @@ common::ErrnoError ReadSlaveConfig(const std::string& path, iptv_cloud::utils::A
       options.insert(pair);
     } else if (pair.first == SERVICE_TTL_FILES_FIELD) {
       options.insert(pair);
+    } else if (pair.first == SERVICE_HLS_STORE_SIZE_FIELD) {
+      options.insert(pair);
+    } else if (pair.first == SERVICE_HTTP_WORKERS_FIELD) {
+      options.insert(pair);
     }
   }
 
@@ -81,7 +87,9 @@ Config::Config()
     : host(GetDefaultHost()),
       log_path(DUMMY_LOG_FILE_PATH),
       log_level(common::logging::LOG_LEVEL_INFO),
-      ttl_files_(TTL_FILES) {}
+      ttl_files_(TTL_FILES),
+      hls_store_size(HLS_STORE_SIZE),
+      http_workers(HTTP_WORKERS) {}
 
 common::net::HostAndPort Config::GetDefaultHost() {
   return common::net::HostAndPort::CreateLocalHost(CLIENT_PORT);
@@ -150,6 +158,18 @@ common::ErrnoError load_config_from_file(const std::string& config_absolute_path
   }
   lconfig.ttl_files_ = ttl_files;
 
+  size_t hls_store_size;
+  if (!utils::ArgsGetValue(slave_config_args, SERVICE_HLS_STORE_SIZE_FIELD, &hls_store_size)) {
+    hls_store_size = HLS_STORE_SIZE;
+  }
+  lconfig.hls_store_size = hls_store_size;
+
+  size_t http_workers;
+  if (!utils::ArgsGetValue(slave_config_args, SERVICE_HTTP_WORKERS_FIELD, &http_workers)) {
+    http_workers = HTTP_WORKERS;
+  }
+  lconfig.http_workers = http_workers;
+
   *config = lconfig;
   return common::ErrnoError();
 }
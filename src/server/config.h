@@ -35,6 +35,8 @@ struct Config {
   common::net::HostAndPort subscribers_host;
   common::net::HostAndPort bandwidth_host;
   time_t ttl_files_;  // in seconds
+  size_t hls_store_size;  // in megabytes per http output, 0 - hls files written on disk
+  size_t http_workers;    // http loops sharing http_host port, 0 - one per cpu core
 };
 
 common::ErrnoError load_config_from_file(const std::string& config_absolute_path, Config* config) WARN_UNUSED_RESULT;
@@ -14,26 +14,181 @@
 
 #include "server/http/handler.h"
 
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <unistd.h>
-
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 
+#include <common/convert2string.h>
+#include <common/sprintf.h>
+#include <common/time.h>
+
 #include "server/base/ihttp_requests_observer.h"
 #include "server/http/client.h"
+#include "server/http/timeshift_playlist.h"
+
+#include "stream/timeshift.h"
+#include "stream/timeshift_ring.h"
 
 namespace iptv_cloud {
 namespace server {
 
 HttpHandler::HttpHandler(base::IHttpRequestsObserver* observer)
-    : base_class(), http_root_(http_directory_path_t::MakeHomeDir()), observer_(observer) {}
+    : base_class(),
+      http_root_(http_directory_path_t::MakeHomeDir()),
+      observer_(observer),
+      hls_stores_mutex_(),
+      hls_stores_(),
+      timeshifts_mutex_(),
+      timeshifts_() {}
 
 void HttpHandler::SetHttpRoot(const http_directory_path_t& http_root) {
   http_root_ = http_root;
 }
 
+void HttpHandler::AddHlsStore(stream_id_t sid,
+                              const http_directory_path_t& http_root,
+                              hls_store_t store,
+                              base::opened_file_t memory,
+                              off_t memory_offset) {
+  std::unique_lock<std::mutex> lock(hls_stores_mutex_);
+  hls_stores_[http_root] = {sid, store, memory, memory_offset};
+}
+
+void HttpHandler::RemoveHlsStores(stream_id_t sid) {
+  std::unique_lock<std::mutex> lock(hls_stores_mutex_);
+  for (auto it = hls_stores_.begin(); it != hls_stores_.end();) {
+    if (it->second.sid == sid) {
+      it = hls_stores_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void HttpHandler::AddTimeShift(stream_id_t sid, const http_directory_path_t& timeshift_dir) {
+  std::unique_lock<std::mutex> lock(timeshifts_mutex_);
+  timeshifts_[sid] = timeshift_dir;
+}
+
+void HttpHandler::RemoveTimeShift(stream_id_t sid) {
+  std::unique_lock<std::mutex> lock(timeshifts_mutex_);
+  timeshifts_.erase(sid);
+}
+
+bool HttpHandler::FindTimeShift(const std::string& url_dirs, http_directory_path_t* timeshift_dir) {
+  static const std::string prefix = "/" TIMESHIFT_HTTP_DIR "/";
+  if (url_dirs.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+
+  std::string sid = url_dirs.substr(prefix.size());
+  if (!sid.empty() && sid.back() == '/') {
+    sid.pop_back();
+  }
+
+  std::unique_lock<std::mutex> lock(timeshifts_mutex_);
+  auto it = timeshifts_.find(sid);
+  if (it == timeshifts_.end()) {
+    return false;
+  }
+
+  *timeshift_dir = it->second;
+  return true;
+}
+
+void HttpHandler::ProcessTimeShiftRequest(base::AsyncHttpClient* hclient,
+                                          const common::http::HttpRequest& hrequest,
+                                          const http_directory_path_t& timeshift_dir,
+                                          bool keep_alive,
+                                          const common::libev::http::HttpServerInfo& hinf) {
+  const common::http::http_protocol protocol = hrequest.GetProtocol();
+  common::uri::Upath path = hrequest.GetPath();
+  const std::string file_name = path.GetFileName();
+  if (file_name != TIMESHIFT_PLAYLIST_NAME) {  // chunk
+    auto file_path = timeshift_dir.MakeFileStringPath(file_name);
+    if (!file_path || file_name == TIMESHIFT_RING_NAME) {  // ring is read only by chunks with eviction check
+      hclient->QueueError(protocol, common::http::HS_NOT_FOUND, nullptr, "File not found.", keep_alive, hinf);
+      return;
+    }
+
+    if (!QueueRingChunk(hclient, hrequest, timeshift_dir, file_name, keep_alive, hinf)) {
+      QueueFileContent(hclient, hrequest, file_path->GetPath(), path.GetMime(), keep_alive, hinf);
+    }
+    return;
+  }
+
+  TimeShiftWindow window;
+  if (!ParseTimeShiftWindow(path.GetQuery(), &window)) {
+    hclient->QueueError(protocol, common::http::HS_BAD_REQUEST, nullptr, "Invalid timeshift window.", keep_alive,
+                        hinf);
+    return;
+  }
+
+  const common::time64_t now_msec = common::time::current_utc_mstime();
+  std::shared_ptr<std::string> playlist = std::make_shared<std::string>();
+  common::ErrnoError err = GenerateTimeShiftPlaylist(timeshift_dir.GetPath(), window, now_msec, playlist.get());
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_DEBUG);
+    hclient->QueueError(protocol, common::http::HS_NOT_FOUND, nullptr, "Timeshift chunks not found.", keep_alive,
+                        hinf);
+    return;
+  }
+
+  const std::string etag =
+      common::MemSPrintf("\"%llx\"", static_cast<unsigned long long>(std::hash<std::string>()(*playlist)));
+  // playlist is held by body check until body sent
+  auto set_source = [playlist](base::AsyncHttpClient* client) {
+    client->SetBodyBuffer(playlist->data(), [playlist]() { return true; });
+  };
+  QueueContent(hclient, hrequest, playlist->size(), now_msec / 1000, etag, path.GetMime(), keep_alive, hinf,
+               set_source);
+}
+
+bool HttpHandler::QueueRingChunk(base::AsyncHttpClient* hclient,
+                                 const common::http::HttpRequest& hrequest,
+                                 const http_directory_path_t& timeshift_dir,
+                                 const std::string& file_name,
+                                 bool keep_alive,
+                                 const common::libev::http::HttpServerInfo& hinf) {
+  const size_t ext_size = sizeof(CHUNK_EXT) - 1;
+  if (file_name.size() <= ext_size || file_name.compare(file_name.size() - ext_size, ext_size, CHUNK_EXT) != 0) {
+    return false;
+  }
+
+  const std::string ring_path = timeshift_dir.GetPath() + TIMESHIFT_RING_NAME;
+  stream::chunk_index_t index;
+  if (!common::ConvertFromString(file_name.substr(0, file_name.size() - ext_size), &index)) {
+    return false;
+  }
+
+  std::shared_ptr<stream::TimeShiftRingReader> ring = std::make_shared<stream::TimeShiftRingReader>();
+  stream::TimeShiftRingChunk chunk;
+  uint64_t offset = 0;
+  if (!stream::OpenTimeShiftRingWithChunk(ring_path, index, ring.get()) || !ring->FindChunk(index, &chunk) ||
+      !ring->GetFileOffset(chunk, &offset)) {
+    return false;
+  }
+
+  // ring data is reused by recorder, response is aborted once chunk evicted, also while sending
+  const std::string etag = common::MemSPrintf("\"%llx-%llx\"", static_cast<unsigned long long>(chunk.offset),
+                                              static_cast<unsigned long long>(chunk.size));
+  QueueFilePartContent(hclient, hrequest, ring_path, offset, chunk.size, etag, hrequest.GetPath().GetMime(),
+                       keep_alive, hinf, [ring, chunk]() { return ring->IsAlive(chunk); });
+  return true;
+}
+
+bool HttpHandler::FindHlsStore(const http_directory_path_t& dir, HlsStoreInfo* info) {
+  std::unique_lock<std::mutex> lock(hls_stores_mutex_);
+  auto it = hls_stores_.find(dir);
+  if (it == hls_stores_.end()) {
+    return false;
+  }
+
+  *info = it->second;
+  return true;
+}
+
 void HttpHandler::PreLooped(common::libev::IoLoop* server) {
   base_class::PreLooped(server);
 }
@@ -69,17 +224,6 @@ void HttpHandler::ChildStatusChanged(common::libev::IoChild* child, int status)
 #endif
 
 void HttpHandler::DataReceived(common::libev::IoClient* client) {
-  char buff[BUF_SIZE] = {0};
-  size_t nread = 0;
-  common::ErrnoError errn = client->SingleRead(buff, BUF_SIZE - 1, &nread);
-  if ((errn && errn->GetErrorCode() != EAGAIN) || nread == 0) {
-    client->Close();
-    delete client;
-    return base_class::DataReceived(client);
-  }
-
-  HttpClient* hclient = static_cast<server::HttpClient*>(client);
-  ProcessReceived(hclient, buff, nread);
   base_class::DataReceived(client);
 }
 
@@ -91,7 +235,7 @@ void HttpHandler::PostLooped(common::libev::IoLoop* server) {
   base_class::PostLooped(server);
 }
 
-void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size_t req_len) {
+void HttpHandler::ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) {
   static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
   common::http::HttpRequest hrequest;
   std::string request_str(request, req_len);
@@ -101,13 +245,7 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
   if (result.second) {
     const std::string error_text = result.second->GetDescription();
     DEBUG_MSG_ERROR(result.second, common::logging::LOG_LEVEL_ERR);
-    common::ErrnoError err =
-        hclient->SendError(common::http::HP_1_1, result.first, nullptr, error_text.c_str(), false, hinf);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
-    hclient->Close();
-    delete hclient;
+    hclient->QueueError(common::http::HP_1_1, result.first, nullptr, error_text.c_str(), false, hinf);
     return;
   }
 
@@ -121,15 +259,17 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
       hrequest.GetMethod() == common::http::http_method::HM_HEAD) {
     common::uri::Upath path = hrequest.GetPath();
     if (!path.IsValid() || path.IsRoot()) {  // for hls
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
+      hclient->QueueError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
       return;
     }
 
     const std::string url_dirs = path.GetHpath();
+    http_directory_path_t timeshift_dir;
+    if (FindTimeShift(url_dirs, &timeshift_dir)) {
+      ProcessTimeShiftRequest(hclient, hrequest, timeshift_dir, IsKeepAlive, hinf);
+      return;
+    }
+
     auto dirs_path = http_root_.MakeDirectoryStringPath(url_dirs.substr(1));
     if (!dirs_path) {
       dirs_path = http_root_;
@@ -137,11 +277,7 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
 
     auto file_path = dirs_path->MakeFileStringPath(path.GetFileName());
     if (!file_path) {
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
+      hclient->QueueError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
       return;
     }
 
@@ -150,61 +286,21 @@ void HttpHandler::ProcessReceived(HttpClient* hclient, const char* request, size
     }
 
     const std::string file_path_str = file_path->GetPath();
-    int open_flags = O_RDONLY;
-    struct stat sb;
-    if (stat(file_path_str.c_str(), &sb) < 0) {
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
-      WARNING_LOG() << "File path: " << file_path_str << ", not found";
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
+    HlsStoreInfo hls_info;
+    SharedHlsStore::File hls_file;
+    if (FindHlsStore(*dirs_path, &hls_info) && hls_info.store->Find(file_path_str, &hls_file)) {
+      // sent by sendfile straight from stream memfd, response is aborted once ring reused file data
+      const hls_store_t hls_store = hls_info.store;
+      const off_t offset = hls_info.memory_offset + (hls_file.data - reinterpret_cast<const char*>(hls_store.get()));
+      const std::string etag = common::MemSPrintf("\"%llx-%llx\"", static_cast<unsigned long long>(hls_file.offset),
+                                                  static_cast<unsigned long long>(hls_file.size));
+      QueueFilePartContent(hclient, hrequest, hls_info.memory, offset, hls_file.size, hls_file.mtime, etag,
+                           path.GetMime(), IsKeepAlive, hinf,
+                           [hls_store, hls_file]() { return hls_store->IsAlive(hls_file); });
       return;
     }
 
-    if (S_ISDIR(sb.st_mode)) {
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_BAD_REQUEST, extra_header, "Bad filename.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      return;
-    }
-
-    int file = open(file_path_str.c_str(), open_flags);
-    if (file == INVALID_DESCRIPTOR) { /* open the file for reading */
-      common::ErrnoError err = hclient->SendError(protocol, common::http::HS_FORBIDDEN, extra_header,
-                                                  "File is protected.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      return;
-    }
-
-    const std::string mime = path.GetMime();
-    common::ErrnoError err = hclient->SendHeaders(protocol, common::http::HS_OK, extra_header, mime.c_str(),
-                                                  &sb.st_size, &sb.st_mtime, IsKeepAlive, hinf);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      ::close(file);
-      return;
-    }
-
-    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
-      common::ErrnoError err = hclient->SendFileByFd(protocol, file, sb.st_size);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      } else {
-        DEBUG_LOG() << "Sent file path: " << file_path_str << ", size: " << sb.st_size;
-      }
-    }
-
-    ::close(file);
-  }
-
-  if (!IsKeepAlive) {
-    hclient->Close();
-    delete hclient;
+    QueueFileContent(hclient, hrequest, file_path_str, path.GetMime(), IsKeepAlive, hinf);
   }
 }
 
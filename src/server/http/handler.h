@@ -14,27 +14,44 @@
 
 #pragma once
 
+#include <map>
+#include <mutex>
+
 #include <common/file_system/path.h>
 
-#include "server/base/iserver_handler.h"
+#include "base/types.h"
+
+#include "server/base/ihttp_handler.h"
+#include "server/stream_struct_utils.h"
 
 namespace iptv_cloud {
 namespace server {
 
-class HttpClient;
 namespace base {
 class IHttpRequestsObserver;
 }
 
-class HttpHandler : public base::IServerHandler {
+class HttpHandler : public base::IHttpHandler {
  public:
-  enum { BUF_SIZE = 4096 };
-  typedef base::IServerHandler base_class;
+  typedef base::IHttpHandler base_class;
   typedef common::file_system::ascii_directory_string_path http_directory_path_t;
   explicit HttpHandler(base::IHttpRequestsObserver* observer);
 
   void SetHttpRoot(const http_directory_path_t& http_root);
 
+  // files of hls output directory are served from stream memory, disk is used only if file not found in store
+  // memory is memfd of stream segment, store lives at memory_offset in it
+  void AddHlsStore(stream_id_t sid,
+                   const http_directory_path_t& http_root,
+                   hls_store_t store,
+                   base::opened_file_t memory,
+                   off_t memory_offset);
+  void RemoveHlsStores(stream_id_t sid);
+
+  // recorder archive is served as /timeshift/<stream id>/, playlists for any delay are generated on request
+  void AddTimeShift(stream_id_t sid, const http_directory_path_t& timeshift_dir);
+  void RemoveTimeShift(stream_id_t sid);
+
   void PreLooped(common::libev::IoLoop* server) override;
 
   void Accepted(common::libev::IoClient* client) override;
@@ -53,10 +70,37 @@ class HttpHandler : public base::IServerHandler {
   void PostLooped(common::libev::IoLoop* server) override;
 
  private:
-  void ProcessReceived(HttpClient* hclient, const char* request, size_t req_len);
+  struct HlsStoreInfo {
+    stream_id_t sid;
+    hls_store_t store;
+    base::opened_file_t memory;
+    off_t memory_offset;
+  };
+
+  void ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) override;
+  bool FindHlsStore(const http_directory_path_t& dir, HlsStoreInfo* info);
+  bool FindTimeShift(const std::string& url_dirs, http_directory_path_t* timeshift_dir);
+  void ProcessTimeShiftRequest(base::AsyncHttpClient* hclient,
+                               const common::http::HttpRequest& hrequest,
+                               const http_directory_path_t& timeshift_dir,
+                               bool keep_alive,
+                               const common::libev::http::HttpServerInfo& hinf);
+  // chunk of ring storage, false if timeshift has no ring or chunk is not in ring
+  bool QueueRingChunk(base::AsyncHttpClient* hclient,
+                      const common::http::HttpRequest& hrequest,
+                      const http_directory_path_t& timeshift_dir,
+                      const std::string& file_name,
+                      bool keep_alive,
+                      const common::libev::http::HttpServerInfo& hinf);
 
   http_directory_path_t http_root_;
   base::IHttpRequestsObserver* observer_;
+
+  std::mutex hls_stores_mutex_;
+  std::map<http_directory_path_t, HlsStoreInfo> hls_stores_;
+
+  std::mutex timeshifts_mutex_;
+  std::map<stream_id_t, http_directory_path_t> timeshifts_;
 };
 
 }  // namespace server
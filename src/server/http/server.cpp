@@ -14,17 +14,153 @@
 
 #include "server/http/server.h"
 
+#include <netdb.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include <common/convert2string.h>
+#include <common/file_system/file_system.h>
+
 #include "server/http/client.h"
 
+#define MAX_ACCEPTS_PER_EVENT 64  // other clients of loop are not starved by connections burst
+
 namespace iptv_cloud {
 namespace server {
 
 HttpServer::HttpServer(const common::net::HostAndPort& host, common::libev::IoLoopObserver* observer)
-    : base_class(host, false, observer) {}
+    : base_class(new common::libev::LibEvLoop, observer),
+      host_(host),
+      sock_(INVALID_DESCRIPTOR),
+      accept_io_(new common::libev::LibevIO) {
+  accept_io_->SetUserData(this);
+}
+
+HttpServer::~HttpServer() {
+  destroy(&accept_io_);
+  if (sock_ != INVALID_DESCRIPTOR) {
+    ignore_result(common::file_system::close_descriptor(sock_));
+    sock_ = INVALID_DESCRIPTOR;
+  }
+}
+
+common::ErrnoError HttpServer::Bind(bool reuseaddr) {
+  if (sock_ != INVALID_DESCRIPTOR) {
+    return common::make_errno_error("Already binded.", EISCONN);
+  }
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* addrs = nullptr;
+  const std::string host = host_.GetHost();
+  const std::string port = common::ConvertToString(host_.GetPort());
+  int res = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addrs);
+  if (res != 0) {
+    return common::make_errno_error("Failed to resolve http host: " + host + ", error: " + gai_strerror(res), EINVAL);
+  }
+
+  int last_errno = EADDRNOTAVAIL;
+  for (struct addrinfo* rp = addrs; rp; rp = rp->ai_next) {
+    descriptor_t fd = socket(rp->ai_family, rp->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, rp->ai_protocol);
+    if (fd == INVALID_DESCRIPTOR) {
+      last_errno = errno;
+      continue;
+    }
+
+    int on = 1;
+    if ((reuseaddr && setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) == -1) ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1 ||
+        bind(fd, rp->ai_addr, rp->ai_addrlen) == -1) {
+      last_errno = errno;
+      ignore_result(common::file_system::close_descriptor(fd));
+      continue;
+    }
+
+    sock_ = fd;
+    break;
+  }
+  freeaddrinfo(addrs);
+
+  if (sock_ == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(last_errno);
+  }
+
+  return common::ErrnoError();
+}
+
+common::ErrnoError HttpServer::Listen(int backlog) {
+  if (sock_ == INVALID_DESCRIPTOR) {
+    return common::make_errno_error_inval();
+  }
+
+  if (listen(sock_, backlog) == -1) {
+    return common::make_errno_error(errno);
+  }
 
-common::libev::tcp::TcpClient* HttpServer::CreateClient(const common::net::socket_info& info) {
+  return common::ErrnoError();
+}
+
+common::net::HostAndPort HttpServer::GetHost() const {
+  return host_;
+}
+
+const char* HttpServer::ClassName() const {
+  return "HttpServer";
+}
+
+common::libev::IoChild* HttpServer::CreateChild() {
+  NOTREACHED();
+  return nullptr;
+}
+
+common::libev::IoClient* HttpServer::CreateClient(const common::net::socket_info& info) {
   return new HttpClient(this, info);
 }
 
+void HttpServer::Started(common::libev::LibEvLoop* loop) {
+  if (sock_ != INVALID_DESCRIPTOR) {
+    accept_io_->Init(loop, accept_cb, sock_, EV_READ);
+    accept_io_->Start();
+  }
+  base_class::Started(loop);
+}
+
+void HttpServer::Stopped(common::libev::LibEvLoop* loop) {
+  if (sock_ != INVALID_DESCRIPTOR) {
+    accept_io_->Stop();
+  }
+  base_class::Stopped(loop);
+}
+
+void HttpServer::accept_cb(common::libev::LibEvLoop* loop, common::libev::LibevIO* io, common::libev::flags_t revents) {
+  UNUSED(loop);
+  UNUSED(revents);
+  HttpServer* server = static_cast<HttpServer*>(io->GetUserData());
+  server->AcceptConnections();
+}
+
+void HttpServer::AcceptConnections() {
+  for (size_t i = 0; i < MAX_ACCEPTS_PER_EVENT; ++i) {
+    descriptor_t fd = accept4(sock_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd == INVALID_DESCRIPTOR) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (errno == EMFILE || errno == ENFILE) {
+        WARNING_LOG() << "Http server " << GetName() << " out of descriptors, " << common::common_strerror(errno);
+      }
+      return;  // EAGAIN, listening socket drained
+    }
+
+    common::libev::IoClient* client = CreateClient(common::net::socket_info(fd));
+    RegisterClient(client);
+  }
+}
+
 }  // namespace server
 }  // namespace iptv_cloud
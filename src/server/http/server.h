@@ -14,18 +14,43 @@
 
 #pragma once
 
-#include <common/libev/http/http_server.h>
+#include <common/libev/event_io.h>
+#include <common/libev/io_loop.h>
+#include <common/net/types.h>
+#include <common/types.h>
 
 namespace iptv_cloud {
 namespace server {
 
-class HttpServer : public common::libev::http::HttpServer {
+// Http loop with own listening socket opened with SO_REUSEPORT, several servers can bind the same host,
+// kernel balances new connections between them, so hls delivery scales over cores.
+// Listening socket is watched by the loop itself, connections are accepted non-blocking in loop thread.
+class HttpServer : public common::libev::IoLoop {
  public:
-  typedef common::libev::http::HttpServer base_class;
+  typedef common::libev::IoLoop base_class;
   explicit HttpServer(const common::net::HostAndPort& host, common::libev::IoLoopObserver* observer = nullptr);
+  ~HttpServer() override;
+
+  common::ErrnoError Bind(bool reuseaddr) WARN_UNUSED_RESULT;
+  common::ErrnoError Listen(int backlog) WARN_UNUSED_RESULT;
+
+  common::net::HostAndPort GetHost() const;
+
+  const char* ClassName() const override;
 
  private:
-  common::libev::tcp::TcpClient* CreateClient(const common::net::socket_info& info) override;
+  common::libev::IoChild* CreateChild() override;
+  common::libev::IoClient* CreateClient(const common::net::socket_info& info) override;
+
+  void Started(common::libev::LibEvLoop* loop) override;
+  void Stopped(common::libev::LibEvLoop* loop) override;
+
+  static void accept_cb(common::libev::LibEvLoop* loop, common::libev::LibevIO* io, common::libev::flags_t revents);
+  void AcceptConnections();
+
+  const common::net::HostAndPort host_;
+  descriptor_t sock_;
+  common::libev::LibevIO* accept_io_;
 };
 
 }  // namespace server
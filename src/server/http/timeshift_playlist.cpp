@@ -0,0 +1,197 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/http/timeshift_playlist.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <common/sprintf.h>
+
+#include "base/types.h"
+
+#include "stream/timeshift_ring.h"
+
+namespace iptv_cloud {
+namespace server {
+
+namespace {
+bool ParseSeconds(const std::string& value, time_t* seconds) {
+  if (value.empty()) {
+    return false;
+  }
+
+  char* end = nullptr;
+  long long result = strtoll(value.c_str(), &end, 10);
+  if (*end != 0 || result < 0) {
+    return false;
+  }
+
+  *seconds = static_cast<time_t>(result);
+  return true;
+}
+}  // namespace
+
+TimeShiftWindow::TimeShiftWindow() : delay(0), start(0) {}
+
+bool ParseTimeShiftWindow(const std::string& query, TimeShiftWindow* window) {
+  if (!window) {
+    return false;
+  }
+
+  TimeShiftWindow result;
+  size_t pos = 0;
+  while (pos < query.size()) {
+    size_t end = query.find('&', pos);
+    if (end == std::string::npos) {
+      end = query.size();
+    }
+
+    const std::string param = query.substr(pos, end - pos);
+    pos = end + 1;
+    const size_t eq = param.find('=');
+    if (eq == std::string::npos) {
+      continue;
+    }
+
+    const std::string key = param.substr(0, eq);
+    const std::string value = param.substr(eq + 1);
+    if (key == TIMESHIFT_DELAY_PARAM) {
+      if (!ParseSeconds(value, &result.delay)) {
+        return false;
+      }
+    } else if (key == TIMESHIFT_START_PARAM) {
+      if (!ParseSeconds(value, &result.start)) {
+        return false;
+      }
+    }
+  }
+
+  *window = result;
+  return true;
+}
+
+std::vector<stream::TimeShiftIndexEntry> SelectTimeShiftChunks(const stream::TimeShiftIndexEntry* entries,
+                                                               size_t count,
+                                                               const TimeShiftWindow& window,
+                                                               int64_t now_msec) {
+  std::vector<stream::TimeShiftIndexEntry> result;
+  if (!entries) {
+    return result;
+  }
+
+  if (window.start) {  // all finished chunks starting from one which contains start
+    const int64_t start_msec = static_cast<int64_t>(window.start) * 1000;
+    size_t first = 0;
+    while (first < count && entries[first].GetEndTime() <= start_msec) {
+      first++;
+    }
+    result.assign(entries + first, entries + count);
+    return result;
+  }
+
+  const int64_t edge_msec = now_msec - static_cast<int64_t>(window.delay) * 1000;
+  size_t last = count;
+  while (last > 0 && entries[last - 1].GetEndTime() > edge_msec) {
+    last--;
+  }
+  const size_t first = last > TIMESHIFT_PLAYLIST_CHUNKS_COUNT ? last - TIMESHIFT_PLAYLIST_CHUNKS_COUNT : 0;
+  result.assign(entries + first, entries + last);
+  return result;
+}
+
+TimeShiftSegment::TimeShiftSegment() : index(0), sequence(0), discontinuity(0), duration(0) {}
+
+std::string MakeTimeShiftPlaylist(const std::vector<TimeShiftSegment>& segments, bool is_event) {
+  if (segments.empty()) {
+    return std::string();
+  }
+
+  uint64_t max_duration = 0;
+  for (const TimeShiftSegment& segment : segments) {
+    max_duration = std::max(max_duration, segment.duration);
+  }
+
+  const uint64_t target_duration = (max_duration + 999999999) / 1000000000;  // rounded up seconds
+  std::string playlist = common::MemSPrintf(
+      "#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-MEDIA-SEQUENCE:%llu\n#EXT-X-DISCONTINUITY-SEQUENCE:%llu\n"
+      "#EXT-X-TARGETDURATION:%llu\n",
+      segments.front().sequence, segments.front().discontinuity, std::max<uint64_t>(target_duration, 1));
+  if (is_event) {
+    playlist += "#EXT-X-PLAYLIST-TYPE:EVENT\n";
+  }
+
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const TimeShiftSegment& segment = segments[i];
+    if (i != 0 && segment.discontinuity != segments[i - 1].discontinuity) {  // recorder restart
+      playlist += "#EXT-X-DISCONTINUITY\n";
+    }
+
+    playlist += common::MemSPrintf("#EXTINF:%.2f,\n%llu" CHUNK_EXT "\n",
+                                   static_cast<double>(segment.duration) / 1000000000, segment.index);
+  }
+  return playlist;
+}
+
+common::ErrnoError GenerateTimeShiftPlaylist(const std::string& timeshift_dir,
+                                             const TimeShiftWindow& window,
+                                             int64_t now_msec,
+                                             std::string* playlist) {
+  if (timeshift_dir.empty() || !playlist) {
+    return common::make_errno_error_inval();
+  }
+
+  stream::TimeShiftIndexReader index;
+  common::ErrnoError err = index.Open(timeshift_dir + TIMESHIFT_INDEX_NAME);
+  if (err) {
+    return err;
+  }
+
+  const std::string ring_path = timeshift_dir + TIMESHIFT_RING_NAME;
+  stream::TimeShiftIndexEntry last;
+  stream::TimeShiftRingReader ring;
+  const bool in_ring = index.GetLast(&last) && stream::OpenTimeShiftRingWithChunk(ring_path, last.index, &ring);
+
+  const std::vector<stream::TimeShiftIndexEntry> chunks =
+      SelectTimeShiftChunks(index.GetEntries(), index.GetCount(), window, now_msec);
+  std::vector<TimeShiftSegment> segments;
+  for (const stream::TimeShiftIndexEntry& chunk : chunks) {
+    if (in_ring) {
+      stream::TimeShiftRingChunk ring_chunk;
+      uint64_t offset = 0;
+      if (!ring.FindChunk(chunk.index, &ring_chunk) || !ring.GetFileOffset(ring_chunk, &offset)) {
+        segments.clear();  // evicted by ring or not contiguous, media sequence can't have holes
+        continue;
+      }
+    }
+
+    TimeShiftSegment segment;
+    segment.index = chunk.index;
+    segment.sequence = chunk.sequence;
+    segment.discontinuity = chunk.discontinuity;
+    segment.duration = chunk.duration;
+    segments.push_back(segment);
+  }
+
+  if (segments.empty()) {
+    return common::make_errno_error("No timeshift chunks in requested window.", ENOENT);
+  }
+
+  *playlist = MakeTimeShiftPlaylist(segments, window.start != 0);
+  return common::ErrnoError();
+}
+
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,72 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+
+#include "stream/timeshift_index.h"
+
+#define TIMESHIFT_HTTP_DIR "timeshift"            // archives are served as /timeshift/<stream id>/<file>
+#define TIMESHIFT_PLAYLIST_NAME "timeshift.m3u8"  // generated on request, never stored
+#define TIMESHIFT_PLAYLIST_CHUNKS_COUNT 6         // sliding window size
+#define TIMESHIFT_DELAY_PARAM "delay"             // seconds behind live
+#define TIMESHIFT_START_PARAM "start"             // utc seconds
+
+namespace iptv_cloud {
+namespace server {
+
+struct TimeShiftWindow {
+  TimeShiftWindow();
+
+  time_t delay;  // sliding playlist which ends delay seconds behind live
+  time_t start;  // if set, event playlist from start up to live edge
+};
+
+// parses "delay=3600" or "start=1571234567" query, other parameters are ignored, false if value is malformed
+bool ParseTimeShiftWindow(const std::string& query, TimeShiftWindow* window);
+
+// finished chunks visible in window at now_msec, entries are ordered by start time as in timeshift index
+std::vector<stream::TimeShiftIndexEntry> SelectTimeShiftChunks(const stream::TimeShiftIndexEntry* entries,
+                                                               size_t count,
+                                                               const TimeShiftWindow& window,
+                                                               int64_t now_msec);
+
+struct TimeShiftSegment {
+  TimeShiftSegment();
+
+  uint64_t index;
+  uint64_t sequence;       // media sequence number, consecutive for segments of playlist
+  uint64_t discontinuity;  // discontinuity sequence number, tag is written where it changes
+  uint64_t duration;       // nsec
+};
+
+// sequence numbers are taken from index records, so same chunk has same numbers on every reload
+std::string MakeTimeShiftPlaylist(const std::vector<TimeShiftSegment>& segments, bool is_event);
+
+// virtual playlist over recorder chunks of timeshift directory, no player process and no files written,
+// chunks of ring storage are referenced by <index>.ts name too and read from ring file on request
+common::ErrnoError GenerateTimeShiftPlaylist(const std::string& timeshift_dir,
+                                             const TimeShiftWindow& window,
+                                             int64_t now_msec,
+                                             std::string* playlist) WARN_UNUSED_RESULT;
+
+}  // namespace server
+}  // namespace iptv_cloud
@@ -24,6 +24,7 @@
 
 #include <common/file_system/file_system.h>
 
+#include "base/abr_ladder.h"
 #include "base/config_fields.h"
 #include "base/constants.h"
 #include "base/gst_constants.h"
@@ -31,6 +32,7 @@
 #include "base/logo.h"
 
 #include "utils/arg_converter.h"
+#include "utils/ts_packet_filter.h"
 
 namespace iptv_cloud {
 namespace server {
@@ -98,6 +100,18 @@ Validity validate_timeshift_delay(const std::string& value) {
   return validate_range(value, 0, 12 * 24 * 3600, false);
 }
 
+Validity validate_timeshift_ring_size(const std::string& value) {
+  return validate_range(value, 0, 16 * 1024 * 1024, false);
+}
+
+Validity validate_playlist_block_size(const std::string& value) {
+  return validate_range(value, 4, 64 * 1024, false);
+}
+
+Validity validate_catchup_time(const std::string& value) {
+  return validate_is_positive(value, false);
+}
+
 Validity validate_video_parser(const std::string& value) {
   for (size_t i = 0; i < SUPPORTED_VIDEO_PARSERS_COUNT; ++i) {
     const char* parser = kSupportedVideoParsers[i];
@@ -173,11 +187,21 @@ Validity validate_cleanupts(const std::string& value) {
   return common::ConvertFromString(value, &cleanup) ? Validity::VALID : Validity::INVALID;
 }
 
+Validity validate_pids(const std::string& value) {
+  utils::ts_pids_t pids;
+  return common::ConvertFromString(value, &pids) ? Validity::VALID : Validity::INVALID;
+}
+
 Validity validate_logo(const std::string& value) {
   Logo logo;
   return common::ConvertFromString(value, &logo) ? Validity::VALID : Validity::INVALID;
 }
 
+Validity validate_abr_ladder(const std::string& value) {
+  abr_ladder_t ladder;
+  return common::ConvertFromString(value, &ladder) ? Validity::VALID : Validity::INVALID;
+}
+
 Validity validate_framerate(const std::string& value) {
   return validate_is_positive(value, false);
 }
@@ -435,8 +459,14 @@ bool FindOption(const std::string& key, option_t* opt) {
                                                   {VOLUME_FIELD, validate_volume},
                                                   {DELAY_TIME_FIELD, validate_delay_time},
                                                   {TIMESHIFT_CHUNK_DURATION_FIELD, validate_timeshift_chunk_duration},
+                                                  {TIMESHIFT_RING_SIZE_FIELD, validate_timeshift_ring_size},
+                                                  {CATCHUP_ARCHIVE_DIR_FIELD, validate_timeshift_dir},
+                                                  {CATCHUP_START_FIELD, validate_catchup_time},
+                                                  {CATCHUP_STOP_FIELD, validate_catchup_time},
                                                   {VIDEO_PARSER_FIELD, validate_video_parser},
                                                   {AUDIO_PARSER_FIELD, validate_audio_parser},
+                                                  {PASSTHROUGH_FIELD, dont_validate},
+                                                  {PIDS_FIELD, validate_pids},
                                                   {AUDIO_CODEC_FIELD, validate_audio_codec},
                                                   {VIDEO_CODEC_FIELD, validate_video_codec},
                                                   {HAVE_VIDEO_FIELD, dont_validate},
@@ -445,10 +475,14 @@ bool FindOption(const std::string& key, option_t* opt) {
                                                   {RELAY_AUDIO_FIELD, dont_validate},
                                                   {RELAY_VIDEO_FIELD, dont_validate},
                                                   {LOOP_FIELD, dont_validate},
+                                                  {PLAYLIST_BLOCK_SIZE_FIELD, validate_playlist_block_size},
+                                                  {PLAYLIST_ZERO_COPY_FIELD, dont_validate},
+                                                  {HOT_STANDBY_FIELD, dont_validate},
                                                   {AVFORMAT_FIELD, dont_validate},
                                                   {SIZE_FIELD, validate_size},
                                                   {CLEANUP_TS_FIELD, validate_cleanupts},
                                                   {LOGO_FIELD, validate_logo},
+                                                  {ABR_LADDER_FIELD, validate_abr_ladder},
                                                   {FRAME_RATE_FIELD, validate_framerate},
                                                   {ASPECT_RATIO_FIELD, validate_aspect_ratio},
                                                   {VIDEO_BIT_RATE_FIELD, validate_video_bitrate},
@@ -22,9 +22,9 @@ namespace iptv_cloud {
 namespace server {
 namespace pipe {
 
-class ProtocoledPipeClient : public protocol::ProtocolClient<common::libev::IoClient> {
+class ProtocoledPipeClient : public protocol::pipe_client_t {
  public:
-  typedef protocol::ProtocolClient<common::libev::IoClient> base_class;
+  typedef protocol::pipe_client_t base_class;
   ~ProtocoledPipeClient() override;
 
   const char* ClassName() const override;
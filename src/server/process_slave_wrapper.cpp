@@ -14,16 +14,17 @@
 
 #include "server/process_slave_wrapper.h"
 
-#include <sys/prctl.h>
 #include <sys/wait.h>
 
 #include <dlfcn.h>
 
+#include <algorithm>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include <common/convert2string.h>
 #include <common/file_system/file_system.h>
 #include <common/file_system/string_path_utils.h>
 #include <common/net/http_client.h>
@@ -153,6 +154,18 @@ common::Error PostHttpFile(const common::file_system::ascii_file_string_path& fi
   return common::Error();
 }
 
+void CloseSharedStreamFd(descriptor_t* fd) {
+  if (*fd == INVALID_DESCRIPTOR) {
+    return;
+  }
+
+  common::ErrnoError err = common::file_system::close_descriptor(*fd);
+  if (err) {
+    DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+  }
+  *fd = INVALID_DESCRIPTOR;
+}
+
 common::ErrnoError CreatePipe(int* read_client_fd, int* write_client_fd) {
   if (!read_client_fd || !write_client_fd) {
     return common::make_errno_error_inval();
@@ -283,6 +296,21 @@ bool CheckIsFullVod(const common::file_system::ascii_file_string_path& file) {
 
   return true;
 }
+
+std::vector<common::file_system::ascii_directory_string_path> GetHttpRoots(const utils::ArgsMap& config_args) {
+  std::vector<common::file_system::ascii_directory_string_path> http_roots;
+  output_t output;
+  if (!read_output(config_args, &output)) {
+    return http_roots;
+  }
+
+  for (auto out_uri : output) {
+    if (out_uri.GetOutput().GetScheme() == common::uri::Url::http) {
+      http_roots.push_back(out_uri.GetHttpRoot());
+    }
+  }
+  return http_roots;
+}
 }  // namespace
 
 struct ProcessSlaveWrapper::NodeStats {
@@ -300,8 +328,8 @@ ProcessSlaveWrapper::ProcessSlaveWrapper(const std::string& license_key, const C
       process_argc_(0),
       process_argv_(nullptr),
       loop_(),
-      http_server_(),
-      http_handler_(nullptr),
+      http_servers_(),
+      http_handlers_(),
       vods_server_(),
       vods_handler_(nullptr),
       subscribers_server_(),
@@ -309,17 +337,27 @@ ProcessSlaveWrapper::ProcessSlaveWrapper(const std::string& license_key, const C
       id_(0),
       ping_client_timer_(INVALID_TIMER_ID),
       node_stats_timer_(INVALID_TIMER_ID),
+      stream_stats_timer_(INVALID_TIMER_ID),
       cleanup_files_timer_(INVALID_TIMER_ID),
       quit_cleanup_timer_(INVALID_TIMER_ID),
       node_stats_(new NodeStats),
       stream_exec_func_(nullptr),
+      zygote_(nullptr),
       vods_links_() {
   loop_ = new DaemonServer(config.host, this);
   loop_->SetName("client_server");
 
-  http_handler_ = new HttpHandler(this);
-  http_server_ = new HttpServer(config.http_host, http_handler_);
-  http_server_->SetName("http_server");
+  size_t http_workers = config.http_workers;
+  if (http_workers == 0) {
+    http_workers = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  for (size_t i = 0; i < http_workers; ++i) {
+    HttpHandler* http_handler = new HttpHandler(this);
+    HttpServer* http_server = new HttpServer(config.http_host, http_handler);
+    http_server->SetName("http_server_" + common::ConvertToString(i));
+    http_handlers_.push_back(http_handler);
+    http_servers_.push_back(http_server);
+  }
 
   vods_handler_ = new VodsHandler(this);
   vods_server_ = new VodsServer(config.vods_host, vods_handler_);
@@ -368,8 +406,10 @@ ProcessSlaveWrapper::~ProcessSlaveWrapper() {
   destroy(&finder_);
   destroy(&vods_server_);
   destroy(&vods_handler_);
-  destroy(&http_server_);
-  destroy(&http_handler_);
+  for (size_t i = 0; i < http_servers_.size(); ++i) {
+    destroy(&http_servers_[i]);
+    destroy(&http_handlers_[i]);
+  }
   destroy(&loop_);
   destroy(&node_stats_);
 }
@@ -395,6 +435,18 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
   process_argc_ = argc;
   process_argv_ = argv;
 
+#if !defined(TEST)
+  // should be forked before any thread started
+  stream_prepare_t stream_prepare_func = reinterpret_cast<stream_prepare_t>(dlsym(handle, "stream_prepare"));
+  zygote_ = new Zygote(stream_prepare_func, stream_exec_func_, process_argc_, process_argv_);
+  common::ErrnoError zygote_err = zygote_->Start();
+  if (zygote_err) {
+    WARNING_LOG() << "Failed to start zygote, streams will be forked from daemon.";
+    DEBUG_MSG_ERROR(zygote_err, common::logging::LOG_LEVEL_WARNING);
+    destroy(&zygote_);
+  }
+#endif
+
   // gpu statistic monitor
   std::thread perf_thread;
   gpu_stats::IPerfMonitor* perf_monitor = gpu_stats::CreatePerfMonitor(&node_stats_->gpu_load);
@@ -402,23 +454,26 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
     perf_thread = std::thread([perf_monitor] { perf_monitor->Exec(); });
   }
 
-  HttpServer* http_server = static_cast<HttpServer*>(http_server_);
-  std::thread http_thread = std::thread([http_server] {
-    common::ErrnoError err = http_server->Bind(true);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      return;
-    }
+  std::vector<std::thread> http_threads;
+  for (common::libev::IoLoop* loop : http_servers_) {
+    HttpServer* http_server = static_cast<HttpServer*>(loop);
+    http_threads.push_back(std::thread([http_server] {
+      common::ErrnoError err = http_server->Bind(true);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        return;
+      }
 
-    err = http_server->Listen(5);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      return;
-    }
+      err = http_server->Listen(SOMAXCONN);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+        return;
+      }
 
-    int res = http_server->Exec();
-    UNUSED(res);
-  });
+      int res = http_server->Exec();
+      UNUSED(res);
+    }));
+  }
 
   VodsServer* vods_server = static_cast<VodsServer*>(vods_server_);
   std::thread vods_thread = std::thread([vods_server] {
@@ -479,7 +534,9 @@ int ProcessSlaveWrapper::Exec(int argc, char** argv) {
 finished:
   subscribers_thread.join();
   vods_thread.join();
-  http_thread.join();
+  for (std::thread& http_thread : http_threads) {
+    http_thread.join();
+  }
   if (perf_monitor) {
     perf_monitor->Stop();
   }
@@ -487,6 +544,10 @@ finished:
     perf_thread.join();
   }
   delete perf_monitor;
+  if (zygote_) {
+    zygote_->Stop();
+    destroy(&zygote_);
+  }
   stream_exec_func_ = nullptr;
   dlclose(handle);
   return res;
@@ -495,6 +556,7 @@ finished:
 void ProcessSlaveWrapper::PreLooped(common::libev::IoLoop* server) {
   ping_client_timer_ = server->CreateTimer(ping_timeout_clients_seconds, true);
   node_stats_timer_ = server->CreateTimer(node_stats_send_seconds, true);
+  stream_stats_timer_ = server->CreateTimer(stream_stats_check_seconds, true);
   cleanup_files_timer_ = server->CreateTimer(config_.ttl_files_, true);
 }
 
@@ -540,14 +602,19 @@ void ProcessSlaveWrapper::TimerEmited(common::libev::IoLoop* server, common::lib
   } else if (node_stats_timer_ == id) {
     const std::string node_stats = MakeServiceStats(false);
     BroadcastClients(StatisitcServiceBroadcast(node_stats));
+  } else if (stream_stats_timer_ == id) {
+    BroadcastStreamsStatistic();
   } else if (cleanup_files_timer_ == id) {
     for (auto it = vods_links_.begin(); it != vods_links_.end(); ++it) {
       utils::RemoveFilesByExtension((*it).first, CHUNK_EXT);
+      it->second.state = VodLink::UNKNOWN;
     }
   } else if (quit_cleanup_timer_ == id) {
     subscribers_server_->Stop();
     vods_server_->Stop();
-    http_server_->Stop();
+    for (common::libev::IoLoop* http_server : http_servers_) {
+      http_server->Stop();
+    }
     loop_->Stop();
   }
 }
@@ -582,8 +649,26 @@ void ProcessSlaveWrapper::ChildStatusChanged(common::libev::IoChild* child, int
              << ", signal: " << signal_number;
 
   loop_->UnRegisterChild(child);
+  for (common::libev::IoLoopObserver* http_handler : http_handlers_) {
+    static_cast<HttpHandler*>(http_handler)->RemoveHlsStores(sid);
+    static_cast<HttpHandler*>(http_handler)->RemoveTimeShift(sid);
+  }
+
+  // vod child finished own work, refresh completeness once
+  for (auto it = vods_links_.begin(); it != vods_links_.end(); ++it) {
+    VodLink* vod = &it->second;
+    if (vod->sid != sid) {
+      continue;
+    }
+
+    vod->state = VodLink::UNKNOWN;
+    if (!vod->playlist.empty()) {
+      const common::file_system::ascii_file_string_path playlist(vod->playlist);
+      vod->state = CheckIsFullVod(playlist) ? VodLink::FULL : VodLink::PARTIAL;
+    }
+  }
 
-  StreamStruct* mem = channel->GetMem();
+  SharedStreamStruct* mem = channel->GetMem();
   FreeSharedStreamStruct(&mem);
   DCHECK(!channel->GetClient()) << "In this place client should be nulled.";
   delete channel;
@@ -613,6 +698,33 @@ Child* ProcessSlaveWrapper::FindChildByID(stream_id_t cid) const {
   return nullptr;
 }
 
+void ProcessSlaveWrapper::BroadcastStreamsStatistic() {
+  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
+  auto childs = loop_->GetChilds();
+  for (auto* child : childs) {
+    Child* channel = static_cast<Child*>(child);
+    if (channel->GetType() != Child::STREAM) {
+      continue;
+    }
+
+    StatisticInfo stat;
+    ChildStream* stream = static_cast<ChildStream*>(channel);
+    if (!stream->ReadStatistic(current_time, stream_stats_send_seconds * 1000, &stat)) {
+      continue;
+    }
+
+    std::string stream_stats;
+    common::Error err_ser = stat.SerializeToString(&stream_stats);
+    if (err_ser) {
+      const std::string err_str = err_ser->GetDescription();
+      WARNING_LOG() << "Failed to generate stream statistic: " << err_str;
+      continue;
+    }
+
+    BroadcastClients(StatisitcStreamBroadcast(stream_stats));
+  }
+}
+
 void ProcessSlaveWrapper::BroadcastClients(const protocol::request_t& req) {
   std::vector<common::libev::IoClient*> clients = loop_->GetClients();
   for (size_t i = 0; i < clients.size(); ++i) {
@@ -667,6 +779,20 @@ common::ErrnoError ProcessSlaveWrapper::DaemonDataReceived(ProtocoledDaemonClien
 
 common::ErrnoError ProcessSlaveWrapper::PipeDataReceived(pipe::ProtocoledPipeClient* pipe_client) {
   CHECK(loop_->IsLoopThread());
+  if (pipe_client->IsBinaryPipeProtocol()) {
+    protocol::PipeMessage msg;
+    common::ErrnoError err = pipe_client->ReadMessage(&msg);
+    if (err) {
+      return err;
+    }
+
+    err = HandleStreamsMessage(pipe_client, msg);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    return common::ErrnoError();
+  }
+
   std::string input_command;
   common::ErrnoError err = pipe_client->ReadCommand(&input_command);
   if (err) {
@@ -751,6 +877,11 @@ void ProcessSlaveWrapper::PostLooped(common::libev::IoLoop* server) {
     server->RemoveTimer(node_stats_timer_);
     node_stats_timer_ = INVALID_TIMER_ID;
   }
+
+  if (stream_stats_timer_ != INVALID_TIMER_ID) {
+    server->RemoveTimer(stream_stats_timer_);
+    stream_stats_timer_ = INVALID_TIMER_ID;
+  }
 }
 
 void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client, const file_path_t& file) {
@@ -764,9 +895,15 @@ void ProcessSlaveWrapper::OnHttpRequest(common::libev::http::HttpClient* client,
           return;
         }
 
-        bool is_full_vod = CheckIsFullVod(file);
-        if (!is_full_vod) {
-          const serialized_stream_t config = it->second;
+        VodLink* vod = &it->second;
+        const std::string playlist = file.GetPath();
+        if (vod->state == VodLink::UNKNOWN || vod->playlist != playlist) {
+          vod->state = CheckIsFullVod(file) ? VodLink::FULL : VodLink::PARTIAL;
+          vod->playlist = playlist;
+        }
+
+        if (vod->state != VodLink::FULL) {
+          const serialized_stream_t config = vod->config;
           CreateChildStream(config);
         }
       });
@@ -808,7 +945,7 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientStopService(Protocole
     auto childs = loop_->GetChilds();
     for (auto* child : childs) {
       ChildStream* channel = static_cast<ChildStream*>(child);
-      channel->SendStop(NextRequestID());
+      channel->SendStop(NextSeqID());
     }
 
     protocol::response_t resp = StopServiceResponceSuccess(req->id);
@@ -866,16 +1003,31 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_strea
     return common::make_errno_error(common::MemSPrintf("Stream with id: %s exist, skip request.", sha.id), EINVAL);
   }
 
-  StreamStruct* mem = nullptr;
-  err = AllocSharedStreamStruct(sha, &mem);
+  const std::vector<common::file_system::ascii_directory_string_path> http_roots = GetHttpRoots(config_args);
+  const size_t hls_store_size = config_.hls_store_size * 1024 * 1024 * http_roots.size();
+  SharedStreamStruct* mem = nullptr;
+  descriptor_t mem_fd = INVALID_DESCRIPTOR;
+  err = AllocSharedStreamStruct(sha, hls_store_size, &mem, (zygote_ || hls_store_size) ? &mem_fd : nullptr);
   if (err) {
     return err;
   }
 
+  hls_store_t hls_store;
+  base::opened_file_t hls_memory;
+  if (mem->GetHlsStore()) {
+    err = MapSharedHlsStore(mem_fd, mem, &hls_store, &hls_memory);
+    if (err) {
+      WARNING_LOG() << "Failed to map hls store of stream id: " << sha.id << ", files will be served from disk.";
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    }
+  }
+
+  const protocol::PipeProtocol pipe_protocol = protocol::BINARY_PIPE_PROTOCOL;
   int read_command_client = 0;
   int write_requests_client = 0;
   err = CreatePipe(&read_command_client, &write_requests_client);
   if (err) {
+    CloseSharedStreamFd(&mem_fd);
     FreeSharedStreamStruct(&mem);
     return err;
   }
@@ -884,27 +1036,33 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_strea
   int write_responce_client = 0;
   err = CreatePipe(&read_responce_client, &write_responce_client);
   if (err) {
+    CloseSharedStreamFd(&mem_fd);
     FreeSharedStreamStruct(&mem);
     return err;
   }
 
+  const StreamExecInfo exec_info = {sha.id, feedback_dir, logs_level, pipe_protocol, config_args};
+  pid_t pid = -1;
+  bool forked_by_zygote = false;
+  if (zygote_ && mem_fd != INVALID_DESCRIPTOR) {
+    err = zygote_->ForkStream(exec_info, read_command_client, write_responce_client, mem_fd, &pid);
+    if (err) {
+      WARNING_LOG() << "Failed to start stream id: " << sha.id << " via zygote, fallback to fork.";
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    } else {
+      forked_by_zygote = true;
+    }
+  }
+  CloseSharedStreamFd(&mem_fd);
+
+  if (!forked_by_zygote) {
 #if !defined(TEST)
-  pid_t pid = fork();
+    pid = fork();
 #else
-  pid_t pid = 0;
+    pid = 0;
 #endif
+  }
   if (pid == 0) {  // child
-    const struct cmd_args client_args = {feedback_dir.c_str(), logs_level};
-    const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", sha.id);
-    for (int i = 0; i < process_argc_; ++i) {
-      memset(process_argv_[i], 0, strlen(process_argv_[i]));
-    }
-    const char* new_name = new_process_name.c_str();
-    char* app_name = process_argv_[0];
-    strncpy(app_name, new_name, new_process_name.length());
-    app_name[new_process_name.length()] = 0;
-    prctl(PR_SET_NAME, new_name);
-
 #if !defined(TEST)
     // close not needed pipes
     common::ErrnoError errn = common::file_system::close_descriptor(read_responce_client);
@@ -917,12 +1075,8 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_strea
     }
 #endif
 
-    pipe::ProtocoledPipeClient* client =
-        new pipe::ProtocoledPipeClient(nullptr, read_command_client, write_responce_client);
-    client->SetName(sha.id);
-    int res = stream_exec_func_(new_name, &client_args, &config_args, client, mem);
-    client->Close();
-    delete client;
+    int res = ExecStream(stream_exec_func_, process_argc_, process_argv_, exec_info, read_command_client,
+                         write_responce_client, mem);
     _exit(res);
   } else if (pid < 0) {
     NOTICE_LOG() << "Failed to start children!";
@@ -933,17 +1087,35 @@ common::ErrnoError ProcessSlaveWrapper::CreateChildStream(const serialized_strea
       DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
     }
     errn = common::file_system::close_descriptor(write_responce_client);
-    if (err) {
+    if (errn) {
       DEBUG_MSG_ERROR(errn, common::logging::LOG_LEVEL_WARNING);
     }
 
     pipe::ProtocoledPipeClient* pipe_client =
         new pipe::ProtocoledPipeClient(loop_, read_responce_client, write_requests_client);
     pipe_client->SetName(sha.id);
+    pipe_client->SetPipeProtocol(pipe_protocol);
     loop_->RegisterClient(pipe_client);
     ChildStream* new_channel = new ChildStream(loop_, mem);
     new_channel->SetClient(pipe_client);
     loop_->RegisterChild(new_channel, pid);
+    if (hls_store) {
+      for (common::libev::IoLoopObserver* http_handler : http_handlers_) {
+        for (const auto& http_root : http_roots) {
+          static_cast<HttpHandler*>(http_handler)
+              ->AddHlsStore(sha.id, http_root, hls_store, hls_memory, mem->hls_store_offset);
+        }
+      }
+    }
+
+    std::string timeshift_dir;
+    if ((sha.type == TIMESHIFT_RECORDER || sha.type == CATCHUP) &&
+        utils::ArgsGetValue(config_args, TIMESHIFT_DIR_FIELD, &timeshift_dir)) {
+      const auto timeshift_root = HttpHandler::http_directory_path_t(timeshift_dir);
+      for (common::libev::IoLoopObserver* http_handler : http_handlers_) {
+        static_cast<HttpHandler*>(http_handler)->AddTimeShift(sha.id, timeshift_root);
+      }
+    }
   }
 
   return common::ErrnoError();
@@ -982,39 +1154,6 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestChangedSourcesStream(pipe::
   return common::make_errno_error_inval();
 }
 
-common::ErrnoError ProcessSlaveWrapper::HandleRequestStatisticStream(pipe::ProtocoledPipeClient* pclient,
-                                                                     protocol::request_t* req) {
-  UNUSED(pclient);
-  CHECK(loop_->IsLoopThread());
-  if (req->params) {
-    const char* params_ptr = req->params->c_str();
-    json_object* jrequest_stat = json_tokener_parse(params_ptr);
-    if (!jrequest_stat) {
-      return common::make_errno_error_inval();
-    }
-
-    StatisticInfo stat;
-    common::Error err_des = stat.DeSerialize(jrequest_stat);
-    json_object_put(jrequest_stat);
-    if (err_des) {
-      const std::string err_str = err_des->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
-
-    std::string stream_stats;
-    common::Error err_ser = stat.SerializeToString(&stream_stats);
-    if (err_ser) {
-      const std::string err_str = err_ser->GetDescription();
-      return common::make_errno_error(err_str, EAGAIN);
-    }
-
-    BroadcastClients(StatisitcStreamBroadcast(stream_stats));
-    return common::ErrnoError();
-  }
-
-  return common::make_errno_error_inval();
-}
-
 common::ErrnoError ProcessSlaveWrapper::HandleRequestClientStartStream(ProtocoledDaemonClient* dclient,
                                                                        protocol::request_t* req) {
   CHECK(loop_->IsLoopThread());
@@ -1052,8 +1191,12 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientStartStream(Protocole
   return common::make_errno_error_inval();
 }
 
+protocol::seq_id_t ProcessSlaveWrapper::NextSeqID() {
+  return id_++;
+}
+
 protocol::sequance_id_t ProcessSlaveWrapper::NextRequestID() {
-  const protocol::seq_id_t next_id = id_++;
+  const protocol::seq_id_t next_id = NextSeqID();
   return common::protocols::json_rpc::MakeRequestID(next_id);
 }
 
@@ -1086,7 +1229,7 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientStopStream(Protocoled
       return common::ErrnoError();
     }
 
-    chan->SendStop(NextRequestID());
+    chan->SendStop(NextSeqID());
     protocol::response_t resp = StopStreamResponceSuccess(req->id);
     dclient->WriteResponse(resp);
     return common::ErrnoError();
@@ -1124,7 +1267,7 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientRestartStream(Protoco
       return common::ErrnoError();
     }
 
-    chan->SendRestart(NextRequestID());
+    chan->SendRestart(NextSeqID());
     protocol::response_t resp = RestartStreamResponceSuccess(req->id);
     dclient->WriteResponse(resp);
     return common::ErrnoError();
@@ -1232,7 +1375,9 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestClientPrepareService(Protoc
     }
 
     const auto http_root = HttpHandler::http_directory_path_t(state_info.GetHlsDirectory());
-    static_cast<HttpHandler*>(http_handler_)->SetHttpRoot(http_root);
+    for (common::libev::IoLoopObserver* http_handler : http_handlers_) {
+      static_cast<HttpHandler*>(http_handler)->SetHttpRoot(http_root);
+    }
 
     const auto vods_root = VodsHandler::vods_directory_path_t(state_info.GetVodsDirectory());
     static_cast<VodsHandler*>(vods_handler_)->SetVodsRoot(vods_root);
@@ -1313,7 +1458,7 @@ void ProcessSlaveWrapper::AddStreamLine(const std::string& config) {
         if (ouri.GetScheme() == common::uri::Url::http) {
           const common::file_system::ascii_directory_string_path http_root = out_uri.GetHttpRoot();
           config_args[CLEANUP_TS_FIELD] = common::ConvertToString(false);
-          vods_links_[http_root] = config_args;
+          vods_links_[http_root] = {sha.id, config_args, VodLink::UNKNOWN, std::string()};
         }
       }
     }
@@ -1484,14 +1629,34 @@ common::ErrnoError ProcessSlaveWrapper::HandleRequestStreamsCommand(pipe::Protoc
                                                                     protocol::request_t* req) {
   if (req->method == CHANGED_SOURCES_STREAM) {
     return HandleRequestChangedSourcesStream(pclient, req);
-  } else if (req->method == STATISTIC_STREAM) {
-    return HandleRequestStatisticStream(pclient, req);
   }
 
   WARNING_LOG() << "Received unknown command: " << req->method;
   return common::ErrnoError();
 }
 
+common::ErrnoError ProcessSlaveWrapper::HandleStreamsMessage(pipe::ProtocoledPipeClient* pclient,
+                                                             const protocol::PipeMessage& msg) {
+  UNUSED(pclient);
+  CHECK(loop_->IsLoopThread());
+  if (msg.IsNotification()) {
+    if (msg.command == protocol::PIPE_CHANGED_SOURCES_STREAM) {
+      // payload is already serialized ChangedSouresInfo, forward it as is
+      BroadcastClients(ChangedSourcesStreamBroadcast(msg.payload));
+      return common::ErrnoError();
+    }
+  } else if (msg.IsResponse()) {
+    if (msg.type == protocol::PIPE_RESPONSE_ERROR) {
+      WARNING_LOG() << "Stream failed command: " << protocol::PipeCommandToString(msg.command) << ", "
+                    << msg.payload;
+    }
+    return common::ErrnoError();
+  }
+
+  WARNING_LOG() << "Received unknown command: " << protocol::PipeCommandToString(msg.command);
+  return common::ErrnoError();
+}
+
 common::ErrnoError ProcessSlaveWrapper::HandleResponceStreamsCommand(pipe::ProtocoledPipeClient* pclient,
                                                                      protocol::response_t* resp) {
   protocol::request_t req;
@@ -1534,7 +1699,11 @@ std::string ProcessSlaveWrapper::MakeServiceStats(bool full_stat) const {
       daemons_client_count++;
     }
   }
-  service::OnlineUsers online(daemons_client_count, static_cast<HttpHandler*>(http_handler_)->GetOnlineClients(),
+  size_t http_client_count = 0;
+  for (common::libev::IoLoopObserver* http_handler : http_handlers_) {
+    http_client_count += static_cast<HttpHandler*>(http_handler)->GetOnlineClients();
+  }
+  service::OnlineUsers online(daemons_client_count, http_client_count,
                               static_cast<HttpHandler*>(vods_handler_)->GetOnlineClients(),
                               static_cast<HttpHandler*>(subscribers_handler_)->GetOnlineClients());
   service::ServerInfo stat(cpu_load * 100, node_stats_->gpu_load, uptime_str, mem_shot, hdd_shot, bytes_recv / ts_diff,
@@ -16,6 +16,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <common/libev/io_loop_observer.h>
 #include <common/net/types.h>
@@ -26,6 +27,7 @@
 
 #include "server/base/ihttp_requests_observer.h"
 #include "server/config.h"
+#include "server/zygote.h"
 
 namespace iptv_cloud {
 namespace server {
@@ -41,7 +43,13 @@ class ProtocoledDaemonClient;
 
 class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server::base::IHttpRequestsObserver {
  public:
-  enum { node_stats_send_seconds = 10, ping_timeout_clients_seconds = 60, cleanup_seconds = 3 };
+  enum {
+    node_stats_send_seconds = 10,
+    stream_stats_check_seconds = 1,
+    stream_stats_send_seconds = 10,
+    ping_timeout_clients_seconds = 60,
+    cleanup_seconds = 3
+  };
   typedef utils::ArgsMap serialized_stream_t;
 
   explicit ProcessSlaveWrapper(const std::string& licensy_key, const Config& config);
@@ -81,20 +89,18 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
                                                          protocol::request_t* req) WARN_UNUSED_RESULT;
   virtual common::ErrnoError HandleResponceStreamsCommand(pipe::ProtocoledPipeClient* pclient,
                                                           protocol::response_t* resp) WARN_UNUSED_RESULT;
+  virtual common::ErrnoError HandleStreamsMessage(pipe::ProtocoledPipeClient* pclient,
+                                                  const protocol::PipeMessage& msg) WARN_UNUSED_RESULT;
 
  private:
-  typedef int (*stream_exec_t)(const char* process_name,
-                               const void* cmd_args,
-                               const void* config_args,
-                               void* command_client,
-                               void* mem);
-
   Child* FindChildByID(stream_id_t cid) const;
   void BroadcastClients(const protocol::request_t& req);
+  void BroadcastStreamsStatistic();
 
   common::ErrnoError DaemonDataReceived(ProtocoledDaemonClient* dclient) WARN_UNUSED_RESULT;
   common::ErrnoError PipeDataReceived(pipe::ProtocoledPipeClient* pclient) WARN_UNUSED_RESULT;
 
+  protocol::seq_id_t NextSeqID();
   protocol::sequance_id_t NextRequestID();
 
   common::ErrnoError CreateChildStream(const std::string& config);
@@ -104,9 +110,6 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   common::ErrnoError HandleRequestChangedSourcesStream(pipe::ProtocoledPipeClient* pclient,
                                                        protocol::request_t* req) WARN_UNUSED_RESULT;
 
-  common::ErrnoError HandleRequestStatisticStream(pipe::ProtocoledPipeClient* pclient,
-                                                  protocol::request_t* req) WARN_UNUSED_RESULT;
-
   common::ErrnoError HandleRequestClientStartStream(ProtocoledDaemonClient* dclient,
                                                     protocol::request_t* req) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestClientStopStream(ProtocoledDaemonClient* dclient,
@@ -140,6 +143,16 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
 
   struct NodeStats;
 
+  // vod output directory, completeness is checked on first playlist request and kept until vod child exits
+  // or chunks are cleaned up, so playlist requests don't parse playlist and stat chunks every time
+  struct VodLink {
+    enum State { UNKNOWN = 0, FULL, PARTIAL };
+    stream_id_t sid;
+    serialized_stream_t config;
+    State state;
+    std::string playlist;  // path state was checked for
+  };
+
   const Config config_;
   const std::string license_key_;
 
@@ -147,8 +160,8 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   char** process_argv_;
 
   common::libev::IoLoop* loop_;
-  common::libev::IoLoop* http_server_;
-  common::libev::IoLoopObserver* http_handler_;
+  std::vector<common::libev::IoLoop*> http_servers_;  // share http host port, one handler per server
+  std::vector<common::libev::IoLoopObserver*> http_handlers_;
   common::libev::IoLoop* vods_server_;
   common::libev::IoLoopObserver* vods_handler_;
   common::libev::IoLoop* subscribers_server_;
@@ -157,12 +170,14 @@ class ProcessSlaveWrapper : public common::libev::IoLoopObserver, public server:
   std::atomic<protocol::seq_id_t> id_;
   common::libev::timer_id_t ping_client_timer_;
   common::libev::timer_id_t node_stats_timer_;
+  common::libev::timer_id_t stream_stats_timer_;
   common::libev::timer_id_t cleanup_files_timer_;
   common::libev::timer_id_t quit_cleanup_timer_;
   NodeStats* node_stats_;
   stream_exec_t stream_exec_func_;
+  Zygote* zygote_;
 
-  std::map<common::file_system::ascii_directory_string_path, serialized_stream_t> vods_links_;
+  std::map<common::file_system::ascii_directory_string_path, VodLink> vods_links_;
   subscribers::ISubscribeFinder* finder_;
 };
 
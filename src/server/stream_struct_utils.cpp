@@ -14,34 +14,158 @@
 
 #include "server/stream_struct_utils.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <common/file_system/file_system.h>
 
 namespace iptv_cloud {
 namespace server {
 
-common::ErrnoError AllocSharedStreamStruct(const StreamInfo& sha, StreamStruct** stream) {
-  StreamStruct* mem = static_cast<StreamStruct*>(
-      mmap(nullptr, sizeof(StreamStruct), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
-  if (!mem) {
+namespace {
+descriptor_t CreateMemoryFile(const char* name, size_t size) {
+#if defined(SYS_memfd_create)
+  descriptor_t fd = static_cast<descriptor_t>(syscall(SYS_memfd_create, name, 0));
+  if (fd == ERROR_RESULT_VALUE) {
+    return INVALID_DESCRIPTOR;
+  }
+
+  if (ftruncate(fd, size) == ERROR_RESULT_VALUE) {
+    ignore_result(common::file_system::close_descriptor(fd));
+    return INVALID_DESCRIPTOR;
+  }
+  return fd;
+#else
+  UNUSED(name);
+  UNUSED(size);
+  return INVALID_DESCRIPTOR;
+#endif
+}
+
+size_t GetHlsStoreOffset() {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  return (sizeof(SharedStreamStruct) + page_size - 1) / page_size * page_size;
+}
+}  // namespace
+
+common::ErrnoError AllocSharedStreamStruct(const StreamInfo& sha,
+                                           size_t hls_store_size,
+                                           SharedStreamStruct** stream,
+                                           descriptor_t* fd) {
+  if (!stream) {
+    return common::make_errno_error_inval();
+  }
+
+  if (!SharedStreamStruct::IsFitInfo(sha)) {
+    return common::make_errno_error("Stream id or channels count not fit into shared memory.", EINVAL);
+  }
+
+  const size_t hls_store_offset = GetHlsStoreOffset();
+  size_t segment_size = sizeof(SharedStreamStruct);
+  descriptor_t mem_fd = INVALID_DESCRIPTOR;
+  if (fd) {
+    // pages of store are allocated on first write, so it is cheap until stream fills it
+    const size_t memfd_size =
+        hls_store_size ? hls_store_offset + SharedHlsStore::CalcSize(hls_store_size) : sizeof(SharedStreamStruct);
+    mem_fd = CreateMemoryFile("stream_stats", memfd_size);
+    if (mem_fd != INVALID_DESCRIPTOR) {
+      segment_size = memfd_size;
+    }
+  }
+
+  void* mem = MAP_FAILED;
+  if (mem_fd != INVALID_DESCRIPTOR) {
+    mem = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+  } else {
+    mem = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  }
+  if (mem == MAP_FAILED) {
+    if (mem_fd != INVALID_DESCRIPTOR) {
+      ignore_result(common::file_system::close_descriptor(mem_fd));
+    }
     return common::make_errno_error("Failed to allocate memory.", ENOMEM);
   }
 
-  *stream = new (mem) StreamStruct(sha);
+  SharedStreamStruct* lstream = new (mem) SharedStreamStruct(sha);
+  lstream->segment_size = segment_size;
+  if (segment_size > sizeof(SharedStreamStruct)) {
+    lstream->hls_store_offset = hls_store_offset;
+    new (static_cast<char*>(mem) + hls_store_offset) SharedHlsStore(hls_store_size);
+  }
+
+  *stream = lstream;
+  if (fd) {
+    *fd = mem_fd;
+  }
+  return common::ErrnoError();
+}
+
+common::ErrnoError MapSharedStreamStruct(descriptor_t fd, SharedStreamStruct** stream) {
+  if (fd == INVALID_DESCRIPTOR || !stream) {
+    return common::make_errno_error_inval();
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+
+  if (static_cast<size_t>(sb.st_size) < sizeof(SharedStreamStruct)) {
+    return common::make_errno_error("Invalid stream segment size.", EINVAL);
+  }
+
+  void* mem = mmap(nullptr, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    return common::make_errno_error(errno);
+  }
+
+  *stream = static_cast<SharedStreamStruct*>(mem);
+  return common::ErrnoError();
+}
+
+common::ErrnoError MapSharedHlsStore(descriptor_t fd,
+                                     const SharedStreamStruct* stream,
+                                     hls_store_t* store,
+                                     base::opened_file_t* memory) {
+  if (fd == INVALID_DESCRIPTOR || !stream || !stream->hls_store_offset || !store || !memory) {
+    return common::make_errno_error_inval();
+  }
+
+  const size_t offset = stream->hls_store_offset;
+  const size_t size = stream->segment_size - offset;
+  void* mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, offset);
+  if (mem == MAP_FAILED) {
+    return common::make_errno_error(errno);
+  }
+
+  const descriptor_t memory_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);  // passed fd is closed after stream started
+  if (memory_fd == INVALID_DESCRIPTOR) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    munmap(mem, size);
+    return err;
+  }
+
+  *memory = std::make_shared<const base::OpenedFile>(memory_fd, stream->segment_size, 0);
+  *store = hls_store_t(static_cast<SharedHlsStore*>(mem), [size](SharedHlsStore* mapped) { munmap(mapped, size); });
   return common::ErrnoError();
 }
 
-void FreeSharedStreamStruct(StreamStruct** data) {
+void FreeSharedStreamStruct(SharedStreamStruct** data) {
   if (!data) {
     return;
   }
 
-  StreamStruct* ldata = *data;
+  SharedStreamStruct* ldata = *data;
   if (!ldata) {
     return;
   }
 
-  ldata->~StreamStruct();
-  munmap(ldata, sizeof(StreamStruct));
+  const size_t segment_size = ldata->segment_size;
+  ldata->~SharedStreamStruct();
+  munmap(ldata, segment_size);
   *data = nullptr;
 }
 
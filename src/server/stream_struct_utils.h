@@ -14,16 +14,37 @@
 
 #pragma once
 
+#include <memory>
+
 #include <common/error.h>
+#include <common/types.h>
+
+#include "base/shared_stream_struct.h"
 
-#include "base/stream_struct.h"
+#include "server/base/open_files_cache.h"
 
 namespace iptv_cloud {
 namespace server {
+typedef std::shared_ptr<SharedHlsStore> hls_store_t;
+
 // id, type, input, output
-common::ErrnoError AllocSharedStreamStruct(const StreamInfo& sha, StreamStruct** stream);
+// if fd not null segment is backed by memfd, so it can be passed to a process which is not our fork (zygote),
+// fd is INVALID_DESCRIPTOR if memfd not supported, caller should close valid fd after passing
+// hls_store_size is data size of in-memory hls store, store is allocated only for memfd backed segment
+common::ErrnoError AllocSharedStreamStruct(const StreamInfo& sha,
+                                           size_t hls_store_size,
+                                           SharedStreamStruct** stream,
+                                           descriptor_t* fd = nullptr) WARN_UNUSED_RESULT;
+// map segment allocated by other process
+common::ErrnoError MapSharedStreamStruct(descriptor_t fd, SharedStreamStruct** stream) WARN_UNUSED_RESULT;
+// own mapping of stream hls store, stays valid after stream segment freed,
+// memory is own descriptor of memfd, so files of store can be sent by sendfile from their memfd offset
+common::ErrnoError MapSharedHlsStore(descriptor_t fd,
+                                     const SharedStreamStruct* stream,
+                                     hls_store_t* store,
+                                     base::opened_file_t* memory) WARN_UNUSED_RESULT;
 
-void FreeSharedStreamStruct(StreamStruct** data);
+void FreeSharedStreamStruct(SharedStreamStruct** data);
 
 }  // namespace server
 }  // namespace iptv_cloud
@@ -14,16 +14,16 @@
 
 #pragma once
 
-#include <common/libev/http/http_client.h>
-
 #include "protocol/protocol.h"
 
+#include "server/base/async_http_client.h"
+
 namespace iptv_cloud {
 namespace server {
 
-class VodsClient : public common::libev::http::HttpClient {
+class VodsClient : public base::AsyncHttpClient {
  public:
-  typedef common::libev::http::HttpClient base_class;
+  typedef base::AsyncHttpClient base_class;
 
   VodsClient(common::libev::IoLoop* server, const common::net::socket_info& info);
 
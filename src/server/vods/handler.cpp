@@ -14,10 +14,6 @@
 
 #include "server/vods/handler.h"
 
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <unistd.h>
-
 #include <string>
 #include <utility>
 
@@ -69,17 +65,6 @@ void VodsHandler::ChildStatusChanged(common::libev::IoChild* child, int status)
 #endif
 
 void VodsHandler::DataReceived(common::libev::IoClient* client) {
-  char buff[BUF_SIZE] = {0};
-  size_t nread = 0;
-  common::ErrnoError errn = client->SingleRead(buff, BUF_SIZE - 1, &nread);
-  if ((errn && errn->GetErrorCode() != EAGAIN) || nread == 0) {
-    client->Close();
-    delete client;
-    return base_class::DataReceived(client);
-  }
-
-  VodsClient* hclient = static_cast<server::VodsClient*>(client);
-  ProcessReceived(hclient, buff, nread);
   base_class::DataReceived(client);
 }
 
@@ -91,7 +76,7 @@ void VodsHandler::PostLooped(common::libev::IoLoop* server) {
   base_class::PostLooped(server);
 }
 
-void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size_t req_len) {
+void VodsHandler::ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) {
   static const common::libev::http::HttpServerInfo hinf(PROJECT_NAME_TITLE, PROJECT_DOMAIN);
   common::http::HttpRequest hrequest;
   std::string request_str(request, req_len);
@@ -101,13 +86,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
   if (result.second) {
     const std::string error_text = result.second->GetDescription();
     DEBUG_MSG_ERROR(result.second, common::logging::LOG_LEVEL_ERR);
-    common::ErrnoError err =
-        hclient->SendError(common::http::HP_1_1, result.first, nullptr, error_text.c_str(), false, hinf);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-    }
-    hclient->Close();
-    delete hclient;
+    hclient->QueueError(common::http::HP_1_1, result.first, nullptr, error_text.c_str(), false, hinf);
     return;
   }
 
@@ -121,11 +100,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
       hrequest.GetMethod() == common::http::http_method::HM_HEAD) {
     common::uri::Upath path = hrequest.GetPath();
     if (!path.IsValid() || path.IsRoot()) {  // for hls
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
+      hclient->QueueError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
       return;
     }
 
@@ -137,11 +112,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
 
     auto file_path = dirs_path->MakeFileStringPath(path.GetFileName());
     if (!file_path) {
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
+      hclient->QueueError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
       return;
     }
 
@@ -150,60 +121,7 @@ void VodsHandler::ProcessReceived(VodsClient* hclient, const char* request, size
     }
 
     const std::string file_path_str = file_path->GetPath();
-    int open_flags = O_RDONLY;
-    struct stat sb;
-    if (stat(file_path_str.c_str(), &sb) < 0) {
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_NOT_FOUND, extra_header, "File not found.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      return;
-    }
-
-    if (S_ISDIR(sb.st_mode)) {
-      common::ErrnoError err =
-          hclient->SendError(protocol, common::http::HS_BAD_REQUEST, extra_header, "Bad filename.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      return;
-    }
-
-    int file = open(file_path_str.c_str(), open_flags);
-    if (file == INVALID_DESCRIPTOR) { /* open the file for reading */
-      common::ErrnoError err = hclient->SendError(protocol, common::http::HS_FORBIDDEN, extra_header,
-                                                  "File is protected.", IsKeepAlive, hinf);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      }
-      return;
-    }
-
-    const std::string mime = path.GetMime();
-    common::ErrnoError err = hclient->SendHeaders(protocol, common::http::HS_OK, extra_header, mime.c_str(),
-                                                  &sb.st_size, &sb.st_mtime, IsKeepAlive, hinf);
-    if (err) {
-      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      ::close(file);
-      return;
-    }
-
-    if (hrequest.GetMethod() == common::http::http_method::HM_GET) {
-      common::ErrnoError err = hclient->SendFileByFd(protocol, file, sb.st_size);
-      if (err) {
-        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
-      } else {
-        DEBUG_LOG() << "Sent file path: " << file_path_str << ", size: " << sb.st_size;
-      }
-    }
-
-    ::close(file);
-  }
-
-  if (!IsKeepAlive) {
-    hclient->Close();
-    delete hclient;
+    QueueFileContent(hclient, hrequest, file_path_str, path.GetMime(), IsKeepAlive, hinf);
   }
 }
 
@@ -16,20 +16,18 @@
 
 #include <common/file_system/path.h>
 
-#include "server/base/iserver_handler.h"
+#include "server/base/ihttp_handler.h"
 
 namespace iptv_cloud {
 namespace server {
 
-class VodsClient;
 namespace base {
 class IHttpRequestsObserver;
 }
 
-class VodsHandler : public base::IServerHandler {
+class VodsHandler : public base::IHttpHandler {
  public:
-  enum { BUF_SIZE = 4096 };
-  typedef base::IServerHandler base_class;
+  typedef base::IHttpHandler base_class;
   typedef common::file_system::ascii_directory_string_path vods_directory_path_t;
   explicit VodsHandler(base::IHttpRequestsObserver* observer);
 
@@ -53,7 +51,7 @@ class VodsHandler : public base::IServerHandler {
   void PostLooped(common::libev::IoLoop* server) override;
 
  private:
-  void ProcessReceived(VodsClient* hclient, const char* request, size_t req_len);
+  void ProcessReceived(base::AsyncHttpClient* hclient, const char* request, size_t req_len) override;
 
   vods_directory_path_t vods_root_;
   base::IHttpRequestsObserver* const observer_;
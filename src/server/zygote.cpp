@@ -0,0 +1,429 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "server/zygote.h"
+
+#include <signal.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <common/file_system/file_system.h>
+#include <common/sprintf.h>
+
+#include "stream/cmd_args.h"
+
+#include "server/pipe/pipe_client.h"
+#include "server/stream_struct_utils.h"
+
+namespace iptv_cloud {
+namespace server {
+
+namespace {
+
+enum { zygote_max_request_size = 256 * 1024, zygote_fds_count = 3 };
+
+struct ZygoteReply {
+  pid_t pid;
+  int error;
+};
+
+void AppendUInt32(uint32_t value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(const std::string& str, std::string* out) {
+  AppendUInt32(str.size(), out);
+  out->append(str);
+}
+
+bool ReadUInt32(const char** data, const char* end, uint32_t* out) {
+  if (static_cast<size_t>(end - *data) < sizeof(uint32_t)) {
+    return false;
+  }
+
+  memcpy(out, *data, sizeof(uint32_t));
+  *data += sizeof(uint32_t);
+  return true;
+}
+
+bool ReadString(const char** data, const char* end, std::string* out) {
+  uint32_t size = 0;
+  if (!ReadUInt32(data, end, &size)) {
+    return false;
+  }
+
+  if (static_cast<size_t>(end - *data) < size) {
+    return false;
+  }
+
+  out->assign(*data, size);
+  *data += size;
+  return true;
+}
+
+std::string SerializeExecInfo(const StreamExecInfo& info) {
+  std::string result;
+  AppendString(info.id, &result);
+  AppendString(info.feedback_dir, &result);
+  AppendUInt32(info.logs_level, &result);
+  AppendUInt32(info.pipe_protocol, &result);
+  AppendUInt32(info.config_args.size(), &result);
+  for (auto it = info.config_args.begin(); it != info.config_args.end(); ++it) {
+    AppendString(it->first, &result);
+    AppendString(it->second, &result);
+  }
+  return result;
+}
+
+bool DeSerializeExecInfo(const char* data, size_t size, StreamExecInfo* info) {
+  const char* end = data + size;
+  StreamExecInfo linfo;
+  uint32_t logs_level = 0;
+  uint32_t pipe_protocol = 0;
+  uint32_t count = 0;
+  if (!ReadString(&data, end, &linfo.id) || !ReadString(&data, end, &linfo.feedback_dir) ||
+      !ReadUInt32(&data, end, &logs_level) || !ReadUInt32(&data, end, &pipe_protocol) ||
+      !ReadUInt32(&data, end, &count)) {
+    return false;
+  }
+
+  if (!protocol::IsValidPipeProtocol(pipe_protocol)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string key;
+    std::string value;
+    if (!ReadString(&data, end, &key) || !ReadString(&data, end, &value)) {
+      return false;
+    }
+    linfo.config_args[key] = value;
+  }
+
+  linfo.logs_level = static_cast<common::logging::LOG_LEVEL>(logs_level);
+  linfo.pipe_protocol = static_cast<protocol::PipeProtocol>(pipe_protocol);
+  *info = linfo;
+  return true;
+}
+
+common::ErrnoError SendWithFds(descriptor_t sock, const std::string& data, const descriptor_t* fds, size_t fds_count) {
+  struct iovec iov;
+  iov.iov_base = const_cast<char*>(data.data());
+  iov.iov_len = data.size();
+
+  char control[CMSG_SPACE(sizeof(descriptor_t) * zygote_fds_count)];
+  memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = CMSG_SPACE(sizeof(descriptor_t) * fds_count);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(descriptor_t) * fds_count);
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(descriptor_t) * fds_count);
+
+  ssize_t res = 0;
+  do {
+    res = sendmsg(sock, &msg, MSG_NOSIGNAL);
+  } while (res == ERROR_RESULT_VALUE && errno == EINTR);
+  if (res == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+  return common::ErrnoError();
+}
+
+common::ErrnoError RecvWithFds(descriptor_t sock,
+                               char* data,
+                               size_t max_size,
+                               size_t* size,
+                               descriptor_t* fds,
+                               size_t* fds_count) {
+  struct iovec iov;
+  iov.iov_base = data;
+  iov.iov_len = max_size;
+
+  char control[CMSG_SPACE(sizeof(descriptor_t) * zygote_fds_count)];
+  memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t res = 0;
+  do {
+    res = recvmsg(sock, &msg, 0);
+  } while (res == ERROR_RESULT_VALUE && errno == EINTR);
+  if (res == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+  if (res == 0) {
+    return common::make_errno_error("Connection closed", ECONNRESET);
+  }
+
+  size_t lfds_count = 0;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      lfds_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(descriptor_t);
+      memcpy(fds, CMSG_DATA(cmsg), sizeof(descriptor_t) * lfds_count);
+    }
+  }
+
+  *size = (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) ? 0 : res;  // truncated request is invalid
+  *fds_count = lfds_count;
+  return common::ErrnoError();
+}
+
+void CloseDescriptors(const descriptor_t* fds, size_t fds_count) {
+  for (size_t i = 0; i < fds_count; ++i) {
+    common::ErrnoError err = common::file_system::close_descriptor(fds[i]);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_WARNING);
+    }
+  }
+}
+
+void SendReply(descriptor_t sock, pid_t pid, int error) {
+  const ZygoteReply reply = {pid, error};
+  ssize_t res = send(sock, &reply, sizeof(reply), MSG_NOSIGNAL);
+  if (res == ERROR_RESULT_VALUE) {
+    WARNING_LOG() << "Zygote failed to send reply: " << common::common_strerror(errno);
+  }
+}
+
+void SetProcessName(int process_argc, char** process_argv, const std::string& name) {
+  for (int i = 0; i < process_argc; ++i) {
+    memset(process_argv[i], 0, strlen(process_argv[i]));
+  }
+  const char* new_name = name.c_str();
+  char* app_name = process_argv[0];
+  strncpy(app_name, new_name, name.length());
+  app_name[name.length()] = 0;
+  prctl(PR_SET_NAME, new_name);
+}
+
+}  // namespace
+
+int ExecStream(stream_exec_t exec_func,
+               int process_argc,
+               char** process_argv,
+               const StreamExecInfo& info,
+               descriptor_t read_command_fd,
+               descriptor_t write_responce_fd,
+               SharedStreamStruct* mem) {
+  const std::string new_process_name = common::MemSPrintf(STREAMER_NAME "_%s", info.id);
+  SetProcessName(process_argc, process_argv, new_process_name);
+
+  const struct cmd_args client_args = {info.feedback_dir.c_str(), info.logs_level, info.pipe_protocol};
+  pipe::ProtocoledPipeClient* client = new pipe::ProtocoledPipeClient(nullptr, read_command_fd, write_responce_fd);
+  client->SetName(info.id);
+  int res = exec_func(new_process_name.c_str(), &client_args, &info.config_args, client, mem);
+  client->Close();
+  delete client;
+  return res;
+}
+
+Zygote::Zygote(stream_prepare_t prepare_func, stream_exec_t exec_func, int process_argc, char** process_argv)
+    : prepare_func_(prepare_func),
+      exec_func_(exec_func),
+      process_argc_(process_argc),
+      process_argv_(process_argv),
+      pid_(-1),
+      sock_(INVALID_DESCRIPTOR) {}
+
+Zygote::~Zygote() {
+  Stop();
+}
+
+common::ErrnoError Zygote::Start() {
+  if (IsRunning() || !exec_func_) {
+    return common::make_errno_error_inval();
+  }
+
+  // orphaned streams should be reparented to us, not to init
+  int res = prctl(PR_SET_CHILD_SUBREAPER, 1);
+  if (res == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+
+  int socks[2] = {INVALID_DESCRIPTOR, INVALID_DESCRIPTOR};
+  res = socketpair(AF_UNIX, SOCK_SEQPACKET, 0, socks);
+  if (res == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    ignore_result(common::file_system::close_descriptor(socks[0]));
+    _exit(Exec(socks[1]));
+  } else if (pid < 0) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    CloseDescriptors(socks, SIZEOFMASS(socks));
+    return err;
+  }
+
+  ignore_result(common::file_system::close_descriptor(socks[1]));
+  pid_ = pid;
+  sock_ = socks[0];
+  INFO_LOG() << "Zygote started, pid: " << pid_;
+  return common::ErrnoError();
+}
+
+void Zygote::Stop() {
+  if (!IsRunning()) {
+    return;
+  }
+
+  // zygote quits on closed socket
+  ignore_result(common::file_system::close_descriptor(sock_));
+  sock_ = INVALID_DESCRIPTOR;
+  waitpid(pid_, nullptr, 0);
+  pid_ = -1;
+}
+
+bool Zygote::IsRunning() const {
+  return sock_ != INVALID_DESCRIPTOR;
+}
+
+common::ErrnoError Zygote::ForkStream(const StreamExecInfo& info,
+                                      descriptor_t read_command_fd,
+                                      descriptor_t write_responce_fd,
+                                      descriptor_t mem_fd,
+                                      pid_t* pid) {
+  if (!IsRunning() || read_command_fd == INVALID_DESCRIPTOR || write_responce_fd == INVALID_DESCRIPTOR ||
+      mem_fd == INVALID_DESCRIPTOR || !pid) {
+    return common::make_errno_error_inval();
+  }
+
+  const std::string request = SerializeExecInfo(info);
+  if (request.size() > zygote_max_request_size) {
+    return common::make_errno_error("Stream config too big for zygote.", EMSGSIZE);
+  }
+
+  const descriptor_t fds[zygote_fds_count] = {read_command_fd, write_responce_fd, mem_fd};
+  common::ErrnoError err = SendWithFds(sock_, request, fds, zygote_fds_count);
+  if (err) {
+    return err;
+  }
+
+  ZygoteReply reply;
+  ssize_t res = 0;
+  do {
+    res = recv(sock_, &reply, sizeof(reply), 0);
+  } while (res == ERROR_RESULT_VALUE && errno == EINTR);
+  if (res == ERROR_RESULT_VALUE) {
+    return common::make_errno_error(errno);
+  }
+  if (res != sizeof(reply)) {
+    return common::make_errno_error("Zygote connection closed.", ECONNRESET);
+  }
+
+  if (reply.pid < 0) {
+    return common::make_errno_error(reply.error);
+  }
+
+  *pid = reply.pid;
+  return common::ErrnoError();
+}
+
+int Zygote::Exec(descriptor_t sock) {
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+  signal(SIGCHLD, SIG_DFL);
+  SetProcessName(process_argc_, process_argv_, STREAMER_NAME "_zygote");
+  if (prepare_func_) {
+    int res = prepare_func_();
+    if (res != EXIT_SUCCESS) {
+      ERROR_LOG() << "Zygote failed to prepare stream backend.";
+      return res;
+    }
+  }
+
+  std::vector<char> request(zygote_max_request_size);
+  while (true) {
+    size_t size = 0;
+    descriptor_t fds[zygote_fds_count];
+    size_t fds_count = 0;
+    common::ErrnoError err = RecvWithFds(sock, request.data(), request.size(), &size, fds, &fds_count);
+    if (err) {
+      break;
+    }
+
+    StreamExecInfo info;
+    if (fds_count != zygote_fds_count || !DeSerializeExecInfo(request.data(), size, &info)) {
+      CloseDescriptors(fds, fds_count);
+      SendReply(sock, -1, EINVAL);
+      continue;
+    }
+
+    int reply_pipe[2] = {INVALID_DESCRIPTOR, INVALID_DESCRIPTOR};
+    if (::pipe(reply_pipe) == ERROR_RESULT_VALUE) {
+      SendReply(sock, -1, errno);
+      CloseDescriptors(fds, fds_count);
+      continue;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      // double fork, stream will be reparented to daemon when intermediate process exits
+      pid_t stream_pid = fork();
+      if (stream_pid == 0) {
+        ignore_result(common::file_system::close_descriptor(sock));
+        CloseDescriptors(reply_pipe, SIZEOFMASS(reply_pipe));
+        SharedStreamStruct* mem = nullptr;
+        err = MapSharedStreamStruct(fds[2], &mem);
+        ignore_result(common::file_system::close_descriptor(fds[2]));
+        if (err) {
+          DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+          _exit(EXIT_FAILURE);
+        }
+        _exit(ExecStream(exec_func_, process_argc_, process_argv_, info, fds[0], fds[1], mem));
+      }
+
+      const ZygoteReply reply = {stream_pid, stream_pid < 0 ? errno : 0};
+      ssize_t res = write(reply_pipe[1], &reply, sizeof(reply));
+      _exit(res == sizeof(reply) ? EXIT_SUCCESS : EXIT_FAILURE);
+    } else if (pid < 0) {
+      SendReply(sock, -1, errno);
+    } else {
+      // reply only after intermediate process exited, so daemon already owns the stream
+      waitpid(pid, nullptr, 0);
+      ZygoteReply reply = {-1, ECHILD};
+      ssize_t res = read(reply_pipe[0], &reply, sizeof(reply));
+      if (res != sizeof(reply)) {
+        reply.pid = -1;
+        reply.error = ECHILD;
+      }
+      SendReply(sock, reply.pid, reply.error);
+    }
+    CloseDescriptors(reply_pipe, SIZEOFMASS(reply_pipe));
+    CloseDescriptors(fds, fds_count);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,89 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <string>
+
+#include <common/error.h>
+#include <common/types.h>
+
+#include "protocol/pipe_protocol.h"
+#include "utils/arg_reader.h"
+
+namespace iptv_cloud {
+struct SharedStreamStruct;
+namespace server {
+
+typedef int (*stream_prepare_t)();
+typedef int (*stream_exec_t)(const char* process_name,
+                             const void* cmd_args,
+                             const void* config_args,
+                             void* command_client,
+                             void* mem);
+
+struct StreamExecInfo {
+  std::string id;
+  std::string feedback_dir;
+  common::logging::LOG_LEVEL logs_level;
+  protocol::PipeProtocol pipe_protocol;
+  utils::ArgsMap config_args;
+};
+
+// child side of stream start: rename process, wrap pipes and run core, returns process exit code
+int ExecStream(stream_exec_t exec_func,
+               int process_argc,
+               char** process_argv,
+               const StreamExecInfo& info,
+               descriptor_t read_command_fd,
+               descriptor_t write_responce_fd,
+               SharedStreamStruct* mem);
+
+// Small helper process forked from daemon before any thread started, with core library and gstreamer loaded.
+// Forks stream processes on daemon requests over unix socket, streams are reparented to daemon (child subreaper),
+// so daemon keeps pid tracking and pipes as for own children.
+class Zygote {
+ public:
+  Zygote(stream_prepare_t prepare_func, stream_exec_t exec_func, int process_argc, char** process_argv);
+  ~Zygote();
+
+  common::ErrnoError Start() WARN_UNUSED_RESULT;  // should be called before any thread created
+  void Stop();
+  bool IsRunning() const;
+
+  // fds are only passed, caller still should close own copies
+  common::ErrnoError ForkStream(const StreamExecInfo& info,
+                                descriptor_t read_command_fd,
+                                descriptor_t write_responce_fd,
+                                descriptor_t mem_fd,
+                                pid_t* pid) WARN_UNUSED_RESULT;
+
+ private:
+  int Exec(descriptor_t sock);
+
+  const stream_prepare_t prepare_func_;
+  const stream_exec_t exec_func_;
+  const int process_argc_;
+  char** const process_argv_;
+
+  pid_t pid_;
+  descriptor_t sock_;
+
+  DISALLOW_COPY_AND_ASSIGN(Zygote);
+};
+
+}  // namespace server
+}  // namespace iptv_cloud
@@ -0,0 +1,293 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/catchup_cut.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <common/file_system/file_system.h>
+#include <common/file_system/path.h>
+#include <common/sprintf.h>
+
+#include "base/types.h"
+
+#include "stream/timeshift_ring.h"
+
+#include "utils/m3u8_writer.h"
+
+#define CATCHUP_COPY_BLOCK_SIZE (1024 * 1024)
+#define CATCHUP_FILE_MODE (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)
+#define CATCHUP_TEMP_SUFFIX ".tmp"
+
+namespace iptv_cloud {
+namespace stream {
+
+namespace {
+common::ErrnoError WriteAll(descriptor_t fd, const char* data, size_t size) {
+  while (size) {
+    ssize_t res = write(fd, data, size);
+    if (res == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return common::make_errno_error(errno);
+    }
+    data += res;
+    size -= res;
+  }
+  return common::ErrnoError();
+}
+
+// archive on other file system, hard link is not possible
+common::ErrnoError CopyFile(const std::string& from, descriptor_t to) {
+  descriptor_t fd = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  std::vector<char> buffer(CATCHUP_COPY_BLOCK_SIZE);
+  common::ErrnoError err;
+  while (true) {
+    ssize_t readed = read(fd, buffer.data(), buffer.size());
+    if (readed == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      err = common::make_errno_error(errno);
+      break;
+    }
+
+    if (readed == 0) {
+      break;
+    }
+
+    err = WriteAll(to, buffer.data(), readed);
+    if (err) {
+      break;
+    }
+  }
+  close(fd);
+  return err;
+}
+
+common::ErrnoError CopyRingChunk(const TimeShiftRingReader* ring, const TimeShiftRingChunk& chunk, descriptor_t to) {
+  std::vector<char> buffer(CATCHUP_COPY_BLOCK_SIZE);
+  uint64_t pos = 0;
+  while (true) {
+    size_t readed = 0;
+    common::ErrnoError err = ring->Read(chunk, pos, buffer.data(), buffer.size(), &readed);
+    if (err) {
+      return err;
+    }
+
+    if (readed == 0) {
+      return common::ErrnoError();
+    }
+
+    err = WriteAll(to, buffer.data(), readed);
+    if (err) {
+      return err;
+    }
+    pos += readed;
+  }
+}
+}  // namespace
+
+std::vector<TimeShiftIndexEntry> SelectCatchupChunks(const TimeShiftIndexEntry* entries,
+                                                     size_t count,
+                                                     int64_t start_msec,
+                                                     int64_t stop_msec,
+                                                     int64_t after_msec) {
+  std::vector<TimeShiftIndexEntry> result;
+  if (!entries) {
+    return result;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const TimeShiftIndexEntry& entry = entries[i];
+    if (stop_msec && entry.start_time >= stop_msec) {
+      break;
+    }
+
+    if (entry.GetEndTime() > start_msec && entry.start_time > after_msec) {
+      result.push_back(entry);
+    }
+  }
+  return result;
+}
+
+CatchupCut::CatchupCut(const std::string& archive_dir,
+                       const std::string& catchup_dir,
+                       int64_t start_msec,
+                       int64_t stop_msec)
+    : archive_dir_(archive_dir),
+      catchup_dir_(catchup_dir),
+      start_msec_(start_msec),
+      stop_msec_(stop_msec),
+      last_start_time_(INT64_MIN),
+      chunks_() {}
+
+common::ErrnoError CatchupCut::Update(bool* finished) {
+  if (!finished) {
+    return common::make_errno_error_inval();
+  }
+
+  const size_t chunks_count = chunks_.size();
+  common::ErrnoError err = UpdateChunks(finished);
+  if (err) {
+    return err;
+  }
+
+  if (chunks_.size() == chunks_count && !*finished) {
+    return common::ErrnoError();
+  }
+
+  return WritePlaylist(*finished);
+}
+
+common::ErrnoError CatchupCut::Finish() {
+  bool finished = false;
+  common::ErrnoError err = UpdateChunks(&finished);
+  if (err) {
+    return err;
+  }
+
+  return WritePlaylist(true);
+}
+
+size_t CatchupCut::GetChunksCount() const {
+  return chunks_.size();
+}
+
+common::ErrnoError CatchupCut::UpdateChunks(bool* finished) {
+  TimeShiftIndexReader index;
+  common::ErrnoError err = index.Open(archive_dir_ + TIMESHIFT_INDEX_NAME);
+  if (err) {
+    return err;
+  }
+
+  TimeShiftIndexEntry last;
+  const bool have_last = index.GetLast(&last);
+  TimeShiftRingReader ring;
+  const bool in_ring = have_last && OpenTimeShiftRingWithChunk(archive_dir_ + TIMESHIFT_RING_NAME, last.index, &ring);
+
+  const std::vector<TimeShiftIndexEntry> entries =
+      SelectCatchupChunks(index.GetEntries(), index.GetCount(), start_msec_, stop_msec_, last_start_time_);
+  for (const TimeShiftIndexEntry& entry : entries) {
+    err = AddChunk(entry, in_ring ? &ring : nullptr);
+    if (err) {
+      return err;
+    }
+    last_start_time_ = entry.start_time;
+  }
+
+  *finished = stop_msec_ && have_last && last.GetEndTime() >= stop_msec_;
+  return common::ErrnoError();
+}
+
+common::ErrnoError CatchupCut::AddChunk(const TimeShiftIndexEntry& entry, const TimeShiftRingReader* ring) {
+  const std::string name = common::MemSPrintf("%llu" CHUNK_EXT, entry.index);
+  const std::string path = catchup_dir_ + name;
+  if (common::file_system::is_file_exist(path)) {
+    // materialized before restart, source may be already evicted from archive
+    chunks_.push_back(utils::ChunkInfo(name, entry.duration, entry.index));
+    return common::ErrnoError();
+  }
+
+  // chunk appears under its name only complete, by rename of temp file
+  const std::string temp_path = path + CATCHUP_TEMP_SUFFIX;
+  const std::string archive_path = archive_dir_ + name;
+  unlink(temp_path.c_str());  // leftover of interrupted cut
+
+  TimeShiftRingChunk ring_chunk;
+  const bool in_ring = ring && ring->FindChunk(entry.index, &ring_chunk);
+  bool linked = false;
+  if (!in_ring) {
+    if (link(archive_path.c_str(), temp_path.c_str()) == 0) {
+      linked = true;
+    } else if (errno == ENOENT) {  // already removed from archive, skipped
+      return common::ErrnoError();
+    } else if (errno != EXDEV && errno != EPERM) {
+      return common::make_errno_error(common::MemSPrintf("Failed to link %s: %s", archive_path, strerror(errno)),
+                                      errno);
+    }
+  }
+
+  if (!linked) {
+    descriptor_t fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, CATCHUP_FILE_MODE);
+    if (fd == INVALID_DESCRIPTOR) {
+      return common::make_errno_error(errno);
+    }
+
+    common::ErrnoError err = in_ring ? CopyRingChunk(ring, ring_chunk, fd) : CopyFile(archive_path, fd);
+    close(fd);
+    if (err) {
+      unlink(temp_path.c_str());
+      return err;
+    }
+  }
+
+  if (rename(temp_path.c_str(), path.c_str()) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    unlink(temp_path.c_str());
+    return err;
+  }
+
+  chunks_.push_back(utils::ChunkInfo(name, entry.duration, entry.index));
+  return common::ErrnoError();
+}
+
+common::ErrnoError CatchupCut::WritePlaylist(bool end_list) {
+  uint64_t max_duration = 0;
+  for (const utils::ChunkInfo& chunk : chunks_) {
+    max_duration = std::max(max_duration, chunk.duration);
+  }
+
+  const auto m3u8_path = common::file_system::ascii_file_string_path(catchup_dir_ + CATCHUP_PLAYLIST_NAME);
+  utils::M3u8Writer writer;
+  common::ErrnoError err = writer.OpenAtomic(m3u8_path);
+  if (err) {
+    return err;
+  }
+
+  const uint64_t first_index = chunks_.empty() ? 0 : chunks_[0].index;
+  const size_t target_duration = (max_duration + utils::ChunkInfo::SECOND - 1) / utils::ChunkInfo::SECOND;
+  err = writer.WriteHeader(first_index, std::max<size_t>(target_duration, 1));
+  if (!err) {
+    err = writer.WritePlaylistType("EVENT");
+  }
+
+  for (size_t i = 0; !err && i < chunks_.size(); ++i) {
+    err = writer.WriteLine(chunks_[i]);
+  }
+
+  if (!err && end_list) {
+    err = writer.WriteFooter();
+  }
+
+  if (err) {
+    return err;
+  }
+
+  return writer.Close();
+}
+
+}  // namespace stream
+}  // namespace iptv_cloud
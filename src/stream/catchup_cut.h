@@ -0,0 +1,72 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <common/error.h>
+
+#include "stream/timeshift_index.h"
+#include "utils/chunk_info.h"
+
+#define CATCHUP_PLAYLIST_NAME "master.m3u8"
+
+namespace iptv_cloud {
+namespace stream {
+
+class TimeShiftRingReader;
+
+// archive chunks which overlap [start_msec, stop_msec) window and started after after_msec, stop_msec 0 - no end
+std::vector<TimeShiftIndexEntry> SelectCatchupChunks(const TimeShiftIndexEntry* entries,
+                                                     size_t count,
+                                                     int64_t start_msec,
+                                                     int64_t stop_msec,
+                                                     int64_t after_msec);
+
+// Catchup program taken from archive of running timeshift recorder instead of own ingest and pipeline:
+// finished chunks of program window are hard linked into catchup directory and listed in playlist.
+// Ring storage reuses space while catchup should be kept, so such chunks are copied out.
+class CatchupCut {
+ public:
+  CatchupCut(const std::string& archive_dir, const std::string& catchup_dir, int64_t start_msec, int64_t stop_msec);
+
+  // adds chunks finished since last update and rewrites playlist, finished is true when window is complete
+  common::ErrnoError Update(bool* finished) WARN_UNUSED_RESULT;
+  // last update and ENDLIST, also if stopped before window end
+  common::ErrnoError Finish() WARN_UNUSED_RESULT;
+
+  size_t GetChunksCount() const;
+
+ private:
+  common::ErrnoError UpdateChunks(bool* finished) WARN_UNUSED_RESULT;
+  common::ErrnoError AddChunk(const TimeShiftIndexEntry& entry, const TimeShiftRingReader* ring) WARN_UNUSED_RESULT;
+  common::ErrnoError WritePlaylist(bool end_list) WARN_UNUSED_RESULT;
+
+  const std::string archive_dir_;
+  const std::string catchup_dir_;
+  const int64_t start_msec_;
+  const int64_t stop_msec_;
+
+  int64_t last_start_time_;  // start time of last added chunk
+  std::vector<utils::ChunkInfo> chunks_;
+
+  DISALLOW_COPY_AND_ASSIGN(CatchupCut);
+};
+
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -19,4 +19,5 @@
 struct cmd_args {
   const char* feedback_dir;
   int log_level;
+  int pipe_protocol;  // protocol::PipeProtocol, chosen by daemon
 };
@@ -208,6 +208,21 @@ common::Error make_config(const utils::ArgsMap& config_args, Config** config) {
     aconf.SetLoop(loop);
   }
 
+  int playlist_block_size;
+  if (utils::ArgsGetValue(config_args, PLAYLIST_BLOCK_SIZE_FIELD, &playlist_block_size) && playlist_block_size > 0) {
+    aconf.SetPlaylistBlockSize(static_cast<size_t>(playlist_block_size) * 1024);
+  }
+
+  bool playlist_zero_copy;
+  if (utils::ArgsGetValue(config_args, PLAYLIST_ZERO_COPY_FIELD, &playlist_zero_copy)) {
+    aconf.SetPlaylistZeroCopy(playlist_zero_copy);
+  }
+
+  bool hot_standby;
+  if (utils::ArgsGetValue(config_args, HOT_STANDBY_FIELD, &hot_standby)) {
+    aconf.SetHotStandby(hot_standby);
+  }
+
   if (stream_type == SCREEN) {
     *config = new streams::AudioVideoConfig(aconf);
     return common::Error();
@@ -223,6 +238,14 @@ common::Error make_config(const utils::ArgsMap& config_args, Config** config) {
     if (utils::ArgsGetValue(config_args, AUDIO_PARSER_FIELD, &audio_parser)) {
       rconfig->SetAudioParser(audio_parser);
     }
+    bool passthrough;
+    if (utils::ArgsGetValue(config_args, PASSTHROUGH_FIELD, &passthrough)) {
+      rconfig->SetPassthrough(passthrough);
+    }
+    utils::ts_pids_t pids;
+    if (utils::ArgsGetValue(config_args, PIDS_FIELD, &pids)) {
+      rconfig->SetPids(pids);
+    }
 
     if (stream_type == VOD_RELAY) {
       streams::VodRelayConfig* vconf = new streams::VodRelayConfig(*rconfig);
@@ -295,6 +318,11 @@ common::Error make_config(const utils::ArgsMap& config_args, Config** config) {
       econfig->SetLogo(logo);
     }
 
+    abr_ladder_t abr_ladder;
+    if (utils::ArgsGetValue(config_args, ABR_LADDER_FIELD, &abr_ladder)) {
+      econfig->SetAbrLadder(abr_ladder);
+    }
+
     common::media::Rational rat;
     if (utils::ArgsGetValue(config_args, ASPECT_RATIO_FIELD, &rat)) {
       econfig->SetAspectRatio(rat);
@@ -334,6 +362,10 @@ common::Error make_config(const utils::ArgsMap& config_args, Config** config) {
     if (utils::ArgsGetValue(config_args, AUDIO_PARSER_FIELD, &audio_parser)) {
       rel.SetAudioParser(audio_parser);
     }
+    bool passthrough;  // chunks are cut from input transport stream without remuxing
+    if (utils::ArgsGetValue(config_args, PASSTHROUGH_FIELD, &passthrough)) {
+      rel.SetPassthrough(passthrough);
+    }
 
     streams::TimeshiftConfig* tconf = new streams::TimeshiftConfig(rel);
     time_t timeshift_chunk_duration;
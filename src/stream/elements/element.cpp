@@ -237,6 +237,14 @@ void ElementQueue::SetMaxSizeBytes(guint64 val) {
   SetProperty("max-size-bytes", val);
 }
 
+void ElementInputSelector::SetActivePad(GstPad* pad) {
+  SetProperty("active-pad", static_cast<void*>(pad));
+}
+
+void ElementInputSelector::SetSyncStreams(bool sync) {
+  SetProperty("sync-streams", sync);
+}
+
 void ElementCapsFilter::SetCaps(GstCaps* caps) {
   SetProperty("caps", caps);
 }
@@ -364,6 +372,7 @@ DECLARE_ELEMENT_TRAITS_SPECIALIZATION(SPLIT_MUX_SINK)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(ALSA_SRC)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(MULTIFILE_SRC)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(APP_SRC)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(APP_SINK)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(FILE_SRC)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(IMAGE_FREEZE)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(CAPS_FILTER)
@@ -423,6 +432,7 @@ DECLARE_ELEMENT_TRAITS_SPECIALIZATION(VAAPI_DECODEBIN)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(VAAPI_POST_PROC)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(MFX_VPP)
 DECLARE_ELEMENT_TRAITS_SPECIALIZATION(MFX_H264_DEC)
+DECLARE_ELEMENT_TRAITS_SPECIALIZATION(INPUT_SELECTOR)
 
 }  // namespace elements
 }  // namespace stream
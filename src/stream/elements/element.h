@@ -62,6 +62,7 @@ enum SupportedElements {
   ELEMENT_ALSA_SRC,
   ELEMENT_MULTIFILE_SRC,
   ELEMENT_APP_SRC,
+  ELEMENT_APP_SINK,
   ELEMENT_FILE_SRC,
   ELEMENT_IMAGE_FREEZE,
   ELEMENT_CAPS_FILTER,
@@ -122,6 +123,7 @@ enum SupportedElements {
   ELEMENT_VAAPI_POST_PROC,
   ELEMENT_MFX_VPP,
   ELEMENT_MFX_H264_DEC,
+  ELEMENT_INPUT_SELECTOR,
   ELEMENTS_COUNT
 };
 
@@ -377,6 +379,15 @@ class ElementTee : public ElementEx<ELEMENT_TEE> {
   using base_class::base_class;
 };
 
+class ElementInputSelector : public ElementEx<ELEMENT_INPUT_SELECTOR> {
+ public:
+  typedef ElementEx<ELEMENT_INPUT_SELECTOR> base_class;
+  using base_class::base_class;
+
+  void SetActivePad(GstPad* pad);
+  void SetSyncStreams(bool sync = true);  // Default: true
+};
+
 class ElementCapsFilter : public ElementEx<ELEMENT_CAPS_FILTER> {
  public:
   typedef ElementEx<ELEMENT_CAPS_FILTER> base_class;
@@ -29,6 +29,21 @@ ElementMPEGTSMux* make_mpegtsmux(element_id_t muxer_id) {
   return make_muxer<ElementMPEGTSMux>(muxer_id);
 }
 
+ElementMPEGTSMux* make_udp_mpegtsmux(int mux_rate, element_id_t muxer_id) {
+  ElementMPEGTSMux* mpegtsmux = make_mpegtsmux(muxer_id);
+  mpegtsmux->SetAlignment(7);  // whole datagrams
+#if GST_CHECK_VERSION(1, 18, 0)
+  if (mux_rate > 0) {
+    mpegtsmux->SetBitrate(mux_rate);
+  }
+#else
+  if (mux_rate > 0) {
+    WARNING_LOG() << "Constant muxrate not supported by mpegtsmux, padding only on sink side.";
+  }
+#endif
+  return mpegtsmux;
+}
+
 ElementRTPMux* make_rtpmux(element_id_t muxer_id) {
   return make_muxer<ElementRTPMux>(muxer_id);
 }
@@ -48,6 +63,16 @@ Element* make_muxer(common::uri::Url::scheme scheme, element_id_t muxer_id) {
   return nullptr;
 }
 
+void ElementMPEGTSMux::SetAlignment(int alignment) {
+  SetProperty("alignment", alignment);
+}
+
+#if GST_CHECK_VERSION(1, 18, 0)
+void ElementMPEGTSMux::SetBitrate(guint64 bitrate) {
+  SetProperty("bitrate", bitrate);
+}
+#endif
+
 void ElementFLVMux::SetStreamable(bool streamable) {
   SetProperty("streamable", streamable);
 }
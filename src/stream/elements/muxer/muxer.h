@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <gst/gstversion.h>
+
 #include <common/sprintf.h>
 #include <common/uri/url.h>
 
@@ -29,6 +31,11 @@ class ElementMPEGTSMux : public ElementEx<ELEMENT_MPEGTS_MUX> {
  public:
   typedef ElementEx<ELEMENT_MPEGTS_MUX> base_class;
   using base_class::base_class;
+
+  void SetAlignment(int alignment = -1);  // -1 - 2147483647; Default: -1
+#if GST_CHECK_VERSION(1, 18, 0)
+  void SetBitrate(guint64 bitrate = 0);  // 0 - 18446744073709551615; Default: 0, null packets padding if set
+#endif
 };
 
 typedef ElementEx<ELEMENT_RTP_MUX> ElementRTPMux;
@@ -49,6 +56,7 @@ T* make_muxer(element_id_t muxer_id) {
 ElementFLVMux* make_flvmux(bool streamable, element_id_t muxer_id);
 ElementRTPMux* make_rtpmux(element_id_t muxer_id);
 ElementMPEGTSMux* make_mpegtsmux(element_id_t muxer_id);
+ElementMPEGTSMux* make_udp_mpegtsmux(int mux_rate, element_id_t muxer_id);
 
 Element* make_muxer(common::uri::Url::scheme scheme, element_id_t muxer_id);
 
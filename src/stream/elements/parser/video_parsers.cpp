@@ -33,6 +33,18 @@ void ElementH265Parse::SetConfigInterval(guint interval) {
   SetProperty("config-interval", interval);
 }
 
+void ElementTsParse::SetAlignment(gint alignment) {
+  SetProperty("alignment", alignment);
+}
+
+void ElementTsParse::SetSetTimestamps(gboolean set) {
+  SetProperty("set-timestamps", set);
+}
+
+void ElementTsParse::SetSplitOnRai(gboolean split) {
+  SetProperty("split-on-rai", split);
+}
+
 ElementMpegParse* make_mpeg2_parser(element_id_t parser_id) {
   return make_video_parser<ElementMpegParse>(parser_id);
 }
@@ -54,6 +54,10 @@ class ElementTsParse : public ElementEx<ELEMENT_TS_PARSE> {
  public:
   typedef ElementEx<ELEMENT_TS_PARSE> base_class;
   using base_class::base_class;
+
+  void SetAlignment(gint alignment = 0);        // Range: 0 - 2147483647 Default: 0, packets per buffer
+  void SetSetTimestamps(gboolean set = FALSE);  // Default: false, timestamps from pcr
+  void SetSplitOnRai(gboolean split = FALSE);   // Default: false, random access points start new buffers
 };
 
 template <typename T>
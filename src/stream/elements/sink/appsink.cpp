@@ -0,0 +1,47 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/elements/sink/appsink.h"
+
+#include <gst/app/gstappsink.h>  // for GST_APP_SINK
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+gboolean ElementAppSink::RegisterNewSampleCallback(new_sample_callback_t cb, gpointer user_data) {
+  return RegisterCallback("new-sample", G_CALLBACK(cb), user_data);
+}
+
+gboolean ElementAppSink::RegisterEosCallback(eos_callback_t cb, gpointer user_data) {
+  return RegisterCallback("eos", G_CALLBACK(cb), user_data);
+}
+
+void ElementAppSink::SetEmitSignals(bool emit_signals) {
+  SetProperty("emit-signals", emit_signals);
+}
+
+GstSample* ElementAppSink::PullSample() {
+  return gst_app_sink_pull_sample(GST_APP_SINK(GetGstElement()));
+}
+
+ElementAppSink* make_app_sink(element_id_t sink_id) {
+  return make_sink<ElementAppSink>(sink_id);
+}
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,45 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <gst/gstpad.h>
+
+#include "stream/elements/sink/sink.h"
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+class ElementAppSink : public ElementSync<ELEMENT_APP_SINK> {
+ public:
+  typedef ElementSync<ELEMENT_APP_SINK> base_class;
+  typedef GstFlowReturn (*new_sample_callback_t)(GstElement* appsink, gpointer user_data);
+  typedef void (*eos_callback_t)(GstElement* appsink, gpointer user_data);
+  using base_class::base_class;
+
+  gboolean RegisterNewSampleCallback(new_sample_callback_t cb, gpointer user_data) WARN_UNUSED_RESULT;
+  gboolean RegisterEosCallback(eos_callback_t cb, gpointer user_data) WARN_UNUSED_RESULT;
+
+  void SetEmitSignals(bool emit_signals = false);  // Default: false
+  GstSample* PullSample();                         // nullptr on eos or flushing
+};
+
+ElementAppSink* make_app_sink(element_id_t sink_id);
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
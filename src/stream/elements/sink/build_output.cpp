@@ -21,6 +21,7 @@
 #include "base/output_uri.h"  // for OutputUri, IsFakeUrl
 
 #include "stream/elements/sink/http.h"  // for build_http_sink, HlsOutput
+#include "stream/elements/sink/ingest.h"
 #include "stream/elements/sink/rtmp.h"  // for build_rtmp_sink
 #include "stream/elements/sink/tcp.h"
 #include "stream/elements/sink/udp.h"  // for build_udp_sink
@@ -30,8 +31,46 @@ namespace stream {
 namespace elements {
 namespace sink {
 
-Element* build_output(const OutputUri& output, element_id_t sink_id, bool is_vod) {
+namespace {
+Element* build_http_output(const OutputUri& output,
+                           const std::string& variant,
+                           element_id_t sink_id,
+                           bool is_vod,
+                           SharedHlsStore* hls_store) {
   common::uri::Url uri = output.GetOutput();
+  const common::file_system::ascii_directory_string_path http_root = output.GetHttpRoot();
+  const common::uri::Upath upath = uri.GetPath();
+  std::string filename = upath.GetFileName();
+  if (filename.empty()) {
+    NOTREACHED() << "Empty playlist name, please create urls like http://localhost/master.m3u8!";
+    return nullptr;
+  }
+
+  if (!variant.empty()) {
+    filename = make_variant_playlist_name(filename, variant);
+  }
+  elements::sink::HlsOutput hout =
+      is_vod ? MakeVodHlsOutput(uri, http_root, filename) : MakeHlsOutput(uri, http_root, filename);
+  if (!variant.empty()) {  // variants share http root, so chunk names should not clash
+    const std::string http_root_str = http_root.GetPath();
+    hout.location = http_root_str + variant + "_" + hout.location.substr(http_root_str.size());
+  }
+  if (!is_vod && hls_store) {
+    ElementHLSMemorySink* http_sink = elements::sink::make_http_memory_sink(sink_id, hout, hls_store);
+    return http_sink;
+  }
+  ElementHLSSink* http_sink = elements::sink::make_http_sink(sink_id, hout);
+  return http_sink;
+}
+}  // namespace
+
+Element* build_output(const OutputUri& output, element_id_t sink_id, bool is_vod, SharedHlsStore* hls_store) {
+  common::uri::Url uri = output.GetOutput();
+  std::string hub_name;
+  if (IsLocalUrl(uri, &hub_name)) {
+    return make_ingest_sink(sink_id, hub_name);
+  }
+
   common::uri::Url::scheme scheme = uri.GetScheme();
 
   if (scheme == common::uri::Url::udp) {
@@ -41,6 +80,10 @@ Element* build_output(const OutputUri& output, element_id_t sink_id, bool is_vod
       NOTREACHED() << "Unknownt output url: " << url;
       return nullptr;
     }
+    const OutputUri::UdpMode mode = output.GetUdpMode();
+    if (mode != OutputUri::RTP_ES) {
+      return elements::sink::make_udp_ts_sink(host, mode == OutputUri::RTP_TS, output.GetMuxRate(), sink_id);
+    }
     ElementUDPSink* udp_sink = elements::sink::make_udp_sink(host, sink_id);
     return udp_sink;
   } else if (scheme == common::uri::Url::tcp) {
@@ -56,23 +99,35 @@ Element* build_output(const OutputUri& output, element_id_t sink_id, bool is_vod
     ElementRtmpSink* rtmp_sink = elements::sink::make_rtmp_sink(sink_id, uri.GetUrl());
     return rtmp_sink;
   } else if (scheme == common::uri::Url::http) {
-    const common::file_system::ascii_directory_string_path http_root = output.GetHttpRoot();
-    const common::uri::Upath upath = uri.GetPath();
-    const std::string filename = upath.GetFileName();
-    if (filename.empty()) {
-      NOTREACHED() << "Empty playlist name, please create urls like http://localhost/master.m3u8!";
-      return nullptr;
-    }
-    elements::sink::HlsOutput hout =
-        is_vod ? MakeVodHlsOutput(uri, http_root, filename) : MakeHlsOutput(uri, http_root, filename);
-    ElementHLSSink* http_sink = elements::sink::make_http_sink(sink_id, hout);
-    return http_sink;
+    return build_http_output(output, std::string(), sink_id, is_vod, hls_store);
   }
 
   NOTREACHED() << "Unknownt output url: " << uri.GetUrl();
   return nullptr;
 }
 
+Element* build_variant_output(const OutputUri& output,
+                              const std::string& variant,
+                              element_id_t sink_id,
+                              bool is_vod,
+                              SharedHlsStore* hls_store) {
+  common::uri::Url uri = output.GetOutput();
+  if (uri.GetScheme() != common::uri::Url::http) {
+    NOTREACHED() << "Variants supported only for http outputs: " << uri.GetUrl();
+    return nullptr;
+  }
+
+  return build_http_output(output, variant, sink_id, is_vod, hls_store);
+}
+
+std::string make_variant_playlist_name(const std::string& filename, const std::string& variant) {
+  const size_t ext_pos = filename.find_last_of('.');
+  if (ext_pos == std::string::npos) {
+    return filename + "_" + variant;
+  }
+  return filename.substr(0, ext_pos) + "_" + variant + filename.substr(ext_pos);
+}
+
 }  // namespace sink
 }  // namespace elements
 }  // namespace stream
@@ -16,17 +16,28 @@
 
 // for element_id_t
 
+#include <string>
+
 #include "stream/stypes.h"
 
 namespace iptv_cloud {
 class OutputUri;
+class SharedHlsStore;
 namespace stream {
 namespace elements {
 class Element;
 
 namespace sink {
 
-Element* build_output(const OutputUri& output, element_id_t sink_id, bool is_vod);
+// live http outputs are kept in hls_store if it is not null
+Element* build_output(const OutputUri& output, element_id_t sink_id, bool is_vod, SharedHlsStore* hls_store);
+// abr variant of http output, playlist and chunks are prefixed by variant name in same http root
+Element* build_variant_output(const OutputUri& output,
+                              const std::string& variant,
+                              element_id_t sink_id,
+                              bool is_vod,
+                              SharedHlsStore* hls_store);
+std::string make_variant_playlist_name(const std::string& filename, const std::string& variant);
 
 }  // namespace sink
 }  // namespace elements
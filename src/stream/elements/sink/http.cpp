@@ -14,10 +14,20 @@
 
 #include "stream/elements/sink/http.h"
 
+#include <math.h>
+#include <time.h>
+
+#include <gst/gstbuffer.h>
+#include <gst/gstsample.h>
+
+#include <algorithm>
 #include <string>
 
+#include <common/sprintf.h>
 #include <common/time.h>
 
+#include "base/shared_hls_store.h"
+
 namespace iptv_cloud {
 namespace stream {
 namespace elements {
@@ -74,6 +84,133 @@ void ElementHLSSink::SetMaxFiles(guint max_files) {
   SetProperty("max-files", max_files);
 }
 
+ElementHLSMemorySink::ElementHLSMemorySink(const std::string& name, const HlsOutput& output, SharedHlsStore* store)
+    : base_class(name),
+      output_(output),
+      chunks_dir_(output.location.substr(0, output.location.find_last_of('/') + 1)),
+      store_(store),
+      chunk_(),
+      chunk_start_(GST_CLOCK_TIME_NONE),
+      last_ts_(GST_CLOCK_TIME_NONE),
+      chunk_index_(0),
+      chunks_() {
+  SetEmitSignals(true);
+  gboolean res = RegisterNewSampleCallback(new_sample_callback, this);
+  DCHECK(res);
+  res = RegisterEosCallback(eos_callback, this);
+  DCHECK(res);
+}
+
+GstFlowReturn ElementHLSMemorySink::new_sample_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementHLSMemorySink* sink = static_cast<ElementHLSMemorySink*>(user_data);
+  return sink->HandleNewSample();
+}
+
+void ElementHLSMemorySink::eos_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementHLSMemorySink* sink = static_cast<ElementHLSMemorySink*>(user_data);
+  sink->HandleEos();
+}
+
+GstFlowReturn ElementHLSMemorySink::HandleNewSample() {
+  GstSample* sample = PullSample();
+  if (!sample) {
+    return GST_FLOW_OK;
+  }
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!buffer) {
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+
+  const GstClockTime ts = GST_BUFFER_PTS_IS_VALID(buffer) ? GST_BUFFER_PTS(buffer) : GST_BUFFER_DTS(buffer);
+  if (GST_CLOCK_TIME_IS_VALID(ts)) {
+    if (!GST_CLOCK_TIME_IS_VALID(chunk_start_) || ts < chunk_start_) {
+      chunk_start_ = ts;
+    }
+
+    const GstClockTime duration = ts - chunk_start_;
+    const bool is_key_unit = !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    // without key frames for too long cut anyway, chunk should fit into store
+    if ((is_key_unit && duration >= TS_DURATION * GST_SECOND) || duration >= 3 * TS_DURATION * GST_SECOND) {
+      FinishChunk(duration);
+      chunk_start_ = ts;
+    }
+    last_ts_ = ts;
+  }
+
+  GstMapInfo map;
+  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    chunk_.append(reinterpret_cast<const char*>(map.data), map.size);
+    gst_buffer_unmap(buffer, &map);
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+void ElementHLSMemorySink::HandleEos() {
+  if (GST_CLOCK_TIME_IS_VALID(chunk_start_) && GST_CLOCK_TIME_IS_VALID(last_ts_) && last_ts_ > chunk_start_) {
+    FinishChunk(last_ts_ - chunk_start_);
+  }
+  PublishPlaylist(true);
+}
+
+void ElementHLSMemorySink::FinishChunk(GstClockTime duration) {
+  if (chunk_.empty()) {
+    return;
+  }
+
+  const std::string chunk_path = common::MemSPrintf(output_.location.c_str(), static_cast<int>(chunk_index_));
+  common::ErrnoError err = store_->Publish(chunk_path, chunk_.data(), chunk_.size(), time(nullptr));
+  chunk_.clear();
+  if (err) {
+    WARNING_LOG() << "Failed to publish hls chunk: " << chunk_path << ", error: " << err->GetDescription();
+    return;
+  }
+
+  chunks_.push_back(utils::ChunkInfo(chunk_path.substr(chunks_dir_.size()), duration, chunk_index_));
+  chunk_index_++;
+  while (output_.max_files && chunks_.size() > output_.max_files) {
+    store_->Remove(chunks_dir_ + chunks_.front().path);
+    chunks_.pop_front();
+  }
+  PublishPlaylist(false);
+}
+
+void ElementHLSMemorySink::PublishPlaylist(bool end_list) {
+  if (chunks_.empty()) {
+    return;
+  }
+
+  size_t first = 0;
+  if (output_.paylist_length && chunks_.size() > output_.paylist_length) {
+    first = chunks_.size() - output_.paylist_length;
+  }
+
+  double target_duration = TS_DURATION;
+  for (size_t i = first; i < chunks_.size(); ++i) {
+    target_duration = std::max(target_duration, ceil(chunks_[i].GetDurationInSecconds()));
+  }
+
+  std::string playlist = common::MemSPrintf(
+      "#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:NO\n#EXT-X-MEDIA-SEQUENCE:%llu\n#EXT-X-TARGETDURATION:%u\n\n",
+      chunks_[first].index, static_cast<uint32_t>(target_duration));
+  for (size_t i = first; i < chunks_.size(); ++i) {
+    playlist += common::MemSPrintf("#EXTINF:%.3f,\n%s\n", chunks_[i].GetDurationInSecconds(), chunks_[i].path);
+  }
+  if (end_list) {
+    playlist += "#EXT-X-ENDLIST\n";
+  }
+
+  common::ErrnoError err = store_->Publish(output_.play_locataion, playlist.data(), playlist.size(), time(nullptr));
+  if (err) {
+    WARNING_LOG() << "Failed to publish hls playlist: " << output_.play_locataion
+                  << ", error: " << err->GetDescription();
+  }
+}
+
 void ElementSoupHttpSink::SetLocation(const std::string& location) {
   SetProperty("location", location);
 }
@@ -94,6 +231,10 @@ ElementHLSSink* make_http_sink(element_id_t sink_id, const HlsOutput& output) {
   return hls_out;
 }
 
+ElementHLSMemorySink* make_http_memory_sink(element_id_t sink_id, const HlsOutput& output, SharedHlsStore* store) {
+  return new ElementHLSMemorySink(common::MemSPrintf(SINK_NAME_1U, sink_id), output, store);
+}
+
 }  // namespace sink
 }  // namespace elements
 }  // namespace stream
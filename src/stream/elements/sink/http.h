@@ -14,17 +14,21 @@
 
 #pragma once
 
+#include <deque>
 #include <string>
 
 #include <common/file_system/file_system.h>
 #include <common/uri/url.h>
 
 #include "stream/elements/element.h"  // for ElementEx, SupportedElements::ELEMENT_...
+#include "stream/elements/sink/appsink.h"
 #include "stream/elements/sink/sink.h"
 
+#include "utils/chunk_info.h"
 #include "utils/utils.h"
 
 namespace iptv_cloud {
+class SharedHlsStore;
 namespace stream {
 namespace elements {
 namespace sink {
@@ -65,8 +69,38 @@ class ElementSoupHttpSink : public ElementEx<ELEMENT_SOUP_HTTP_CLIENT_SINK> {
   void SetLocation(const std::string& location);  // String; Default: null
 };
 
+// Same chunks and playlist as hlssink, but published into stream hls store (shared with daemon http server)
+// instead of files, chunks are cut on key frames after TS_DURATION.
+class ElementHLSMemorySink : public ElementAppSink {
+ public:
+  typedef ElementAppSink base_class;
+
+  ElementHLSMemorySink(const std::string& name, const HlsOutput& output, SharedHlsStore* store);
+
+ private:
+  static GstFlowReturn new_sample_callback(GstElement* appsink, gpointer user_data);
+  static void eos_callback(GstElement* appsink, gpointer user_data);
+
+  GstFlowReturn HandleNewSample();
+  void HandleEos();
+
+  void FinishChunk(GstClockTime duration);
+  void PublishPlaylist(bool end_list);
+
+  const HlsOutput output_;
+  const std::string chunks_dir_;
+  SharedHlsStore* const store_;
+
+  std::string chunk_;  // data of current chunk, capacity reused between chunks
+  GstClockTime chunk_start_;
+  GstClockTime last_ts_;
+  uint64_t chunk_index_;
+  std::deque<utils::ChunkInfo> chunks_;  // published chunks, path is file name
+};
+
 ElementSoupHttpSink* make_http_soup_sink(element_id_t sink_id, const std::string& location);
 ElementHLSSink* make_http_sink(element_id_t sink_id, const HlsOutput& output);
+ElementHLSMemorySink* make_http_memory_sink(element_id_t sink_id, const HlsOutput& output, SharedHlsStore* store);
 
 }  // namespace sink
 }  // namespace elements
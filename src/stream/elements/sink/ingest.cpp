@@ -0,0 +1,87 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/elements/sink/ingest.h"
+
+#include <gst/gstbuffer.h>
+#include <gst/gstsample.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+
+#include "base/shared_ingest_ring.h"
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+ElementIngestSink::ElementIngestSink(const std::string& name, const std::string& hub_name)
+    : base_class(name), ring_(nullptr) {
+  const std::string path = MakeIngestRingPath(hub_name);
+  common::ErrnoError err = CreateSharedIngestRing(path, INGEST_RING_DATA_SIZE, &ring_);
+  if (err) {
+    WARNING_LOG() << "Failed to create ingest ring: " << path << ", error: " << err->GetDescription();
+  }
+
+  SetSync(false);  // subscribers are synced by own pipelines
+  SetEmitSignals(true);
+  gboolean res = RegisterNewSampleCallback(new_sample_callback, this);
+  DCHECK(res);
+}
+
+ElementIngestSink::~ElementIngestSink() {
+  FreeSharedIngestRing(ring_);
+  ring_ = nullptr;
+}
+
+GstFlowReturn ElementIngestSink::new_sample_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementIngestSink* sink = static_cast<ElementIngestSink*>(user_data);
+  return sink->HandleNewSample();
+}
+
+GstFlowReturn ElementIngestSink::HandleNewSample() {
+  GstSample* sample = PullSample();
+  if (!sample) {
+    return GST_FLOW_OK;
+  }
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!buffer || !ring_) {
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+
+  GstMapInfo map;
+  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    common::ErrnoError err = ring_->Write(map.data, map.size);
+    if (err) {
+      WARNING_LOG() << "Failed to write into ingest ring: " << err->GetDescription();
+    }
+    gst_buffer_unmap(buffer, &map);
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+ElementIngestSink* make_ingest_sink(element_id_t sink_id, const std::string& hub_name) {
+  return new ElementIngestSink(common::MemSPrintf(SINK_NAME_1U, sink_id), hub_name);
+}
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,49 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "stream/elements/sink/appsink.h"
+
+namespace iptv_cloud {
+class SharedIngestRing;
+namespace stream {
+namespace elements {
+namespace sink {
+
+// Ingest hub output (local://<hub_name>), muxed stream is appended into node local ring,
+// streams with same local input read it from there instead of pulling upstream source again.
+class ElementIngestSink : public ElementAppSink {
+ public:
+  typedef ElementAppSink base_class;
+
+  ElementIngestSink(const std::string& name, const std::string& hub_name);
+  ~ElementIngestSink() override;
+
+ private:
+  static GstFlowReturn new_sample_callback(GstElement* appsink, gpointer user_data);
+
+  GstFlowReturn HandleNewSample();
+
+  SharedIngestRing* ring_;
+};
+
+ElementIngestSink* make_ingest_sink(element_id_t sink_id, const std::string& hub_name);
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
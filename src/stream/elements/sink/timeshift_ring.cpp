@@ -0,0 +1,93 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/elements/sink/timeshift_ring.h"
+
+#include <gst/gstbuffer.h>
+#include <gst/gstsample.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+ElementTimeShiftRingSink::ElementTimeShiftRingSink(const std::string& name)
+    : base_class(name), ring_mutex_(), ring_(), write_failed_(false) {
+  SetSync(false);
+  SetEmitSignals(true);
+  gboolean res = RegisterNewSampleCallback(new_sample_callback, this);
+  DCHECK(res);
+}
+
+common::ErrnoError ElementTimeShiftRingSink::Open(const std::string& path, uint64_t data_size) {
+  std::unique_lock<std::mutex> lock(ring_mutex_);
+  return ring_.Open(path, data_size);
+}
+
+common::ErrnoError ElementTimeShiftRingSink::BeginChunk(uint64_t index) {
+  std::unique_lock<std::mutex> lock(ring_mutex_);
+  write_failed_ = false;
+  return ring_.BeginChunk(index);
+}
+
+common::ErrnoError ElementTimeShiftRingSink::FinishChunk(TimeShiftRingChunk* chunk) {
+  std::unique_lock<std::mutex> lock(ring_mutex_);
+  return ring_.FinishChunk(chunk);
+}
+
+GstFlowReturn ElementTimeShiftRingSink::new_sample_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementTimeShiftRingSink* sink = static_cast<ElementTimeShiftRingSink*>(user_data);
+  return sink->HandleNewSample();
+}
+
+GstFlowReturn ElementTimeShiftRingSink::HandleNewSample() {
+  GstSample* sample = PullSample();
+  if (!sample) {
+    return GST_FLOW_OK;
+  }
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!buffer) {
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+
+  GstMapInfo map;
+  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    std::unique_lock<std::mutex> lock(ring_mutex_);
+    common::ErrnoError err = ring_.Write(map.data, map.size);
+    if (err && !write_failed_) {
+      WARNING_LOG() << "Failed to write into timeshift ring: " << err->GetDescription();
+      write_failed_ = true;
+    }
+    lock.unlock();
+    gst_buffer_unmap(buffer, &map);
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+ElementTimeShiftRingSink* make_timeshift_ring_sink(element_id_t sink_id) {
+  return new ElementTimeShiftRingSink(common::MemSPrintf(SINK_NAME_1U, sink_id));
+}
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,57 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include <common/error.h>
+
+#include "stream/elements/sink/appsink.h"
+#include "stream/timeshift_ring.h"
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+// Sink of timeshift recorder splitmuxsink in ring storage mode, muxed chunks are appended into ring file,
+// chunk boundaries are set by recorder when splitmuxsink requests next fragment location.
+class ElementTimeShiftRingSink : public ElementAppSink {
+ public:
+  typedef ElementAppSink base_class;
+
+  explicit ElementTimeShiftRingSink(const std::string& name);
+
+  common::ErrnoError Open(const std::string& path, uint64_t data_size) WARN_UNUSED_RESULT;
+  common::ErrnoError BeginChunk(uint64_t index) WARN_UNUSED_RESULT;
+  common::ErrnoError FinishChunk(TimeShiftRingChunk* chunk) WARN_UNUSED_RESULT;
+
+ private:
+  static GstFlowReturn new_sample_callback(GstElement* appsink, gpointer user_data);
+
+  GstFlowReturn HandleNewSample();
+
+  std::mutex ring_mutex_;  // fragments are switched and data is pushed from different splitmuxsink threads
+  TimeShiftRingWriter ring_;
+  bool write_failed_;  // reported once per chunk
+};
+
+ElementTimeShiftRingSink* make_timeshift_ring_sink(element_id_t sink_id);
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
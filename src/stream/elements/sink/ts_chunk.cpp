@@ -0,0 +1,239 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/elements/sink/ts_chunk.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gst/gstbuffer.h>
+#include <gst/gstsample.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+
+#include "base/types.h"
+
+#include "utils/ts_packet_filter.h"
+
+#define TS_CHUNK_FILE_MODE 0644
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+namespace {
+common::ErrnoError write_all(descriptor_t fd, const void* data, size_t size) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size) {
+    ssize_t res = write(fd, ptr, size);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return common::make_errno_error(errno);
+    }
+    ptr += res;
+    size -= res;
+  }
+  return common::ErrnoError();
+}
+}  // namespace
+
+ElementTsChunkSink::ElementTsChunkSink(const std::string& name,
+                                       const std::string& chunks_dir,
+                                       uint64_t chunk_duration_msec)
+    : base_class(name),
+      chunks_dir_(chunks_dir),
+      chunker_(chunk_duration_msec),
+      chunk_started_cb_(nullptr),
+      chunk_started_user_data_(nullptr),
+      chunk_mutex_(),
+      ring_(),
+      fd_(INVALID_DESCRIPTOR),
+      in_chunk_(false),
+      chunk_size_(0),
+      last_chunk_size_(0),
+      write_failed_(false),
+      rai_missing_reported_(false) {
+  SetSync(false);
+  SetEmitSignals(true);
+  gboolean res = RegisterNewSampleCallback(new_sample_callback, this);
+  DCHECK(res);
+}
+
+ElementTsChunkSink::~ElementTsChunkSink() {
+  Close();
+}
+
+common::ErrnoError ElementTsChunkSink::OpenRing(const std::string& path, uint64_t data_size) {
+  std::unique_lock<std::mutex> lock(chunk_mutex_);
+  return ring_.Open(path, data_size);
+}
+
+void ElementTsChunkSink::RegisterChunkStartedCallback(chunk_started_callback_t cb, gpointer user_data) {
+  std::unique_lock<std::mutex> lock(chunk_mutex_);
+  chunk_started_cb_ = cb;
+  chunk_started_user_data_ = user_data;
+}
+
+uint64_t ElementTsChunkSink::GetLastChunkSize() const {
+  return last_chunk_size_.load();
+}
+
+void ElementTsChunkSink::Close() {
+  std::unique_lock<std::mutex> lock(chunk_mutex_);
+  FinishChunk();
+}
+
+GstFlowReturn ElementTsChunkSink::new_sample_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementTsChunkSink* sink = static_cast<ElementTsChunkSink*>(user_data);
+  return sink->HandleNewSample();
+}
+
+GstFlowReturn ElementTsChunkSink::HandleNewSample() {
+  GstSample* sample = PullSample();
+  if (!sample) {
+    return GST_FLOW_OK;
+  }
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!buffer) {
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+
+  GstMapInfo map;
+  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    std::unique_lock<std::mutex> lock(chunk_mutex_);
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT)) {  // current chunk lasts till new program start
+      chunker_.Reset();
+    }
+    HandleData(map.data, map.size, GST_BUFFER_DTS_OR_PTS(buffer));
+    lock.unlock();
+    gst_buffer_unmap(buffer, &map);
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+void ElementTsChunkSink::HandleData(const uint8_t* data, size_t size, GstClockTime pts) {
+  size_t writed = 0;
+  size_t pos = 0;
+  while (pos < size) {
+    const size_t start = pos + chunker_.FindChunkStart(data + pos, size - pos);
+    if (start >= size) {
+      break;
+    }
+
+    WriteChunk(data + writed, start - writed);
+    BeginChunk(pts);
+    writed = start;
+    pos = start + TS_PACKET_SIZE;
+  }
+  WriteChunk(data + writed, size - writed);
+}
+
+void ElementTsChunkSink::BeginChunk(GstClockTime pts) {
+  if (!rai_missing_reported_ && chunker_.IsRandomAccessMissing()) {
+    WARNING_LOG() << "Source of " << GetName() << " has no random access indicators, chunks are split on "
+                  << "video frames after twice chunk duration and may start without key frame";
+    rai_missing_reported_ = true;
+  }
+
+  FinishChunk();
+  if (!chunk_started_cb_) {
+    return;
+  }
+
+  const uint64_t index = chunk_started_cb_(pts, chunk_started_user_data_);
+  if (ring_.IsOpen()) {
+    common::ErrnoError err = ring_.BeginChunk(index);
+    if (err) {
+      WARNING_LOG() << "Failed to begin chunk " << index << " in timeshift ring: " << err->GetDescription();
+      return;
+    }
+  } else {
+    const std::string path = common::MemSPrintf("%s%llu" CHUNK_EXT, chunks_dir_, index);
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, TS_CHUNK_FILE_MODE);
+    if (fd_ == INVALID_DESCRIPTOR) {
+      WARNING_LOG() << "Failed to create chunk " << path << ": " << common::make_errno_error(errno)->GetDescription();
+      return;
+    }
+  }
+
+  in_chunk_ = true;
+  chunk_size_ = 0;
+  write_failed_ = false;
+  const std::string psi = chunker_.GetPsiPackets();
+  WriteChunk(psi.data(), psi.size());
+}
+
+void ElementTsChunkSink::FinishChunk() {
+  if (!in_chunk_) {
+    return;
+  }
+
+  in_chunk_ = false;
+  uint64_t size = write_failed_ ? 0 : chunk_size_;
+  if (ring_.IsOpen()) {
+    TimeShiftRingChunk chunk;
+    common::ErrnoError err = ring_.FinishChunk(&chunk);
+    if (err) {
+      WARNING_LOG() << "Failed to finish chunk in timeshift ring: " << err->GetDescription();
+      size = 0;
+    }
+  } else if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+    fd_ = INVALID_DESCRIPTOR;
+  }
+  last_chunk_size_.store(size);
+}
+
+void ElementTsChunkSink::WriteChunk(const void* data, size_t size) {
+  if (!in_chunk_ || !size) {
+    return;
+  }
+
+  common::ErrnoError err;
+  if (ring_.IsOpen()) {
+    err = ring_.Write(data, size);
+  } else {
+    err = write_all(fd_, data, size);
+  }
+
+  if (err) {
+    if (!write_failed_) {
+      WARNING_LOG() << "Failed to write timeshift chunk: " << err->GetDescription();
+      write_failed_ = true;
+    }
+    return;
+  }
+  chunk_size_ += size;
+}
+
+ElementTsChunkSink* make_ts_chunk_sink(element_id_t sink_id,
+                                       const std::string& chunks_dir,
+                                       uint64_t chunk_duration_msec) {
+  return new ElementTsChunkSink(common::MemSPrintf(SINK_NAME_1U, sink_id), chunks_dir, chunk_duration_msec);
+}
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,82 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <common/error.h>
+#include <common/types.h>
+
+#include "stream/elements/sink/appsink.h"
+#include "stream/timeshift_ring.h"
+
+#include "utils/ts_chunker.h"
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sink {
+
+// Sink of passthrough timeshift recorder, transport stream is cut into chunks without demuxing,
+// chunks are written as N.ts files or appended into ring file, index of every chunk is given by recorder.
+class ElementTsChunkSink : public ElementAppSink {
+ public:
+  typedef ElementAppSink base_class;
+  // previous chunk is already finished, returns index of new one
+  typedef uint64_t (*chunk_started_callback_t)(GstClockTime pts, gpointer user_data);
+
+  ElementTsChunkSink(const std::string& name, const std::string& chunks_dir, uint64_t chunk_duration_msec);
+  ~ElementTsChunkSink() override;
+
+  common::ErrnoError OpenRing(const std::string& path, uint64_t data_size) WARN_UNUSED_RESULT;
+  void RegisterChunkStartedCallback(chunk_started_callback_t cb, gpointer user_data);
+
+  uint64_t GetLastChunkSize() const;  // last finished chunk, 0 if it was not stored
+  void Close();                       // finishes chunk in progress
+
+ private:
+  static GstFlowReturn new_sample_callback(GstElement* appsink, gpointer user_data);
+
+  GstFlowReturn HandleNewSample();
+  void HandleData(const uint8_t* data, size_t size, GstClockTime pts);
+  void BeginChunk(GstClockTime pts);
+  void FinishChunk();
+  void WriteChunk(const void* data, size_t size);
+
+  const std::string chunks_dir_;  // with trailing separator
+  utils::TsChunker chunker_;
+  chunk_started_callback_t chunk_started_cb_;
+  gpointer chunk_started_user_data_;
+
+  std::mutex chunk_mutex_;  // data is written from streaming thread, recorder closes last chunk on stop
+  TimeShiftRingWriter ring_;
+  descriptor_t fd_;  // chunk file in progress, INVALID_DESCRIPTOR if none or ring is used
+  bool in_chunk_;    // data before first chunk start is dropped, it is not decodable
+  uint64_t chunk_size_;
+  std::atomic<uint64_t> last_chunk_size_;
+  bool write_failed_;  // reported once per chunk
+  bool rai_missing_reported_;
+};
+
+ElementTsChunkSink* make_ts_chunk_sink(element_id_t sink_id,
+                                       const std::string& chunks_dir,
+                                       uint64_t chunk_duration_msec);
+
+}  // namespace sink
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -14,13 +14,66 @@
 
 #include "stream/elements/sink/udp.h"
 
+#include <netdb.h>
+#include <string.h>
+
+#include <gst/base/gstbasesink.h>
+#include <gst/gstbuffer.h>
+#include <gst/gstsample.h>
+
+#include <algorithm>
 #include <string>
 
+#include <common/convert2string.h>
+#include <common/file_system/file_system.h>
+#include <common/sprintf.h>
+
+#include "utils/ts_packet_filter.h"
+
+#define UDP_TS_PACKETS_PER_DATAGRAM 7
+#define UDP_TS_DATAGRAM_PAYLOAD_SIZE (UDP_TS_PACKETS_PER_DATAGRAM * TS_PACKET_SIZE)  // 1316 bytes
+#define UDP_TS_SINK_BATCH_SIZE 64                                                     // datagrams per sendmmsg
+#define UDP_TS_SINK_TICK_USEC 1000
+#define UDP_TS_SINK_MAX_BURST_USEC 100000  // sending credit limit, after stalls rate is not caught up
+#define UDP_TS_SINK_MAX_QUEUE_SIZE size_t(UDP_TS_DATAGRAM_PAYLOAD_SIZE * 4096)
+#define UDP_TS_SINK_OPEN_RETRY_USEC G_USEC_PER_SEC
+
+#define RTP_HEADER_SIZE 12
+#define RTP_MP2T_PAYLOAD_TYPE 33  // RFC 3551
+#define RTP_MP2T_CLOCK_RATE 90000
+
+#define UDP_TS_SINK_DATAGRAM_STRIDE (RTP_HEADER_SIZE + UDP_TS_DATAGRAM_PAYLOAD_SIZE)
+
 namespace iptv_cloud {
 namespace stream {
 namespace elements {
 namespace sink {
 
+namespace {
+void MakeNullPacket(uint8_t* packet) {
+  memset(packet, 0xFF, TS_PACKET_SIZE);
+  packet[0] = TS_SYNC_BYTE;
+  packet[1] = TS_NULL_PID >> 8;
+  packet[2] = TS_NULL_PID & 0xFF;
+  packet[3] = 0x10;  // payload only, continuity counter of null packets is not checked
+}
+
+void WriteRtpHeader(uint8_t* header, uint16_t seq, uint32_t timestamp, uint32_t ssrc) {
+  header[0] = 0x80;  // version 2
+  header[1] = RTP_MP2T_PAYLOAD_TYPE;
+  header[2] = seq >> 8;
+  header[3] = seq & 0xFF;
+  header[4] = timestamp >> 24;
+  header[5] = (timestamp >> 16) & 0xFF;
+  header[6] = (timestamp >> 8) & 0xFF;
+  header[7] = timestamp & 0xFF;
+  header[8] = ssrc >> 24;
+  header[9] = (ssrc >> 16) & 0xFF;
+  header[10] = (ssrc >> 8) & 0xFF;
+  header[11] = ssrc & 0xFF;
+}
+}  // namespace
+
 void ElementUDPSink::SetHost(const std::string& host) {
   SetProperty("host", host);
 }
@@ -29,6 +82,326 @@ void ElementUDPSink::SetPort(uint16_t port) {
   SetProperty("port", port);
 }
 
+ElementUDPTsSink::ElementUDPTsSink(const std::string& name,
+                                   const common::net::HostAndPort& host,
+                                   bool rtp,
+                                   int mux_rate)
+    : base_class(name),
+      host_(host),
+      rtp_(rtp),
+      mux_rate_(mux_rate),
+      fd_(INVALID_DESCRIPTOR),
+      next_open_time_(0),
+      live_(false),
+      sender_(),
+      queue_mutex_(),
+      queue_cond_(),
+      queue_(new uint8_t[UDP_TS_SINK_MAX_QUEUE_SIZE]),
+      queue_read_(0),
+      queue_size_(0),
+      stop_(false),
+      dropped_packets_(0),
+      datagrams_(new uint8_t[UDP_TS_SINK_BATCH_SIZE * UDP_TS_SINK_DATAGRAM_STRIDE]),
+      msgs_(new struct mmsghdr[UDP_TS_SINK_BATCH_SIZE]),
+      iovs_(new struct iovec[UDP_TS_SINK_BATCH_SIZE]),
+      rtp_seq_(0),
+      rtp_ssrc_(g_random_int()) {
+  SetSync(mux_rate_ <= 0);  // paced by sender thread if mux rate is set
+  SetEmitSignals(true);
+  gboolean res = RegisterNewSampleCallback(new_sample_callback, this);
+  DCHECK(res);
+  res = RegisterEosCallback(eos_callback, this);
+  DCHECK(res);
+}
+
+ElementUDPTsSink::~ElementUDPTsSink() {
+  StopSender();
+  CloseSocket();
+  delete[] iovs_;
+  delete[] msgs_;
+  delete[] datagrams_;
+  delete[] queue_;
+}
+
+GstFlowReturn ElementUDPTsSink::new_sample_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementUDPTsSink* sink = static_cast<ElementUDPTsSink*>(user_data);
+  return sink->HandleNewSample();
+}
+
+void ElementUDPTsSink::eos_callback(GstElement* appsink, gpointer user_data) {
+  UNUSED(appsink);
+  ElementUDPTsSink* sink = static_cast<ElementUDPTsSink*>(user_data);
+  sink->StopSender();
+}
+
+GstFlowReturn ElementUDPTsSink::HandleNewSample() {
+  GstSample* sample = PullSample();
+  if (!sample) {
+    return GST_FLOW_OK;
+  }
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  if (!buffer || !StartSender()) {
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+
+  GstMapInfo map;
+  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    const uint8_t* data = map.data;
+    size_t size = map.size;
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (live_) {  // live source can't wait, drop oldest packets
+      const size_t free = UDP_TS_SINK_MAX_QUEUE_SIZE - queue_size_;
+      if (size > free) {
+        const size_t drop = std::min((size - free + TS_PACKET_SIZE - 1) / TS_PACKET_SIZE * TS_PACKET_SIZE, queue_size_);
+        PopQueue(nullptr, drop);
+        if (size > UDP_TS_SINK_MAX_QUEUE_SIZE) {  // only tail of huge buffer fits
+          data += size - UDP_TS_SINK_MAX_QUEUE_SIZE;
+          size = UDP_TS_SINK_MAX_QUEUE_SIZE;
+        }
+        if (!dropped_packets_) {
+          WARNING_LOG() << "Udp output " << GetName() << " can't keep up, packets are dropped, mux rate: "
+                        << mux_rate_;
+        }
+        dropped_packets_ += (drop + map.size - size) / TS_PACKET_SIZE;
+      }
+      PushQueue(data, size);
+    } else {  // muxer is faster than mux rate, wait for sender
+      while (size && !stop_) {
+        queue_cond_.wait(lock, [this]() { return stop_ || queue_size_ < UDP_TS_SINK_MAX_QUEUE_SIZE; });
+        const size_t part = std::min(size, UDP_TS_SINK_MAX_QUEUE_SIZE - queue_size_);
+        PushQueue(data, part);
+        data += part;
+        size -= part;
+        if (size) {  // sender waits for data while rest of buffer waits for space
+          queue_cond_.notify_all();
+        }
+      }
+    }
+    lock.unlock();
+    queue_cond_.notify_all();
+    gst_buffer_unmap(buffer, &map);
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+common::ErrnoError ElementUDPTsSink::OpenSocket() {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_NUMERICSERV;
+  const std::string port = common::ConvertToString(host_.GetPort());
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(host_.GetHost().c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+    return common::make_errno_error("Can't resolve udp host: " + host_.GetHost(), EINVAL);
+  }
+
+  descriptor_t fd = socket(result->ai_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd == INVALID_DESCRIPTOR) {
+    freeaddrinfo(result);
+    return common::make_errno_error(errno);
+  }
+
+  // connected socket, datagrams are sent without address
+  if (connect(fd, result->ai_addr, result->ai_addrlen) < 0) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    freeaddrinfo(result);
+    ignore_result(common::file_system::close_descriptor(fd));
+    return err;
+  }
+
+  freeaddrinfo(result);
+  fd_ = fd;
+  return common::ErrnoError();
+}
+
+void ElementUDPTsSink::CloseSocket() {
+  if (fd_ == INVALID_DESCRIPTOR) {
+    return;
+  }
+
+  ignore_result(common::file_system::close_descriptor(fd_));
+  fd_ = INVALID_DESCRIPTOR;
+}
+
+bool ElementUDPTsSink::StartSender() {
+  if (sender_.joinable()) {
+    return true;
+  }
+
+  if (fd_ == INVALID_DESCRIPTOR) {
+    const gint64 now = g_get_monotonic_time();
+    if (now < next_open_time_) {  // samples are dropped silently until retry
+      return false;
+    }
+
+    common::ErrnoError err = OpenSocket();
+    if (err) {
+      next_open_time_ = now + UDP_TS_SINK_OPEN_RETRY_USEC;
+      WARNING_LOG() << "Failed to open udp output " << GetName() << ", error: " << err->GetDescription();
+      return false;
+    }
+  }
+
+  const bool live = IsUpstreamLive();
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  stop_ = false;
+  live_ = live;
+  lock.unlock();
+  sender_ = std::thread(&ElementUDPTsSink::SendLoop, this);
+  return true;
+}
+
+void ElementUDPTsSink::StopSender() {
+  if (!sender_.joinable()) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  stop_ = true;
+  lock.unlock();
+  queue_cond_.notify_all();
+  sender_.join();
+  if (dropped_packets_) {
+    WARNING_LOG() << "Udp output " << GetName() << " dropped packets: " << dropped_packets_;
+  }
+}
+
+bool ElementUDPTsSink::IsUpstreamLive() {
+  gboolean upstream_live = FALSE;
+  if (!gst_base_sink_query_latency(GST_BASE_SINK(GetGstElement()), nullptr, &upstream_live, nullptr, nullptr)) {
+    return true;  // unknown, queue limit is kept by dropping as for live
+  }
+  return upstream_live;
+}
+
+void ElementUDPTsSink::SendLoop() {
+  const uint64_t datagram_bits = UDP_TS_DATAGRAM_PAYLOAD_SIZE * 8;
+  const uint64_t max_credit_bits =
+      std::max(static_cast<uint64_t>(mux_rate_) * UDP_TS_SINK_MAX_BURST_USEC / G_USEC_PER_SEC, datagram_bits);
+  uint64_t credit_bits = 0;
+  gint64 last_time = g_get_monotonic_time();
+  bool stop = false;
+  while (!stop) {
+    size_t due = UDP_TS_SINK_BATCH_SIZE;
+    if (mux_rate_ > 0) {  // datagrams which should be sent since previous tick
+      g_usleep(UDP_TS_SINK_TICK_USEC);
+      const gint64 now = g_get_monotonic_time();
+      credit_bits += static_cast<uint64_t>(now - last_time) * mux_rate_ / G_USEC_PER_SEC;
+      credit_bits = std::min(credit_bits, max_credit_bits);
+      last_time = now;
+      due = credit_bits / datagram_bits;
+      credit_bits -= due * datagram_bits;
+    }
+
+    do {
+      size_t count = 0;
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      if (mux_rate_ <= 0) {
+        queue_cond_.wait(lock, [this]() { return stop_ || queue_size_ >= UDP_TS_DATAGRAM_PAYLOAD_SIZE; });
+      }
+      stop = stop_;
+      const bool was_full = queue_size_ >= UDP_TS_SINK_MAX_QUEUE_SIZE;
+      if (!stop) {
+        count = FillDatagrams(std::min<size_t>(due, UDP_TS_SINK_BATCH_SIZE), mux_rate_ > 0, false);
+      }
+      lock.unlock();
+      if (was_full && count) {  // streaming thread waits for space
+        queue_cond_.notify_all();
+      }
+      SendDatagrams(count);
+      due -= count;
+    } while (!stop && due && mux_rate_ > 0);
+  }
+
+  // eos, rest of queue is sent without pacing and padding
+  size_t count = 0;
+  do {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    count = FillDatagrams(UDP_TS_SINK_BATCH_SIZE, false, true);
+    lock.unlock();
+    SendDatagrams(count);
+  } while (count);
+}
+
+size_t ElementUDPTsSink::FillDatagrams(size_t count, bool pad, bool flush) {
+  size_t filled = 0;
+  for (; filled < count; ++filled) {
+    const size_t packets = std::min<size_t>(queue_size_ / TS_PACKET_SIZE, UDP_TS_PACKETS_PER_DATAGRAM);
+    if (packets < UDP_TS_PACKETS_PER_DATAGRAM && !pad && !(flush && packets)) {
+      break;
+    }
+
+    uint8_t* datagram = datagrams_ + filled * UDP_TS_SINK_DATAGRAM_STRIDE;
+    uint8_t* payload = datagram + RTP_HEADER_SIZE;
+    size_t payload_size = packets * TS_PACKET_SIZE;
+    PopQueue(payload, payload_size);
+    if (pad) {  // muxer is late, keep constant rate
+      for (size_t i = packets; i < UDP_TS_PACKETS_PER_DATAGRAM; ++i) {
+        MakeNullPacket(payload + i * TS_PACKET_SIZE);
+      }
+      payload_size = UDP_TS_DATAGRAM_PAYLOAD_SIZE;
+    }
+
+    iovs_[filled].iov_base = rtp_ ? datagram : payload;
+    iovs_[filled].iov_len = rtp_ ? payload_size + RTP_HEADER_SIZE : payload_size;
+  }
+  return filled;
+}
+
+void ElementUDPTsSink::PushQueue(const uint8_t* data, size_t size) {
+  const size_t write = (queue_read_ + queue_size_) % UDP_TS_SINK_MAX_QUEUE_SIZE;
+  const size_t first = std::min(size, UDP_TS_SINK_MAX_QUEUE_SIZE - write);
+  memcpy(queue_ + write, data, first);
+  memcpy(queue_, data + first, size - first);
+  queue_size_ += size;
+}
+
+void ElementUDPTsSink::PopQueue(uint8_t* data, size_t size) {
+  if (data) {
+    const size_t first = std::min(size, UDP_TS_SINK_MAX_QUEUE_SIZE - queue_read_);
+    memcpy(data, queue_ + queue_read_, first);
+    memcpy(data + first, queue_, size - first);
+  }
+  queue_read_ = (queue_read_ + size) % UDP_TS_SINK_MAX_QUEUE_SIZE;
+  queue_size_ -= size;
+}
+
+void ElementUDPTsSink::SendDatagrams(size_t count) {
+  if (!count) {
+    return;
+  }
+
+  const uint32_t timestamp = g_get_monotonic_time() * RTP_MP2T_CLOCK_RATE / G_USEC_PER_SEC;
+  for (size_t i = 0; i < count; ++i) {
+    if (rtp_) {
+      WriteRtpHeader(datagrams_ + i * UDP_TS_SINK_DATAGRAM_STRIDE, rtp_seq_++, timestamp, rtp_ssrc_);
+    }
+    memset(&msgs_[i], 0, sizeof(msgs_[i]));
+    msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+    msgs_[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  size_t sent = 0;
+  while (sent < count) {
+    int res = sendmmsg(fd_, msgs_ + sent, count - sent, 0);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != ECONNREFUSED) {  // no receiver yet, not an error for udp output
+        WARNING_LOG() << "Failed to send udp output " << GetName() << " datagrams, errno: " << errno;
+      }
+      return;
+    }
+    sent += res;
+  }
+}
+
 ElementUDPSink* make_udp_sink(const common::net::HostAndPort& host, element_id_t sink_id) {
   ElementUDPSink* udp_out = make_sink<ElementUDPSink>(sink_id);
   udp_out->SetHost(host.GetHost());
@@ -36,6 +409,13 @@ ElementUDPSink* make_udp_sink(const common::net::HostAndPort& host, element_id_t
   return udp_out;
 }
 
+ElementUDPTsSink* make_udp_ts_sink(const common::net::HostAndPort& host,
+                                   bool rtp,
+                                   int mux_rate,
+                                   element_id_t sink_id) {
+  return new ElementUDPTsSink(common::MemSPrintf(SINK_NAME_1U, sink_id), host, rtp, mux_rate);
+}
+
 }  // namespace sink
 }  // namespace elements
 }  // namespace stream
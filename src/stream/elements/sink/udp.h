@@ -14,13 +14,20 @@
 
 #pragma once
 
+#include <sys/socket.h>
+
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
+#include <common/error.h>
 #include <common/net/types.h>
 
 // for element_id_t
 
-#include "stream/elements/element.h"    // for SupportedElements::ELEMENT_UDP_SINK
+#include "stream/elements/element.h"  // for SupportedElements::ELEMENT_UDP_SINK
+#include "stream/elements/sink/appsink.h"
 #include "stream/elements/sink/sink.h"  // for ElementSync
 
 namespace common {
@@ -41,7 +48,63 @@ class ElementUDPSink : public ElementSync<ELEMENT_UDP_SINK> {
   void SetPort(uint16_t port = 5004);                   // 0 - 65535; Default: 5004
 };
 
+// Ts over udp output: 7 packets per datagram (raw or behind rtp header), sent by own thread in batches
+// with one sendmmsg call. If mux rate is set datagrams are paced to it and padded with null packets
+// when muxer can't fill them, so receivers get constant bitrate without bursts.
+// Full queue blocks streaming thread, so files are played at mux rate, only live sources drop oldest packets.
+class ElementUDPTsSink : public ElementAppSink {
+ public:
+  typedef ElementAppSink base_class;
+
+  ElementUDPTsSink(const std::string& name, const common::net::HostAndPort& host, bool rtp, int mux_rate);
+  ~ElementUDPTsSink() override;
+
+ private:
+  static GstFlowReturn new_sample_callback(GstElement* appsink, gpointer user_data);
+  static void eos_callback(GstElement* appsink, gpointer user_data);
+
+  GstFlowReturn HandleNewSample();
+  common::ErrnoError OpenSocket() WARN_UNUSED_RESULT;
+  void CloseSocket();
+
+  bool StartSender();  // lazily on first data, false if socket can't be opened
+  bool IsUpstreamLive();
+  void StopSender();
+  void SendLoop();
+  size_t FillDatagrams(size_t count, bool pad, bool flush);  // queue lock, returns filled datagrams count
+  void SendDatagrams(size_t count);
+  void PushQueue(const uint8_t* data, size_t size);  // queue lock, size fits free space
+  void PopQueue(uint8_t* data, size_t size);         // queue lock, dropped if data is nullptr
+
+  const common::net::HostAndPort host_;
+  const bool rtp_;
+  const int mux_rate_;  // bits per second, 0 means only aggregation
+  descriptor_t fd_;
+  gint64 next_open_time_;  // monotonic usec, socket open is retried not more often
+  bool live_;              // queried on sender start
+
+  std::thread sender_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  uint8_t* queue_;  // ring of pending ts packets, sent data is not moved
+  size_t queue_read_;
+  size_t queue_size_;
+  bool stop_;
+  uint64_t dropped_packets_;
+
+  // sender thread only
+  uint8_t* datagrams_;
+  struct mmsghdr* msgs_;
+  struct iovec* iovs_;
+  uint16_t rtp_seq_;
+  uint32_t rtp_ssrc_;
+};
+
 ElementUDPSink* make_udp_sink(const common::net::HostAndPort& host, element_id_t sink_id);
+ElementUDPTsSink* make_udp_ts_sink(const common::net::HostAndPort& host,
+                                   bool rtp,
+                                   int mux_rate,
+                                   element_id_t sink_id);
 
 }  // namespace sink
 }  // namespace elements
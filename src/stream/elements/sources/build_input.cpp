@@ -18,6 +18,7 @@
 
 #include "stream/elements/sources/filesrc.h"
 #include "stream/elements/sources/httpsrc.h"
+#include "stream/elements/sources/ingestsrc.h"
 #include "stream/elements/sources/rtmpsrc.h"
 #include "stream/elements/sources/tcpsrc.h"
 #include "stream/elements/sources/udpsrc.h"
@@ -34,6 +35,11 @@ namespace sources {
 
 Element* make_src(const InputUri& uri, element_id_t input_id, gint timeout_secs) {
   common::uri::Url url = uri.GetInput();
+  std::string hub_name;
+  if (IsLocalUrl(url, &hub_name)) {
+    return make_ingest_src(hub_name, input_id);
+  }
+
   common::uri::Url::scheme scheme = url.GetScheme();
   if (scheme == common::uri::Url::file) {
     const common::uri::Upath upath = url.GetPath();
@@ -55,7 +61,11 @@ Element* make_src(const InputUri& uri, element_id_t input_id, gint timeout_secs)
       NOTREACHED() << "Unknownt input url: " << host_str;
       return nullptr;
     }
-    return make_udp_src(host, input_id);
+    UdpSrcOptions options;
+    options.recv_buffer_size = uri.GetRecvBufferSize();
+    options.multicast_iface = uri.GetMulticastIface();
+    options.multicast_source = uri.GetMulticastSource();
+    return make_udp_batch_src(host, options, input_id);
   } else if (scheme == common::uri::Url::rtmp) {
     return make_rtmp_src(url.GetUrl(), timeout_secs, input_id);
   } else if (scheme == common::uri::Url::tcp) {
@@ -0,0 +1,127 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/elements/sources/ingestsrc.h"
+
+#include <gst/gstbuffer.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+
+#include "base/shared_ingest_ring.h"
+
+#define INGEST_SRC_BLOCK_SIZE (188 * 348)  // ~64 KB of ts packets
+#define INGEST_SRC_POLL_USEC 5000
+#define INGEST_SRC_MAP_RETRY_USEC 100000
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sources {
+
+ElementIngestSrc::ElementIngestSrc(const std::string& name, const std::string& hub_name)
+    : base_class(name), hub_name_(hub_name), ring_(nullptr), offset_(0), discont_(true) {
+  SetProperty("is-live", true);
+  gboolean res = RegisterNeedDataCallback(need_data_callback, this);
+  DCHECK(res);
+}
+
+ElementIngestSrc::~ElementIngestSrc() {
+  FreeSharedIngestRing(ring_);
+  ring_ = nullptr;
+}
+
+void ElementIngestSrc::need_data_callback(GstElement* pipeline, guint size, gpointer user_data) {
+  UNUSED(pipeline);
+  ElementIngestSrc* src = static_cast<ElementIngestSrc*>(user_data);
+  src->HandleNeedData(size);
+}
+
+bool ElementIngestSrc::MapRing() {
+  const std::string path = MakeIngestRingPath(hub_name_);
+  common::ErrnoError err = MapSharedIngestRing(path, &ring_);
+  if (err) {
+    return false;
+  }
+
+  INFO_LOG() << "Subscribed to ingest hub: " << hub_name_;
+  offset_ = ring_->GetWriteOffset();
+  discont_ = true;
+  return true;
+}
+
+bool ElementIngestSrc::IsStopping() {
+  GstElement* src = GetGstElement();
+  GST_OBJECT_LOCK(src);
+  const GstState target = GST_STATE_TARGET(src);
+  GST_OBJECT_UNLOCK(src);
+  return target < GST_STATE_PAUSED;
+}
+
+void ElementIngestSrc::HandleNeedData(guint size) {
+  UNUSED(size);
+  // appsrc waits for push after need-data, so data should be polled here until it is available or we are stopped
+  GstBuffer* buffer = nullptr;
+  while (!IsStopping()) {
+    if (!ring_ && !MapRing()) {
+      g_usleep(INGEST_SRC_MAP_RETRY_USEC);
+      continue;
+    }
+
+    if (!buffer) {
+      buffer = gst_buffer_new_allocate(nullptr, INGEST_SRC_BLOCK_SIZE, nullptr);
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+      break;
+    }
+
+    bool lost = false;
+    const size_t readed = ring_->Read(&offset_, map.data, map.size, &lost);
+    gst_buffer_unmap(buffer, &map);
+    if (lost) {
+      WARNING_LOG() << "Ingest hub " << hub_name_ << " data lost, skipped to live edge.";
+      discont_ = true;
+      continue;
+    }
+
+    if (!readed) {
+      g_usleep(INGEST_SRC_POLL_USEC);
+      continue;
+    }
+
+    gst_buffer_set_size(buffer, readed);
+    if (discont_) {
+      GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+      discont_ = false;
+    }
+    PushBuffer(buffer);  // takes ownership
+    return;
+  }
+
+  if (buffer) {
+    gst_buffer_unref(buffer);
+  }
+}
+
+ElementIngestSrc* make_ingest_src(const std::string& hub_name, element_id_t input_id) {
+  return new ElementIngestSrc(common::MemSPrintf(SRC_NAME_1U, input_id), hub_name);
+}
+
+}  // namespace sources
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,54 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "stream/elements/sources/appsrc.h"
+
+namespace iptv_cloud {
+class SharedIngestRing;
+namespace stream {
+namespace elements {
+namespace sources {
+
+// Subscriber of ingest hub (local://<hub_name> input), reads muxed stream of hub from node local ring,
+// waits for hub if it is not started yet, starts from live edge and skips to it if hub lapped us.
+class ElementIngestSrc : public ElementAppSrc {
+ public:
+  typedef ElementAppSrc base_class;
+
+  ElementIngestSrc(const std::string& name, const std::string& hub_name);
+  ~ElementIngestSrc() override;
+
+ private:
+  static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
+
+  void HandleNeedData(guint size);
+  bool MapRing();
+  bool IsStopping();
+
+  const std::string hub_name_;
+  const SharedIngestRing* ring_;
+  uint64_t offset_;
+  bool discont_;
+};
+
+ElementIngestSrc* make_ingest_src(const std::string& hub_name, element_id_t input_id);
+
+}  // namespace sources
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,143 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/elements/sources/timeshiftsrc.h"
+
+#include <gst/gstbuffer.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+
+#define TIMESHIFT_SRC_BLOCK_SIZE (188 * 1394)  // ~256 KB of ts packets
+#define TIMESHIFT_SRC_POLL_USEC 100000
+#define TIMESHIFT_SRC_OPEN_RETRY_USEC 1000000
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sources {
+
+ElementTimeShiftRingSrc::ElementTimeShiftRingSrc(const std::string& name,
+                                                 const std::string& ring_path,
+                                                 uint64_t start_index)
+    : base_class(name),
+      ring_path_(ring_path),
+      ring_(),
+      chunk_(),
+      next_index_(start_index),
+      pos_(0),
+      have_chunk_(false),
+      discont_(true) {
+  gboolean res = RegisterNeedDataCallback(need_data_callback, this);
+  DCHECK(res);
+}
+
+void ElementTimeShiftRingSrc::need_data_callback(GstElement* pipeline, guint size, gpointer user_data) {
+  UNUSED(pipeline);
+  ElementTimeShiftRingSrc* src = static_cast<ElementTimeShiftRingSrc*>(user_data);
+  src->HandleNeedData(size);
+}
+
+bool ElementTimeShiftRingSrc::IsStopping() {
+  GstElement* src = GetGstElement();
+  GST_OBJECT_LOCK(src);
+  const GstState target = GST_STATE_TARGET(src);
+  GST_OBJECT_UNLOCK(src);
+  return target < GST_STATE_PAUSED;
+}
+
+bool ElementTimeShiftRingSrc::SelectChunk() {
+  uint64_t last_index = 0;
+  while (!ring_.FindChunk(next_index_, &chunk_)) {
+    if (!ring_.GetLastIndex(&last_index) || next_index_ > last_index) {
+      return false;
+    }
+
+    next_index_++;  // evicted or never recorded (recorder was down), skip it
+    discont_ = true;
+  }
+
+  have_chunk_ = true;
+  pos_ = 0;
+  return true;
+}
+
+void ElementTimeShiftRingSrc::HandleNeedData(guint size) {
+  UNUSED(size);
+  // appsrc waits for push after need-data, so data should be polled here until it is available or we are stopped
+  GstBuffer* buffer = nullptr;
+  while (!IsStopping()) {
+    if (!ring_.IsOpen()) {
+      common::ErrnoError err = ring_.Open(ring_path_);
+      if (err) {
+        WARNING_LOG() << "Failed to open timeshift ring " << ring_path_ << ": " << err->GetDescription();
+        g_usleep(TIMESHIFT_SRC_OPEN_RETRY_USEC);
+        continue;
+      }
+    }
+
+    if (!have_chunk_ && !SelectChunk()) {
+      g_usleep(TIMESHIFT_SRC_POLL_USEC);
+      continue;
+    }
+
+    if (!buffer) {
+      buffer = gst_buffer_new_allocate(nullptr, TIMESHIFT_SRC_BLOCK_SIZE, nullptr);
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+      break;
+    }
+
+    size_t readed = 0;
+    common::ErrnoError err = ring_.Read(chunk_, pos_, map.data, map.size, &readed);
+    gst_buffer_unmap(buffer, &map);
+    if (err) {
+      WARNING_LOG() << "Failed to read timeshift chunk " << chunk_.index << ": " << err->GetDescription();
+      discont_ = true;
+    }
+
+    if (err || !readed) {  // chunk finished or lost, next one
+      have_chunk_ = false;
+      next_index_ = chunk_.index + 1;
+      continue;
+    }
+
+    pos_ += readed;
+    gst_buffer_set_size(buffer, readed);
+    if (discont_) {
+      GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+      discont_ = false;
+    }
+    PushBuffer(buffer);  // takes ownership
+    return;
+  }
+
+  if (buffer) {
+    gst_buffer_unref(buffer);
+  }
+}
+
+ElementTimeShiftRingSrc* make_timeshift_ring_src(const std::string& ring_path,
+                                                 uint64_t start_index,
+                                                 element_id_t input_id) {
+  return new ElementTimeShiftRingSrc(common::MemSPrintf(SRC_NAME_1U, input_id), ring_path, start_index);
+}
+
+}  // namespace sources
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
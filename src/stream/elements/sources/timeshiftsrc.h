@@ -0,0 +1,58 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "stream/elements/sources/appsrc.h"
+#include "stream/timeshift_ring.h"
+
+namespace iptv_cloud {
+namespace stream {
+namespace elements {
+namespace sources {
+
+// Timeshift player input over ring storage, reads finished chunks by offset one after another from start chunk,
+// waits for chunks which are not recorded yet and skips chunks which are already evicted.
+class ElementTimeShiftRingSrc : public ElementAppSrc {
+ public:
+  typedef ElementAppSrc base_class;
+
+  ElementTimeShiftRingSrc(const std::string& name, const std::string& ring_path, uint64_t start_index);
+
+ private:
+  static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
+
+  void HandleNeedData(guint size);
+  bool SelectChunk();  // false if next chunk is not recorded yet
+  bool IsStopping();
+
+  const std::string ring_path_;
+  TimeShiftRingReader ring_;
+  TimeShiftRingChunk chunk_;
+  uint64_t next_index_;
+  uint64_t pos_;  // in current chunk
+  bool have_chunk_;
+  bool discont_;
+};
+
+ElementTimeShiftRingSrc* make_timeshift_ring_src(const std::string& ring_path,
+                                                 uint64_t start_index,
+                                                 element_id_t input_id);
+
+}  // namespace sources
+}  // namespace elements
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -14,11 +14,50 @@
 
 #include "stream/elements/sources/udpsrc.h"
 
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gst/gstbuffer.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+
+#define UDP_SRC_BATCH_SIZE 32           // datagrams per read
+#define UDP_SRC_MAX_DATAGRAM_SIZE 2048  // ts over udp is 7 packets, 1316 bytes
+#define UDP_SRC_DEFAULT_RECV_BUFFER_SIZE (8 * 1024 * 1024)
+#define UDP_SRC_POLL_MSEC 100
+#define UDP_SRC_OPEN_RETRY_USEC 1000000
+#define UDP_SRC_STATS_INTERVAL_USEC G_USEC_PER_SEC
+
 namespace iptv_cloud {
 namespace stream {
 namespace elements {
 namespace sources {
 
+namespace {
+common::ErrnoError ResolveIPv4(const std::string& host, struct sockaddr_in* addr) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+    return common::make_errno_error("Can't resolve udp host: " + host, EINVAL);
+  }
+
+  memcpy(addr, result->ai_addr, sizeof(*addr));
+  freeaddrinfo(result);
+  return common::ErrnoError();
+}
+}  // namespace
+
 void ElementUDPSrc::SetUri(const std::string& uri) {
   SetProperty("uri", uri);
 }
@@ -31,6 +70,245 @@ void ElementUDPSrc::SetPort(uint16_t port) {
   SetProperty("port", port);
 }
 
+UdpSrcOptions::UdpSrcOptions() : recv_buffer_size(0), multicast_iface(), multicast_source() {}
+
+ElementUDPBatchSrc::ElementUDPBatchSrc(const std::string& name,
+                                       const common::net::HostAndPort& host,
+                                       const UdpSrcOptions& options,
+                                       element_id_t input_id)
+    : base_class(name),
+      host_(host),
+      options_(options),
+      input_id_(input_id),
+      fd_(INVALID_DESCRIPTOR),
+      socket_drops_(0),
+      kernel_drops_(0),
+      ts_checker_(),
+      reported_cc_errors_(0),
+      last_stats_time_(0),
+      batch_(new uint8_t[UDP_SRC_BATCH_SIZE * UDP_SRC_MAX_DATAGRAM_SIZE]) {
+  SetProperty("is-live", true);
+  gboolean res = RegisterNeedDataCallback(need_data_callback, this);
+  DCHECK(res);
+}
+
+ElementUDPBatchSrc::~ElementUDPBatchSrc() {
+  CloseSocket();
+  delete[] batch_;
+}
+
+void ElementUDPBatchSrc::need_data_callback(GstElement* pipeline, guint size, gpointer user_data) {
+  UNUSED(pipeline);
+  ElementUDPBatchSrc* src = static_cast<ElementUDPBatchSrc*>(user_data);
+  src->HandleNeedData(size);
+}
+
+common::ErrnoError ElementUDPBatchSrc::OpenSocket() {
+  struct sockaddr_in addr;
+  common::ErrnoError err = ResolveIPv4(host_.GetHost(), &addr);
+  if (err) {
+    return err;
+  }
+  addr.sin_port = htons(host_.GetPort());
+
+  descriptor_t fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  // drops counter of socket is attached to received datagrams
+  if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0) {
+    WARNING_LOG() << "Kernel drops are not reported for udp input " << input_id_ << ", errno: " << errno;
+  }
+
+  const int buffer_size = options_.recv_buffer_size ? options_.recv_buffer_size : UDP_SRC_DEFAULT_RECV_BUFFER_SIZE;
+  // force variant ignores net.core.rmem_max, but needs CAP_NET_ADMIN
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &buffer_size, sizeof(buffer_size)) < 0) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+  }
+  int real_buffer_size = 0;
+  socklen_t optlen = sizeof(real_buffer_size);
+  if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &real_buffer_size, &optlen) == 0 && real_buffer_size < buffer_size) {
+    WARNING_LOG() << "Udp input " << input_id_ << " receive buffer is " << real_buffer_size << " bytes instead of "
+                  << buffer_size << ", please increase net.core.rmem_max";
+  }
+
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {  // group address for multicast
+    err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  if (IN_MULTICAST(ntohl(addr.sin_addr.s_addr))) {
+    uint32_t iface_index = 0;
+    if (!options_.multicast_iface.empty()) {
+      iface_index = if_nametoindex(options_.multicast_iface.c_str());
+      if (!iface_index) {
+        err = common::make_errno_error("Unknown multicast interface: " + options_.multicast_iface, ENODEV);
+        close(fd);
+        return err;
+      }
+    }
+
+    int res = 0;
+    if (options_.multicast_source.empty()) {
+      struct group_req req;
+      memset(&req, 0, sizeof(req));
+      req.gr_interface = iface_index;
+      memcpy(&req.gr_group, &addr, sizeof(addr));
+      res = setsockopt(fd, IPPROTO_IP, MCAST_JOIN_GROUP, &req, sizeof(req));
+    } else {
+      struct sockaddr_in source;
+      err = ResolveIPv4(options_.multicast_source, &source);
+      if (err) {
+        close(fd);
+        return err;
+      }
+
+      struct group_source_req req;
+      memset(&req, 0, sizeof(req));
+      req.gsr_interface = iface_index;
+      memcpy(&req.gsr_group, &addr, sizeof(addr));
+      memcpy(&req.gsr_source, &source, sizeof(source));
+      res = setsockopt(fd, IPPROTO_IP, MCAST_JOIN_SOURCE_GROUP, &req, sizeof(req));
+    }
+
+    if (res < 0) {
+      err = common::make_errno_error(errno);
+      close(fd);
+      return err;
+    }
+  }
+
+  fd_ = fd;
+  socket_drops_ = 0;
+  return common::ErrnoError();
+}
+
+void ElementUDPBatchSrc::CloseSocket() {
+  if (fd_ == INVALID_DESCRIPTOR) {
+    return;
+  }
+
+  close(fd_);
+  fd_ = INVALID_DESCRIPTOR;
+}
+
+bool ElementUDPBatchSrc::IsStopping() {
+  GstElement* src = GetGstElement();
+  GST_OBJECT_LOCK(src);
+  const GstState target = GST_STATE_TARGET(src);
+  GST_OBJECT_UNLOCK(src);
+  return target < GST_STATE_PAUSED;
+}
+
+void ElementUDPBatchSrc::HandleNeedData(guint size) {
+  UNUSED(size);
+  // appsrc waits for push after need-data, so socket should be polled here until data is available or we are stopped
+  while (!IsStopping()) {
+    if (fd_ == INVALID_DESCRIPTOR) {
+      common::ErrnoError err = OpenSocket();
+      if (err) {
+        WARNING_LOG() << "Can't open udp input " << input_id_ << ": " << err->GetDescription();
+        g_usleep(UDP_SRC_OPEN_RETRY_USEC);
+        continue;
+      }
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, UDP_SRC_POLL_MSEC) <= 0) {
+      continue;
+    }
+
+    GstBuffer* buffer = ReadBatch();
+    PostStats();
+    if (buffer) {
+      PushBuffer(buffer);  // takes ownership
+      return;
+    }
+  }
+}
+
+GstBuffer* ElementUDPBatchSrc::ReadBatch() {
+  struct mmsghdr msgs[UDP_SRC_BATCH_SIZE];
+  struct iovec iovs[UDP_SRC_BATCH_SIZE];
+  union {
+    char buf[CMSG_SPACE(sizeof(uint32_t))];
+    struct cmsghdr align;
+  } controls[UDP_SRC_BATCH_SIZE];
+  memset(msgs, 0, sizeof(msgs));
+  for (size_t i = 0; i < UDP_SRC_BATCH_SIZE; ++i) {
+    iovs[i].iov_base = batch_ + i * UDP_SRC_MAX_DATAGRAM_SIZE;
+    iovs[i].iov_len = UDP_SRC_MAX_DATAGRAM_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_control = controls[i].buf;
+    msgs[i].msg_hdr.msg_controllen = sizeof(controls[i].buf);
+  }
+
+  const int count = recvmmsg(fd_, msgs, UDP_SRC_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+  size_t total = 0;
+  for (int i = 0; i < count; ++i) {
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+        uint32_t drops = 0;
+        memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+        kernel_drops_ += drops - socket_drops_;  // cumulative counter of socket
+        socket_drops_ = drops;
+      }
+    }
+
+    const size_t len = msgs[i].msg_len;
+    const size_t offset = i * UDP_SRC_MAX_DATAGRAM_SIZE;
+    uint8_t* datagram = batch_ + offset;
+    if (len && len % TS_PACKET_SIZE == 0 && datagram[0] == TS_SYNC_BYTE) {
+      ts_checker_.Check(datagram, len);
+    }
+
+    if (total != offset) {  // datagrams are joined into one continuous buffer
+      memmove(batch_ + total, datagram, len);
+    }
+    total += len;
+  }
+
+  if (!total) {
+    return nullptr;
+  }
+
+  // exact size, queues limited by bytes hold only received data
+  GstBuffer* buffer = gst_buffer_new_allocate(nullptr, total, nullptr);
+  gst_buffer_fill(buffer, 0, batch_, total);
+  return buffer;
+}
+
+void ElementUDPBatchSrc::PostStats() {
+  const gint64 now = g_get_monotonic_time();
+  if (now - last_stats_time_ < UDP_SRC_STATS_INTERVAL_USEC) {
+    return;
+  }
+
+  last_stats_time_ = now;
+  const uint64_t cc_errors = ts_checker_.GetStats().cc_errors;
+  if (!kernel_drops_ && cc_errors == reported_cc_errors_) {
+    return;
+  }
+
+  GstElement* src = GetGstElement();
+  const guint64 new_cc_errors = cc_errors - reported_cc_errors_;
+  GstStructure* info = gst_structure_new(UDP_SRC_STATS_MESSAGE, UDP_SRC_STATS_INPUT_FIELD, G_TYPE_UINT64,
+                                         guint64(input_id_), UDP_SRC_STATS_KERNEL_DROPS_FIELD, G_TYPE_UINT64,
+                                         guint64(kernel_drops_), UDP_SRC_STATS_CC_ERRORS_FIELD, G_TYPE_UINT64,
+                                         new_cc_errors, nullptr);
+  gst_element_post_message(src, gst_message_new_element(GST_OBJECT(src), info));
+  kernel_drops_ = 0;
+  reported_cc_errors_ = cc_errors;
+}
+
 ElementUDPSrc* make_udp_src(const common::net::HostAndPort& host, element_id_t input_id) {
   ElementUDPSrc* udpsrc = make_sources<ElementUDPSrc>(input_id);
   udpsrc->SetAddress(host.GetHost());
@@ -38,6 +316,12 @@ ElementUDPSrc* make_udp_src(const common::net::HostAndPort& host, element_id_t i
   return udpsrc;
 }
 
+ElementUDPBatchSrc* make_udp_batch_src(const common::net::HostAndPort& host,
+                                       const UdpSrcOptions& options,
+                                       element_id_t input_id) {
+  return new ElementUDPBatchSrc(common::MemSPrintf(SRC_NAME_1U, input_id), host, options, input_id);
+}
+
 }  // namespace sources
 }  // namespace elements
 }  // namespace stream
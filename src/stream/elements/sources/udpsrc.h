@@ -16,13 +16,23 @@
 
 #include <string>
 
+#include <common/error.h>
 #include <common/net/types.h>
 
 // for element_id_t
 
 #include "stream/elements/element.h"  // for ElementEx, SupportedElements::ELEMENT_...
+#include "stream/elements/sources/appsrc.h"
 #include "stream/elements/sources/sources.h"
 
+#include "utils/ts_packet_filter.h"
+
+// element message of ElementUDPBatchSrc, counters are increments since previous message
+#define UDP_SRC_STATS_MESSAGE "udp-src-stats"
+#define UDP_SRC_STATS_INPUT_FIELD "input"
+#define UDP_SRC_STATS_KERNEL_DROPS_FIELD "kernel-drops"
+#define UDP_SRC_STATS_CC_ERRORS_FIELD "cc-errors"
+
 namespace iptv_cloud {
 namespace stream {
 namespace elements {
@@ -38,7 +48,54 @@ class ElementUDPSrc : public ElementEx<ELEMENT_UDP_SRC> {
   void SetUri(const std::string& uri = "udp://0.0.0.0:5004");  // String. Default: "udp://0.0.0.0:5004"
 };
 
+struct UdpSrcOptions {
+  UdpSrcOptions();
+
+  int recv_buffer_size;          // bytes, 0 means default
+  std::string multicast_iface;   // empty means any
+  std::string multicast_source;  // source specific multicast, empty means any
+};
+
+// Reads own socket instead of udpsrc: sets receive buffer, joins multicast group (source specific if needed)
+// on chosen interface, reads all queued datagrams with one recvmmsg call into one buffer,
+// and reports kernel socket drops (SO_RXQ_OVFL) and ts continuity errors with element messages.
+class ElementUDPBatchSrc : public ElementAppSrc {
+ public:
+  typedef ElementAppSrc base_class;
+
+  ElementUDPBatchSrc(const std::string& name,
+                     const common::net::HostAndPort& host,
+                     const UdpSrcOptions& options,
+                     element_id_t input_id);
+  ~ElementUDPBatchSrc() override;
+
+ private:
+  static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
+
+  void HandleNeedData(guint size);
+  GstBuffer* ReadBatch();  // nullptr if nothing was read
+  common::ErrnoError OpenSocket() WARN_UNUSED_RESULT;
+  void CloseSocket();
+  bool IsStopping();
+  void PostStats();
+
+  const common::net::HostAndPort host_;
+  const UdpSrcOptions options_;
+  const element_id_t input_id_;
+
+  descriptor_t fd_;
+  uint32_t socket_drops_;  // last SO_RXQ_OVFL value, counter of socket
+  uint64_t kernel_drops_;  // not reported yet
+  utils::TsPacketFilter ts_checker_;
+  uint64_t reported_cc_errors_;
+  gint64 last_stats_time_;
+  uint8_t* batch_;  // datagrams are received here, buffer is allocated by received size
+};
+
 ElementUDPSrc* make_udp_src(const common::net::HostAndPort& host, element_id_t input_id);
+ElementUDPBatchSrc* make_udp_batch_src(const common::net::HostAndPort& host,
+                                       const UdpSrcOptions& options,
+                                       element_id_t input_id);
 
 }  // namespace sources
 }  // namespace elements
@@ -96,7 +96,8 @@ elements::Element* IBaseBuilder::BuildGenericOutput(const OutputUri& output, ele
 
 elements::Element* IBaseBuilder::CreateSink(const OutputUri& output, element_id_t sink_id) {
   IBaseStream* stream = static_cast<IBaseStream*>(GetObserver());
-  elements::Element* sink = elements::sink::build_output(output, sink_id, stream->IsVod());
+  elements::Element* sink =
+      elements::sink::build_output(output, sink_id, stream->IsVod(), stream->GetStats()->GetHlsStore());
   return sink;
 }
 
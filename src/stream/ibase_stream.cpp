@@ -20,6 +20,7 @@
 
 #include <gst/base/gstbasesrc.h>  // for GstBaseSrc
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -31,6 +32,7 @@
 
 #include "stream/dumpers/dumpers_factory.h"
 #include "stream/elements/element.h"
+#include "stream/elements/sources/udpsrc.h"  // for UDP_SRC_STATS_MESSAGE
 #include "stream/gstreamer_utils.h"
 #include "stream/ibase_builder.h"
 #include "stream/probes.h"  // for Probe (ptr only), PROBE_IN, PROBE_OUT
@@ -100,22 +102,10 @@ void RedirectGstLog(GstDebugCategory* category,
   }
 }
 
-}  // namespace
-
-namespace iptv_cloud {
-namespace stream {
-
-void streams_init(int argc, char** argv, EncoderType enc) {
-  if (gst_is_initialized()) {
-    return;
-  }
-
-  signal(SIGPIPE, SIG_IGN);
-#ifdef HAVE_X11
-  XInitThreads();
-#endif
+bool is_preinited = false;  // gstreamer loaded by zygote before fork
 
-  if (enc == GPU_MFX) {
+void InitEncoderEnviroment(iptv_cloud::stream::EncoderType enc) {
+  if (enc == iptv_cloud::stream::GPU_MFX) {
     int res = ::setenv("LIBVA_DRIVER_NAME", MFX_ENV, 1);
     if (res == ERROR_RESULT_VALUE) {
       WARNING_LOG() << "Failed to set enviroment variable LIBVA_DRIVER_NAME to " MFX_ENV;
@@ -125,7 +115,7 @@ void streams_init(int argc, char** argv, EncoderType enc) {
       WARNING_LOG() << "Failed to set enviroment variable LIBVA_DRIVERS_PATH "
                        "to " MFX_DRIVER_PATH;
     }
-  } else if (enc == GPU_VAAPI) {
+  } else if (enc == iptv_cloud::stream::GPU_VAAPI) {
     int res = ::setenv("LIBVA_DRIVER_NAME", VAAPI_I965_ENV, 1);
     if (res == ERROR_RESULT_VALUE) {
       WARNING_LOG() << "Failed to set enviroment variable LIBVA_DRIVER_NAME "
@@ -137,6 +127,49 @@ void streams_init(int argc, char** argv, EncoderType enc) {
                        "to " VAAPI_I965_DRIVER_PATH;
     }
   }
+}
+
+}  // namespace
+
+namespace iptv_cloud {
+namespace stream {
+
+void streams_preinit() {
+  if (gst_is_initialized()) {
+    return;
+  }
+
+  is_preinited = true;
+  signal(SIGPIPE, SIG_IGN);
+#ifdef HAVE_X11
+  XInitThreads();
+#endif
+  gst_init(nullptr, nullptr);
+}
+
+void streams_init(int argc, char** argv, EncoderType enc) {
+  if (gst_is_initialized()) {
+    if (!is_preinited) {
+      return;
+    }
+
+    // preinited by zygote, apply only per stream settings, va drivers read enviroment on display open
+    is_preinited = false;
+    InitEncoderEnviroment(enc);
+    if (common::logging::CURRENT_LOG_LEVEL() == common::logging::LOG_LEVEL_DEBUG) {
+      gst_debug_set_default_threshold(GST_LEVEL_FIXME);
+      gst_debug_add_log_function(RedirectGstLog, nullptr, nullptr);
+    }
+    DEBUG_LOG() << "Stream backend preinited";
+    return;
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+#ifdef HAVE_X11
+  XInitThreads();
+#endif
+
+  InitEncoderEnviroment(enc);
   if (common::logging::CURRENT_LOG_LEVEL() == common::logging::LOG_LEVEL_DEBUG) {
     int res = ::setenv("GST_DEBUG", "3", 1);
     if (res == SUCCESS_RESULT_VALUE) {
@@ -161,7 +194,7 @@ void streams_deinit() {
 
 IBaseStream::IStreamClient::~IStreamClient() {}
 
-IBaseStream::IBaseStream(const Config* config, IStreamClient* client, StreamStruct* stats)
+IBaseStream::IBaseStream(const Config* config, IStreamClient* client, SharedStreamStruct* stats)
     : common::IMetaClassInfo(),
       client_(client),
       config_(config),
@@ -191,6 +224,18 @@ void IBaseStream::LinkInputPad(GstPad* pad, element_id_t id) {
   probe_in_.push_back(probe);
 }
 
+void IBaseStream::UnLinkInputPad(element_id_t id) {
+  for (auto it = probe_in_.begin(); it != probe_in_.end();) {
+    Probe* probe = *it;
+    if (probe->GetID() == id) {
+      delete probe;
+      it = probe_in_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void IBaseStream::LinkOutputPad(GstPad* pad, element_id_t id) {
   Probe* probe = new Probe(PROBE_OUT, id, this);
   probe->LinkPads(pad);
@@ -326,8 +371,7 @@ ExitStatus IBaseStream::Exec() {
   gst_object_unref(bus);
   SetStatus(INIT);
 
-  stats_->loop_start_time = common::time::current_utc_mstime();
-  ResetDataWait();
+  StartLoop();
 
   Play();
 
@@ -344,7 +388,7 @@ ExitStatus IBaseStream::Exec() {
   SetStatus(INIT);  // emulating loop statuses
   Stop();
 
-  stats_->restarts++;
+  stats_->IncreaseRestarts();
   PostExecCleanup();
   return last_exit_status_;
 }
@@ -373,9 +417,9 @@ void IBaseStream::RegisterAudioCaps(SupportedAudioCodec saudio, GstCaps* caps, e
     gint rate = 0, channels = 0;
     if (gst_structure_get_int(pad_struct, "rate", &rate) && gst_structure_get_int(pad_struct, "channels", &channels)) {
       common::media::DesireBytesPerSec kbps = common::media::CalculateDesireAudioBandwidthBytesPerSec(rate, channels);
-      common::media::DesireBytesPerSec prev = stats_->input[id].GetDesireBytesPerSecond();
+      common::media::DesireBytesPerSec prev = stats_->GetDesireBytesPerSecond(id);
       common::media::DesireBytesPerSec next = prev + kbps;
-      stats_->input[id].SetDesireBytesPerSecond(next);
+      stats_->SetDesireBytesPerSecond(id, next);
       desire_flags_ |= INITED_AUDIO;
     }
   }
@@ -394,8 +438,8 @@ void IBaseStream::RegisterVideoCaps(SupportedVideoCodec svideo, GstCaps* caps, e
       gint height = 0;
       if (gst_structure_get_int(pad_struct, "width", &width) && gst_structure_get_int(pad_struct, "height", &height)) {
         common::media::DesireBytesPerSec kbps = common::media::CalculateDesireMPEGBandwidthBytesPerSec(width, height);
-        common::media::DesireBytesPerSec prev = stats_->input[id].GetDesireBytesPerSecond();
-        stats_->input[id].SetDesireBytesPerSecond(prev + kbps);
+        common::media::DesireBytesPerSec prev = stats_->GetDesireBytesPerSecond(id);
+        stats_->SetDesireBytesPerSecond(id, prev + kbps);
         desire_flags_ |= INITED_VIDEO;
       }
     }
@@ -417,8 +461,8 @@ void IBaseStream::RegisterVideoCaps(SupportedVideoCodec svideo, GstCaps* caps, e
 
         common::media::DesireBytesPerSec kbps =
             common::media::CalculateDesireH264BandwidthBytesPerSec(width, height, framerate, profile);
-        common::media::DesireBytesPerSec prev = stats_->input[id].GetDesireBytesPerSecond();
-        stats_->input[id].SetDesireBytesPerSecond(prev + kbps);
+        common::media::DesireBytesPerSec prev = stats_->GetDesireBytesPerSecond(id);
+        stats_->SetDesireBytesPerSecond(id, prev + kbps);
         desire_flags_ |= INITED_VIDEO;
       }
     }
@@ -442,14 +486,13 @@ void IBaseStream::SetVideoInited(bool val) {
 }
 
 void IBaseStream::Restart() {
-  stats_->loop_start_time = common::time::current_utc_mstime();
-  ResetDataWait();
+  StartLoop();
 
   Pause();
   SetStatus(INIT);  // emulating loop statuses
   Play();
 
-  stats_->restarts++;
+  stats_->IncreaseRestarts();
 }
 
 void IBaseStream::Stop() {
@@ -469,6 +512,11 @@ void IBaseStream::Play() {
   }
 }
 
+void IBaseStream::StartLoop() {
+  no_data_panic_tick_ = GetElipsedTime() + no_data_panic_sec;  // update no_data_panic timestamp
+  stats_->StartLoop();
+}
+
 void IBaseStream::ResetDataWait() {
   no_data_panic_tick_ = GetElipsedTime() + no_data_panic_sec;  // update no_data_panic timestamp
   stats_->ResetDataWait();
@@ -484,7 +532,7 @@ void IBaseStream::Quit(ExitStatus status) {
   }
 }
 
-StreamStruct* IBaseStream::GetStats() const {
+SharedStreamStruct* IBaseStream::GetStats() const {
   return stats_;
 }
 
@@ -493,6 +541,18 @@ time_t IBaseStream::GetElipsedTime() const {
   return (current_time - stats_->start_time) / 1000;
 }
 
+GstClockTime IBaseStream::GetRunningTime() const {
+  GstClock* clock = gst_element_get_clock(pipeline_);
+  if (!clock) {
+    return GST_CLOCK_TIME_NONE;
+  }
+
+  const GstClockTime now = gst_clock_get_time(clock);
+  gst_object_unref(clock);
+  const GstClockTime base_time = gst_element_get_base_time(pipeline_);
+  return now > base_time ? now - base_time : 0;
+}
+
 StreamType IBaseStream::GetType() const {
   return stats_->type;
 }
@@ -537,26 +597,40 @@ void IBaseStream::OnInputDataFailed() {
 
 void IBaseStream::OnInputDataOK() {}
 
+bool IBaseStream::IsActiveInput(element_id_t id) const {
+  UNUSED(id);
+  return true;
+}
+
+bool IBaseStream::SwitchToStandbyInput() {
+  return false;
+}
+
+bool IBaseStream::RestartInputSource() {
+  return false;
+}
+
 gboolean IBaseStream::HandleMainTimerTick() {
   const time_t up_time = GetElipsedTime();
   const size_t diff = (no_data_panic_sec - no_data_panic_tick_ + up_time) + 1;
 
+  stats_->UpdateBps(diff);
+
   size_t checkpoint_diff_in_total = 0;
   common::media::DesireBytesPerSec checkpoint_desire_in_total;
-  size_t input_stream_count = stats_->input.size();
+  size_t input_stream_count = stats_->GetInputCount();
   for (size_t i = 0; i < input_stream_count; ++i) {
-    size_t checkpoint_diff_out_stream = stats_->input[i].GetDiffTotalBytes();
-    stats_->input[i].UpdateBps(diff);
-    checkpoint_diff_in_total += checkpoint_diff_out_stream;
-    checkpoint_desire_in_total += stats_->input[i].GetDesireBytesPerSecond();
+    if (!IsActiveInput(i)) {
+      continue;
+    }
+    checkpoint_diff_in_total += stats_->GetInput(i)->GetDiffTotalBytes();
+    checkpoint_desire_in_total += stats_->GetDesireBytesPerSecond(i);
   }
 
   size_t checkpoint_diff_out_total = 0;
-  size_t output_stream_count = stats_->output.size();
+  size_t output_stream_count = stats_->GetOutputCount();
   for (size_t i = 0; i < output_stream_count; ++i) {
-    size_t checkpoint_diff_out_stream = stats_->output[i].GetDiffTotalBytes();
-    stats_->output[i].UpdateBps(diff);
-    checkpoint_diff_out_total += checkpoint_diff_out_stream;
+    checkpoint_diff_out_total += stats_->GetOutput(i)->GetDiffTotalBytes();
   }
 
   if (up_time > no_data_panic_tick_) {  // check is stream in noraml state
@@ -566,25 +640,29 @@ gboolean IBaseStream::HandleMainTimerTick() {
                 << count_out_eos << "/" << output_stream_count << "), received bytes " << checkpoint_diff_in_total
                 << ", sended bytes " << checkpoint_diff_out_total;
     bool is_input_failed = checkpoint_diff_in_total < MIN_IN_DATA;
-    if (is_input_failed) {
-      OnInputDataFailed();
+    if (is_input_failed && (SwitchToStandbyInput() || RestartInputSource())) {  // outputs starved with failed input
+      ResetDataWait();
     } else {
-      OnInputDataOK();
-    }
+      if (is_input_failed) {
+        OnInputDataFailed();
+      } else {
+        OnInputDataOK();
+      }
 
-    if (checkpoint_desire_in_total.IsValid() && desire_flags_ != INITED_NOTHING) {
-      size_t in_bytes_per_sec = (checkpoint_diff_in_total / diff);
-      if (!checkpoint_desire_in_total.InRange(in_bytes_per_sec)) {
-        NOTICE_LOG() << "Input bandwidth not in range of desire speed " << checkpoint_desire_in_total.min
-                     << " <= " << in_bytes_per_sec << " <= " << checkpoint_desire_in_total.max;
+      if (checkpoint_desire_in_total.IsValid() && desire_flags_ != INITED_NOTHING) {
+        size_t in_bytes_per_sec = (checkpoint_diff_in_total / diff);
+        if (!checkpoint_desire_in_total.InRange(in_bytes_per_sec)) {
+          NOTICE_LOG() << "Input bandwidth not in range of desire speed " << checkpoint_desire_in_total.min
+                       << " <= " << in_bytes_per_sec << " <= " << checkpoint_desire_in_total.max;
+        }
       }
-    }
 
-    bool is_output_failed = checkpoint_diff_out_total < MIN_OUT_DATA;
-    if (is_output_failed) {
-      OnOutputDataFailed();
-    } else {
-      OnOutputDataOK();
+      bool is_output_failed = checkpoint_diff_out_total < MIN_OUT_DATA;
+      if (is_output_failed) {
+        OnOutputDataFailed();
+      } else {
+        OnOutputDataOK();
+      }
     }
   }
 
@@ -621,7 +699,10 @@ gboolean IBaseStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* mes
       common::uri::Url input_url = input[i].GetInput();
       if (input_url.GetScheme() == common::uri::Url::http) {
         GstBaseSrc* basesrc = reinterpret_cast<GstBaseSrc*>(src);
-        UpdateStats(probe_in_[i], basesrc->segment.duration);
+        SharedChannelStats* channel = probe_in_[i]->GetChannel();
+        if (channel) {
+          channel->AddTotalBytes(basesrc->segment.duration);
+        }
       }
     }
   } else if (type == GST_MESSAGE_STATE_CHANGED) {
@@ -637,6 +718,22 @@ gboolean IBaseStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* mes
         SetStatus(PLAYING);
       }
     }
+  } else if (type == GST_MESSAGE_ELEMENT) {
+    const GstStructure* info = gst_message_get_structure(message);
+    guint64 id = 0;
+    if (gst_structure_has_name(info, UDP_SRC_STATS_MESSAGE) &&
+        gst_structure_get_uint64(info, UDP_SRC_STATS_INPUT_FIELD, &id) && id < stats_->GetInputCount()) {
+      guint64 kernel_drops = 0;
+      guint64 cc_errors = 0;
+      gst_structure_get_uint64(info, UDP_SRC_STATS_KERNEL_DROPS_FIELD, &kernel_drops);
+      gst_structure_get_uint64(info, UDP_SRC_STATS_CC_ERRORS_FIELD, &cc_errors);
+      SharedChannelStats* channel = stats_->GetInput(id);
+      channel->AddKernelDrops(kernel_drops);
+      channel->AddContinuityErrors(cc_errors);
+      if (kernel_drops) {
+        WARNING_LOG() << "Input " << id << " socket dropped " << kernel_drops << " datagrams";
+      }
+    }
   } else if (type == GST_MESSAGE_EOS) {
     WARNING_LOG() << " Received end of stream: " << GST_OBJECT_NAME(src);
     if (client_) {
@@ -652,7 +749,7 @@ gboolean IBaseStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* mes
 }
 
 void IBaseStream::SetStatus(StreamStatus status) {
-  stats_->status = status;
+  stats_->SetStatus(status);
   INFO_LOG() << "Changing status to: " << common::ConvertToString(status);
   if (client_) {
     client_->OnStatusChanged(this, status);
@@ -660,7 +757,7 @@ void IBaseStream::SetStatus(StreamStatus status) {
 }
 
 bool IBaseStream::IsActive() const {
-  return stats_->status != INIT;
+  return stats_->GetStatus() != INIT;
 }
 
 bool IBaseStream::IsVod() const {
@@ -684,6 +781,23 @@ elements::Element* IBaseStream::GetElementByName(const std::string& name) const
   return nullptr;
 }
 
+void IBaseStream::AddElement(elements::Element* elem) {
+  bool res = gst_bin_add(GST_BIN(pipeline_), elem->GetGstElement());
+  CHECK(res) << "Can't added " << elem->GetPluginName();
+  pipeline_elements_.push_back(elem);
+}
+
+void IBaseStream::RemoveElement(elements::Element* elem) {
+  GstElement* element = elem->GetGstElement();
+  pipeline_elements_.erase(std::remove(pipeline_elements_.begin(), pipeline_elements_.end(), elem),
+                           pipeline_elements_.end());
+  delete elem;  // disconnect signals while element alive
+
+  gst_element_set_state(element, GST_STATE_NULL);
+  bool res = gst_bin_remove(GST_BIN(pipeline_), element);  // also unlinks pads
+  CHECK(res);
+}
+
 void IBaseStream::HandleBufferingMessage(GstMessage* message) {
   UNUSED(message);
 }
@@ -729,20 +843,6 @@ gboolean IBaseStream::main_timer_callback(gpointer user_data) {
   return res;
 }
 
-void IBaseStream::UpdateStats(const Probe* probe, gsize size) {
-  if (probe->GetName() == PROBE_IN) {
-    if (probe->GetID() < stats_->input.size()) {
-      const size_t prev_total = stats_->input[probe->GetID()].GetTotalBytes();
-      stats_->input[probe->GetID()].SetTotalBytes(prev_total + size);
-    }
-  } else if (probe->GetName() == PROBE_OUT) {
-    if (probe->GetID() < stats_->output.size()) {
-      const size_t prev_total = stats_->output[probe->GetID()].GetTotalBytes();
-      stats_->output[probe->GetID()].SetTotalBytes(prev_total + size);
-    }
-  }
-}
-
 const Config* IBaseStream::GetConfig() const {
   return config_;
 }
@@ -24,7 +24,7 @@
 
 #include "base/input_uri.h"
 
-#include "base/stream_struct.h"  // for StreamStatus, StreamStruct (ptr only)
+#include "base/shared_stream_struct.h"  // for StreamStatus, SharedStreamStruct (ptr only)
 #include "stream/gst_types.h"
 #include "stream/ibase_builder_observer.h"
 
@@ -37,6 +37,7 @@ class Config;
 
 enum ExitStatus { EXIT_SELF, EXIT_INNER };
 
+void streams_preinit();  // load gstreamer and plugins registry once, before forking streams
 void streams_init(int argc, char** argv, EncoderType enc = CPU);
 void streams_deinit();
 
@@ -66,7 +67,7 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   };
 
   // channel_id_t not empty
-  IBaseStream(const Config* config, IStreamClient* client, StreamStruct* stats);
+  IBaseStream(const Config* config, IStreamClient* client, SharedStreamStruct* stats);
   const char* ClassName() const override;
   ~IBaseStream() override;
 
@@ -76,9 +77,10 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   bool IsLive() const;
 
   void Quit(ExitStatus status);
-  StreamStruct* GetStats() const;
+  SharedStreamStruct* GetStats() const;
 
   time_t GetElipsedTime() const;  // stream life time sec
+  GstClockTime GetRunningTime() const;  // pipeline clock running time, GST_CLOCK_TIME_NONE without clock
 
   StreamType GetType() const;
 
@@ -91,11 +93,10 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   virtual GstPadProbeInfo* CheckProbeData(Probe* probe, GstPadProbeInfo* buff);
   virtual GstPadProbeInfo* CheckProbeDataOutput(Probe* probe, GstPadProbeInfo* buff);
 
-  void UpdateStats(const Probe* probe, gsize size);
-
   const Config* GetConfig() const;
 
   void LinkInputPad(GstPad* pad, element_id_t id);
+  void UnLinkInputPad(element_id_t id);  // drops input probes of id, stats are kept
   void LinkOutputPad(GstPad* pad, element_id_t id);
 
   size_t CountInputEOS() const;
@@ -105,6 +106,9 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
 
  protected:
   elements::Element* GetElementByName(const std::string& name) const;
+  // runtime pipeline changes, main loop only
+  void AddElement(elements::Element* elem);     // pipeline takes ownership, caller syncs state after linking
+  void RemoveElement(elements::Element* elem);  // stops, unlinks and deletes element
 
   bool IsAudioInited() const;
   bool IsVideoInited() const;
@@ -134,6 +138,13 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   virtual void OnInputDataFailed();
   virtual void OnInputDataOK();
 
+  // hot standby, only active inputs are checked for data, failed input can be replaced without restart
+  virtual bool IsActiveInput(element_id_t id) const;
+  virtual bool SwitchToStandbyInput();
+  // rebuilds failed source in place, rest of pipeline keeps playing
+  virtual bool RestartInputSource();
+  void ResetDataWait();
+
   virtual void OnOutputDataFailed();
   virtual void OnOutputDataOK();
 
@@ -158,7 +169,7 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   bool InitPipeLine();
   void ClearOutProbes();
   void ClearInProbes();
-  void ResetDataWait();
+  void StartLoop();
 
   static GstBusSyncReply sync_bus_callback(GstBus* bus, GstMessage* message, gpointer user_data);
   static gboolean main_timer_callback(gpointer user_data);
@@ -172,7 +183,7 @@ class IBaseStream : public common::IMetaClassInfo, public IBaseBuilderObserver {
   time_t status_tick_;
   time_t no_data_panic_tick_;
 
-  StreamStruct* const stats_;
+  SharedStreamStruct* const stats_;
 
   ExitStatus last_exit_status_;
   bool is_live_;
@@ -0,0 +1,195 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/playlist_feeder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+namespace iptv_cloud {
+namespace stream {
+
+// Shared by feeder and all buffers wrapping it.
+struct PlaylistFileMapping {
+  PlaylistFileMapping(void* data, size_t size) : data(data), size(size), refs(1) {}
+
+  void* const data;
+  const size_t size;
+  std::atomic<int> refs;
+};
+
+namespace {
+size_t round_to_pages(size_t size) {
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  if (size < page_size) {
+    return page_size;
+  }
+  return (size + page_size - 1) / page_size * page_size;
+}
+
+void unref_mapping(gpointer user_data) {
+  PlaylistFileMapping* mapping = static_cast<PlaylistFileMapping*>(user_data);
+  if (mapping->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  munmap(mapping->data, mapping->size);
+  delete mapping;
+}
+}  // namespace
+
+PlaylistFileFeeder::PlaylistFileFeeder(size_t block_size, bool zero_copy)
+    : block_size_(round_to_pages(block_size)),
+      zero_copy_(zero_copy),
+      fd_(INVALID_DESCRIPTOR),
+      file_size_(0),
+      offset_(0),
+      mapping_(nullptr) {}
+
+PlaylistFileFeeder::~PlaylistFileFeeder() {
+  Close();
+}
+
+common::ErrnoError PlaylistFileFeeder::Open(const std::string& path) {
+  Close();
+
+  descriptor_t fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) < 0) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);  // bigger kernel readahead window
+  fd_ = fd;
+  file_size_ = sb.st_size;
+  offset_ = 0;
+  if (file_size_ == 0) {
+    return common::ErrnoError();
+  }
+
+  if (zero_copy_) {
+    void* data = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      madvise(data, file_size_, MADV_SEQUENTIAL);  // pages behind read position can be dropped early
+      mapping_ = new PlaylistFileMapping(data, file_size_);
+    }
+  }
+  Prefetch(0);
+  return common::ErrnoError();
+}
+
+bool PlaylistFileFeeder::IsOpen() const {
+  return fd_ != INVALID_DESCRIPTOR;
+}
+
+void PlaylistFileFeeder::Close() {
+  if (mapping_) {
+    unref_mapping(mapping_);
+    mapping_ = nullptr;
+  }
+
+  if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+    fd_ = INVALID_DESCRIPTOR;
+  }
+  file_size_ = 0;
+  offset_ = 0;
+}
+
+size_t PlaylistFileFeeder::GetBlockSize() const {
+  return block_size_;
+}
+
+GstBuffer* PlaylistFileFeeder::ReadBuffer() {
+  if (!IsOpen() || offset_ >= file_size_) {
+    return nullptr;
+  }
+
+  const bool first = offset_ == 0;
+  GstBuffer* buffer = mapping_ ? ReadMappedBuffer() : ReadCopyBuffer();
+  if (!buffer) {
+    return nullptr;
+  }
+
+  if (first) {
+    GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+  }
+  GST_BUFFER_OFFSET(buffer) = offset_ - gst_buffer_get_size(buffer);
+  GST_BUFFER_OFFSET_END(buffer) = offset_;
+  Prefetch(offset_);
+  return buffer;
+}
+
+GstBuffer* PlaylistFileFeeder::ReadMappedBuffer() {
+  const uint64_t offset = offset_;
+  const size_t size = std::min<uint64_t>(block_size_, file_size_ - offset);
+  mapping_->refs.fetch_add(1, std::memory_order_relaxed);
+  offset_ += size;
+  return gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, mapping_->data, mapping_->size, offset, size,
+                                     mapping_, unref_mapping);
+}
+
+GstBuffer* PlaylistFileFeeder::ReadCopyBuffer() {
+  const size_t size = std::min<uint64_t>(block_size_, file_size_ - offset_);
+  gpointer data = g_malloc(size);
+  size_t readed = 0;
+  while (readed < size) {
+    ssize_t res = pread(fd_, static_cast<char*>(data) + readed, size - readed, offset_ + readed);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {  // truncated while playing
+      break;
+    }
+    readed += res;
+  }
+
+  if (readed == 0) {
+    g_free(data);
+    offset_ = file_size_;
+    return nullptr;
+  }
+
+  offset_ += readed;
+  return gst_buffer_new_wrapped(data, readed);
+}
+
+void PlaylistFileFeeder::Prefetch(uint64_t offset) {
+  if (offset >= file_size_) {
+    return;
+  }
+
+  const size_t size = std::min<uint64_t>(block_size_, file_size_ - offset);
+  if (mapping_) {
+    madvise(static_cast<char*>(mapping_->data) + offset, size, MADV_WILLNEED);  // offset is multiple of pages
+  } else {
+    posix_fadvise(fd_, offset, size, POSIX_FADV_WILLNEED);
+  }
+}
+
+}  // namespace stream
+}  // namespace iptv_cloud
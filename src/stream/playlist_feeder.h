@@ -0,0 +1,65 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <gst/gstbuffer.h>
+
+#include <string>
+
+#include <common/error.h>
+#include <common/types.h>
+
+namespace iptv_cloud {
+namespace stream {
+
+struct PlaylistFileMapping;
+
+// Reads playlist file for appsrc by big blocks instead of small fread copies. Blocks are read into allocated
+// buffers by default. In zero copy mode file is mmapped and blocks are wrapped into buffers, mapping lives
+// until last buffer is released; file truncated or rewritten in place while mapped kills process by SIGBUS,
+// so zero copy is only for files which are replaced by rename. If file can't be mapped blocks are read.
+// Kernel is asked to read ahead, next block is prefetched.
+class PlaylistFileFeeder {
+ public:
+  PlaylistFileFeeder(size_t block_size, bool zero_copy);  // block size is rounded up to pages
+  ~PlaylistFileFeeder();
+
+  common::ErrnoError Open(const std::string& path) WARN_UNUSED_RESULT;
+  bool IsOpen() const;
+  void Close();
+
+  size_t GetBlockSize() const;
+
+  // next block, first block of file is marked DISCONT, so downstream resyncs on file change;
+  // nullptr at end of file or on read error
+  GstBuffer* ReadBuffer();
+
+ private:
+  GstBuffer* ReadMappedBuffer();
+  GstBuffer* ReadCopyBuffer();
+  void Prefetch(uint64_t offset);
+
+  const size_t block_size_;
+  const bool zero_copy_;
+  descriptor_t fd_;
+  uint64_t file_size_;
+  uint64_t offset_;               // of next block
+  PlaylistFileMapping* mapping_;  // nullptr if blocks are read
+
+  DISALLOW_COPY_AND_ASSIGN(PlaylistFileFeeder);
+};
+
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -14,11 +14,50 @@
 
 #include "stream/probes.h"
 
+#include "base/shared_stream_struct.h"
+
 #include "stream/ibase_stream.h"
 
 namespace iptv_cloud {
 namespace stream {
 
+#define INGEST_TIMESTAMP_CAPS "timestamp/x-iptv-ingest"
+
+namespace {
+#if GST_CHECK_VERSION(1, 14, 0)
+GstCaps* GetIngestCaps() {
+  static GstStaticCaps ingest_caps = GST_STATIC_CAPS(INGEST_TIMESTAMP_CAPS);
+  static GstCaps* caps = gst_static_caps_get(&ingest_caps);  // metas are matched by caps pointer
+  return caps;
+}
+
+GstReferenceTimestampMeta* FindIngestMeta(GstBuffer* buffer) {
+  GstCaps* caps = GetIngestCaps();
+  gpointer state = nullptr;
+  GstMeta* meta = nullptr;
+  while ((meta = gst_buffer_iterate_meta_filtered(buffer, &state, GST_REFERENCE_TIMESTAMP_META_API_TYPE))) {
+    GstReferenceTimestampMeta* ref_meta = reinterpret_cast<GstReferenceTimestampMeta*>(meta);
+    if (ref_meta->reference == caps) {
+      return ref_meta;
+    }
+  }
+
+  return nullptr;
+}
+#endif
+
+SharedChannelStats* FindChannel(const std::string& name, element_id_t id, IBaseStream* stream) {
+  SharedStreamStruct* stats = stream->GetStats();
+  if (name == PROBE_IN) {
+    return stats->GetInput(id);
+  } else if (name == PROBE_OUT) {
+    return stats->GetOutput(id);
+  }
+
+  return nullptr;
+}
+}  // namespace
+
 Consistency::Consistency()
     : segment(FALSE),
       eos(TRUE),
@@ -28,8 +67,17 @@ Consistency::Consistency()
       saw_serialized_event(FALSE) {}
 
 Probe::Probe(const std::string& name, element_id_t id, IBaseStream* stream)
-    : stream_(stream), name_(name), id_(id), id_buffer_(0), pad_(nullptr), consistency_() {
+    : stream_(stream),
+      name_(name),
+      id_(id),
+      id_buffer_(0),
+      pad_(nullptr),
+      consistency_(),
+      channel_(FindChannel(name, id, stream)),
+      last_arrival_(0),
+      segment_() {
   CHECK(stream);
+  gst_segment_init(&segment_, GST_FORMAT_UNDEFINED);
 }
 
 Probe::~Probe() {
@@ -98,6 +146,57 @@ GstPad* Probe::GetPad() const {
   return pad_;
 }
 
+SharedChannelStats* Probe::GetChannel() const {
+  return channel_;
+}
+
+void Probe::UpdateArrival() {
+  const gint64 arrival = g_get_monotonic_time();  // intervals must not jump with wall clock steps
+  channel_->AddArrival(g_get_real_time(), last_arrival_ ? arrival - last_arrival_ : -1);
+  last_arrival_ = arrival;
+}
+
+void Probe::StampIngest(GstPadProbeInfo* info) {
+#if GST_CHECK_VERSION(1, 14, 0)
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (FindIngestMeta(buffer)) {  // already stamped by previous input probe
+    return;
+  }
+
+  buffer = gst_buffer_make_writable(buffer);
+  gst_buffer_add_reference_timestamp_meta(buffer, GetIngestCaps(), g_get_monotonic_time() * GST_USECOND,
+                                          GST_CLOCK_TIME_NONE);
+  GST_PAD_PROBE_INFO_DATA(info) = buffer;
+#else
+  UNUSED(info);
+#endif
+}
+
+void Probe::UpdateLatency(GstBuffer* buffer) const {
+  GstClockTime ingest = GST_CLOCK_TIME_NONE;
+  GstClockTime now = GST_CLOCK_TIME_NONE;
+#if GST_CHECK_VERSION(1, 14, 0)
+  GstReferenceTimestampMeta* meta = FindIngestMeta(buffer);
+  if (meta) {
+    ingest = meta->timestamp;
+    now = g_get_monotonic_time() * GST_USECOND;
+  }
+#endif
+  // muxers and demuxers make new buffers without meta, for live inputs
+  // running time of buffer timestamp is the time it was captured
+  if (!GST_CLOCK_TIME_IS_VALID(ingest) && segment_.format == GST_FORMAT_TIME && GST_BUFFER_PTS_IS_VALID(buffer)) {
+    ingest = gst_segment_to_running_time(&segment_, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+    now = stream_->GetRunningTime();
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID(ingest) || !GST_CLOCK_TIME_IS_VALID(now)) {
+    return;
+  }
+
+  const GstClockTime latency = now > ingest ? now - ingest : 0;
+  channel_->AddLatency(GST_TIME_AS_MSECONDS(latency));
+}
+
 Consistency Probe::GetConsistency() const {
   return consistency_;
 }
@@ -117,8 +216,12 @@ GstPadProbeReturn Probe::source_callback_probe_buffer(GstPad* pad, GstPadProbeIn
 
   void* data = GST_PAD_PROBE_INFO_DATA(checked_info);
   if (GST_IS_BUFFER(data)) {
-    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
-    stream->UpdateStats(probe, gst_buffer_get_size(buffer));
+    if (probe->channel_) {
+      GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
+      probe->channel_->AddBuffer(gst_buffer_get_size(buffer));
+      probe->UpdateArrival();
+    }
+    probe->StampIngest(checked_info);
   } else if (GST_IS_EVENT(data)) {
     GstEvent* event = GST_EVENT(data);
     const gchar* event_name = GST_EVENT_TYPE_NAME(event);
@@ -209,14 +312,22 @@ GstPadProbeReturn Probe::sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo
 
   void* data = GST_PAD_PROBE_INFO_DATA(checked_info);
   if (GST_IS_BUFFER(data)) {
-    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
-    stream->UpdateStats(probe, gst_buffer_get_size(buffer));
+    if (probe->channel_) {
+      GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(checked_info);
+      probe->channel_->AddBuffer(gst_buffer_get_size(buffer));
+      probe->UpdateArrival();
+      probe->UpdateLatency(buffer);
+    }
   } else if (GST_IS_BUFFER_LIST(data)) {
     GstBufferList* buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST(checked_info);
     guint len = gst_buffer_list_length(buffer_list);
-    for (guint i = 0; i < len; ++i) {
-      GstBuffer* buffer = gst_buffer_list_get(buffer_list, i);
-      stream->UpdateStats(probe, gst_buffer_get_size(buffer));
+    if (probe->channel_ && len) {  // list is a single arrival
+      for (guint i = 0; i < len; ++i) {
+        GstBuffer* buffer = gst_buffer_list_get(buffer_list, i);
+        probe->channel_->AddBuffer(gst_buffer_get_size(buffer));
+      }
+      probe->UpdateArrival();
+      probe->UpdateLatency(gst_buffer_list_get(buffer_list, 0));
     }
   } else if (GST_IS_EVENT(data)) {
     GstEvent* event = GST_EVENT(data);
@@ -245,6 +356,7 @@ GstPadProbeReturn Probe::sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo
       if (probe->consistency_.expect_flush && probe->consistency_.flushing) {
         INFO_LOG() << "Received SEGMENT while in a flushing seek on pad " << pad;
       }
+      gst_event_copy_segment(event, &probe->segment_);
       probe->consistency_.segment = TRUE;
       probe->consistency_.eos = FALSE;
     } else if (event_type == GST_EVENT_EOS) {
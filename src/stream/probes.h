@@ -26,6 +26,7 @@
 #define PROBE_OUT "out"
 
 namespace iptv_cloud {
+struct SharedChannelStats;
 namespace stream {
 
 class IBaseStream;
@@ -53,6 +54,7 @@ class Probe {
 
   GstPad* GetPad() const;
   Consistency GetConsistency() const;
+  SharedChannelStats* GetChannel() const;  // nullptr if stats has no slot for probe
 
  private:
   static GstPadProbeReturn sink_callback_probe_buffer(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
@@ -62,6 +64,9 @@ class Probe {
   void Link(GstPad* pad);
   void Clear();
   void ClearInner();
+  void UpdateArrival();
+  void StampIngest(GstPadProbeInfo* info);     // source pads, buffer is replaced if it was not writable
+  void UpdateLatency(GstBuffer* buffer) const;  // sink pads
 
   IBaseStream* const stream_;
 
@@ -71,6 +76,10 @@ class Probe {
   GstPad* pad_;
   Consistency consistency_;
 
+  SharedChannelStats* const channel_;  // resolved once, buffers are counted from streaming thread
+  gint64 last_arrival_;                // monotonic usec, streaming thread only
+  GstSegment segment_;                 // last segment on sink pad, streaming thread only
+
   DISALLOW_COPY_AND_ASSIGN(Probe);
 };
 
@@ -29,6 +29,7 @@
 
 #include "protocol/protocol.h"
 
+#include "stream/catchup_cut.h"
 #include "stream/configs_factory.h"
 #include "stream/ibase_stream.h"
 #include "stream/probes.h"
@@ -37,7 +38,6 @@
 
 #include "stream_commands_info/changed_sources_info.h"
 #include "stream_commands_info/restart_info.h"
-#include "stream_commands_info/statistic_info.h"
 #include "stream_commands_info/stop_info.h"
 
 #include "utils/arg_converter.h"
@@ -65,30 +65,25 @@ TimeShiftInfo make_timeshift_info(const utils::ArgsMap& args) {
   if (utils::ArgsGetValue(args, TIMESHIFT_DELAY_FIELD, &timeshift_delay)) {
     tinfo.timeshift_delay = timeshift_delay;
   }
-  return tinfo;
-}
 
-bool PrepareStatus(StreamStruct* stats, double cpu_load, std::string* status_out) {
-  if (!stats || !status_out) {
-    return false;
+  int timeshift_ring_size = 0;
+  if (utils::ArgsGetValue(args, TIMESHIFT_RING_SIZE_FIELD, &timeshift_ring_size) && timeshift_ring_size > 0) {
+    tinfo.timeshift_ring_size = static_cast<uint64_t>(timeshift_ring_size) * 1024 * 1024;
   }
 
-  if (isnan(cpu_load) || isinf(cpu_load)) {  // stable double
-    cpu_load = 0.0;
+  std::string catchup_archive_dir;
+  if (utils::ArgsGetValue(args, CATCHUP_ARCHIVE_DIR_FIELD, &catchup_archive_dir)) {
+    tinfo.catchup_archive_dir = common::file_system::ascii_directory_string_path(catchup_archive_dir);
   }
 
-  long rss = common::system_info::GetProcessRss(getpid());
-  const fastotv::timestamp_t current_time = common::time::current_utc_mstime();
-  StatisticInfo sinf(*stats, cpu_load, rss * 1024, current_time);
-
-  std::string out;
-  common::Error err = sinf.SerializeToString(&out);
-  if (err) {
-    return false;
+  time_t catchup_time = 0;
+  if (utils::ArgsGetValue(args, CATCHUP_START_FIELD, &catchup_time)) {
+    tinfo.catchup_start = catchup_time;
   }
-
-  *status_out = out;
-  return true;
+  if (utils::ArgsGetValue(args, CATCHUP_STOP_FIELD, &catchup_time)) {
+    tinfo.catchup_stop = catchup_time;
+  }
+  return tinfo;
 }
 
 class StreamServer : public common::libev::IoLoop {
@@ -96,7 +91,7 @@ class StreamServer : public common::libev::IoLoop {
   typedef common::libev::IoLoop base_class;
   explicit StreamServer(common::libev::IoClient* command_client, common::libev::IoLoopObserver* observer = nullptr)
       : base_class(new common::libev::LibEvLoop, observer),
-        command_client_(static_cast<protocol::protocol_client_t*>(command_client)) {
+        command_client_(static_cast<protocol::pipe_client_t*>(command_client)) {
     CHECK(command_client);
   }
 
@@ -105,6 +100,18 @@ class StreamServer : public common::libev::IoLoop {
     ExecInLoopThread(cb);
   }
 
+  void WriteMessage(const protocol::PipeMessage& msg) {
+    auto cb = [this, msg] {
+      common::ErrnoError err = command_client_->WriteMessage(msg);
+      if (err) {
+        DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+      }
+    };
+    ExecInLoopThread(cb);
+  }
+
+  bool IsBinaryPipeProtocol() const { return command_client_->IsBinaryPipeProtocol(); }
+
   const char* ClassName() const override { return "StreamServer"; }
 
   common::libev::IoChild* CreateChild() override {
@@ -129,14 +136,14 @@ class StreamServer : public common::libev::IoLoop {
   }
 
  private:
-  protocol::protocol_client_t* const command_client_;
+  protocol::pipe_client_t* const command_client_;
 };
 
 }  // namespace
 
 StreamController::StreamController(const std::string& feedback_dir,
                                    common::libev::IoClient* command_client,
-                                   StreamStruct* mem)
+                                   SharedStreamStruct* mem)
     : IBaseStream::IStreamClient(),
       feedback_dir_(feedback_dir),
       config_(nullptr),
@@ -198,20 +205,24 @@ int StreamController::Exec() {
   });
   libev_started_.Wait();
 
+  if (config_->GetType() == CATCHUP && timeshift_info_.catchup_archive_dir.IsValid()) {
+    ExecCatchupCut();
+    return EXIT_SUCCESS;
+  }
+
   while (!stop_) {
     chunk_index_t start_chunk_index = invalid_chunk_index;
     if (config_->GetType() == TIMESHIFT_PLAYER) {  // if timeshift player or cathcup player
       const streams::TimeshiftConfig* tconfig = static_cast<const streams::TimeshiftConfig*>(config_);
       time_t timeshift_chunk_duration = tconfig->GetTimeShiftChunkDuration();
       while (!timeshift_info_.FindChunkToPlay(timeshift_chunk_duration, &start_chunk_index)) {
-        mem_->status = WAITING;
-        DumpStreamStatus(mem_);
+        mem_->SetStatus(WAITING);
 
         {
           std::unique_lock<std::mutex> lock(stop_mutex_);
           std::cv_status interrupt_status = stop_cond_.wait_for(lock, std::chrono::seconds(timeshift_chunk_duration));
           if (interrupt_status == std::cv_status::no_timeout) {  // if notify
-            mem_->restarts++;
+            mem_->IncreaseRestarts();
             break;
           }
         }
@@ -260,14 +271,13 @@ int StreamController::Exec() {
     size_t wait_time = 0;
     if (++restart_attempts_ == config_->GetMaxRestartAttempts()) {
       restart_attempts_ = 0;
-      mem_->status = FROZEN;
-      DumpStreamStatus(mem_);
+      mem_->SetStatus(FROZEN);
       wait_time = restart_after_frozen_sec;
     } else {
       wait_time = restart_attempts_ * (restart_after_frozen_sec / config_->GetMaxRestartAttempts());
     }
 
-    INFO_LOG() << "Automatically restarted after " << wait_time << " seconds, stream restarts: " << mem_->restarts
+    INFO_LOG() << "Automatically restarted after " << wait_time << " seconds, stream restarts: " << mem_->GetRestarts()
                << ", attempts: " << restart_attempts_;
 
     std::unique_lock<std::mutex> lock(stop_mutex_);
@@ -280,6 +290,40 @@ int StreamController::Exec() {
   return EXIT_SUCCESS;
 }
 
+void StreamController::ExecCatchupCut() {
+  const streams::TimeshiftConfig* tconfig = static_cast<const streams::TimeshiftConfig*>(config_);
+  const time_t chunk_duration = tconfig->GetTimeShiftChunkDuration();
+  const int64_t start_msec = timeshift_info_.catchup_start ? static_cast<int64_t>(timeshift_info_.catchup_start) * 1000
+                                                           : common::time::current_utc_mstime();
+  const int64_t stop_msec = static_cast<int64_t>(timeshift_info_.catchup_stop) * 1000;
+  const std::string archive_dir = timeshift_info_.catchup_archive_dir.GetPath();
+  CatchupCut cut(archive_dir, timeshift_info_.timshift_dir.GetPath(), start_msec, stop_msec);
+  INFO_LOG() << "Catchup is cut from archive " << archive_dir;
+  mem_->SetStatus(PLAYING);
+
+  while (true) {
+    bool finished = false;
+    common::ErrnoError err = cut.Update(&finished);
+    if (err) {
+      WARNING_LOG() << "Failed to update catchup from archive: " << err->GetDescription();
+    }
+    if (finished) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    if (stop_cond_.wait_for(lock, std::chrono::seconds(chunk_duration), [this] { return stop_; })) {
+      break;
+    }
+  }
+
+  common::ErrnoError err = cut.Finish();
+  if (err) {
+    WARNING_LOG() << "Failed to finish catchup from archive: " << err->GetDescription();
+  }
+  INFO_LOG() << "Catchup finished, chunks: " << cut.GetChunksCount();
+}
+
 void StreamController::Stop() {
   {
     std::unique_lock<std::mutex> lock(stop_mutex_);
@@ -332,8 +376,22 @@ void StreamController::Closed(common::libev::IoClient* client) {
 }
 
 common::ErrnoError StreamController::StreamDataRecived(common::libev::IoClient* client) {
+  protocol::pipe_client_t* pclient = static_cast<protocol::pipe_client_t*>(client);
+  if (pclient->IsBinaryPipeProtocol()) {
+    protocol::PipeMessage msg;
+    common::ErrnoError err = pclient->ReadMessage(&msg);
+    if (err) {
+      return err;
+    }
+
+    err = HandleMessage(pclient, msg);
+    if (err) {
+      DEBUG_MSG_ERROR(err, common::logging::LOG_LEVEL_ERR);
+    }
+    return common::ErrnoError();
+  }
+
   std::string input_command;
-  protocol::protocol_client_t* pclient = static_cast<protocol::protocol_client_t*>(client);
   common::ErrnoError err = pclient->ReadCommand(&input_command);
   if (err) {  // i don't want handle spam, command must be formated according
               // protocol
@@ -419,15 +477,35 @@ common::ErrnoError StreamController::HandleRequestCommand(common::libev::IoClien
   return common::ErrnoError();
 }
 
+common::ErrnoError StreamController::HandleMessage(common::libev::IoClient* client, const protocol::PipeMessage& msg) {
+  CHECK(loop_->IsLoopThread());
+  protocol::pipe_client_t* pclient = static_cast<protocol::pipe_client_t*>(client);
+  if (msg.IsRequest()) {
+    if (msg.command == protocol::PIPE_STOP_STREAM) {
+      common::ErrnoError err = pclient->WriteMessage(StopStreamPipeResponceSuccess(msg.seq));
+      Stop();
+      return err;
+    } else if (msg.command == protocol::PIPE_RESTART_STREAM) {
+      common::ErrnoError err = pclient->WriteMessage(RestartStreamPipeResponceSuccess(msg.seq));
+      Restart();
+      return err;
+    }
+  } else if (msg.IsResponse()) {
+    return common::ErrnoError();
+  }
+
+  WARNING_LOG() << "Received unknown command: " << protocol::PipeCommandToString(msg.command);
+  return common::ErrnoError();
+}
+
 common::ErrnoError StreamController::HandleResponceCommand(common::libev::IoClient* client,
                                                            protocol::response_t* resp) {
   CHECK(loop_->IsLoopThread());
 
-  protocol::protocol_client_t* pclient = static_cast<protocol::protocol_client_t*>(client);
+  protocol::pipe_client_t* pclient = static_cast<protocol::pipe_client_t*>(client);
   protocol::request_t req;
   if (pclient->PopRequestByID(resp->id, &req)) {
-    if (req.method == STATISTIC_STREAM) {
-    } else if (req.method == CHANGED_SOURCES_STREAM) {
+    if (req.method == CHANGED_SOURCES_STREAM) {
     } else {
       WARNING_LOG() << "HandleResponceStreamsCommand not handled command: " << req.method;
     }
@@ -443,7 +521,7 @@ protocol::sequance_id_t StreamController::NextRequestID() {
 common::ErrnoError StreamController::HandleRequestStopStream(common::libev::IoClient* client,
                                                              protocol::request_t* req) {
   CHECK(loop_->IsLoopThread());
-  protocol::protocol_client_t* pclient = static_cast<protocol::protocol_client_t*>(client);
+  protocol::pipe_client_t* pclient = static_cast<protocol::pipe_client_t*>(client);
   protocol::response_t resp = StopStreamResponceSuccess(req->id);
   pclient->WriteResponse(resp);
   Stop();
@@ -453,7 +531,7 @@ common::ErrnoError StreamController::HandleRequestStopStream(common::libev::IoCl
 common::ErrnoError StreamController::HandleRequestRestartStream(common::libev::IoClient* client,
                                                                 protocol::request_t* req) {
   CHECK(loop_->IsLoopThread());
-  protocol::protocol_client_t* pclient = static_cast<protocol::protocol_client_t*>(client);
+  protocol::pipe_client_t* pclient = static_cast<protocol::pipe_client_t*>(client);
   protocol::response_t resp = RestartStreamResponceSuccess(req->id);
   pclient->WriteResponse(resp);
   Restart();
@@ -473,8 +551,8 @@ void StreamController::RestartStream() {
 }
 
 void StreamController::OnStatusChanged(IBaseStream* stream, StreamStatus status) {
+  UNUSED(stream);
   UNUSED(status);
-  DumpStreamStatus(stream->GetStats());
 }
 
 GstPadProbeInfo* StreamController::OnCheckReveivedData(IBaseStream* stream, Probe* probe, GstPadProbeInfo* info) {
@@ -518,15 +596,21 @@ void StreamController::OnSyncMessageReceived(IBaseStream* stream, GstMessage* me
 }
 
 void StreamController::OnInputChanged(const InputUri& uri) {
-  ChangedSouresInfo ch(mem_->id, uri);
+  ChangedSouresInfo ch(mem_->GetID(), uri);
   std::string changed_json;
   common::Error err = ch.SerializeToString(&changed_json);
   if (err) {
     return;
   }
 
+  StreamServer* server = static_cast<StreamServer*>(loop_);
+  if (server->IsBinaryPipeProtocol()) {
+    server->WriteMessage(ChangedSourcesStreamPipeNotification(changed_json));
+    return;
+  }
+
   protocol::request_t req = ChangedSourcesStreamBroadcast(changed_json);
-  static_cast<StreamServer*>(loop_)->WriteRequest(req);
+  server->WriteRequest(req);
 }
 
 void StreamController::OnPipelineCreated(IBaseStream* stream) {
@@ -537,12 +621,15 @@ void StreamController::OnPipelineCreated(IBaseStream* stream) {
   }
 }
 
-void StreamController::DumpStreamStatus(StreamStruct* stat) {
-  std::string status_json;
-  if (PrepareStatus(stat, common::system_info::GetCpuLoad(getpid()), &status_json)) {
-    protocol::request_t req = StatisticStreamBroadcast(status_json);
-    static_cast<StreamServer*>(loop_)->WriteRequest(req);
+void StreamController::DumpStreamStatus(SharedStreamStruct* stat) {
+  double cpu_load = common::system_info::GetCpuLoad(getpid());
+  if (isnan(cpu_load) || isinf(cpu_load)) {  // stable double
+    cpu_load = 0.0;
   }
+
+  long rss = common::system_info::GetProcessRss(getpid());
+  stat->SetProcessStats(cpu_load, rss * 1024);  // daemon reads it from shared memory
+  stat->UpdateLatency();
 }
 
 }  // namespace stream
@@ -21,6 +21,7 @@
 #include <common/libev/io_loop_observer.h>
 #include <common/threads/barrier.h>
 
+#include "protocol/pipe_protocol.h"
 #include "protocol/types.h"
 #include "stream/ibase_stream.h"
 #include "stream/timeshift.h"
@@ -34,7 +35,7 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
  public:
   enum constants : uint32_t { restart_after_frozen_sec = 60 };
 
-  StreamController(const std::string& feedback_dir, common::libev::IoClient* command_client, StreamStruct* mem);
+  StreamController(const std::string& feedback_dir, common::libev::IoClient* command_client, SharedStreamStruct* mem);
 
   common::Error Init(const utils::ArgsMap& config_args);
 
@@ -47,10 +48,15 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
                                                   protocol::request_t* req) WARN_UNUSED_RESULT;
   virtual common::ErrnoError HandleResponceCommand(common::libev::IoClient* client,
                                                    protocol::response_t* resp) WARN_UNUSED_RESULT;
+  virtual common::ErrnoError HandleMessage(common::libev::IoClient* client,
+                                           const protocol::PipeMessage& msg) WARN_UNUSED_RESULT;
 
  private:
   protocol::sequance_id_t NextRequestID();
 
+  // catchup from archive of timeshift recorder, no pipeline, runs until window complete or stopped
+  void ExecCatchupCut();
+
   common::ErrnoError HandleRequestStopStream(common::libev::IoClient* client,
                                              protocol::request_t* req) WARN_UNUSED_RESULT;
   common::ErrnoError HandleRequestRestartStream(common::libev::IoClient* client,
@@ -92,7 +98,7 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
 
   common::ErrnoError SendResponceToParent(const std::string& cmd) WARN_UNUSED_RESULT;
 
-  void DumpStreamStatus(StreamStruct* stat);
+  void DumpStreamStatus(SharedStreamStruct* stat);
 
   const std::string feedback_dir_;
   const Config* config_;
@@ -108,7 +114,7 @@ class StreamController : public common::libev::IoLoopObserver, public IBaseStrea
   common::libev::timer_id_t ttl_master_timer_;
   common::threads::barrier libev_started_;
 
-  StreamStruct* mem_;
+  SharedStreamStruct* mem_;
 
   //
   IBaseStream* origin_;
@@ -27,6 +27,8 @@
 
 #include "base/config_fields.h"
 
+#include "protocol/protocol.h"
+
 #include "stream/stream_controller.h"
 
 #include "utils/arg_converter.h"
@@ -40,7 +42,7 @@ int start_stream(const std::string& process_name,
                  common::logging::LOG_LEVEL logs_level,
                  const iptv_cloud::utils::ArgsMap& config_args,
                  common::libev::IoClient* command_client,
-                 iptv_cloud::StreamStruct* mem) {
+                 iptv_cloud::SharedStreamStruct* mem) {
   const std::string logs_path = common::file_system::make_path(feedback_dir, LOGS_FILE_NAME);
   common::logging::INIT_LOGGER(process_name, logs_path, logs_level);  // initialization of logging system
   NOTICE_LOG() << "Running " PROJECT_VERSION_HUMAN;
@@ -60,6 +62,11 @@ int start_stream(const std::string& process_name,
 
 }  // namespace
 
+int stream_prepare() {
+  iptv_cloud::stream::streams_preinit();
+  return EXIT_SUCCESS;
+}
+
 int stream_exec(const char* process_name,
                 const cmd_args* args,
                 const void* config_args,
@@ -77,8 +84,14 @@ int stream_exec(const char* process_name,
     return EXIT_FAILURE;
   }
 
+  if (!iptv_cloud::protocol::IsValidPipeProtocol(args->pipe_protocol)) {
+    CRITICAL_LOG() << "Unsupported pipe protocol: " << args->pipe_protocol;
+    return EXIT_FAILURE;
+  }
+
   common::logging::LOG_LEVEL logs_level = static_cast<common::logging::LOG_LEVEL>(args->log_level);
-  common::libev::IoClient* client = static_cast<common::libev::IoClient*>(command_client);
-  iptv_cloud::StreamStruct* smem = static_cast<iptv_cloud::StreamStruct*>(mem);
+  iptv_cloud::protocol::pipe_client_t* client = static_cast<iptv_cloud::protocol::pipe_client_t*>(command_client);
+  client->SetPipeProtocol(static_cast<iptv_cloud::protocol::PipeProtocol>(args->pipe_protocol));
+  iptv_cloud::SharedStreamStruct* smem = static_cast<iptv_cloud::SharedStreamStruct*>(mem);
   return start_stream(process_name, feedback_dir_ptr, logs_level, *config_args_map, client, smem);
 }
@@ -16,6 +16,8 @@
 
 #include "stream/cmd_args.h"
 
+extern "C" int stream_prepare();
+
 extern "C" int stream_exec(const char* process_name,
                            const cmd_args* args,
                            const void* config_args,
@@ -19,24 +19,30 @@
 #include <common/sprintf.h>
 
 #include "base/constants.h"
+#include "base/gst_constants.h"
+#include "base/shared_stream_struct.h"
 
 #include "stream/elements/audio/audio.h"
 #include "stream/elements/encoders/audio_encoders.h"
 #include "stream/elements/encoders/video_encoders.h"
 #include "stream/elements/parser/audio_parsers.h"
 #include "stream/elements/parser/video_parsers.h"
+#include "stream/elements/sink/build_output.h"
 #include "stream/elements/sink/screen.h"
 #include "stream/elements/video/video.h"
 
+#include "stream/ibase_stream.h"
 #include "stream/pad/pad.h"
 
+#include "utils/m3u8_writer.h"
+
 namespace iptv_cloud {
 namespace stream {
 namespace streams {
 namespace builders {
 
 EncodingStreamBuilder::EncodingStreamBuilder(const EncodingConfig* api, SrcDecodeBinStream* observer)
-    : SrcDecodeStreamBuilder(api, observer) {}
+    : SrcDecodeStreamBuilder(api, observer), variant_tees_() {}
 
 Connector EncodingStreamBuilder::BuildPostProc(Connector conn) {
   const EncodingConfig* config = static_cast<const EncodingConfig*>(GetConfig());
@@ -91,24 +97,11 @@ SupportedAudioCodec EncodingStreamBuilder::GetAudioCodecType() const {
 Connector EncodingStreamBuilder::BuildConverter(Connector conn) {
   const EncodingConfig* config = static_cast<const EncodingConfig*>(GetConfig());
   if (config->HaveVideo()) {
-    elements_line_t video_encoder = BuildVideoConverter(0);
-    if (!video_encoder.empty()) {
-      ElementLink(conn.video, video_encoder.front());
-      conn.video = video_encoder.back();
-    }
-
-    const std::string vcodec = config->GetVideoEncoder();
-    if (elements::encoders::IsH264Encoder(vcodec)) {
-      elements::parser::ElementH264Parse* premux_parser = elements::parser::make_h264_parser(0);
-      ElementAdd(premux_parser);
-      ElementLink(conn.video, premux_parser);
-      conn.video = premux_parser;
+    if (config->GetAbrLadder().empty()) {
+      conn.video = BuildVideoEncoded(conn.video, BuildVideoConverter(0), 0);
+    } else {
+      conn.video = BuildAbrLadder(conn.video);
     }
-
-    elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(VIDEO_TEE_NAME_1U, 0));
-    ElementAdd(tee);
-    ElementLink(conn.video, tee);
-    conn.video = tee;
   }
 
   if (config->HaveAudio()) {
@@ -134,6 +127,156 @@ Connector EncodingStreamBuilder::BuildConverter(Connector conn) {
   return conn;
 }
 
+Connector EncodingStreamBuilder::BuildOutput(Connector conn) {
+  if (variant_tees_.empty()) {
+    return SrcDecodeStreamBuilder::BuildOutput(conn);
+  }
+
+  const EncodingConfig* config = static_cast<const EncodingConfig*>(GetConfig());
+  const abr_ladder_t ladder = config->GetAbrLadder();
+  IBaseStream* stream = static_cast<IBaseStream*>(GetObserver());
+  output_t out = config->GetOutput();
+  for (size_t i = 0; i < out.size(); ++i) {
+    const OutputUri output = out[i];
+    SinkDeviceType dt;
+    if (IsDeviceOutUrl(output.GetOutput(), &dt)) {  // monitor
+      CRITICAL_LOG() << "Decklink not supported for encoding based streams!";
+      continue;
+    }
+
+    common::uri::Url uri = output.GetOutput();
+    common::uri::Url::scheme scheme = uri.GetScheme();
+    if (scheme != common::uri::Url::http) {  // no variants, first rendition
+      elements::Element* mux = BuildMuxer(output, conn, i);
+      elements::Element* sink = BuildGenericOutput(output, i);
+      ElementAdd(sink);
+      ElementLink(mux, sink);
+      continue;
+    }
+
+    for (size_t j = 0; j < ladder.size(); ++j) {
+      const element_id_t variant_id = out.size() + i * ladder.size() + j;
+      Connector variant_conn = {variant_tees_[j], conn.audio};
+      elements::Element* mux = BuildMuxer(output, variant_conn, variant_id);
+      SharedHlsStore* hls_store = stream->GetStats()->GetHlsStore();
+      elements::Element* sink =
+          elements::sink::build_variant_output(output, ladder[j].GetName(), variant_id, stream->IsVod(), hls_store);
+      pad::Pad* sink_pad = sink->StaticPad("sink");
+      if (sink_pad->IsValid()) {
+        HandleOutputSinkPadCreated(scheme, sink_pad, i);  // all variants are accounted in own output stats
+      }
+      delete sink_pad;
+      ElementAdd(sink);
+      ElementLink(mux, sink);
+    }
+    WriteMasterPlaylist(output);
+  }
+  return conn;
+}
+
+elements::Element* EncodingStreamBuilder::BuildVideoEncoded(elements::Element* video,
+                                                            const elements_line_t& encoder,
+                                                            element_id_t video_id) {
+  const EncodingConfig* config = static_cast<const EncodingConfig*>(GetConfig());
+  if (!encoder.empty()) {
+    ElementLink(video, encoder.front());
+    video = encoder.back();
+  }
+
+  const std::string vcodec = config->GetVideoEncoder();
+  if (elements::encoders::IsH264Encoder(vcodec)) {
+    elements::parser::ElementH264Parse* premux_parser = elements::parser::make_h264_parser(video_id);
+    ElementAdd(premux_parser);
+    ElementLink(video, premux_parser);
+    video = premux_parser;
+  }
+
+  elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(VIDEO_TEE_NAME_1U, video_id));
+  ElementAdd(tee);
+  ElementLink(video, tee);
+  return tee;
+}
+
+elements::Element* EncodingStreamBuilder::BuildAbrLadder(elements::Element* video) {
+  const EncodingConfig* config = static_cast<const EncodingConfig*>(GetConfig());
+  const abr_ladder_t ladder = config->GetAbrLadder();
+  elements::ElementTee* ladder_tee = new elements::ElementTee(common::MemSPrintf(VIDEO_LADDER_TEE_NAME_1U, 0));
+  ElementAdd(ladder_tee);
+  ElementLink(video, ladder_tee);
+
+  variant_tees_.clear();
+  for (size_t i = 0; i < ladder.size(); ++i) {
+    const element_id_t video_id = i + 1;  // 0 is taken by post processing
+    elements::ElementQueue* queue = new elements::ElementQueue(common::MemSPrintf(VIDEO_LADDER_QUEUE_NAME_1U, i));
+    ElementAdd(queue);
+    ElementLink(ladder_tee, queue);
+
+    const common::draw::Size size = ladder[i].GetSize();
+    elements::Element* scaled = elements::encoders::build_video_scale(size.width, size.height, this, queue, video_id);
+    elements::Element* tee = BuildVideoEncoded(scaled, BuildRenditionConverter(ladder[i], video_id), video_id);
+    variant_tees_.push_back(tee);
+  }
+  return variant_tees_.front();
+}
+
+elements_line_t EncodingStreamBuilder::BuildRenditionConverter(const AbrRendition& rendition, element_id_t video_id) {
+  const EncodingConfig* conf = static_cast<const EncodingConfig*>(GetConfig());
+
+  // all renditions get same encoder args (gop size), without scene cut key frames stay on same frames
+  const std::string vcodec = conf->GetVideoEncoder();
+  video_encoders_str_args_t str_args = conf->GetVideoEncoderStrArgs();
+  if (vcodec == elements::encoders::ElementX264Enc::GetPluginName() &&
+      str_args.find(X264_ENC_OPTION_STRING) == str_args.end()) {
+    str_args[X264_ENC_OPTION_STRING] = "scenecut=0";
+  }
+
+  bit_rate_t video_bitrate = rendition.GetVideoBitrate();
+  return elements::encoders::build_video_encoder(vcodec, video_bitrate, conf->GetVideoEncoderArgs(), str_args, this,
+                                                 video_id);
+}
+
+void EncodingStreamBuilder::WriteMasterPlaylist(const OutputUri& output) const {
+  const EncodingConfig* config = static_cast<const EncodingConfig*>(GetConfig());
+  const abr_ladder_t ladder = config->GetAbrLadder();
+  const common::uri::Url uri = output.GetOutput();
+  const std::string filename = uri.GetPath().GetFileName();
+  const common::file_system::ascii_directory_string_path http_root = output.GetHttpRoot();
+  auto master_path = http_root.MakeFileStringPath(filename);
+  if (!master_path) {
+    return;
+  }
+
+  utils::M3u8Writer fl;
+  common::ErrnoError err = fl.OpenAtomic(*master_path);
+  if (err) {
+    WARNING_LOG() << "Failed to open master playlist " << master_path->GetPath() << ": " << err->GetDescription();
+    return;
+  }
+
+  err = fl.WriteMasterHeader();
+  if (err) {
+    WARNING_LOG() << "Failed to write master playlist header to " << master_path->GetPath() << ": "
+                  << err->GetDescription();
+    return;
+  }
+
+  const auto audio_bitrate = config->HaveAudio() ? config->GetAudioBitrate() : bit_rate_t();
+  for (const AbrRendition& rendition : ladder) {
+    const size_t bandwidth = (rendition.GetVideoBitrate() + (audio_bitrate ? *audio_bitrate : 0)) * 1000;
+    const std::string variant_playlist = elements::sink::make_variant_playlist_name(filename, rendition.GetName());
+    err = fl.WriteStreamInf(bandwidth, rendition.GetSize(), variant_playlist);
+    if (err) {
+      WARNING_LOG() << "Failed to write variant info to " << master_path->GetPath() << ": " << err->GetDescription();
+      return;
+    }
+  }
+
+  err = fl.Close();
+  if (err) {
+    WARNING_LOG() << "Failed to save master playlist " << master_path->GetPath() << ": " << err->GetDescription();
+  }
+}
+
 elements_line_t EncodingStreamBuilder::BuildVideoPostProc(element_id_t video_id) {
   const EncodingConfig* conf = static_cast<const EncodingConfig*>(GetConfig());
   elements::Element* first = nullptr;
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "stream/streams/builders/src_decodebin_stream_builder.h"
 
 #include "stream/streams/configs/encoding_config.h"
@@ -31,6 +33,7 @@ class EncodingStreamBuilder : public SrcDecodeStreamBuilder {
   EncodingStreamBuilder(const EncodingConfig* api, SrcDecodeBinStream* observer);
   Connector BuildPostProc(Connector conn) override;
   Connector BuildConverter(Connector conn) override;
+  Connector BuildOutput(Connector conn) override;
 
   SupportedVideoCodec GetVideoCodecType() const override;
   SupportedAudioCodec GetAudioCodecType() const override;
@@ -41,6 +44,17 @@ class EncodingStreamBuilder : public SrcDecodeStreamBuilder {
 
   virtual elements_line_t BuildVideoConverter(element_id_t video_id);
   virtual elements_line_t BuildAudioConverter(element_id_t audio_id);
+
+ private:
+  // encoder => parser => video tee, returns tee
+  elements::Element* BuildVideoEncoded(elements::Element* video, const elements_line_t& encoder, element_id_t video_id);
+
+  // abr ladder: single decoded video teed into scale => encoder branch per rendition, returns first rendition tee
+  elements::Element* BuildAbrLadder(elements::Element* video);
+  elements_line_t BuildRenditionConverter(const AbrRendition& rendition, element_id_t video_id);
+  void WriteMasterPlaylist(const OutputUri& output) const;
+
+  std::vector<elements::Element*> variant_tees_;  // encoded video of renditions in ladder order
 };
 
 }  // namespace builders
@@ -0,0 +1,104 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/builders/relay/ts_relay_stream_builder.h"
+
+#include <common/sprintf.h>
+
+#include "stream/ibase_stream.h"
+
+#include "stream/elements/element.h"
+#include "stream/elements/parser/video_parsers.h"
+#include "stream/elements/sources/build_input.h"
+
+#include "stream/pad/pad.h"
+
+#define TS_PACKETS_PER_BUFFER 7  // 1316 bytes, one udp datagram
+
+namespace iptv_cloud {
+namespace stream {
+namespace streams {
+namespace builders {
+
+TsRelayStreamBuilder::TsRelayStreamBuilder(const RelayConfig* config, IBaseBuilderObserver* observer)
+    : GstBaseBuilder(config, observer) {}
+
+Connector TsRelayStreamBuilder::BuildInput() {
+  const RelayConfig* config = static_cast<const RelayConfig*>(GetConfig());
+  input_t prepared = config->GetInput();
+  InputUri uri = prepared[0];
+  const common::uri::Url url = uri.GetInput();
+  elements::Element* src = elements::sources::make_src(uri, 0, IBaseStream::src_timeout_sec);
+  ElementAdd(src);
+
+  elements::parser::ElementTsParse* tsparse = elements::parser::make_ts_parser(0);
+  tsparse->SetAlignment(TS_PACKETS_PER_BUFFER);
+  tsparse->SetSetTimestamps(TRUE);  // live sinks and hls chunks need timestamps
+  tsparse->SetSplitOnRai(TRUE);     // hls chunks are cut on not delta buffers
+  ElementAdd(tsparse);
+  ElementLink(src, tsparse);
+
+  // input probe sees aligned packets, so stream can check and filter them
+  pad::Pad* src_pad = tsparse->StaticPad("src");
+  if (src_pad->IsValid()) {
+    HandleInputSrcPadCreated(url.GetScheme(), src_pad, 0);
+  }
+  delete src_pad;
+  return {tsparse, nullptr};  // whole transport stream goes through video line
+}
+
+Connector TsRelayStreamBuilder::BuildUdbConnections(Connector conn) {
+  return conn;
+}
+
+Connector TsRelayStreamBuilder::BuildPostProc(Connector conn) {
+  return conn;
+}
+
+Connector TsRelayStreamBuilder::BuildConverter(Connector conn) {
+  elements::ElementTee* tee = new elements::ElementTee(common::MemSPrintf(TS_TEE_NAME_1U, 0));
+  ElementAdd(tee);
+  ElementLink(conn.video, tee);
+  return {tee, nullptr};
+}
+
+Connector TsRelayStreamBuilder::BuildOutput(Connector conn) {
+  const RelayConfig* config = static_cast<const RelayConfig*>(GetConfig());
+  output_t out = config->GetOutput();
+  for (size_t i = 0; i < out.size(); ++i) {
+    const OutputUri output = out[i];
+    const common::uri::Url uri = output.GetOutput();
+    const common::uri::Url::scheme scheme = uri.GetScheme();
+    const bool is_ts_out = scheme == common::uri::Url::udp || scheme == common::uri::Url::tcp ||
+                           scheme == common::uri::Url::http || IsLocalUrl(uri, nullptr);
+    if (!is_ts_out) {
+      CRITICAL_LOG() << "Passthrough relay supports only mpeg-ts outputs, skipped: " << uri.GetUrl();
+      continue;
+    }
+
+    elements::ElementQueue* queue = new elements::ElementQueue(common::MemSPrintf(TS_TEE_QUEUE_NAME_1U, i));
+    ElementAdd(queue);
+    ElementLink(conn.video, queue);
+
+    elements::Element* sink = BuildGenericOutput(output, i);
+    ElementAdd(sink);
+    ElementLink(queue, sink);
+  }
+  return conn;
+}
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -66,7 +66,9 @@ SrcDecodeStreamBuilder::SrcDecodeStreamBuilder(const AudioVideoConfig* config, S
     : GstBaseBuilder(config, observer) {}
 
 Connector SrcDecodeStreamBuilder::BuildInput() {
-  elements::Element* src = BuildInputSrc();
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  const bool hot_standby = config->IsHotStandby() && config->GetInput().size() > 1;
+  elements::Element* src = hot_standby ? BuildStandbyInputs() : BuildInputSrc();
   elements::ElementDecodebin* decodebin = new elements::ElementDecodebin(common::MemSPrintf(DECODEBIN_NAME_1U, 0));
   ElementAdd(decodebin);
   ElementLink(src, decodebin);
@@ -82,6 +84,20 @@ void SrcDecodeStreamBuilder::HandleDecodebinCreated(elements::ElementDecodebin*
   }
 }
 
+void SrcDecodeStreamBuilder::HandleInputSelectorCreated(elements::ElementInputSelector* selector) {
+  SrcDecodeBinStream* stream = static_cast<SrcDecodeBinStream*>(GetObserver());
+  if (stream) {
+    stream->OnInputSelectorCreated(selector);
+  }
+}
+
+void SrcDecodeStreamBuilder::HandleInputSourceCreated(elements::Element* src, element_id_t id) {
+  SrcDecodeBinStream* stream = static_cast<SrcDecodeBinStream*>(GetObserver());
+  if (stream) {
+    stream->OnInputSourceCreated(src, id);
+  }
+}
+
 elements::Element* SrcDecodeStreamBuilder::BuildInputSrc() {
   const Config* config = GetConfig();
   input_t prepared = config->GetInput();
@@ -94,9 +110,35 @@ elements::Element* SrcDecodeStreamBuilder::BuildInputSrc() {
   }
   delete src_pad;
   ElementAdd(src);
+  HandleInputSourceCreated(src, 0);
   return src;
 }
 
+elements::Element* SrcDecodeStreamBuilder::BuildStandbyInputs() {
+  const Config* config = GetConfig();
+  input_t prepared = config->GetInput();
+  elements::ElementInputSelector* selector =
+      new elements::ElementInputSelector(common::MemSPrintf(INPUT_SELECTOR_NAME_1U, 0));
+  selector->SetSyncStreams(false);  // standby sources are live, drop their data instead of blocking them
+  ElementAdd(selector);
+  for (size_t i = 0; i < prepared.size(); ++i) {
+    InputUri uri = prepared[i];
+    const common::uri::Url url = uri.GetInput();
+    elements::Element* src = elements::sources::make_src(uri, i, IBaseStream::src_timeout_sec);
+    pad::Pad* src_pad = src->StaticPad("src");
+    if (src_pad->IsValid()) {
+      HandleInputSrcPadCreated(url.GetScheme(), src_pad, i);
+    }
+    delete src_pad;
+    ElementAdd(src);
+    HandleInputSourceCreated(src, i);
+    ElementLink(src, selector);  // selector sink pads are requested in inputs order
+  }
+
+  HandleInputSelectorCreated(selector);
+  return selector;
+}
+
 elements::Element* SrcDecodeStreamBuilder::BuildVideoUdbConnection() {
   elements::ElementQueue* video_queue = new elements::ElementQueue(common::MemSPrintf(UDB_VIDEO_NAME_1U, 0));
   return video_queue;
@@ -137,46 +179,7 @@ Connector SrcDecodeStreamBuilder::BuildOutput(Connector conn) {
       continue;
     }
 
-    common::uri::Url uri = output.GetOutput();
-    common::uri::Url::scheme scheme = uri.GetScheme();
-    bool is_rtp_out = scheme == common::uri::Url::udp;
-    elements::Element* mux = elements::muxer::make_muxer(scheme, i);
-    ElementAdd(mux);
-
-    if (config->HaveVideo()) {
-      elements::ElementQueue* video_tee_queue =
-          new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, i));
-      ElementAdd(video_tee_queue);
-      elements::Element* next = video_tee_queue;
-      ElementLink(conn.video, next);
-
-      if (is_rtp_out) {
-        elements::Element* rtp_pay = make_video_pay(GetVideoCodecType(), i);
-        ElementAdd(rtp_pay);
-        ElementLink(next, rtp_pay);
-        next = rtp_pay;
-      }
-
-      ElementLink(next, mux);
-    }
-
-    if (config->HaveAudio()) {
-      elements::ElementQueue* audio_tee_queue =
-          new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, i));
-      ElementAdd(audio_tee_queue);
-      elements::Element* next = audio_tee_queue;
-      ElementLink(conn.audio, next);
-
-      if (is_rtp_out) {
-        elements::Element* rtp_pay = make_audio_pay(GetAudioCodecType(), i);
-        ElementAdd(rtp_pay);
-        ElementLink(next, rtp_pay);
-        next = rtp_pay;
-      }
-
-      ElementLink(next, mux);
-    }
-
+    elements::Element* mux = BuildMuxer(output, conn, i);
     elements::Element* sink = BuildGenericOutput(output, i);
     ElementAdd(sink);
     ElementLink(mux, sink);
@@ -184,6 +187,58 @@ Connector SrcDecodeStreamBuilder::BuildOutput(Connector conn) {
   return conn;
 }
 
+elements::Element* SrcDecodeStreamBuilder::BuildMuxer(const OutputUri& output, Connector conn, element_id_t mux_id) {
+  const AudioVideoConfig* config = static_cast<const AudioVideoConfig*>(GetConfig());
+  const common::uri::Url uri = output.GetOutput();
+  common::uri::Url::scheme scheme = uri.GetScheme();
+  bool is_udp_out = scheme == common::uri::Url::udp;
+  bool is_rtp_out = is_udp_out && output.GetUdpMode() == OutputUri::RTP_ES;
+  elements::Element* mux = nullptr;
+  if (IsLocalUrl(uri, nullptr)) {  // ingest hub
+    mux = elements::muxer::make_mpegtsmux(mux_id);
+  } else if (is_udp_out && !is_rtp_out) {  // ts over udp, packed and paced by sink
+    mux = elements::muxer::make_udp_mpegtsmux(output.GetMuxRate(), mux_id);
+  } else {
+    mux = elements::muxer::make_muxer(scheme, mux_id);
+  }
+  ElementAdd(mux);
+
+  if (config->HaveVideo()) {
+    elements::ElementQueue* video_tee_queue =
+        new elements::ElementQueue(common::MemSPrintf(VIDEO_TEE_QUEUE_NAME_1U, mux_id));
+    ElementAdd(video_tee_queue);
+    elements::Element* next = video_tee_queue;
+    ElementLink(conn.video, next);
+
+    if (is_rtp_out) {
+      elements::Element* rtp_pay = make_video_pay(GetVideoCodecType(), mux_id);
+      ElementAdd(rtp_pay);
+      ElementLink(next, rtp_pay);
+      next = rtp_pay;
+    }
+
+    ElementLink(next, mux);
+  }
+
+  if (config->HaveAudio()) {
+    elements::ElementQueue* audio_tee_queue =
+        new elements::ElementQueue(common::MemSPrintf(AUDIO_TEE_QUEUE_NAME_1U, mux_id));
+    ElementAdd(audio_tee_queue);
+    elements::Element* next = audio_tee_queue;
+    ElementLink(conn.audio, next);
+
+    if (is_rtp_out) {
+      elements::Element* rtp_pay = make_audio_pay(GetAudioCodecType(), mux_id);
+      ElementAdd(rtp_pay);
+      ElementLink(next, rtp_pay);
+      next = rtp_pay;
+    }
+
+    ElementLink(next, mux);
+  }
+  return mux;
+}
+
 }  // namespace builders
 }  // namespace streams
 }  // namespace stream
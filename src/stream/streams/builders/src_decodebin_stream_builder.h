@@ -20,6 +20,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace elements {
 class ElementDecodebin;
+class ElementInputSelector;
 }
 namespace streams {
 class SrcDecodeBinStream;
@@ -32,6 +33,7 @@ class SrcDecodeStreamBuilder : public GstBaseBuilder {
 
   Connector BuildInput() override;
   virtual elements::Element* BuildInputSrc();
+  virtual elements::Element* BuildStandbyInputs();  // all inputs prerolled behind input selector
 
   Connector BuildUdbConnections(Connector conn) override;
   virtual elements::Element* BuildVideoUdbConnection();
@@ -45,7 +47,12 @@ class SrcDecodeStreamBuilder : public GstBaseBuilder {
   virtual SupportedAudioCodec GetAudioCodecType() const = 0;
 
  protected:
+  // muxer fed by queues from video/audio tees (and rtp pays for udp), sink should be linked by caller
+  elements::Element* BuildMuxer(const OutputUri& output, Connector conn, element_id_t mux_id);
+
   void HandleDecodebinCreated(elements::ElementDecodebin* decodebin);
+  void HandleInputSelectorCreated(elements::ElementInputSelector* selector);
+  void HandleInputSourceCreated(elements::Element* src, element_id_t id);
 };
 
 }  // namespace builders
@@ -17,6 +17,8 @@
 #include "base/constants.h"
 
 #include "stream/elements/sources/multifilesrc.h"
+#include "stream/elements/sources/timeshiftsrc.h"
+#include "stream/timeshift_ring.h"
 
 namespace iptv_cloud {
 namespace stream {
@@ -30,6 +32,15 @@ TimeShiftPlayerBuilder::TimeShiftPlayerBuilder(TimeShiftInfo tinfo,
     : base_class(api, observer), tinfo_(tinfo), start_chunk_index_(start_chunk_index) {}
 
 elements::Element* TimeShiftPlayerBuilder::BuildInputSrc() {
+  const std::string ring_path = tinfo_.GetRingPath();
+  TimeShiftRingReader ring;
+  if (OpenTimeShiftRingWithChunk(ring_path, start_chunk_index_, &ring)) {  // recorder writes into ring storage
+    elements::sources::ElementTimeShiftRingSrc* ring_src =
+        elements::sources::make_timeshift_ring_src(ring_path, start_chunk_index_, 0);
+    ElementAdd(ring_src);
+    return ring_src;
+  }
+
   elements::sources::MultiFileSrcInfo info;
   info.location = tinfo_.timshift_dir.GetPath() + "%llu." TS_EXTENSION;
   info.index = start_chunk_index_;
@@ -0,0 +1,53 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/builders/timeshift/ts_timeshift_recorder_stream_builder.h"
+
+#include "stream/elements/sink/ts_chunk.h"
+
+#include "stream/streams/timeshift/timeshift_recorder_stream.h"
+
+namespace iptv_cloud {
+namespace stream {
+namespace streams {
+namespace builders {
+
+TsTimeShiftRecorderStreamBuilder::TsTimeShiftRecorderStreamBuilder(const TimeshiftConfig* api,
+                                                                   TimeShiftRecorderStream* observer)
+    : base_class(api, observer) {}
+
+Connector TsTimeShiftRecorderStreamBuilder::BuildConverter(Connector conn) {
+  return conn;
+}
+
+Connector TsTimeShiftRecorderStreamBuilder::BuildOutput(Connector conn) {
+  TimeShiftRecorderStream* stream = static_cast<TimeShiftRecorderStream*>(GetObserver());
+  if (!stream) {
+    return conn;
+  }
+
+  const TimeshiftConfig* tconf = static_cast<const TimeshiftConfig*>(GetConfig());
+  const TimeShiftInfo tinfo = stream->GetTimeshiftInfo();
+  elements::sink::ElementTsChunkSink* sink = elements::sink::make_ts_chunk_sink(
+      0, tinfo.timshift_dir.GetPath(), tconf->GetTimeShiftChunkDuration() * 1000);
+  ElementAdd(sink);
+  ElementLink(conn.video, sink);
+  stream->OnTsChunkSinkCreated(sink);
+  return conn;
+}
+
+}  // namespace builders
+}  // namespace streams
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -26,7 +26,10 @@ AudioVideoConfig::AudioVideoConfig(const base_class& config)
       have_audio_(true),
       audio_select_(),
       avformat_(DEFAULT_AVFORMAT),
-      loop_(DEFAULT_LOOP) {}
+      loop_(DEFAULT_LOOP),
+      playlist_block_size_(DEFAULT_PLAYLIST_BLOCK_SIZE),
+      playlist_zero_copy_(DEFAULT_PLAYLIST_ZERO_COPY),
+      hot_standby_(DEFAULT_HOT_STANDBY) {}
 
 AudioVideoConfig::have_stream_t AudioVideoConfig::HaveVideo() const {
   return have_video_;
@@ -68,6 +71,30 @@ void AudioVideoConfig::SetLoop(loop_t loop) {
   loop_ = loop;
 }
 
+AudioVideoConfig::playlist_block_size_t AudioVideoConfig::GetPlaylistBlockSize() const {
+  return playlist_block_size_;
+}
+
+void AudioVideoConfig::SetPlaylistBlockSize(playlist_block_size_t size) {
+  playlist_block_size_ = size;
+}
+
+AudioVideoConfig::playlist_zero_copy_t AudioVideoConfig::IsPlaylistZeroCopy() const {
+  return playlist_zero_copy_;
+}
+
+void AudioVideoConfig::SetPlaylistZeroCopy(playlist_zero_copy_t zero_copy) {
+  playlist_zero_copy_ = zero_copy;
+}
+
+AudioVideoConfig::hot_standby_t AudioVideoConfig::IsHotStandby() const {
+  return hot_standby_;
+}
+
+void AudioVideoConfig::SetHotStandby(hot_standby_t hot_standby) {
+  hot_standby_ = hot_standby;
+}
+
 bool AudioVideoConfig::IsVod() const {
   if (loop_) {
     return false;
@@ -25,6 +25,9 @@ class AudioVideoConfig : public Config {
   typedef Config base_class;
   typedef common::Optional<int> audio_select_t;
   typedef bool loop_t;
+  typedef size_t playlist_block_size_t;
+  typedef bool playlist_zero_copy_t;
+  typedef bool hot_standby_t;
   typedef bool avformat_t;
   typedef bool have_stream_t;
   explicit AudioVideoConfig(const base_class& config);
@@ -44,6 +47,16 @@ class AudioVideoConfig : public Config {
   loop_t GetLoop() const;
   void SetLoop(loop_t loop);
 
+  playlist_block_size_t GetPlaylistBlockSize() const;  // bytes, playlist streams
+  void SetPlaylistBlockSize(playlist_block_size_t size);
+
+  // playlist files are mmapped, truncating or rewriting them in place while played crashes stream (SIGBUS)
+  playlist_zero_copy_t IsPlaylistZeroCopy() const;
+  void SetPlaylistZeroCopy(playlist_zero_copy_t zero_copy);
+
+  hot_standby_t IsHotStandby() const;  // multiple inputs are backups of one source
+  void SetHotStandby(hot_standby_t hot_standby);
+
   bool IsVod() const;
 
  private:
@@ -52,6 +65,9 @@ class AudioVideoConfig : public Config {
   audio_select_t audio_select_;
   avformat_t avformat_;
   loop_t loop_;
+  playlist_block_size_t playlist_block_size_;
+  playlist_zero_copy_t playlist_zero_copy_;
+  hot_standby_t hot_standby_;
 };
 
 }  // namespace streams
@@ -42,6 +42,7 @@ EncodingConfig::EncodingConfig(const base_class& config)
       video_bit_rate_(),
       audio_bit_rate_(),
       logo_(),
+      abr_ladder_(),
       decklink_video_mode_(DEFAULT_DECKLINK_VIDEO_MODE),
       aspect_ratio_(),
       relay_video_(false),
@@ -179,6 +180,14 @@ Logo EncodingConfig::GetLogo() const {
   return logo_;
 }
 
+abr_ladder_t EncodingConfig::GetAbrLadder() const {
+  return abr_ladder_;
+}
+
+void EncodingConfig::SetAbrLadder(const abr_ladder_t& ladder) {
+  abr_ladder_ = ladder;
+}
+
 rational_t EncodingConfig::GetAspectRatio() const {
   return aspect_ratio_;
 }
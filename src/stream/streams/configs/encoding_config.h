@@ -18,6 +18,7 @@
 
 #include <common/draw/types.h>
 
+#include "base/abr_ladder.h"
 #include "base/logo.h"
 
 #include "stream/streams/configs/audio_video_config.h"
@@ -78,6 +79,9 @@ class EncodingConfig : public AudioVideoConfig {
   Logo GetLogo() const;  // encoding
   void SetLogo(const Logo& logo);
 
+  abr_ladder_t GetAbrLadder() const;  // encoding, one decode shared by all renditions
+  void SetAbrLadder(const abr_ladder_t& ladder);
+
   rational_t GetAspectRatio() const;  // encoding
   void SetAspectRatio(rational_t rat);
 
@@ -103,6 +107,7 @@ class EncodingConfig : public AudioVideoConfig {
   bit_rate_t audio_bit_rate_;
 
   Logo logo_;
+  abr_ladder_t abr_ladder_;
 
   decklink_video_mode_t decklink_video_mode_;
   rational_t aspect_ratio_;
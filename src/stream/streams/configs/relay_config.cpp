@@ -27,7 +27,11 @@ namespace stream {
 namespace streams {
 
 RelayConfig::RelayConfig(const base_class& config)
-    : base_class(config), video_parser_(DEFAULT_VIDEO_PARSER), audio_parser_(DEFAULT_AUDIO_PARSER) {}
+    : base_class(config),
+      video_parser_(DEFAULT_VIDEO_PARSER),
+      audio_parser_(DEFAULT_AUDIO_PARSER),
+      passthrough_(false),
+      pids_() {}
 
 std::string RelayConfig::GetVideoParser() const {
   return video_parser_;
@@ -45,6 +49,22 @@ void RelayConfig::SetAudioParser(const std::string& parser) {
   audio_parser_ = parser;
 }
 
+bool RelayConfig::IsPassthrough() const {
+  return passthrough_;
+}
+
+void RelayConfig::SetPassthrough(bool passthrough) {
+  passthrough_ = passthrough;
+}
+
+utils::ts_pids_t RelayConfig::GetPids() const {
+  return pids_;
+}
+
+void RelayConfig::SetPids(const utils::ts_pids_t& pids) {
+  pids_ = pids;
+}
+
 VodRelayConfig::VodRelayConfig(const base_class& config) : base_class(config), cleanup_ts_(false) {}
 
 bool VodRelayConfig::GetCleanupTS() const {
@@ -18,6 +18,8 @@
 
 #include "stream/streams/configs/audio_video_config.h"
 
+#include "utils/ts_packet_filter.h"
+
 namespace iptv_cloud {
 namespace stream {
 namespace streams {
@@ -33,9 +35,17 @@ class RelayConfig : public AudioVideoConfig {
   std::string GetAudioParser() const;  // relay
   void SetAudioParser(const std::string& parser);
 
+  bool IsPassthrough() const;  // relay, ts packets are forwarded as is, without demuxing
+  void SetPassthrough(bool passthrough);
+
+  utils::ts_pids_t GetPids() const;  // passthrough, empty means all pids
+  void SetPids(const utils::ts_pids_t& pids);
+
  private:
   std::string video_parser_;
   std::string audio_parser_;
+  bool passthrough_;
+  utils::ts_pids_t pids_;
 };
 
 class VodRelayConfig : public RelayConfig {
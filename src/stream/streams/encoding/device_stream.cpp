@@ -20,7 +20,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-DeviceStream::DeviceStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats)
+DeviceStream::DeviceStream(const EncodingConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : EncodingStream(config, client, stats) {}
 
 const char* DeviceStream::ClassName() const {
@@ -26,7 +26,7 @@ namespace streams {
 
 EncodingOnlyAudioStream::EncodingOnlyAudioStream(const EncodingConfig* config,
                                                  IStreamClient* client,
-                                                 StreamStruct* stats)
+                                                 SharedStreamStruct* stats)
     : EncodingStream(config, client, stats) {}
 
 const char* EncodingOnlyAudioStream::ClassName() const {
@@ -26,7 +26,7 @@ namespace streams {
 
 EncodingOnlyVideoStream::EncodingOnlyVideoStream(const EncodingConfig* config,
                                                  IStreamClient* client,
-                                                 StreamStruct* stats)
+                                                 SharedStreamStruct* stats)
     : EncodingStream(config, client, stats) {}
 
 const char* EncodingOnlyVideoStream::ClassName() const {
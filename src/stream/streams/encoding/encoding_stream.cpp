@@ -36,7 +36,7 @@ IBaseBuilder* EncodingStream::CreateBuilder() {
   return new builders::EncodingStreamBuilder(econf, this);
 }
 
-EncodingStream::EncodingStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats)
+EncodingStream::EncodingStream(const EncodingConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : base_class(config, client, stats) {}
 
 const char* EncodingStream::ClassName() const {
@@ -21,14 +21,14 @@ namespace stream {
 namespace streams {
 
 FakeStream::FakeStream(EncodingConfig* config, IStreamClient* client)
-    : EncodingStream(config, client, new StreamStruct(StreamInfo{"fake", ENCODE, {0}, {1}})) {}
+    : EncodingStream(config, client, new SharedStreamStruct(StreamInfo{"fake", ENCODE, {0}, {1}})) {}
 
 const char* FakeStream::ClassName() const {
   return "FakeStream";
 }
 
 FakeStream::~FakeStream() {
-  StreamStruct* stat = GetStats();
+  SharedStreamStruct* stat = GetStats();
   delete stat;
 }
 
@@ -22,21 +22,19 @@
 
 #include "stream/streams/builders/encoding/playlist_encoding_stream_builder.h"
 
-#define BUFFER_SIZE 4096
-
 namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-PlaylistEncodingStream::PlaylistEncodingStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats)
-    : EncodingStream(config, client, stats), app_src_(nullptr), current_file_(nullptr), curent_pos_(0) {}
+PlaylistEncodingStream::PlaylistEncodingStream(const EncodingConfig* config,
+                                               IStreamClient* client,
+                                               SharedStreamStruct* stats)
+    : EncodingStream(config, client, stats),
+      app_src_(nullptr),
+      feeder_(config->GetPlaylistBlockSize(), config->IsPlaylistZeroCopy()),
+      curent_pos_(0) {}
 
-PlaylistEncodingStream::~PlaylistEncodingStream() {
-  if (current_file_) {
-    fclose(current_file_);
-    current_file_ = nullptr;
-  }
-}
+PlaylistEncodingStream::~PlaylistEncodingStream() {}
 
 const char* PlaylistEncodingStream::ClassName() const {
   return "PlaylistEncodingStream";
@@ -59,32 +57,19 @@ void PlaylistEncodingStream::HandleNeedData(GstElement* pipeline, guint rsize) {
   UNUSED(pipeline);
   UNUSED(rsize);
 
-  size_t size = 0;
-  char* ptr = static_cast<char*>(calloc(BUFFER_SIZE, sizeof(char)));
-  if (!ptr) {
-    app_src_->SendEOS();
-    return;
-  }
-
-  while (size == 0) {
-    if (!current_file_) {
-      current_file_ = OpenNextFile();
-    }
-
-    if (!current_file_) {
+  GstBuffer* buffer = nullptr;
+  while (!buffer) {
+    if (!feeder_.IsOpen() && !OpenNextFile()) {
       app_src_->SendEOS();
-      free(ptr);
       return;
     }
 
-    size = fread(ptr, sizeof(char), BUFFER_SIZE, current_file_);
-    if (size == 0) {
-      fclose(current_file_);
-      current_file_ = nullptr;
+    buffer = feeder_.ReadBuffer();
+    if (!buffer) {  // end of file
+      feeder_.Close();
     }
   }
 
-  GstBuffer* buffer = gst_buffer_new_wrapped(ptr, size);
   GstFlowReturn ret = app_src_->PushBuffer(buffer);
   if (ret != GST_FLOW_OK) {
     WARNING_LOG() << "gst_app_src_push_buffer failed: " << gst_flow_get_name(ret);
@@ -97,7 +82,7 @@ void PlaylistEncodingStream::need_data_callback(GstElement* pipeline, guint size
   return stream->HandleNeedData(pipeline, size);
 }
 
-FILE* PlaylistEncodingStream::OpenNextFile() {
+bool PlaylistEncodingStream::OpenNextFile() {
   const PlaylistEncodingConfig* econf = static_cast<const PlaylistEncodingConfig*>(GetConfig());
   const auto loop = econf->GetLoop();
 
@@ -105,7 +90,7 @@ FILE* PlaylistEncodingStream::OpenNextFile() {
     input_t input = econf->GetInput();
     if (curent_pos_ >= input.size()) {
       INFO_LOG() << "No more files for playing";
-      return nullptr;  // EOS
+      return false;  // EOS
     }
   }
 
@@ -119,16 +104,17 @@ FILE* PlaylistEncodingStream::OpenNextFile() {
   curent_pos_++;
   common::uri::Upath path = uri.GetPath();
   std::string cur_path = path.GetPath();
-  FILE* file = fopen(cur_path.c_str(), "rb");
-  if (file) {
-    INFO_LOG() << "File " << cur_path << " open for playing";
-    if (client_) {
-      client_->OnInputChanged(iuri);
-    }
-  } else {
-    WARNING_LOG() << "File " << cur_path << " can't open for playing";
+  common::ErrnoError err = feeder_.Open(cur_path);
+  if (err) {
+    WARNING_LOG() << "File " << cur_path << " can't open for playing: " << err->GetDescription();
+    return false;
+  }
+
+  INFO_LOG() << "File " << cur_path << " open for playing";
+  if (client_) {
+    client_->OnInputChanged(iuri);
   }
-  return file;
+  return true;
 }
 
 }  // namespace streams
@@ -16,6 +16,8 @@
 
 #include "stream/streams/encoding/encoding_stream.h"
 
+#include "stream/playlist_feeder.h"
+
 namespace iptv_cloud {
 namespace stream {
 
@@ -35,7 +37,7 @@ class PlaylistEncodingStream : public EncodingStream {
   friend class builders::PlaylistEncodingStreamBuilder;
 
  public:
-  PlaylistEncodingStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats);
+  PlaylistEncodingStream(const EncodingConfig* config, IStreamClient* client, SharedStreamStruct* stats);
   ~PlaylistEncodingStream() override;
 
   const char* ClassName() const override;
@@ -51,10 +53,10 @@ class PlaylistEncodingStream : public EncodingStream {
  private:
   static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
 
-  FILE* OpenNextFile();
+  bool OpenNextFile();
 
   elements::sources::ElementAppSrc* app_src_;
-  FILE* current_file_;
+  PlaylistFileFeeder feeder_;
   size_t curent_pos_;
 };
 
@@ -276,7 +276,7 @@ void MosaicStream::HandleCairoDraw(GstElement* overlay, cairo_t* cr, guint64 tim
   }
 }
 
-MosaicStream::MosaicStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats)
+MosaicStream::MosaicStream(const EncodingConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : IBaseStream(config, client, stats), options_() {}
 
 const char* MosaicStream::ClassName() const {
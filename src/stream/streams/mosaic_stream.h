@@ -50,7 +50,7 @@ class MosaicStream : public IBaseStream {
   friend class builders::MosaicStreamBuilder;
 
  public:
-  MosaicStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats);
+  MosaicStream(const EncodingConfig* config, IStreamClient* client, SharedStreamStruct* stats);
   const char* ClassName() const override;
 
  protected:
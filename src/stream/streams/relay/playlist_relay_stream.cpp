@@ -23,21 +23,19 @@
 
 #include "stream/streams/builders/relay/playlist_relay_stream_builder.h"
 
-#define BUFFER_SIZE 4096
-
 namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-PlaylistRelayStream::PlaylistRelayStream(const PlaylistRelayConfig* config, IStreamClient* client, StreamStruct* stats)
-    : RelayStream(config, client, stats), app_src_(nullptr), current_file_(nullptr), curent_pos_(0) {}
+PlaylistRelayStream::PlaylistRelayStream(const PlaylistRelayConfig* config,
+                                         IStreamClient* client,
+                                         SharedStreamStruct* stats)
+    : RelayStream(config, client, stats),
+      app_src_(nullptr),
+      feeder_(config->GetPlaylistBlockSize(), config->IsPlaylistZeroCopy()),
+      curent_pos_(0) {}
 
-PlaylistRelayStream::~PlaylistRelayStream() {
-  if (current_file_) {
-    fclose(current_file_);
-    current_file_ = nullptr;
-  }
-}
+PlaylistRelayStream::~PlaylistRelayStream() {}
 
 const char* PlaylistRelayStream::ClassName() const {
   return "PlaylistRelayStream";
@@ -64,32 +62,19 @@ void PlaylistRelayStream::HandleNeedData(GstElement* pipeline, guint rsize) {
   UNUSED(pipeline);
   UNUSED(rsize);
 
-  char* ptr = static_cast<char*>(calloc(BUFFER_SIZE, sizeof(char)));
-  if (!ptr) {
-    app_src_->SendEOS();  // send  eos
-    return;
-  }
-
-  size_t size = 0;
-  while (size == 0) {
-    if (!current_file_) {
-      current_file_ = OpenNextFile();
-    }
-
-    if (!current_file_) {
-      app_src_->SendEOS();  // send  eos
-      free(ptr);
+  GstBuffer* buffer = nullptr;
+  while (!buffer) {
+    if (!feeder_.IsOpen() && !OpenNextFile()) {
+      app_src_->SendEOS();
       return;
     }
 
-    size = fread(ptr, sizeof(char), BUFFER_SIZE, current_file_);
-    if (size == 0) {
-      fclose(current_file_);
-      current_file_ = nullptr;
+    buffer = feeder_.ReadBuffer();
+    if (!buffer) {  // end of file
+      feeder_.Close();
     }
   }
 
-  GstBuffer* buffer = gst_buffer_new_wrapped(ptr, size);
   GstFlowReturn ret = app_src_->PushBuffer(buffer);
   if (ret != GST_FLOW_OK) {
     WARNING_LOG() << "gst_app_src_push_buffer failed: " << gst_flow_get_name(ret);
@@ -102,7 +87,7 @@ void PlaylistRelayStream::need_data_callback(GstElement* pipeline, guint size, g
   return stream->HandleNeedData(pipeline, size);
 }
 
-FILE* PlaylistRelayStream::OpenNextFile() {
+bool PlaylistRelayStream::OpenNextFile() {
   const PlaylistRelayConfig* rconf = static_cast<const PlaylistRelayConfig*>(GetConfig());
   const bool loop = rconf->GetLoop();
 
@@ -110,7 +95,7 @@ FILE* PlaylistRelayStream::OpenNextFile() {
     input_t input = rconf->GetInput();
     if (curent_pos_ >= input.size()) {
       INFO_LOG() << "No more files for playing";
-      return nullptr;  // EOS
+      return false;  // EOS
     }
   }
 
@@ -123,16 +108,17 @@ FILE* PlaylistRelayStream::OpenNextFile() {
   common::uri::Url uri = iuri.GetInput();
   common::uri::Upath path = uri.GetPath();
   std::string cur_path = path.GetPath();
-  FILE* file = fopen(cur_path.c_str(), "rb");
-  if (file) {
-    INFO_LOG() << "File " << cur_path << " open for playing";
-    if (client_) {
-      client_->OnInputChanged(iuri);
-    }
-  } else {
-    WARNING_LOG() << "File " << cur_path << "can't open for playing";
+  common::ErrnoError err = feeder_.Open(cur_path);
+  if (err) {
+    WARNING_LOG() << "File " << cur_path << " can't open for playing: " << err->GetDescription();
+    return false;
+  }
+
+  INFO_LOG() << "File " << cur_path << " open for playing";
+  if (client_) {
+    client_->OnInputChanged(iuri);
   }
-  return file;
+  return true;
 }
 
 }  // namespace streams
@@ -16,6 +16,8 @@
 
 #include "stream/streams/relay/relay_stream.h"
 
+#include "stream/playlist_feeder.h"
+
 namespace iptv_cloud {
 namespace stream {
 namespace elements {
@@ -34,7 +36,7 @@ class PlaylistRelayStream : public RelayStream {
   friend class builders::PlaylistRelayStreamBuilder;
 
  public:
-  PlaylistRelayStream(const PlaylistRelayConfig* config, IStreamClient* client, StreamStruct* stats);
+  PlaylistRelayStream(const PlaylistRelayConfig* config, IStreamClient* client, SharedStreamStruct* stats);
   ~PlaylistRelayStream() override;
 
   const char* ClassName() const override;
@@ -52,10 +54,10 @@ class PlaylistRelayStream : public RelayStream {
  private:
   static void need_data_callback(GstElement* pipeline, guint size, gpointer user_data);
 
-  FILE* OpenNextFile();
+  bool OpenNextFile();
 
   elements::sources::ElementAppSrc* app_src_;
-  FILE* current_file_;
+  PlaylistFileFeeder feeder_;
   size_t curent_pos_;
 };
 
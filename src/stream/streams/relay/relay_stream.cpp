@@ -32,7 +32,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-RelayStream::RelayStream(const RelayConfig* config, IStreamClient* client, StreamStruct* stats)
+RelayStream::RelayStream(const RelayConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : SrcDecodeBinStream(config, client, stats) {}
 
 const char* RelayStream::ClassName() const {
@@ -0,0 +1,117 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/streams/relay/ts_relay_stream.h"
+
+#include "stream/pad/pad.h"
+#include "stream/probes.h"
+#include "stream/streams/builders/relay/ts_relay_stream_builder.h"
+
+#define TS_CHECK_LOG_INTERVAL_SEC 10
+
+namespace iptv_cloud {
+namespace stream {
+namespace streams {
+
+TsRelayStream::TsRelayStream(const RelayConfig* config, IStreamClient* client, SharedStreamStruct* stats)
+    : IBaseStream(config, client, stats), filter_(config->GetPids()), logged_stats_(), last_log_time_(0) {}
+
+const char* TsRelayStream::ClassName() const {
+  return "TsRelayStream";
+}
+
+GstPadProbeInfo* TsRelayStream::CheckProbeData(Probe* probe, GstPadProbeInfo* info) {
+  if (probe->GetName() == PROBE_IN && GST_IS_BUFFER(GST_PAD_PROBE_INFO_DATA(info)) && !HandlePackets(info)) {
+    return nullptr;
+  }
+
+  return IBaseStream::CheckProbeData(probe, info);
+}
+
+void TsRelayStream::OnInpudSrcPadCreated(common::uri::Url::scheme scheme, pad::Pad* src_pad, element_id_t id) {
+  UNUSED(scheme);
+  LinkInputPad(src_pad->GetGstPad(), id);
+}
+
+void TsRelayStream::OnOutputSinkPadCreated(common::uri::Url::scheme scheme, pad::Pad* sink_pad, element_id_t id) {
+  UNUSED(scheme);
+  LinkOutputPad(sink_pad->GetGstPad(), id);
+}
+
+IBaseBuilder* TsRelayStream::CreateBuilder() {
+  const RelayConfig* rconf = static_cast<const RelayConfig*>(GetConfig());
+  return new builders::TsRelayStreamBuilder(rconf, this);
+}
+
+void TsRelayStream::PreLoop() {
+  filter_.Reset();  // restarted pipeline reads input from new position
+  const Config* conf = GetConfig();
+  const auto input = conf->GetInput();
+  if (client_) {
+    client_->OnInputChanged(input[0]);
+  }
+}
+
+void TsRelayStream::PostLoop(ExitStatus status) {
+  UNUSED(status);
+}
+
+bool TsRelayStream::HandlePackets(GstPadProbeInfo* info) {
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT)) {
+    filter_.Reset();
+  }
+
+  bool have_packets = true;
+  GstMapInfo map;
+  if (filter_.IsFiltering()) {
+    buffer = gst_buffer_make_writable(buffer);
+    GST_PAD_PROBE_INFO_DATA(info) = buffer;
+    if (gst_buffer_map(buffer, &map, GST_MAP_READWRITE)) {
+      const size_t size = filter_.Filter(map.data, map.size);
+      gst_buffer_unmap(buffer, &map);
+      gst_buffer_set_size(buffer, size);
+      have_packets = size != 0;
+    }
+  } else if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {  // byte for byte, only checks
+    filter_.Check(map.data, map.size);
+    gst_buffer_unmap(buffer, &map);
+  }
+
+  LogCheckStats();
+  return have_packets;
+}
+
+void TsRelayStream::LogCheckStats() {
+  const gint64 now = g_get_monotonic_time();
+  if (now - last_log_time_ < TS_CHECK_LOG_INTERVAL_SEC * G_USEC_PER_SEC) {
+    return;
+  }
+
+  const utils::TsCheckStats stats = filter_.GetStats();
+  const uint64_t sync_errors = stats.sync_errors - logged_stats_.sync_errors;
+  const uint64_t cc_errors = stats.cc_errors - logged_stats_.cc_errors;
+  const uint64_t pcr_errors = stats.pcr_errors - logged_stats_.pcr_errors;
+  if (sync_errors || cc_errors || pcr_errors) {
+    WARNING_LOG() << "Input ts errors for last " << TS_CHECK_LOG_INTERVAL_SEC << " sec, sync: " << sync_errors
+                  << ", continuity: " << cc_errors << ", pcr: " << pcr_errors
+                  << ", packets: " << stats.packets - logged_stats_.packets;
+  }
+  logged_stats_ = stats;
+  last_log_time_ = now;
+}
+
+}  // namespace streams
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -22,7 +22,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-ScreenStream::ScreenStream(AudioVideoConfig* config, IStreamClient* client, StreamStruct* stats)
+ScreenStream::ScreenStream(AudioVideoConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : IBaseStream(config, client, stats) {}
 
 const char* ScreenStream::ClassName() const {
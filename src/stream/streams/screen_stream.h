@@ -24,7 +24,7 @@ namespace streams {
 
 class ScreenStream : public IBaseStream {  // only videotestsrc and audiotestsrc
  public:
-  ScreenStream(AudioVideoConfig* config, IStreamClient* client, StreamStruct* stats);
+  ScreenStream(AudioVideoConfig* config, IStreamClient* client, SharedStreamStruct* stats);
   const char* ClassName() const override;
 
  protected:
@@ -14,8 +14,18 @@
 
 #include "stream/streams/src_decodebin_stream.h"
 
+#include <common/sprintf.h>
+
+#include "base/shared_stream_struct.h"
+
 #include "stream/config.h"
+#include "stream/elements/sources/build_input.h"
 #include "stream/pad/pad.h"
+#include "stream/probes.h"
+
+#define INPUT_EOS_MESSAGE "input_eos"
+#define INPUT_EOS_ID_FIELD "input"
+#define MAX_SOURCE_RESTARTS 3
 
 namespace iptv_cloud {
 namespace stream {
@@ -41,8 +51,13 @@ void SrcDecodeBinStream::ConnectDecodebinSignals(elements::ElementDecodebin* dec
   DCHECK(element_removed);
 }
 
-SrcDecodeBinStream::SrcDecodeBinStream(const Config* config, IStreamClient* client, StreamStruct* stats)
-    : IBaseStream(config, client, stats) {}
+SrcDecodeBinStream::SrcDecodeBinStream(const Config* config, IStreamClient* client, SharedStreamStruct* stats)
+    : IBaseStream(config, client, stats),
+      input_selector_(nullptr),
+      active_input_(0),
+      eos_inputs_(),
+      input_sources_(),
+      source_restarts_(0) {}
 
 const char* SrcDecodeBinStream::ClassName() const {
   return "SrcDecodeBinStream";
@@ -52,7 +67,7 @@ void SrcDecodeBinStream::PreLoop() {
   const Config* conf = GetConfig();
   const auto input = conf->GetInput();
   if (client_) {
-    client_->OnInputChanged(input[0]);
+    client_->OnInputChanged(input[active_input_]);
   }
 }
 
@@ -60,6 +75,132 @@ void SrcDecodeBinStream::PostLoop(ExitStatus status) {
   UNUSED(status);
 }
 
+GstPadProbeInfo* SrcDecodeBinStream::CheckProbeData(Probe* probe, GstPadProbeInfo* buff) {
+  if (input_selector_ && probe->GetName() == PROBE_IN && GST_IS_EVENT(GST_PAD_PROBE_INFO_DATA(buff))) {
+    GstEvent* event = GST_PAD_PROBE_INFO_EVENT(buff);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_EOS) {  // eos of one input should not reach decodebin, switch instead
+      GstElement* selector = input_selector_->GetGstElement();
+      GstStructure* info =
+          gst_structure_new(INPUT_EOS_MESSAGE, INPUT_EOS_ID_FIELD, G_TYPE_UINT64, guint64(probe->GetID()), nullptr);
+      gst_element_post_message(selector, gst_message_new_application(GST_OBJECT(selector), info));
+      return nullptr;
+    }
+  }
+
+  return IBaseStream::CheckProbeData(probe, buff);
+}
+
+gboolean SrcDecodeBinStream::HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* message) {
+  if (input_selector_ && GST_MESSAGE_TYPE(message) == GST_MESSAGE_APPLICATION &&
+      GST_MESSAGE_SRC(message) == GST_OBJECT(input_selector_->GetGstElement())) {
+    const GstStructure* info = gst_message_get_structure(message);
+    guint64 id = 0;
+    if (gst_structure_has_name(info, INPUT_EOS_MESSAGE) && gst_structure_get_uint64(info, INPUT_EOS_ID_FIELD, &id) &&
+        id < eos_inputs_.size()) {
+      WARNING_LOG() << "Input " << id << " reached end of stream";
+      eos_inputs_[id] = true;
+      if (id == active_input_ && SwitchToStandbyInput()) {
+        ResetDataWait();
+      }  // otherwise no data timeout stops stream
+    }
+  }
+
+  return IBaseStream::HandleAsyncBusMessageReceived(bus, message);
+}
+
+bool SrcDecodeBinStream::IsActiveInput(element_id_t id) const {
+  return !input_selector_ || id == active_input_;
+}
+
+bool SrcDecodeBinStream::SwitchToStandbyInput() {
+  if (!input_selector_) {
+    return false;
+  }
+
+  const Config* conf = GetConfig();
+  const auto input = conf->GetInput();
+  SharedStreamStruct* stats = GetStats();
+  for (size_t step = 1; step < eos_inputs_.size(); ++step) {
+    const element_id_t id = (active_input_ + step) % eos_inputs_.size();
+    if (eos_inputs_[id] || stats->GetInput(id)->GetDiffTotalBytes() == 0) {  // dead or silent standby
+      continue;
+    }
+
+    pad::Pad* sink_pad = input_selector_->StaticPad(common::MemSPrintf("sink_%lu", id).c_str());
+    if (!sink_pad->IsValid()) {
+      delete sink_pad;
+      continue;
+    }
+
+    input_selector_->SetActivePad(sink_pad->GetGstPad());
+    delete sink_pad;
+    WARNING_LOG() << "Switched from input " << active_input_ << " to standby input " << id;
+    active_input_ = id;
+    if (client_) {
+      client_->OnInputChanged(input[id]);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+bool SrcDecodeBinStream::RestartInputSource() {
+  const element_id_t id = active_input_;
+  if (source_restarts_ >= MAX_SOURCE_RESTARTS || id >= input_sources_.size() || !input_sources_[id]) {
+    return false;  // source keeps failing, full restart
+  }
+
+  elements::Element* old_src = input_sources_[id];
+  pad::Pad* old_pad = old_src->StaticPad("src");
+  GstPad* peer = old_pad->IsValid() ? gst_pad_get_peer(old_pad->GetGstPad()) : nullptr;
+  delete old_pad;
+  if (!peer) {
+    return false;
+  }
+
+  // decodebin or input selector, same sink pad should be reused to keep input id
+  GstElement* next = gst_pad_get_parent_element(peer);
+  gchar* peer_name = gst_pad_get_name(peer);
+  gst_object_unref(peer);
+
+  input_sources_[id] = nullptr;
+  UnLinkInputPad(id);
+  RemoveElement(old_src);
+
+  const Config* conf = GetConfig();
+  const InputUri uri = conf->GetInput()[id];
+  elements::Element* src = elements::sources::make_src(uri, id, src_timeout_sec);
+  pad::Pad* src_pad = src->StaticPad("src");
+  if (src_pad->IsValid()) {
+    LinkInputPad(src_pad->GetGstPad(), id);
+  }
+  delete src_pad;
+  AddElement(src);
+
+  const gboolean linked = gst_element_link_pads(src->GetGstElement(), "src", next, peer_name);
+  g_free(peer_name);
+  gst_object_unref(next);
+  if (!linked) {
+    WARNING_LOG() << "Can't link restarted source " << id << " to pipeline";
+    UnLinkInputPad(id);
+    RemoveElement(src);
+    return false;
+  }
+
+  // new segment with discont flag instead of eos, downstream elements and outputs stay playing
+  gst_element_sync_state_with_parent(src->GetGstElement());
+  input_sources_[id] = src;
+  source_restarts_++;
+  WARNING_LOG() << "Restarted source of input " << id << " (" << source_restarts_ << "/" << MAX_SOURCE_RESTARTS << ")";
+  return true;
+}
+
+void SrcDecodeBinStream::OnInputDataOK() {
+  source_restarts_ = 0;
+  IBaseStream::OnInputDataOK();
+}
+
 void SrcDecodeBinStream::decodebin_pad_added_callback(GstElement* src, GstPad* new_pad, gpointer user_data) {
   SrcDecodeBinStream* stream = reinterpret_cast<SrcDecodeBinStream*>(user_data);
   stream->HandleDecodeBinPadAdded(src, new_pad);
@@ -115,6 +256,20 @@ void SrcDecodeBinStream::OnDecodebinCreated(elements::ElementDecodebin* decodebi
   ConnectDecodebinSignals(decodebin);
 }
 
+void SrcDecodeBinStream::OnInputSourceCreated(elements::Element* src, element_id_t id) {
+  if (id >= input_sources_.size()) {
+    input_sources_.resize(id + 1, nullptr);
+  }
+  input_sources_[id] = src;
+}
+
+void SrcDecodeBinStream::OnInputSelectorCreated(elements::ElementInputSelector* selector) {
+  const Config* conf = GetConfig();
+  input_selector_ = selector;
+  active_input_ = 0;
+  eos_inputs_.assign(conf->GetInput().size(), false);
+}
+
 }  // namespace streams
 }  // namespace stream
 }  // namespace iptv_cloud
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "stream/ibase_stream.h"
 
 #include "stream/elements/element.h"
@@ -30,20 +32,30 @@ class SrcDecodeBinStream : public IBaseStream {
   friend class builders::SrcDecodeStreamBuilder;
 
  public:
-  SrcDecodeBinStream(const Config* config, IStreamClient* client, StreamStruct* stats);
+  SrcDecodeBinStream(const Config* config, IStreamClient* client, SharedStreamStruct* stats);
 
   const char* ClassName() const override;
 
+  GstPadProbeInfo* CheckProbeData(Probe* probe, GstPadProbeInfo* buff) override;
+
  protected:
   void OnInpudSrcPadCreated(common::uri::Url::scheme scheme, pad::Pad* src_pad, element_id_t id) override;
   void OnOutputSinkPadCreated(common::uri::Url::scheme scheme, pad::Pad* sink_pad, element_id_t id) override;
   virtual void OnDecodebinCreated(elements::ElementDecodebin* decodebin);
+  virtual void OnInputSelectorCreated(elements::ElementInputSelector* selector);
+  virtual void OnInputSourceCreated(elements::Element* src, element_id_t id);
 
   IBaseBuilder* CreateBuilder() override = 0;
 
   void PreLoop() override;
   void PostLoop(ExitStatus status) override;
 
+  gboolean HandleAsyncBusMessageReceived(GstBus* bus, GstMessage* message) override;
+  bool IsActiveInput(element_id_t id) const override;
+  bool SwitchToStandbyInput() override;
+  bool RestartInputSource() override;
+  void OnInputDataOK() override;
+
   virtual void ConnectDecodebinSignals(elements::ElementDecodebin* decodebin);
 
   virtual gboolean HandleDecodeBinAutoplugger(GstElement* elem, GstPad* pad, GstCaps* caps) = 0;
@@ -75,6 +87,12 @@ class SrcDecodeBinStream : public IBaseStream {
 
   static void decodebin_element_added_callback(GstBin* bin, GstElement* element, gpointer user_data);
   static void decodebin_element_removed_callback(GstBin* bin, GstElement* element, gpointer user_data);
+
+  elements::ElementInputSelector* input_selector_;  // only in hot standby mode
+  element_id_t active_input_;
+  std::vector<bool> eos_inputs_;  // main loop only
+  std::vector<elements::Element*> input_sources_;
+  size_t source_restarts_;  // in a row, without input data
 };
 
 }  // namespace streams
@@ -21,7 +21,7 @@ namespace stream {
 namespace streams {
 namespace test {
 
-TestLifeStream::TestLifeStream(const RelayConfig* config, IStreamClient* client, StreamStruct* stats)
+TestLifeStream::TestLifeStream(const RelayConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : RelayStream(config, client, stats) {}
 
 const char* TestLifeStream::ClassName() const {
@@ -23,7 +23,7 @@ namespace test {
 
 class TestLifeStream : public RelayStream {
  public:
-  TestLifeStream(const RelayConfig* config, IStreamClient* client, StreamStruct* stats);
+  TestLifeStream(const RelayConfig* config, IStreamClient* client, SharedStreamStruct* stats);
   const char* ClassName() const override;
 
  protected:
@@ -20,7 +20,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-TestInputStream::TestInputStream(const EncodingConfig* config, IStreamClient* client, StreamStruct* stats)
+TestInputStream::TestInputStream(const EncodingConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : EncodingStream(config, client, stats) {}
 
 const char* TestInputStream::ClassName() const {
@@ -21,8 +21,7 @@
 #include "utils/m3u8_reader.h"
 #include "utils/m3u8_writer.h"
 
-#define PLAYLIST_NAME "master.m3u8"
-
+#include "stream/catchup_cut.h"
 #include "stream/streams/builders/timeshift/catchup_stream_builder.h"
 
 namespace iptv_cloud {
@@ -32,9 +31,9 @@ namespace streams {
 CatchupStream::CatchupStream(const TimeshiftConfig* config,
                              const TimeShiftInfo& info,
                              IStreamClient* client,
-                             StreamStruct* stats)
+                             SharedStreamStruct* stats)
     : base_class(config, info, client, stats), chunks_() {
-  auto m3u8_path = info.timshift_dir.MakeFileStringPath(PLAYLIST_NAME);
+  auto m3u8_path = info.timshift_dir.MakeFileStringPath(CATCHUP_PLAYLIST_NAME);
   if (!m3u8_path) {
     return;
   }
@@ -53,22 +52,29 @@ chunk_index_t CatchupStream::GetNextChunkStrategy(chunk_index_t last_index, time
   return last_index + 1;
 }
 
+bool CatchupStream::IsRingStorageSupported() const {
+  return false;
+}
+
 IBaseBuilder* CatchupStream::CreateBuilder() {
   const TimeshiftConfig* tconf = static_cast<const TimeshiftConfig*>(GetConfig());
+  if (tconf->IsPassthrough()) {
+    return base_class::CreateBuilder();
+  }
   return new builders::CatchupStreamBuilder(tconf, this);
 }
 
-void CatchupStream::WriteM3u8List() {
+void CatchupStream::WriteM3u8List(bool end_list) {
   TimeShiftInfo tinf = GetTimeshiftInfo();
-  auto m3u8_path = tinf.timshift_dir.MakeFileStringPath(PLAYLIST_NAME);
+  auto m3u8_path = tinf.timshift_dir.MakeFileStringPath(CATCHUP_PLAYLIST_NAME);
   if (!m3u8_path) {
     return;
   }
 
   utils::M3u8Writer fl;
-  common::ErrnoError err =
-      fl.Open(*m3u8_path, common::file_system::File::FLAG_CREATE | common::file_system::File::FLAG_WRITE);
+  common::ErrnoError err = fl.OpenAtomic(*m3u8_path);
   if (err) {
+    WARNING_LOG() << "Failed to open m3u8 " << m3u8_path->GetPath() << ": " << err->GetDescription();
     return;
   }
 
@@ -79,53 +85,61 @@ void CatchupStream::WriteM3u8List() {
     first_index = chunks_[0].index;
   }
   err = fl.WriteHeader(first_index, duration);
+  if (!err) {
+    err = fl.WritePlaylistType("EVENT");  // chunks are only appended, ENDLIST is added when recording finished
+  }
   if (err) {
     WARNING_LOG() << "Failed to write m3u8 header to " << m3u8_path->GetPath() << ": " << err->GetDescription();
     return;
   }
-  GstClockTime total_time = 0;
   for (size_t i = 0; i < chunks_.size(); ++i) {
     if (!GST_CLOCK_TIME_IS_VALID(chunks_[i].duration)) {
       chunks_[i].duration = duration * GST_SECOND;
     }
-    total_time += chunks_[i].duration;
     err = fl.WriteLine(chunks_[i]);
     if (err) {
       WARNING_LOG() << "Failed to write chunk info to " << m3u8_path->GetPath() << ": " << err->GetDescription();
       return;
     }
   }
-  err = fl.WriteFooter();
+  if (end_list) {
+    err = fl.WriteFooter();
+    if (err) {
+      WARNING_LOG() << "Failed to write m3u8 footer to " << m3u8_path->GetPath() << ": " << err->GetDescription();
+      return;
+    }
+  }
+
+  err = fl.Close();
   if (err) {
-    WARNING_LOG() << "Failed to write m3u8 footer to " << m3u8_path->GetPath() << ": " << err->GetDescription();
+    WARNING_LOG() << "Failed to update m3u8 " << m3u8_path->GetPath() << ": " << err->GetDescription();
   }
 }
 
 void CatchupStream::PostLoop(ExitStatus status) {
-  WriteM3u8List();
+  WriteM3u8List(true);
   base_class::PostLoop(status);
 }
 
-gchararray CatchupStream::OnPathSet(GstElement* splitmux, guint fragment_id, GstSample* sample) {
+chunk_index_t CatchupStream::StartChunk(GstClockTime pts) {
   const chunk_index_t ind = CalcNextIndex();
   const utils::ChunkInfo chunk(common::MemSPrintf("%llu." TS_EXTENSION, ind), GST_CLOCK_TIME_NONE, ind);
 
-  if (sample) {
-    GstBuffer* buffer = gst_sample_get_buffer(sample);
-    if (buffer) {
-      GstClockTime curr_time = GST_BUFFER_DTS_OR_PTS(buffer);
-      if (GST_CLOCK_TIME_IS_VALID(curr_time) && GST_CLOCK_TIME_IS_VALID(chunk_.duration)) {
-        GstClockTime diff = GST_CLOCK_DIFF(chunk_.duration, curr_time);
-        if (!chunks_.empty()) {
-          chunks_[chunks_.size() - 1].duration = diff;
-        }
+  if (GST_CLOCK_TIME_IS_VALID(pts)) {
+    if (GST_CLOCK_TIME_IS_VALID(chunk_.duration)) {
+      GstClockTime diff = GST_CLOCK_DIFF(chunk_.duration, pts);
+      if (!chunks_.empty()) {
+        chunks_[chunks_.size() - 1].duration = diff;
       }
-      chunk_.duration = curr_time;
     }
+    chunk_.duration = pts;
   }
 
+  if (!chunks_.empty()) {  // previous chunk finished, new one is not listed until it is finished too
+    WriteM3u8List(false);
+  }
   chunks_.push_back(chunk);
-  return base_class::OnPathSet(splitmux, fragment_id, sample);
+  return base_class::StartChunk(pts);
 }
 
 }  // namespace streams
@@ -25,19 +25,24 @@ namespace streams {
 class CatchupStream : public TimeShiftRecorderStream {
  public:
   typedef TimeShiftRecorderStream base_class;
-  CatchupStream(const TimeshiftConfig* config, const TimeShiftInfo& info, IStreamClient* client, StreamStruct* stats);
+  CatchupStream(const TimeshiftConfig* config,
+                const TimeShiftInfo& info,
+                IStreamClient* client,
+                SharedStreamStruct* stats);
 
   const char* ClassName() const override;
 
  protected:
   chunk_index_t GetNextChunkStrategy(chunk_index_t last_index, time_t last_index_created_time) const override;
+  bool IsRingStorageSupported() const override;  // playlist references chunk files
   IBaseBuilder* CreateBuilder() override;
 
   void PostLoop(ExitStatus status) override;
-  gchararray OnPathSet(GstElement* splitmux, guint fragment_id, GstSample* sample) override;
+  chunk_index_t StartChunk(GstClockTime pts) override;
 
  private:
-  void WriteM3u8List();
+  // rewrites playlist with finished chunks atomically, so it is playable while recording
+  void WriteM3u8List(bool end_list);
   std::vector<utils::ChunkInfo> chunks_;
 };
 
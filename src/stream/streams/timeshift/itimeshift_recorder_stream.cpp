@@ -21,7 +21,7 @@ namespace streams {
 ITimeShiftRecorderStream::ITimeShiftRecorderStream(const RelayConfig* config,
                                                    const TimeShiftInfo& info,
                                                    IStreamClient* client,
-                                                   StreamStruct* stats)
+                                                   SharedStreamStruct* stats)
     : base_class(config, client, stats), timeshift_info_(info) {
   CHECK(GetType() == TIMESHIFT_RECORDER || GetType() == CATCHUP);
 }
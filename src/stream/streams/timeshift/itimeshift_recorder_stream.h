@@ -28,7 +28,7 @@ class ITimeShiftRecorderStream : public RelayStream {
   ITimeShiftRecorderStream(const RelayConfig* config,
                            const TimeShiftInfo& info,
                            IStreamClient* client,
-                           StreamStruct* stats);
+                           SharedStreamStruct* stats);
   const char* ClassName() const override;
 
   TimeShiftInfo GetTimeshiftInfo() const;
@@ -23,7 +23,7 @@ namespace streams {
 TimeShiftPlayerStream::TimeShiftPlayerStream(const RelayConfig* config,
                                              const TimeShiftInfo& info,
                                              IStreamClient* client,
-                                             StreamStruct* stats,
+                                             SharedStreamStruct* stats,
                                              chunk_index_t start_chunk_index)
     : base_class(config, client, stats), timeshift_info_(info), start_chunk_index_(start_chunk_index) {}
 
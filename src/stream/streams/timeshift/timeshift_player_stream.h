@@ -28,7 +28,7 @@ class TimeShiftPlayerStream : public RelayStream {
   TimeShiftPlayerStream(const RelayConfig* config,
                         const TimeShiftInfo& info,
                         IStreamClient* client,
-                        StreamStruct* stats,
+                        SharedStreamStruct* stats,
                         chunk_index_t start_chunk_index);
   const char* ClassName() const override;
 
@@ -14,6 +14,9 @@
 
 #include "stream/streams/timeshift/timeshift_recorder_stream.h"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <string>
 
 #include <common/file_system/string_path_utils.h>
@@ -22,8 +25,11 @@
 #include "base/constants.h"
 
 #include "stream/elements/sink/sink.h"
+#include "stream/elements/sink/timeshift_ring.h"
+#include "stream/elements/sink/ts_chunk.h"
 #include "stream/pad/pad.h"
 #include "stream/streams/builders/timeshift/timeshift_recorder_stream_builder.h"
+#include "stream/streams/builders/timeshift/ts_timeshift_recorder_stream_builder.h"
 
 #include "utils/utils.h"
 
@@ -54,38 +60,115 @@ namespace streams {
 TimeShiftRecorderStream::TimeShiftRecorderStream(const TimeshiftConfig* config,
                                                  const TimeShiftInfo& info,
                                                  IStreamClient* client,
-                                                 StreamStruct* stats)
-    : base_class(config, info, client, stats), chunk_(), audio_pad_(nullptr), video_pad_(nullptr) {}
+                                                 SharedStreamStruct* stats)
+    : base_class(config, info, client, stats),
+      chunk_(),
+      audio_pad_(nullptr),
+      video_pad_(nullptr),
+      ring_sink_(nullptr),
+      ts_sink_(nullptr),
+      in_ring_(false),
+      index_(),
+      current_entry_(),
+      last_index_(invalid_chunk_index) {
+  current_entry_.index = invalid_chunk_index;
+}
 
 const char* TimeShiftRecorderStream::ClassName() const {
   return "TimeShiftRecorderStream";
 }
 
 TimeShiftRecorderStream::~TimeShiftRecorderStream() {
-  elements::Element* splitmuxsink = GetElementByName(common::MemSPrintf(SPLIT_SINK_NAME_1U, 0));
-  if (audio_pad_) {
-    splitmuxsink->ReleaseRequestedPad(audio_pad_);
-  }
-  if (video_pad_) {
-    splitmuxsink->ReleaseRequestedPad(video_pad_);
+  if (audio_pad_ || video_pad_) {  // passthrough pipeline has no splitmuxsink
+    elements::Element* splitmuxsink = GetElementByName(common::MemSPrintf(SPLIT_SINK_NAME_1U, 0));
+    if (audio_pad_) {
+      splitmuxsink->ReleaseRequestedPad(audio_pad_);
+    }
+    if (video_pad_) {
+      splitmuxsink->ReleaseRequestedPad(video_pad_);
+    }
   }
   destroy(&audio_pad_);
   destroy(&video_pad_);
+  destroy(&ring_sink_);
 }
 
 void TimeShiftRecorderStream::OnSplitmuxsinkCreated(Connector conn, elements::sink::ElementSplitMuxSink* sink) {
+  OpenIndex();
+
+  TimeShiftInfo tinfo = GetTimeshiftInfo();
+  if (tinfo.timeshift_ring_size && IsRingStorageSupported()) {
+    const std::string ring_path = tinfo.GetRingPath();
+    elements::sink::ElementTimeShiftRingSink* ring_sink = elements::sink::make_timeshift_ring_sink(0);
+    common::ErrnoError err = ring_sink->Open(ring_path, tinfo.timeshift_ring_size);
+    if (err) {
+      WARNING_LOG() << "Failed to open timeshift ring " << ring_path << ", file per chunk is used: "
+                    << err->GetDescription();
+      delete ring_sink;
+    } else {
+      sink->SetSink(ring_sink);
+      ring_sink_ = ring_sink;
+      in_ring_ = true;
+    }
+  }
+
+  if (!in_ring_) {
+    RemoveStaleRing();
+  }
+
+  gboolean res = sink->RegisterFormatLocationFullCallback(TimeShiftRecorderStream::path_setter_full_callback, this);
+  DCHECK(res);
+
+  audio_pad_ = link_to_multiplexer(conn.audio, sink, "audio_%u");
+  video_pad_ = link_to_multiplexer(conn.video, sink, "video");
+}
+
+void TimeShiftRecorderStream::OnTsChunkSinkCreated(elements::sink::ElementTsChunkSink* sink) {
+  OpenIndex();
+
+  TimeShiftInfo tinfo = GetTimeshiftInfo();
+  if (tinfo.timeshift_ring_size && IsRingStorageSupported()) {
+    const std::string ring_path = tinfo.GetRingPath();
+    common::ErrnoError err = sink->OpenRing(ring_path, tinfo.timeshift_ring_size);
+    if (err) {
+      WARNING_LOG() << "Failed to open timeshift ring " << ring_path << ", file per chunk is used: "
+                    << err->GetDescription();
+    } else {
+      in_ring_ = true;
+    }
+  }
+
+  if (!in_ring_) {
+    RemoveStaleRing();
+  }
+
+  sink->RegisterChunkStartedCallback(TimeShiftRecorderStream::chunk_started_callback, this);
+  ts_sink_ = sink;
+}
+
+void TimeShiftRecorderStream::RemoveStaleRing() {
+  // ring of previous run in ring mode, players and http server would take archive from it otherwise
+  const std::string ring_path = GetTimeshiftInfo().GetRingPath();
+  if (unlink(ring_path.c_str()) == 0) {
+    INFO_LOG() << "Stale timeshift ring " << ring_path << " removed, file per chunk is used";
+  }
+}
+
+void TimeShiftRecorderStream::OpenIndex() {
   TimeShiftInfo tinfo = GetTimeshiftInfo();
   chunk_index_t index = invalid_chunk_index;
   time_t file_created_time = 0;
   if (tinfo.FindLastChunk(&index, &file_created_time)) {
+    last_index_ = index;
     index = GetNextChunkStrategy(index, file_created_time);
   }
   chunk_ = {tinfo.timshift_dir.GetPath(), index, GST_CLOCK_TIME_NONE};
-  gboolean res = sink->RegisterFormatLocationFullCallback(TimeShiftRecorderStream::path_setter_full_callback, this);
-  DCHECK(res);
 
-  audio_pad_ = link_to_multiplexer(conn.audio, sink, "audio_%u");
-  video_pad_ = link_to_multiplexer(conn.video, sink, "video");
+  const std::string index_path = tinfo.GetIndexPath();  // after last chunk lookup, old archives have no index
+  common::ErrnoError err = index_.Open(index_path);
+  if (err) {
+    WARNING_LOG() << "Failed to open timeshift index " << index_path << ": " << err->GetDescription();
+  }
 }
 
 chunk_index_t TimeShiftRecorderStream::GetNextChunkStrategy(chunk_index_t last_index,
@@ -100,8 +183,15 @@ chunk_index_t TimeShiftRecorderStream::GetNextChunkStrategy(chunk_index_t last_i
   return last_index;
 }
 
+bool TimeShiftRecorderStream::IsRingStorageSupported() const {
+  return true;
+}
+
 IBaseBuilder* TimeShiftRecorderStream::CreateBuilder() {
   const TimeshiftConfig* tconf = static_cast<const TimeshiftConfig*>(GetConfig());
+  if (tconf->IsPassthrough()) {
+    return new builders::TsTimeShiftRecorderStreamBuilder(tconf, this);
+  }
   return new builders::TimeShiftRecorderStreamBuilder(tconf, this);
 }
 
@@ -116,7 +206,15 @@ gboolean TimeShiftRecorderStream::HandleMainTimerTick() {
   time_t el = GetElipsedTime();
   if (el % no_data_panic_sec == 0) {
     const time_t max_life_time = common::time::current_utc_mstime() / 1000 - tinfo.timeshift_chunk_life_time;
-    utils::RemoveOldFilesByTime(tinfo.timshift_dir, max_life_time, CHUNK_EXT);
+    if (!in_ring_) {  // ring evicts old chunks itself while writing
+      utils::RemoveOldFilesByTime(tinfo.timshift_dir, max_life_time, CHUNK_EXT);
+    }
+    if (index_.IsOpen()) {
+      common::ErrnoError err = index_.RemoveOlderThan(max_life_time * 1000);
+      if (err) {
+        WARNING_LOG() << "Failed to cleanup timeshift index: " << err->GetDescription();
+      }
+    }
   }
   return base_class::HandleMainTimerTick();
 }
@@ -125,28 +223,103 @@ void TimeShiftRecorderStream::OnOutputDataFailed() {
   OnOutputDataOK();
 }
 
+void TimeShiftRecorderStream::PostLoop(ExitStatus status) {
+  if (ts_sink_) {
+    ts_sink_->Close();
+  }
+  FinishChunk(GST_CLOCK_TIME_NONE);
+  base_class::PostLoop(status);
+}
+
 chunk_index_t TimeShiftRecorderStream::CalcNextIndex() const {
   chunk_index_t index = chunk_.index;
   if (index == invalid_chunk_index) {
     index = 0;
   }
 
-  std::string old_path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, index);
-  if (common::file_system::is_file_exist(old_path)) {  // if chunk exist move to next
-    index++;
+  if (last_index_ != invalid_chunk_index && index <= last_index_) {  // if chunk exist move to next
+    index = last_index_ + 1;
   }
 
   return index;
 }
 
-gchararray TimeShiftRecorderStream::OnPathSet(GstElement* splitmux, guint fragment_id, GstSample* sample) {
-  UNUSED(splitmux);
-  UNUSED(fragment_id);
-  UNUSED(sample);
+void TimeShiftRecorderStream::FinishChunk(GstClockTime next_chunk_pts) {
+  if (current_entry_.index == invalid_chunk_index) {
+    return;
+  }
+
+  TimeShiftIndexEntry entry = current_entry_;
+  current_entry_.index = invalid_chunk_index;
+  if (GST_CLOCK_TIME_IS_VALID(entry.start_pts) && GST_CLOCK_TIME_IS_VALID(next_chunk_pts) &&
+      next_chunk_pts > entry.start_pts) {
+    entry.duration = next_chunk_pts - entry.start_pts;
+  } else {
+    entry.duration = (common::time::current_utc_mstime() - entry.start_time) * GST_MSECOND;
+  }
+
+  if (ts_sink_) {
+    entry.size = ts_sink_->GetLastChunkSize();
+    if (!entry.size) {  // chunk always starts with program tables
+      WARNING_LOG() << "Chunk " << entry.index << " was not stored";
+      return;
+    }
+  } else if (ring_sink_) {
+    TimeShiftRingChunk ring_chunk;
+    common::ErrnoError err = ring_sink_->FinishChunk(&ring_chunk);
+    if (err) {
+      WARNING_LOG() << "Failed to finish chunk " << entry.index << " in timeshift ring: " << err->GetDescription();
+      return;
+    }
+    entry.size = ring_chunk.size;
+  } else {
+    const std::string path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, entry.index);
+    struct stat sb;
+    if (stat(path.c_str(), &sb) == 0) {
+      entry.size = sb.st_size;
+    }
+  }
+
+  if (!index_.IsOpen()) {
+    return;
+  }
+
+  common::ErrnoError err = index_.Append(entry);
+  if (err) {
+    WARNING_LOG() << "Failed to append chunk " << entry.index << " to timeshift index: " << err->GetDescription();
+  }
+}
+
+chunk_index_t TimeShiftRecorderStream::StartChunk(GstClockTime pts) {
+  FinishChunk(pts);
 
   chunk_index_t ind = CalcNextIndex();
   chunk_.index = ind;
-  std::string new_path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, chunk_.index);
+  last_index_ = ind;
+  current_entry_ = TimeShiftIndexEntry();
+  current_entry_.index = ind;
+  current_entry_.start_time = common::time::current_utc_mstime();
+  current_entry_.start_pts = pts;
+  if (ring_sink_) {
+    common::ErrnoError err = ring_sink_->BeginChunk(ind);
+    if (err) {
+      WARNING_LOG() << "Failed to begin chunk " << ind << " in timeshift ring: " << err->GetDescription();
+    }
+  }
+  return ind;
+}
+
+gchararray TimeShiftRecorderStream::OnPathSet(GstSample* sample) {
+  GstClockTime pts = GST_CLOCK_TIME_NONE;
+  if (sample) {
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    if (buffer) {
+      pts = GST_BUFFER_DTS_OR_PTS(buffer);
+    }
+  }
+
+  const chunk_index_t ind = StartChunk(pts);
+  std::string new_path = common::MemSPrintf("%s%llu." TS_EXTENSION, chunk_.path, ind);
   return strdup(new_path.c_str());
 }
 
@@ -159,9 +332,15 @@ gchararray TimeShiftRecorderStream::path_setter_full_callback(GstElement* splitm
                                                               GstSample* sample,
                                                               gpointer user_data) {
   UNUSED(splitmux);
+  UNUSED(fragment_id);
+
+  TimeShiftRecorderStream* stream = reinterpret_cast<TimeShiftRecorderStream*>(user_data);
+  return stream->OnPathSet(sample);
+}
 
+chunk_index_t TimeShiftRecorderStream::chunk_started_callback(GstClockTime pts, gpointer user_data) {
   TimeShiftRecorderStream* stream = reinterpret_cast<TimeShiftRecorderStream*>(user_data);
-  return stream->OnPathSet(splitmux, fragment_id, sample);
+  return stream->StartChunk(pts);
 }
 
 }  // namespace streams
@@ -16,6 +16,8 @@
 
 #include "stream/streams/timeshift/itimeshift_recorder_stream.h"
 
+#include "stream/timeshift_index.h"
+
 #include "utils/chunk_info.h"
 
 namespace iptv_cloud {
@@ -23,28 +25,34 @@ namespace stream {
 namespace elements {
 namespace sink {
 class ElementSplitMuxSink;
+class ElementTimeShiftRingSink;
+class ElementTsChunkSink;
 }
 }  // namespace elements
 namespace streams {
 
 namespace builders {
 class TimeShiftRecorderStreamBuilder;
+class TsTimeShiftRecorderStreamBuilder;
 }
 
 class TimeShiftRecorderStream : public ITimeShiftRecorderStream {
   friend class builders::TimeShiftRecorderStreamBuilder;
+  friend class builders::TsTimeShiftRecorderStreamBuilder;
 
  public:
   typedef ITimeShiftRecorderStream base_class;
   TimeShiftRecorderStream(const TimeshiftConfig* config,
                           const TimeShiftInfo& info,
                           IStreamClient* client,
-                          StreamStruct* stats);
+                          SharedStreamStruct* stats);
   const char* ClassName() const override;
   ~TimeShiftRecorderStream() override;
 
  protected:
   virtual void OnSplitmuxsinkCreated(Connector conn, elements::sink::ElementSplitMuxSink* sink);
+  virtual void OnTsChunkSinkCreated(elements::sink::ElementTsChunkSink* sink);  // passthrough mode
+  virtual bool IsRingStorageSupported() const;  // chunks are written into ring file if it is configured
   chunk_index_t GetNextChunkStrategy(chunk_index_t last_index, time_t last_index_created_time) const override;
 
   IBaseBuilder* CreateBuilder() override;
@@ -53,7 +61,9 @@ class TimeShiftRecorderStream : public ITimeShiftRecorderStream {
 
   gboolean HandleMainTimerTick() override;
   void OnOutputDataFailed() override;
-  virtual gchararray OnPathSet(GstElement* splitmux, guint fragment_id, GstSample* sample);
+  void PostLoop(ExitStatus status) override;
+  // finishes previous chunk, pts of first buffer of new chunk, returns its index
+  virtual chunk_index_t StartChunk(GstClockTime pts);
 
   chunk_index_t CalcNextIndex() const;
   utils::ChunkInfo chunk_;
@@ -64,9 +74,22 @@ class TimeShiftRecorderStream : public ITimeShiftRecorderStream {
                                               guint fragment_id,
                                               GstSample* sample,
                                               gpointer user_data);
+  static chunk_index_t chunk_started_callback(GstClockTime pts, gpointer user_data);
+
+  void OpenIndex();        // continues numbering of existing archive
+  void RemoveStaleRing();  // file per chunk mode
+  gchararray OnPathSet(GstSample* sample);
+  void FinishChunk(GstClockTime next_chunk_pts);
 
   pad::Pad* audio_pad_;
   pad::Pad* video_pad_;
+  elements::sink::ElementTimeShiftRingSink* ring_sink_;  // nullptr if chunks are separate files
+  elements::sink::ElementTsChunkSink* ts_sink_;          // passthrough mode, owned by pipeline
+  bool in_ring_;                                         // chunks are written into ring file
+
+  TimeShiftIndexWriter index_;
+  TimeShiftIndexEntry current_entry_;  // chunk in progress, index is invalid_chunk_index if none
+  chunk_index_t last_index_;           // last recorded or in progress chunk
 };
 
 }  // namespace streams
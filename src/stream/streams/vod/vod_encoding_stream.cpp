@@ -20,7 +20,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-VodEncodeStream::VodEncodeStream(const VodEncodeConfig* config, IStreamClient* client, StreamStruct* stats)
+VodEncodeStream::VodEncodeStream(const VodEncodeConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : base_class(config, client, stats) {
   CHECK(config->IsVod());
 }
@@ -23,7 +23,7 @@ namespace streams {
 class VodEncodeStream : public EncodingStream {
  public:
   typedef EncodingStream base_class;
-  VodEncodeStream(const VodEncodeConfig* config, IStreamClient* client, StreamStruct* stats);
+  VodEncodeStream(const VodEncodeConfig* config, IStreamClient* client, SharedStreamStruct* stats);
 
   const char* ClassName() const override;
 
@@ -20,7 +20,7 @@ namespace iptv_cloud {
 namespace stream {
 namespace streams {
 
-VodRelayStream::VodRelayStream(const VodRelayConfig* config, IStreamClient* client, StreamStruct* stats)
+VodRelayStream::VodRelayStream(const VodRelayConfig* config, IStreamClient* client, SharedStreamStruct* stats)
     : base_class(config, client, stats) {
   CHECK(config->IsVod());
 }
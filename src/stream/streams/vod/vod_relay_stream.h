@@ -23,7 +23,7 @@ namespace streams {
 class VodRelayStream : public RelayStream {
  public:
   typedef RelayStream base_class;
-  VodRelayStream(const VodRelayConfig* config, IStreamClient* client, StreamStruct* stats);
+  VodRelayStream(const VodRelayConfig* config, IStreamClient* client, SharedStreamStruct* stats);
 
   const char* ClassName() const override;
 
@@ -24,6 +24,7 @@
 #include "stream/streams/encoding/playlist_encoding_stream.h"
 #include "stream/streams/mosaic_stream.h"
 #include "stream/streams/relay/playlist_relay_stream.h"
+#include "stream/streams/relay/ts_relay_stream.h"
 #include "stream/streams/test/test_life_stream.h"
 #include "stream/streams/test/test_stream.h"
 #include "stream/streams/timeshift/catchup_stream.h"
@@ -39,7 +40,7 @@ namespace stream {
 
 IBaseStream* StreamsFactory::CreateStream(const Config* config,
                                           IBaseStream::IStreamClient* client,
-                                          StreamStruct* stats,
+                                          SharedStreamStruct* stats,
                                           const TimeShiftInfo& tinfo,
                                           chunk_index_t start_chunk_index) {
   input_t input = config->GetInput();
@@ -49,7 +50,7 @@ IBaseStream* StreamsFactory::CreateStream(const Config* config,
     return nullptr;
   } else if (type == RELAY) {
     const streams::RelayConfig* rconfig = static_cast<const streams::RelayConfig*>(config);
-    if (input.size() > 1) {
+    if (input.size() > 1 && !rconfig->IsHotStandby()) {
       bool is_playlist = true;
       for (InputUri iuri : input) {
         common::uri::Url input_uri = iuri.GetInput();
@@ -65,10 +66,14 @@ IBaseStream* StreamsFactory::CreateStream(const Config* config,
       // return new streams::MosaicStream(rconfig, client, stats);
     }
 
+    if (rconfig->IsPassthrough()) {
+      return new streams::TsRelayStream(rconfig, client, stats);
+    }
+
     return new streams::RelayStream(rconfig, client, stats);
   } else if (type == ENCODE) {
     const streams::EncodingConfig* econfig = static_cast<const streams::EncodingConfig*>(config);
-    if (input.size() > 1) {
+    if (input.size() > 1 && !econfig->IsHotStandby()) {
       bool is_playlist = true;
       for (InputUri iuri : input) {
         common::uri::Url input_uri = iuri.GetInput();
@@ -29,7 +29,7 @@ class StreamsFactory : public common::patterns::LazySingleton<StreamsFactory> {
 
   IBaseStream* CreateStream(const Config* config,
                             IBaseStream::IStreamClient* client,
-                            StreamStruct* stats,
+                            SharedStreamStruct* stats,
                             const TimeShiftInfo& tinfo,
                             chunk_index_t start_chunk_index);
 };
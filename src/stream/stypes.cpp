@@ -14,6 +14,8 @@
 
 #include "stream/stypes.h"
 
+#include <ctype.h>
+
 #include <regex>
 
 #include <common/convert2string.h>
@@ -76,6 +78,30 @@ bool IsFakeUrl(const common::uri::Url& url) {
   return url == common::uri::Url(FAKE_URL);
 }
 
+bool IsLocalUrl(const common::uri::Url& url, std::string* hub_name) {
+  const std::string url_str = url.GetUrl();
+  const size_t prefix_size = sizeof(LOCAL_URL_PREFIX) - 1;
+  if (url_str.compare(0, prefix_size, LOCAL_URL_PREFIX) != 0) {
+    return false;
+  }
+
+  const std::string name = url_str.substr(prefix_size);
+  if (name.empty()) {
+    return false;
+  }
+
+  for (char c : name) {  // used as file name of hub ring
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-') {
+      return false;
+    }
+  }
+
+  if (hub_name) {
+    *hub_name = name;
+  }
+  return true;
+}
+
 bool GetElementId(const std::string& name, element_id_t* elem_id) {
   if (!elem_id) {
     return false;
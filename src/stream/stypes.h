@@ -27,6 +27,9 @@
 
 #define VIDEO_TEE_NAME_1U "video_tee_%lu"
 #define AUDIO_TEE_NAME_1U "audio_tee_%lu"
+#define VIDEO_LADDER_TEE_NAME_1U "video_ladder_tee_%lu"
+#define VIDEO_LADDER_QUEUE_NAME_1U "video_ladder_queue_%lu"
+#define TS_TEE_NAME_1U "ts_tee_%lu"
 
 #define UDB_VIDEO_NAME_1U "udb_conn_video_%lu"
 #define UDB_AUDIO_NAME_1U "udb_conn_audio_%lu"
@@ -66,6 +69,7 @@
 #define MPEG_AUDIO_PARSE_NAME_1U "mpegaudioparse_%lu"
 
 #define DECODEBIN_NAME_1U "decodebin_%lu"
+#define INPUT_SELECTOR_NAME_1U "input_selector_%lu"
 #define VIDEOBOX_NAME_1U "videobox_%lu"
 
 #define VIDEO_DECODEBIN_NAME_1U "video_decodebin_%lu"
@@ -84,6 +88,7 @@
 
 #define VIDEO_TEE_QUEUE_NAME_1U "video_tee_queue_%lu"
 #define AUDIO_TEE_QUEUE_NAME_1U "audio_tee_queue_%lu"
+#define TS_TEE_QUEUE_NAME_1U "ts_tee_queue_%lu"
 
 #define AUDIO_LEVEL_NAME_1U "level_%lu"
 
@@ -95,6 +100,7 @@
 
 #define RECORDING_URL "rec"
 #define FAKE_URL "fake"
+#define LOCAL_URL_PREFIX "local://"  // ingest hub, local://<hub_name>
 
 namespace iptv_cloud {
 namespace stream {
@@ -162,6 +168,7 @@ bool IsDeviceOutUrl(const common::uri::Url& url, SinkDeviceType* type);
 
 bool IsRecordingUrl(const common::uri::Url& url);
 bool IsFakeUrl(const common::uri::Url& url);
+bool IsLocalUrl(const common::uri::Url& url, std::string* hub_name);
 
 }  // namespace stream
 }  // namespace iptv_cloud
@@ -26,6 +26,8 @@
 
 #include "base/constants.h"
 #include "stream/stypes.h"
+#include "stream/timeshift_index.h"
+#include "stream/timeshift_ring.h"
 
 namespace iptv_cloud {
 namespace stream {
@@ -51,20 +53,12 @@ bool compare_files(const common::file_system::ascii_file_string_path& first,
   CHECK(ok) << "Must be index but: " << second_chunk;
   return first_index < second_index;
 }
-}  // namespace
-
-TimeShiftInfo::TimeShiftInfo()
-    : timshift_dir(), timeshift_chunk_life_time(DEFAULT_CHUNK_LIFE_TIME), timeshift_delay(0) {}
-
-TimeShiftInfo::TimeShiftInfo(const std::string& path, chunk_life_time_t lth, time_shift_delay_t delay)
-    : timshift_dir(path), timeshift_chunk_life_time(lth), timeshift_delay(delay) {}
-
-bool TimeShiftInfo::FindChunkToPlay(time_t chunk_duration, chunk_index_t* index) const {
-  if (!index) {
-    return false;
-  }
 
-  time_t desired_time = common::time::current_utc_mstime() / 1000 - timeshift_delay * 60;  // OK
+// archives recorded without index
+bool ScanChunkToPlay(const common::file_system::ascii_directory_string_path& timshift_dir,
+                     time_t desired_time,
+                     time_t chunk_duration,
+                     chunk_index_t* index) {
   std::string absolute_path = timshift_dir.GetPath();
   if (!common::file_system::is_directory_exist(absolute_path)) {
     CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
@@ -102,11 +96,9 @@ bool TimeShiftInfo::FindChunkToPlay(time_t chunk_duration, chunk_index_t* index)
   return false;
 }
 
-bool TimeShiftInfo::FindLastChunk(chunk_index_t* index, time_t* file_created_time) const {
-  if (!index || !file_created_time) {
-    return false;
-  }
-
+bool ScanLastChunk(const common::file_system::ascii_directory_string_path& timshift_dir,
+                   chunk_index_t* index,
+                   time_t* file_created_time) {
   const std::string absolute_path = timshift_dir.GetPath();
   if (!common::file_system::is_directory_exist(absolute_path)) {
     CRITICAL_LOG() << "Folder with chunks doesn't exist: " << absolute_path;
@@ -130,6 +122,85 @@ bool TimeShiftInfo::FindLastChunk(chunk_index_t* index, time_t* file_created_tim
   *index = lindex;
   return true;
 }
+}  // namespace
+
+TimeShiftInfo::TimeShiftInfo()
+    : timshift_dir(),
+      timeshift_chunk_life_time(DEFAULT_CHUNK_LIFE_TIME),
+      timeshift_delay(0),
+      timeshift_ring_size(0),
+      catchup_archive_dir(),
+      catchup_start(0),
+      catchup_stop(0) {}
+
+TimeShiftInfo::TimeShiftInfo(const std::string& path, chunk_life_time_t lth, time_shift_delay_t delay)
+    : timshift_dir(path),
+      timeshift_chunk_life_time(lth),
+      timeshift_delay(delay),
+      timeshift_ring_size(0),
+      catchup_archive_dir(),
+      catchup_start(0),
+      catchup_stop(0) {}
+
+std::string TimeShiftInfo::GetIndexPath() const {
+  return timshift_dir.GetPath() + TIMESHIFT_INDEX_NAME;
+}
+
+std::string TimeShiftInfo::GetRingPath() const {
+  return timshift_dir.GetPath() + TIMESHIFT_RING_NAME;
+}
+
+bool TimeShiftInfo::FindChunkToPlay(time_t chunk_duration, chunk_index_t* index) const {
+  if (!index) {
+    return false;
+  }
+
+  const int64_t desired_time = common::time::current_utc_mstime() - timeshift_delay * 60 * 1000;
+  TimeShiftIndexReader reader;
+  common::ErrnoError err = reader.Open(GetIndexPath());
+  TimeShiftIndexEntry entry;
+  if (err || !reader.FindByTime(desired_time, &entry)) {
+    // empty index of fresh archive or archive recorded without index
+    return ScanChunkToPlay(timshift_dir, desired_time / 1000, chunk_duration, index);
+  }
+
+  const int64_t diff = desired_time - entry.GetEndTime();
+  if (diff >= chunk_duration * 1000) {
+    // chunk in progress at recorder crash is not indexed, otherwise hole in archive, wait until recorder fills it
+    return ScanChunkToPlay(timshift_dir, desired_time / 1000, chunk_duration, index);
+  }
+
+  *index = entry.index;
+  INFO_LOG() << "Select " << *index << " part, diff msec " << diff;
+  return true;
+}
+
+bool TimeShiftInfo::FindLastChunk(chunk_index_t* index, time_t* file_created_time) const {
+  if (!index || !file_created_time) {
+    return false;
+  }
+
+  TimeShiftIndexReader reader;
+  TimeShiftIndexEntry entry;
+  if (reader.Open(GetIndexPath()) || !reader.GetLast(&entry)) {
+    // archive recorded without index or index is empty after first start
+    return ScanLastChunk(timshift_dir, index, file_created_time);
+  }
+
+  // chunk in progress at recorder crash is on disk but not indexed
+  const chunk_index_t next_index = entry.index + 1;
+  const std::string next_path = timshift_dir.GetPath() + common::ConvertToString(next_index) + CHUNK_EXT;
+  time_t next_time = 0;
+  if (!common::file_system::get_file_time_last_modification(next_path, &next_time)) {
+    *index = next_index;
+    *file_created_time = next_time;
+    return true;
+  }
+
+  *index = entry.index;
+  *file_created_time = entry.GetEndTime() / 1000;
+  return true;
+}
 
 }  // namespace stream
 }  // namespace iptv_cloud
@@ -32,12 +32,20 @@ struct TimeShiftInfo {
   TimeShiftInfo();
   explicit TimeShiftInfo(const std::string& path, chunk_life_time_t lth, time_shift_delay_t delay);
 
+  std::string GetIndexPath() const;
+  std::string GetRingPath() const;
   bool FindLastChunk(chunk_index_t* index, time_t* file_created_time) const WARN_UNUSED_RESULT;
   bool FindChunkToPlay(time_t chunk_duration, chunk_index_t* index) const WARN_UNUSED_RESULT;
 
   common::file_system::ascii_directory_string_path timshift_dir;
   chunk_life_time_t timeshift_chunk_life_time;
   time_shift_delay_t timeshift_delay;
+  uint64_t timeshift_ring_size;  // bytes, recorder writes into ring file if set, otherwise file per chunk
+
+  // catchup is cut from archive of timeshift recorder if set, instead of own recording
+  common::file_system::ascii_directory_string_path catchup_archive_dir;
+  time_t catchup_start;  // utc sec, stream start if 0
+  time_t catchup_stop;   // utc sec, until stream stopped if 0
 };
 
 }  // namespace stream
@@ -0,0 +1,278 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/timeshift_index.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#define INDEX_FILE_MODE (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)
+
+namespace iptv_cloud {
+namespace stream {
+
+static_assert(sizeof(TimeShiftIndexEntry) == 56, "Index entry layout is part of file format");
+
+namespace {
+common::ErrnoError WriteAll(descriptor_t fd, const void* data, size_t size) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size) {
+    ssize_t res = write(fd, ptr, size);
+    if (res == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return common::make_errno_error(errno);
+    }
+    ptr += res;
+    size -= res;
+  }
+  return common::ErrnoError();
+}
+}  // namespace
+
+TimeShiftIndexEntry::TimeShiftIndexEntry()
+    : index(0), start_time(0), start_pts(UINT64_MAX), duration(0), size(0), sequence(0), discontinuity(0) {}
+
+int64_t TimeShiftIndexEntry::GetEndTime() const {
+  return start_time + duration / 1000000;
+}
+
+TimeShiftIndexWriter::TimeShiftIndexWriter() : path_(), fd_(INVALID_DESCRIPTOR), last_(), have_last_(false) {}
+
+TimeShiftIndexWriter::~TimeShiftIndexWriter() {
+  Close();
+}
+
+common::ErrnoError TimeShiftIndexWriter::Open(const std::string& path) {
+  if (path.empty()) {
+    return common::make_errno_error_inval();
+  }
+
+  Close();
+  // read too, numbering continues from last record
+  descriptor_t fd = open(path.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, INDEX_FILE_MODE);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  const off_t tail = sb.st_size % sizeof(TimeShiftIndexEntry);
+  if (tail && ftruncate(fd, sb.st_size - tail) == -1) {  // record torn by crash
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  const off_t size = sb.st_size - tail;
+  if (size) {
+    TimeShiftIndexEntry last;
+    if (pread(fd, &last, sizeof(last), size - sizeof(last)) == sizeof(last)) {
+      last_ = last;
+      have_last_ = true;
+    }
+  }
+
+  path_ = path;
+  fd_ = fd;
+  return common::ErrnoError();
+}
+
+bool TimeShiftIndexWriter::IsOpen() const {
+  return fd_ != INVALID_DESCRIPTOR;
+}
+
+common::ErrnoError TimeShiftIndexWriter::Append(const TimeShiftIndexEntry& entry) {
+  if (!IsOpen()) {
+    return common::make_errno_error_inval();
+  }
+
+  TimeShiftIndexEntry record = entry;
+  record.sequence = have_last_ ? last_.sequence + 1 : 0;
+  record.discontinuity = have_last_ && entry.index != last_.index + 1 ? last_.discontinuity + 1 : last_.discontinuity;
+  common::ErrnoError err = WriteAll(fd_, &record, sizeof(record));
+  if (err) {
+    return err;
+  }
+
+  last_ = record;
+  have_last_ = true;
+  return common::ErrnoError();
+}
+
+common::ErrnoError TimeShiftIndexWriter::RemoveOlderThan(int64_t msec) {
+  if (!IsOpen()) {
+    return common::make_errno_error_inval();
+  }
+
+  TimeShiftIndexReader reader;
+  common::ErrnoError err = reader.Open(path_);
+  if (err) {
+    return err;
+  }
+
+  const TimeShiftIndexEntry* begin = reader.GetEntries();
+  const TimeShiftIndexEntry* end = begin + reader.GetCount();
+  const TimeShiftIndexEntry* first = begin;
+  while (first != end && first->GetEndTime() < msec) {
+    first++;
+  }
+
+  if (first == begin) {
+    return common::ErrnoError();
+  }
+
+  const std::string tmp_path = path_ + ".tmp";
+  descriptor_t fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, INDEX_FILE_MODE);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  err = WriteAll(fd, first, (end - first) * sizeof(TimeShiftIndexEntry));
+  close(fd);
+  if (err) {
+    unlink(tmp_path.c_str());
+    return err;
+  }
+
+  if (rename(tmp_path.c_str(), path_.c_str()) == -1) {
+    err = common::make_errno_error(errno);
+    unlink(tmp_path.c_str());
+    return err;
+  }
+
+  // numbering continues even if all records were removed
+  const std::string path = path_;
+  const TimeShiftIndexEntry last = last_;
+  const bool have_last = have_last_;
+  err = Open(path);
+  if (!err && !have_last_) {
+    last_ = last;
+    have_last_ = have_last;
+  }
+  return err;
+}
+
+void TimeShiftIndexWriter::Close() {
+  if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+    fd_ = INVALID_DESCRIPTOR;
+  }
+  path_.clear();
+  last_ = TimeShiftIndexEntry();
+  have_last_ = false;
+}
+
+TimeShiftIndexReader::TimeShiftIndexReader() : data_(MAP_FAILED), size_(0) {}
+
+TimeShiftIndexReader::~TimeShiftIndexReader() {
+  Close();
+}
+
+common::ErrnoError TimeShiftIndexReader::Open(const std::string& path) {
+  if (path.empty()) {
+    return common::make_errno_error_inval();
+  }
+
+  Close();
+  descriptor_t fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  const size_t size = sb.st_size - sb.st_size % sizeof(TimeShiftIndexEntry);  // skip record in progress
+  if (size == 0) {
+    close(fd);
+    return common::ErrnoError();
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return common::make_errno_error(errno);
+  }
+
+  data_ = data;
+  size_ = size;
+  return common::ErrnoError();
+}
+
+void TimeShiftIndexReader::Close() {
+  if (data_ != MAP_FAILED) {
+    munmap(data_, size_);
+    data_ = MAP_FAILED;
+  }
+  size_ = 0;
+}
+
+size_t TimeShiftIndexReader::GetCount() const {
+  return size_ / sizeof(TimeShiftIndexEntry);
+}
+
+const TimeShiftIndexEntry* TimeShiftIndexReader::GetEntries() const {
+  if (data_ == MAP_FAILED) {
+    return nullptr;
+  }
+
+  return static_cast<const TimeShiftIndexEntry*>(data_);
+}
+
+bool TimeShiftIndexReader::GetLast(TimeShiftIndexEntry* entry) const {
+  const size_t count = GetCount();
+  if (!entry || count == 0) {
+    return false;
+  }
+
+  *entry = GetEntries()[count - 1];
+  return true;
+}
+
+bool TimeShiftIndexReader::FindByTime(int64_t msec, TimeShiftIndexEntry* entry) const {
+  const size_t count = GetCount();
+  if (!entry || count == 0) {
+    return false;
+  }
+
+  const TimeShiftIndexEntry* begin = GetEntries();
+  const TimeShiftIndexEntry* end = begin + count;
+  const TimeShiftIndexEntry* it = std::upper_bound(
+      begin, end, msec, [](int64_t time, const TimeShiftIndexEntry& item) { return time < item.start_time; });
+  if (it == begin) {
+    return false;
+  }
+
+  *entry = *(it - 1);
+  return true;
+}
+
+}  // namespace stream
+}  // namespace iptv_cloud
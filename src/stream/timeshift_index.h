@@ -0,0 +1,94 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+
+#include <common/error.h>
+#include <common/types.h>
+
+#define TIMESHIFT_INDEX_NAME "chunks.idx"
+
+namespace iptv_cloud {
+namespace stream {
+
+// Fixed size record of finished chunk, file is array of them ordered by start_time.
+struct TimeShiftIndexEntry {
+  TimeShiftIndexEntry();
+
+  int64_t GetEndTime() const;  // utc msec
+
+  uint64_t index;      // chunk number, file name is <index>.ts
+  int64_t start_time;  // utc msec when chunk was opened
+  uint64_t start_pts;  // first buffer timestamp in nsec, UINT64_MAX if unknown
+  uint64_t duration;   // nsec
+  uint64_t size;       // bytes
+  // numbering of records which only grows, so it survives index trimming and gaps of chunk indexes:
+  // previous record + 1, and count of index gaps (recorder restarts) up to and including this record
+  uint64_t sequence;
+  uint64_t discontinuity;
+};
+
+// Recorder side, records are only appended with single write, so readers never see torn record except tail.
+class TimeShiftIndexWriter {
+ public:
+  TimeShiftIndexWriter();
+  ~TimeShiftIndexWriter();
+
+  common::ErrnoError Open(const std::string& path) WARN_UNUSED_RESULT;
+  bool IsOpen() const;
+  // sequence and discontinuity of entry are ignored, they continue numbering of last record
+  common::ErrnoError Append(const TimeShiftIndexEntry& entry) WARN_UNUSED_RESULT;
+  // rewrites index without chunks finished before time, readers keep own copy until reopen
+  common::ErrnoError RemoveOlderThan(int64_t msec) WARN_UNUSED_RESULT;
+  void Close();
+
+ private:
+  std::string path_;
+  descriptor_t fd_;
+  TimeShiftIndexEntry last_;  // last appended or found on open
+  bool have_last_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeShiftIndexWriter);
+};
+
+// Player side, maps whole index and searches it without touching chunk files.
+class TimeShiftIndexReader {
+ public:
+  TimeShiftIndexReader();
+  ~TimeShiftIndexReader();
+
+  common::ErrnoError Open(const std::string& path) WARN_UNUSED_RESULT;
+  void Close();
+
+  size_t GetCount() const;
+  const TimeShiftIndexEntry* GetEntries() const;
+
+  bool GetLast(TimeShiftIndexEntry* entry) const;
+  // last chunk started at or before msec
+  bool FindByTime(int64_t msec, TimeShiftIndexEntry* entry) const;
+
+ private:
+  void* data_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeShiftIndexReader);
+};
+
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,451 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stream/timeshift_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+
+#define RING_FILE_MODE (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)
+#define RING_MAGIC UINT64_C(0x31474E4952535449)  // "ITSRING1"
+#define RING_INVALID_INDEX UINT64_MAX
+#define RING_MIN_CHUNK_RESERVE (8 * 1024 * 1024)  // free space at data end for new chunk, otherwise start from begin
+#define RING_SLOTS_OFFSET TIMESHIFT_RING_ALIGN
+#define RING_DATA_OFFSET (RING_SLOTS_OFFSET + TIMESHIFT_RING_SLOTS_COUNT * sizeof(TimeShiftRingSlot))
+
+namespace iptv_cloud {
+namespace stream {
+
+// Lives in first page of ring file, mapped MAP_SHARED by writer and readers.
+struct TimeShiftRingHeader {
+  uint64_t magic;
+  uint64_t data_size;
+  std::atomic<uint64_t> head;        // data before this absolute offset can be overwritten
+  std::atomic<uint64_t> tail;        // absolute write offset
+  std::atomic<uint64_t> last_index;  // last finished chunk
+};
+
+struct TimeShiftRingSlot {
+  std::atomic<uint64_t> index;  // RING_INVALID_INDEX while writer updates slot
+  std::atomic<uint64_t> offset;
+  std::atomic<uint64_t> size;
+};
+
+static_assert(sizeof(TimeShiftRingHeader) <= RING_SLOTS_OFFSET, "Ring header should fit first page");
+static_assert(RING_DATA_OFFSET % TIMESHIFT_RING_ALIGN == 0, "Ring data should be page aligned");
+
+namespace {
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + TIMESHIFT_RING_ALIGN - 1) / TIMESHIFT_RING_ALIGN * TIMESHIFT_RING_ALIGN;
+}
+
+TimeShiftRingSlot* GetSlot(TimeShiftRingHeader* header, uint64_t index) {
+  TimeShiftRingSlot* slots = reinterpret_cast<TimeShiftRingSlot*>(reinterpret_cast<char*>(header) + RING_SLOTS_OFFSET);
+  return &slots[index % TIMESHIFT_RING_SLOTS_COUNT];
+}
+
+const TimeShiftRingSlot* GetSlot(const TimeShiftRingHeader* header, uint64_t index) {
+  return GetSlot(const_cast<TimeShiftRingHeader*>(header), index);
+}
+
+common::ErrnoError PWriteAll(descriptor_t fd, const void* data, size_t size, off_t offset) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size) {
+    ssize_t res = pwrite(fd, ptr, size, offset);
+    if (res == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return common::make_errno_error(errno);
+    }
+    ptr += res;
+    size -= res;
+    offset += res;
+  }
+  return common::ErrnoError();
+}
+
+common::ErrnoError PReadAll(descriptor_t fd, void* data, size_t size, off_t offset) {
+  char* ptr = static_cast<char*>(data);
+  while (size) {
+    ssize_t res = pread(fd, ptr, size, offset);
+    if (res == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return common::make_errno_error(errno);
+    }
+    if (res == 0) {
+      return common::make_errno_error("Timeshift ring is truncated.", EIO);
+    }
+    ptr += res;
+    size -= res;
+    offset += res;
+  }
+  return common::ErrnoError();
+}
+}  // namespace
+
+TimeShiftRingChunk::TimeShiftRingChunk() : index(RING_INVALID_INDEX), offset(0), size(0) {}
+
+TimeShiftRingWriter::TimeShiftRingWriter()
+    : fd_(INVALID_DESCRIPTOR), header_(nullptr), current_(), last_chunk_size_(0) {}
+
+TimeShiftRingWriter::~TimeShiftRingWriter() {
+  Close();
+}
+
+common::ErrnoError TimeShiftRingWriter::Open(const std::string& path, uint64_t data_size) {
+  if (path.empty() || !data_size || data_size % TIMESHIFT_RING_ALIGN) {
+    return common::make_errno_error_inval();
+  }
+
+  Close();
+  descriptor_t fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, RING_FILE_MODE);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  const uint64_t file_size = RING_DATA_OFFSET + data_size;
+  bool reuse = false;
+  if (static_cast<uint64_t>(sb.st_size) == file_size) {  // restarted recorder continues own archive
+    uint64_t fields[2] = {0, 0};
+    reuse = !PReadAll(fd, fields, sizeof(fields), 0) && fields[0] == RING_MAGIC && fields[1] == data_size;
+  }
+
+  if (!reuse) {
+    // blocks are reserved once, archive never grows, fragments or changes metadata while recording
+    if (ftruncate(fd, 0) == -1 || (fallocate(fd, 0, 0, file_size) == -1 && ftruncate(fd, file_size) == -1)) {
+      common::ErrnoError err = common::make_errno_error(errno);
+      close(fd);
+      return err;
+    }
+  }
+
+  void* mem = mmap(nullptr, RING_DATA_OFFSET, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  TimeShiftRingHeader* header = static_cast<TimeShiftRingHeader*>(mem);
+  if (!reuse) {
+    header->magic = 0;
+    header->data_size = data_size;
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->last_index.store(RING_INVALID_INDEX, std::memory_order_relaxed);
+    for (uint64_t i = 0; i < TIMESHIFT_RING_SLOTS_COUNT; ++i) {
+      GetSlot(header, i)->index.store(RING_INVALID_INDEX, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = RING_MAGIC;
+  }
+
+  fd_ = fd;
+  header_ = header;
+  current_ = TimeShiftRingChunk();
+  last_chunk_size_ = 0;
+  return common::ErrnoError();
+}
+
+bool TimeShiftRingWriter::IsOpen() const {
+  return header_ != nullptr;
+}
+
+void TimeShiftRingWriter::Close() {
+  if (header_) {
+    munmap(header_, RING_DATA_OFFSET);
+    header_ = nullptr;
+  }
+  if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+    fd_ = INVALID_DESCRIPTOR;
+  }
+  current_ = TimeShiftRingChunk();
+}
+
+common::ErrnoError TimeShiftRingWriter::BeginChunk(uint64_t index) {
+  if (!IsOpen() || index == RING_INVALID_INDEX) {
+    return common::make_errno_error_inval();
+  }
+
+  const uint64_t data_size = header_->data_size;
+  uint64_t start = AlignUp(header_->tail.load(std::memory_order_relaxed));
+  const uint64_t pos = start % data_size;
+  const uint64_t reserve =
+      std::min<uint64_t>(std::max<uint64_t>(last_chunk_size_ * 2, RING_MIN_CHUNK_RESERVE), data_size / 2);
+  if (pos + reserve > data_size) {  // chunk should be contiguous if possible, skip ring tail
+    start += data_size - pos;
+  }
+
+  current_.index = index;
+  current_.offset = start;
+  current_.size = 0;
+  header_->tail.store(start, std::memory_order_relaxed);
+  return common::ErrnoError();
+}
+
+common::ErrnoError TimeShiftRingWriter::Write(const void* data, size_t size) {
+  if (!IsOpen() || current_.index == RING_INVALID_INDEX || (!data && size)) {
+    return common::make_errno_error_inval();
+  }
+
+  const uint64_t data_size = header_->data_size;
+  if (current_.size + size > data_size) {
+    return common::make_errno_error("Chunk too big for timeshift ring.", ENOSPC);
+  }
+
+  const uint64_t start = current_.offset + current_.size;
+  const uint64_t end = start + size;
+  if (end > data_size && end - data_size > header_->head.load(std::memory_order_relaxed)) {
+    header_->head.store(end - data_size, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // evicted before overwritten, readers check head after read
+  }
+
+  const uint64_t pos = start % data_size;
+  const size_t first = std::min<uint64_t>(size, data_size - pos);
+  common::ErrnoError err = PWriteAll(fd_, data, first, RING_DATA_OFFSET + pos);
+  if (err) {
+    return err;
+  }
+
+  if (first < size) {  // wrapped around
+    err = PWriteAll(fd_, static_cast<const char*>(data) + first, size - first, RING_DATA_OFFSET);
+    if (err) {
+      return err;
+    }
+  }
+
+  current_.size += size;
+  header_->tail.store(end, std::memory_order_relaxed);
+  return common::ErrnoError();
+}
+
+common::ErrnoError TimeShiftRingWriter::FinishChunk(TimeShiftRingChunk* chunk) {
+  if (!IsOpen() || current_.index == RING_INVALID_INDEX) {
+    return common::make_errno_error_inval();
+  }
+
+  TimeShiftRingSlot* slot = GetSlot(header_, current_.index);
+  slot->index.store(RING_INVALID_INDEX, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->offset.store(current_.offset, std::memory_order_relaxed);
+  slot->size.store(current_.size, std::memory_order_relaxed);
+  slot->index.store(current_.index, std::memory_order_release);
+  header_->last_index.store(current_.index, std::memory_order_release);
+
+  last_chunk_size_ = current_.size;
+  if (chunk) {
+    *chunk = current_;
+  }
+  current_ = TimeShiftRingChunk();
+  return common::ErrnoError();
+}
+
+TimeShiftRingReader::TimeShiftRingReader() : fd_(INVALID_DESCRIPTOR), header_(nullptr) {}
+
+TimeShiftRingReader::~TimeShiftRingReader() {
+  Close();
+}
+
+common::ErrnoError TimeShiftRingReader::Open(const std::string& path) {
+  if (path.empty()) {
+    return common::make_errno_error_inval();
+  }
+
+  Close();
+  descriptor_t fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  if (static_cast<uint64_t>(sb.st_size) <= RING_DATA_OFFSET) {
+    close(fd);
+    return common::make_errno_error("Invalid timeshift ring.", EINVAL);
+  }
+
+  void* mem = mmap(nullptr, RING_DATA_OFFSET, PROT_READ, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) {
+    common::ErrnoError err = common::make_errno_error(errno);
+    close(fd);
+    return err;
+  }
+
+  const TimeShiftRingHeader* header = static_cast<const TimeShiftRingHeader*>(mem);
+  if (header->magic != RING_MAGIC || RING_DATA_OFFSET + header->data_size != static_cast<uint64_t>(sb.st_size)) {
+    munmap(mem, RING_DATA_OFFSET);
+    close(fd);
+    return common::make_errno_error("Invalid timeshift ring.", EINVAL);
+  }
+
+  fd_ = fd;
+  header_ = header;
+  return common::ErrnoError();
+}
+
+bool TimeShiftRingReader::IsOpen() const {
+  return header_ != nullptr;
+}
+
+void TimeShiftRingReader::Close() {
+  if (header_) {
+    munmap(const_cast<TimeShiftRingHeader*>(header_), RING_DATA_OFFSET);
+    header_ = nullptr;
+  }
+  if (fd_ != INVALID_DESCRIPTOR) {
+    close(fd_);
+    fd_ = INVALID_DESCRIPTOR;
+  }
+}
+
+bool TimeShiftRingReader::GetLastIndex(uint64_t* index) const {
+  if (!IsOpen() || !index) {
+    return false;
+  }
+
+  const uint64_t last = header_->last_index.load(std::memory_order_acquire);
+  if (last == RING_INVALID_INDEX) {
+    return false;
+  }
+
+  *index = last;
+  return true;
+}
+
+bool TimeShiftRingReader::FindChunk(uint64_t index, TimeShiftRingChunk* chunk) const {
+  if (!IsOpen() || !chunk || index == RING_INVALID_INDEX) {
+    return false;
+  }
+
+  const TimeShiftRingSlot* slot = GetSlot(header_, index);
+  if (slot->index.load(std::memory_order_acquire) != index) {  // not finished, reused or updated right now
+    return false;
+  }
+
+  TimeShiftRingChunk result;
+  result.index = index;
+  result.offset = slot->offset.load(std::memory_order_relaxed);
+  result.size = slot->size.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot->index.load(std::memory_order_relaxed) != index || !IsAlive(result)) {
+    return false;
+  }
+
+  *chunk = result;
+  return true;
+}
+
+bool TimeShiftRingReader::IsAlive(const TimeShiftRingChunk& chunk) const {
+  if (!IsOpen()) {
+    return false;
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return chunk.offset >= header_->head.load(std::memory_order_relaxed);
+}
+
+bool TimeShiftRingReader::GetFileOffset(const TimeShiftRingChunk& chunk, uint64_t* offset) const {
+  if (!IsOpen() || !offset) {
+    return false;
+  }
+
+  const uint64_t data_size = header_->data_size;
+  const uint64_t pos = chunk.offset % data_size;
+  if (pos + chunk.size > data_size) {
+    return false;
+  }
+
+  *offset = RING_DATA_OFFSET + pos;
+  return true;
+}
+
+common::ErrnoError TimeShiftRingReader::Read(const TimeShiftRingChunk& chunk,
+                                             uint64_t pos,
+                                             void* data,
+                                             size_t size,
+                                             size_t* readed) const {
+  if (!IsOpen() || !readed || (!data && size)) {
+    return common::make_errno_error_inval();
+  }
+
+  if (pos >= chunk.size) {
+    *readed = 0;
+    return common::ErrnoError();
+  }
+
+  size = std::min<uint64_t>(size, chunk.size - pos);
+  const uint64_t data_size = header_->data_size;
+  const uint64_t start = (chunk.offset + pos) % data_size;
+  const size_t first = std::min<uint64_t>(size, data_size - start);
+  common::ErrnoError err = PReadAll(fd_, data, first, RING_DATA_OFFSET + start);
+  if (err) {
+    return err;
+  }
+
+  if (first < size) {  // wrapped around
+    err = PReadAll(fd_, static_cast<char*>(data) + first, size - first, RING_DATA_OFFSET);
+    if (err) {
+      return err;
+    }
+  }
+
+  if (!IsAlive(chunk)) {  // overwritten while reading
+    return common::make_errno_error("Timeshift chunk is evicted.", ESTALE);
+  }
+
+  *readed = size;
+  return common::ErrnoError();
+}
+
+bool OpenTimeShiftRingWithChunk(const std::string& path, uint64_t index, TimeShiftRingReader* ring) {
+  if (!ring) {
+    return false;
+  }
+
+  common::ErrnoError err = ring->Open(path);  // header is validated
+  if (err) {
+    return false;
+  }
+
+  TimeShiftRingChunk chunk;
+  if (!ring->FindChunk(index, &chunk)) {
+    ring->Close();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -0,0 +1,104 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include <common/error.h>
+#include <common/types.h>
+
+#define TIMESHIFT_RING_NAME "archive.ring"
+#define TIMESHIFT_RING_SLOTS_COUNT 65536  // chunk slots, chunk index modulo count, 7 days of 10 sec chunks
+#define TIMESHIFT_RING_ALIGN 4096         // chunks start at page aligned offsets
+
+namespace iptv_cloud {
+namespace stream {
+
+struct TimeShiftRingHeader;
+struct TimeShiftRingSlot;
+
+struct TimeShiftRingChunk {
+  TimeShiftRingChunk();
+
+  uint64_t index;   // chunk number, same as in timeshift index
+  uint64_t offset;  // absolute offset, position in data area is offset % data size
+  uint64_t size;    // bytes
+};
+
+// Timeshift archive in one preallocated file instead of file per chunk: header, chunk slots and data ring.
+// Writer appends chunks at aligned offsets and evicts old ones only by advancing head offset,
+// so there is no file creation, unlinking or directory scans; players read chunks by offset.
+class TimeShiftRingWriter {
+ public:
+  TimeShiftRingWriter();
+  ~TimeShiftRingWriter();
+
+  // reuses existing ring with same data size, otherwise creates (fallocates) new one
+  common::ErrnoError Open(const std::string& path, uint64_t data_size) WARN_UNUSED_RESULT;
+  bool IsOpen() const;
+  void Close();
+
+  common::ErrnoError BeginChunk(uint64_t index) WARN_UNUSED_RESULT;
+  common::ErrnoError Write(const void* data, size_t size) WARN_UNUSED_RESULT;
+  // publishes chunk for readers
+  common::ErrnoError FinishChunk(TimeShiftRingChunk* chunk) WARN_UNUSED_RESULT;
+
+ private:
+  descriptor_t fd_;
+  TimeShiftRingHeader* header_;
+  TimeShiftRingChunk current_;  // chunk in progress, index is UINT64_MAX if none
+  uint64_t last_chunk_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeShiftRingWriter);
+};
+
+// Player side, never blocks writer, chunk data read while it is being overwritten is detected by IsAlive.
+class TimeShiftRingReader {
+ public:
+  TimeShiftRingReader();
+  ~TimeShiftRingReader();
+
+  common::ErrnoError Open(const std::string& path) WARN_UNUSED_RESULT;
+  bool IsOpen() const;
+  void Close();
+
+  bool GetLastIndex(uint64_t* index) const;                         // last finished chunk
+  bool FindChunk(uint64_t index, TimeShiftRingChunk* chunk) const;  // finished and not evicted chunk
+  bool IsAlive(const TimeShiftRingChunk& chunk) const;              // false if ring already reused chunk data
+  // position of chunk data in ring file, false if chunk wraps around ring end and can't be read as one range
+  bool GetFileOffset(const TimeShiftRingChunk& chunk, uint64_t* offset) const;
+
+  // reads chunk data from chunk position pos, readed is 0 after chunk end
+  common::ErrnoError Read(const TimeShiftRingChunk& chunk,
+                          uint64_t pos,
+                          void* data,
+                          size_t size,
+                          size_t* readed) const WARN_UNUSED_RESULT;
+
+ private:
+  descriptor_t fd_;
+  const TimeShiftRingHeader* header_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeShiftRingReader);
+};
+
+// opens ring of archive only if it holds chunk index (usually last indexed one), so archive is in ring storage,
+// ring file left by recorder which was switched to file per chunk is not used
+bool OpenTimeShiftRingWithChunk(const std::string& path, uint64_t index, TimeShiftRingReader* ring);
+
+}  // namespace stream
+}  // namespace iptv_cloud
@@ -22,10 +22,44 @@
 #define FIELD_STATS_TOTAL_BYTES "total_bytes"
 #define FIELD_STATS_BYTES_PER_SECOND "bps"
 #define FIELD_STATS_DESIRE_BYTES_PER_SECOND "dbps"
+#define FIELD_STATS_BUFFERS_COUNT "buffers"
+#define FIELD_STATS_SIZE_HISTOGRAM "size_hist"
+#define FIELD_STATS_INTERVAL_HISTOGRAM "interval_hist"
+#define FIELD_STATS_LATENCY_P50 "latency_p50"
+#define FIELD_STATS_LATENCY_P95 "latency_p95"
+#define FIELD_STATS_LATENCY_P99 "latency_p99"
+#define FIELD_STATS_KERNEL_DROPS "kernel_drops"
+#define FIELD_STATS_CC_ERRORS "cc_errors"
 
 namespace iptv_cloud {
 namespace details {
 
+namespace {
+json_object* MakeHistogramArray(const channel_histogram_t& hist) {
+  json_object* jhist = json_object_new_array();
+  for (size_t i = 0; i < hist.size(); ++i) {
+    json_object_array_add(jhist, json_object_new_int64(hist[i]));
+  }
+  return jhist;
+}
+
+bool GetHistogramArray(json_object* serialized, const char* field, channel_histogram_t* hist) {
+  json_object* jhist = nullptr;
+  json_bool jhist_exists = json_object_object_get_ex(serialized, field, &jhist);
+  if (!jhist_exists || !json_object_is_type(jhist, json_type_array)) {
+    return false;
+  }
+
+  channel_histogram_t lhist = {};
+  const size_t len = json_object_array_length(jhist);
+  for (size_t i = 0; i < len && i < lhist.size(); ++i) {
+    lhist[i] = json_object_get_int64(json_object_array_get_idx(jhist, i));
+  }
+  *hist = lhist;
+  return true;
+}
+}  // namespace
+
 ChannelStatsInfo::ChannelStatsInfo() : ChannelStatsInfo(ChannelStats()) {}
 
 ChannelStatsInfo::ChannelStatsInfo(const ChannelStats& stats) : stats_(stats) {}
@@ -54,6 +88,15 @@ common::Error ChannelStatsInfo::SerializeFields(json_object* out) const {
   std::string dbps_str = common::ConvertToString(dbps);
   json_object_object_add(out, FIELD_STATS_DESIRE_BYTES_PER_SECOND, json_object_new_string(dbps_str.c_str()));
 
+  size_t buffers = stats_.GetBuffersCount();
+  json_object_object_add(out, FIELD_STATS_BUFFERS_COUNT, json_object_new_int64(buffers));
+  json_object_object_add(out, FIELD_STATS_SIZE_HISTOGRAM, MakeHistogramArray(stats_.GetSizeHistogram()));
+  json_object_object_add(out, FIELD_STATS_INTERVAL_HISTOGRAM, MakeHistogramArray(stats_.GetIntervalHistogram()));
+  json_object_object_add(out, FIELD_STATS_LATENCY_P50, json_object_new_int64(stats_.GetLatencyP50()));
+  json_object_object_add(out, FIELD_STATS_LATENCY_P95, json_object_new_int64(stats_.GetLatencyP95()));
+  json_object_object_add(out, FIELD_STATS_LATENCY_P99, json_object_new_int64(stats_.GetLatencyP99()));
+  json_object_object_add(out, FIELD_STATS_KERNEL_DROPS, json_object_new_int64(stats_.GetKernelDrops()));
+  json_object_object_add(out, FIELD_STATS_CC_ERRORS, json_object_new_int64(stats_.GetContinuityErrors()));
   return common::Error();
 }
 
@@ -96,6 +139,43 @@ common::Error ChannelStatsInfo::DoDeSerialize(json_object* serialized) {
     stats.SetDesireBytesPerSecond(dbps);
   }
 
+  json_object* jbuffers = nullptr;
+  json_bool jbuffers_exists = json_object_object_get_ex(serialized, FIELD_STATS_BUFFERS_COUNT, &jbuffers);
+  if (jbuffers_exists) {
+    stats.SetBuffersCount(json_object_get_int64(jbuffers));
+  }
+
+  channel_histogram_t hist;
+  if (GetHistogramArray(serialized, FIELD_STATS_SIZE_HISTOGRAM, &hist)) {
+    stats.SetSizeHistogram(hist);
+  }
+  if (GetHistogramArray(serialized, FIELD_STATS_INTERVAL_HISTOGRAM, &hist)) {
+    stats.SetIntervalHistogram(hist);
+  }
+
+  size_t latency[3] = {0, 0, 0};
+  const char* latency_fields[3] = {FIELD_STATS_LATENCY_P50, FIELD_STATS_LATENCY_P95, FIELD_STATS_LATENCY_P99};
+  for (size_t i = 0; i < 3; ++i) {
+    json_object* jlatency = nullptr;
+    json_bool jlatency_exists = json_object_object_get_ex(serialized, latency_fields[i], &jlatency);
+    if (jlatency_exists) {
+      latency[i] = json_object_get_int64(jlatency);
+    }
+  }
+  stats.SetLatency(latency[0], latency[1], latency[2]);
+
+  json_object* jkernel_drops = nullptr;
+  json_bool jkernel_drops_exists = json_object_object_get_ex(serialized, FIELD_STATS_KERNEL_DROPS, &jkernel_drops);
+  if (jkernel_drops_exists) {
+    stats.SetKernelDrops(json_object_get_int64(jkernel_drops));
+  }
+
+  json_object* jcc_errors = nullptr;
+  json_bool jcc_errors_exists = json_object_object_get_ex(serialized, FIELD_STATS_CC_ERRORS, &jcc_errors);
+  if (jcc_errors_exists) {
+    stats.SetContinuityErrors(json_object_get_int64(jcc_errors));
+  }
+
   *this = ChannelStatsInfo(stats);
   return common::Error();
 }
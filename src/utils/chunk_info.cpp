@@ -20,10 +20,23 @@
 namespace iptv_cloud {
 namespace utils {
 
-ChunkInfo::ChunkInfo() : path(), duration(0), index(0) {}
+ChunkInfo::ChunkInfo()
+    : path(),
+      duration(0),
+      index(0),
+      discontinuity(false),
+      program_date_time(-1),
+      byterange_length(0),
+      byterange_offset(0) {}
 
 ChunkInfo::ChunkInfo(const std::string& path, uint64_t duration, uint64_t index)
-    : path(path), duration(duration), index(index) {}
+    : path(path),
+      duration(duration),
+      index(index),
+      discontinuity(false),
+      program_date_time(-1),
+      byterange_length(0),
+      byterange_offset(0) {}
 
 double ChunkInfo::GetDurationInSecconds() const {
   return duration / static_cast<double>(SECOND);
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #include <string>
 
 namespace iptv_cloud {
@@ -30,6 +32,12 @@ struct ChunkInfo {
   std::string path;
   uint64_t duration;  // in nanoseconds
   uint64_t index;
+
+  // optional playlist tags of chunk
+  bool discontinuity;         // EXT-X-DISCONTINUITY before chunk
+  int64_t program_date_time;  // EXT-X-PROGRAM-DATE-TIME in utc msec, -1 if not set
+  uint64_t byterange_length;  // EXT-X-BYTERANGE, 0 if whole file
+  uint64_t byterange_offset;
 };
 
 inline bool operator<(const ChunkInfo& left, const ChunkInfo& right) {
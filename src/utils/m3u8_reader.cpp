@@ -14,172 +14,450 @@
 
 #include "utils/m3u8_reader.h"
 
-#include <regex>
-#include <string>
-
-#include <common/convert2string.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-#define CHUNK_EXT ".ts"
-#define CHUNK_EXT_RE "\\" CHUNK_EXT
+#include <string>
 
-#define M3U8_HEADER "#EXTM3U"
-#define M3U8_VERSION "#EXT-X-VERSION:%d"
-#define M3U8_ALLOW_CACHE "#EXT-X-ALLOW-CACHE:%s"
-#define M3U8_MEDIA_SEQUENCE "#EXT-X-MEDIA-SEQUENCE:%d"
-#define M3U8_TARGET_DURATION "#EXT-X-TARGETDURATION:%d"
-#define M3U8_CHUNK_HEADER "#EXTINF:%lf"
+#define M3U8_VERSION "#EXT-X-VERSION:"
+#define M3U8_ALLOW_CACHE "#EXT-X-ALLOW-CACHE:"
+#define M3U8_MEDIA_SEQUENCE "#EXT-X-MEDIA-SEQUENCE:"
+#define M3U8_TARGET_DURATION "#EXT-X-TARGETDURATION:"
+#define M3U8_CHUNK_HEADER "#EXTINF:"
+#define M3U8_BYTERANGE "#EXT-X-BYTERANGE:"
+#define M3U8_DISCONTINUITY "#EXT-X-DISCONTINUITY"
+#define M3U8_PROGRAM_DATE_TIME "#EXT-X-PROGRAM-DATE-TIME:"
 #define M3U8_FOOTER "#EXT-X-ENDLIST"
 #define SECOND 1000000000
-#define MAX_LINE 255
+#define MAX_UINT_DIGITS 19
+
+#define CONSUME_TAG(line, tag) ConsumePrefix(line, tag, sizeof(tag) - 1)
+#define IS_TAG(line, tag) IsEqual(line, tag, sizeof(tag) - 1)
 
 namespace {
 
-bool GetNonEmptyLine(FILE* file, std::string* line) {
-  if (!line) {
-    return false;
-  }
+struct Line {
+  const char* data;
+  const char* end;
+};
 
-  char t[MAX_LINE] = {0};
-  while (true) {
-    if (!fgets(t, MAX_LINE, file)) {
-      return false;
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// trimmed line without copy, false if buffer ended
+bool GetNonEmptyLine(const char** pos, const char* end, Line* line) {
+  const char* cur = *pos;
+  while (cur < end) {
+    const char* eol = static_cast<const char*>(memchr(cur, '\n', end - cur));
+    const char* next = eol ? eol + 1 : end;
+    const char* stop = eol ? eol : end;
+    while (cur < stop && IsSpace(*cur)) {
+      cur++;
+    }
+    while (stop > cur && IsSpace(stop[-1])) {
+      stop--;
     }
 
-    auto it = std::find_if(std::begin(t), std::end(t), [](char c) { return !std::isspace(c); });
-    if (it != std::end(t) && *it != 0) {
-      *line = t;
+    if (cur != stop) {
+      line->data = cur;
+      line->end = stop;
+      *pos = next;
       return true;
     }
+    cur = next;
   }
+
+  *pos = end;
+  return false;
+}
+
+bool IsEqual(const Line& line, const char* str, size_t size) {
+  return static_cast<size_t>(line.end - line.data) == size && memcmp(line.data, str, size) == 0;
 }
 
-void RemoveTrailingSpaces(std::string* str) {
-  if (!str || str->empty()) {
-    return;
+bool ConsumePrefix(Line* line, const char* prefix, size_t size) {
+  if (static_cast<size_t>(line->end - line->data) < size || memcmp(line->data, prefix, size) != 0) {
+    return false;
   }
-  while (std::isspace(str->back())) {
-    str->pop_back();
+
+  line->data += size;
+  return true;
+}
+
+bool ParseUInt(Line* line, uint64_t* out) {
+  const char* cur = line->data;
+  uint64_t result = 0;
+  while (cur < line->end && IsDigit(*cur)) {
+    if (cur - line->data == MAX_UINT_DIGITS) {
+      return false;
+    }
+    result = result * 10 + (*cur - '0');
+    cur++;
   }
+
+  if (cur == line->data) {
+    return false;
+  }
+
+  line->data = cur;
+  *out = result;
+  return true;
 }
-}  // namespace
 
-namespace iptv_cloud {
-namespace utils {
+bool ParseWholeUInt(Line line, uint64_t* out) {
+  return ParseUInt(&line, out) && line.data == line.end;
+}
 
-M3u8Reader::M3u8Reader() : version_(-1), allow_cache_(false), media_sequence_(-1), target_duration_(-1), chunks_() {}
+bool ParseWholeInt(Line line, int* out) {
+  uint64_t result;
+  if (!ParseWholeUInt(line, &result) || result > INT_MAX) {
+    return false;
+  }
 
-bool M3u8Reader::Parse(const std::string& path) {
-  FILE* file = fopen(path.c_str(), "r");
-  return ParseFile(file);
+  *out = static_cast<int>(result);
+  return true;
 }
 
-bool M3u8Reader::Parse(const common::file_system::ascii_file_string_path& path) {
-  const std::string filepath = path.GetPath();
-  FILE* file = fopen(filepath.c_str(), "r");
-  return ParseFile(file);
+// fixed width number, like month or hours in date
+bool ParseDigits(Line* line, size_t count, int* out) {
+  if (static_cast<size_t>(line->end - line->data) < count) {
+    return false;
+  }
+
+  int result = 0;
+  for (size_t i = 0; i < count; ++i) {
+    char c = line->data[i];
+    if (!IsDigit(c)) {
+      return false;
+    }
+    result = result * 10 + (c - '0');
+  }
+
+  line->data += count;
+  *out = result;
+  return true;
 }
 
-bool M3u8Reader::ParseFile(FILE* file) {
-  static const std::regex m3u8_version("^#EXT-X-VERSION:([0-9]+)$");
-  static const std::regex m3u8_allow_cache("^#EXT-X-ALLOW-CACHE:([A-Z]+)$");
-  static const std::regex m3u8_media_sequence("^#EXT-X-MEDIA-SEQUENCE:([0-9]+)$");
-  static const std::regex m3u8_target_duration("^#EXT-X-TARGETDURATION:([0-9]+)$");
+bool ConsumeChar(Line* line, char c) {
+  if (line->data == line->end || *line->data != c) {
+    return false;
+  }
 
-  Clear();
+  line->data++;
+  return true;
+}
 
-  if (!file) {
+// decimal seconds into nanoseconds, without double rounding
+bool ParseDuration(Line* line, uint64_t* out) {
+  uint64_t sec;
+  if (!ParseUInt(line, &sec)) {
     return false;
   }
 
-  std::string line;
-  std::smatch match;
-  while (GetNonEmptyLine(file, &line)) {
-    RemoveTrailingSpaces(&line);
-    if (line == M3U8_HEADER) {
-      continue;
-    } else if (std::regex_match(line, match, m3u8_version)) {
-      int version;
-      if (!common::ConvertFromString(match.str(1), &version)) {
-        return false;
-      }
-      version_ = version;
-    } else if (std::regex_match(line, match, m3u8_allow_cache)) {
-      const std::string allow_cache = match.str(1);
-      if (allow_cache == "YES") {
-        allow_cache_ = true;
-      } else if (allow_cache == "NO") {
-        allow_cache_ = false;
-      } else {
-        return false;
-      }
-      continue;
-    } else if (std::regex_match(line, match, m3u8_media_sequence)) {
-      int media_sequence;
-      if (!common::ConvertFromString(match.str(1), &media_sequence)) {
-        return false;
-      }
-      media_sequence_ = media_sequence;
-    } else if (std::regex_match(line, match, m3u8_target_duration)) {
-      int target_duration;
-      if (!common::ConvertFromString(match.str(1), &target_duration)) {
-        return false;
-      }
-      target_duration_ = target_duration;
-    } else {
-      long off = ftell(file);
-      fseek(file, off - line.length() - 1, SEEK_SET);
-      return ParseChunks(file);
+  uint64_t nsec = 0;
+  if (ConsumeChar(line, '.')) {
+    uint64_t mult = SECOND / 10;
+    while (line->data < line->end && IsDigit(*line->data)) {
+      nsec += (*line->data - '0') * mult;
+      mult /= 10;
+      line->data++;
     }
   }
 
-  return false;
+  *out = sec * SECOND + nsec;
+  return true;
+}
+
+int64_t DaysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const int64_t yoe = y - era * 400;
+  const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
 }
 
-bool M3u8Reader::ParseChunks(FILE* file) {
-  if (!file) {
+// YYYY-MM-DDThh:mm:ss[.SSS][Z|+hh:mm|-hh:mm]
+bool ParseProgramDateTime(Line line, int64_t* msec) {
+  int year, month, day, hour, minute, second;
+  if (!ParseDigits(&line, 4, &year) || !ConsumeChar(&line, '-') || !ParseDigits(&line, 2, &month) ||
+      !ConsumeChar(&line, '-') || !ParseDigits(&line, 2, &day) || !ConsumeChar(&line, 'T') ||
+      !ParseDigits(&line, 2, &hour) || !ConsumeChar(&line, ':') || !ParseDigits(&line, 2, &minute) ||
+      !ConsumeChar(&line, ':') || !ParseDigits(&line, 2, &second)) {
     return false;
   }
 
-  std::string header_line, chunk_line;
-  while (true) {
-    if (!GetNonEmptyLine(file, &header_line)) {
-      return !chunks_.empty();
+  if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+    return false;
+  }
+
+  int64_t millis = 0;
+  if (ConsumeChar(&line, '.')) {
+    int64_t mult = 100;
+    if (line.data == line.end || !IsDigit(*line.data)) {
+      return false;
+    }
+    while (line.data < line.end && IsDigit(*line.data)) {
+      millis += (*line.data - '0') * mult;
+      mult /= 10;
+      line.data++;
     }
-    RemoveTrailingSpaces(&header_line);
+  }
 
-    if (header_line == M3U8_FOOTER) {
-      return true;
+  int64_t offset_min = 0;
+  if (line.data != line.end && !ConsumeChar(&line, 'Z')) {
+    int sign = 1;
+    if (ConsumeChar(&line, '-')) {
+      sign = -1;
+    } else if (!ConsumeChar(&line, '+')) {
+      return false;
     }
 
-    if (!GetNonEmptyLine(file, &chunk_line)) {
+    int offset_hour, offset_minute = 0;
+    if (!ParseDigits(&line, 2, &offset_hour)) {
       return false;
     }
-    RemoveTrailingSpaces(&chunk_line);
+    if (line.data != line.end) {
+      ConsumeChar(&line, ':');
+      if (!ParseDigits(&line, 2, &offset_minute)) {
+        return false;
+      }
+    }
+    offset_min = sign * (offset_hour * 60 + offset_minute);
+  }
+
+  if (line.data != line.end) {
+    return false;
+  }
 
-    double duration = 0;
-    uint64_t index = 0;
+  const int64_t days = DaysFromCivil(year, month, day);
+  const int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset_min * 60;
+  *msec = seconds * 1000 + millis;
+  return true;
+}
 
-    static const std::regex m3u8_chunk_header_re("^#EXTINF:([0-9.]+),$");
-    static const std::regex m3u8_chunk_re("^[A-Za-z0-9_]*?([0-9]+)" CHUNK_EXT_RE "$");
+// <n>[@<o>]
+bool ParseByteRange(Line line, uint64_t* length, uint64_t* offset, bool* have_offset) {
+  if (!ParseUInt(&line, length)) {
+    return false;
+  }
 
-    std::smatch header_match;
-    if (!std::regex_match(header_line, header_match, m3u8_chunk_header_re)) {
-      return false;
+  *have_offset = ConsumeChar(&line, '@');
+  if (*have_offset && !ParseUInt(&line, offset)) {
+    return false;
+  }
+
+  return line.data == line.end;
+}
+
+// trailing digits of file name before extension, like 1497615343667_segment10012.ts
+bool GetChunkIndex(const Line& uri, uint64_t* index) {
+  const char* name = uri.data;
+  const char* stop = uri.end;
+  for (const char* cur = uri.data; cur < uri.end; ++cur) {
+    if (*cur == '?' || *cur == '#') {
+      stop = cur;
+      break;
+    }
+    if (*cur == '/') {
+      name = cur + 1;
+    }
+  }
+
+  const char* ext = stop;
+  for (const char* cur = stop; cur > name; --cur) {
+    if (cur[-1] == '.') {
+      ext = cur - 1;
+      break;
+    }
+  }
+
+  const char* digits = ext;
+  while (digits > name && IsDigit(digits[-1])) {
+    digits--;
+  }
+
+  Line number = {digits, ext};
+  return ParseWholeUInt(number, index);
+}
+
+class MappedFile {
+ public:
+  MappedFile() : data_(MAP_FAILED), size_(0) {}
+  ~MappedFile() {
+    if (data_ != MAP_FAILED) {
+      munmap(data_, size_);
     }
-    if (!common::ConvertFromString(header_match.str(1), &duration)) {
+  }
+
+  bool Map(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
       return false;
     }
-    std::smatch chunk_match;
-    if (!std::regex_match(chunk_line, chunk_match, m3u8_chunk_re)) {
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1 || !S_ISREG(sb.st_mode) || sb.st_size == 0) {
+      close(fd);
       return false;
     }
-    if (!common::ConvertFromString(chunk_match.str(1), &index)) {
+
+    void* data = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // mapping keeps own reference to file
+    if (data == MAP_FAILED) {
       return false;
     }
 
-    ChunkInfo chunk(chunk_line, static_cast<uint64_t>(duration * SECOND), index);
-    chunks_.push_back(chunk);
+    madvise(data, sb.st_size, MADV_SEQUENTIAL);
+    data_ = data;
+    size_ = sb.st_size;
+    return true;
+  }
+
+  const char* GetData() const { return static_cast<const char*>(data_); }
+  size_t GetSize() const { return size_; }
+
+ private:
+  void* data_;
+  size_t size_;
+};
+
+}  // namespace
+
+namespace iptv_cloud {
+namespace utils {
+
+M3u8Reader::M3u8Reader()
+    : version_(-1), allow_cache_(false), media_sequence_(-1), target_duration_(-1), end_list_(false), chunks_() {}
+
+bool M3u8Reader::Parse(const std::string& path) {
+  Clear();
+
+  MappedFile file;
+  if (!file.Map(path.c_str())) {
+    return false;
+  }
+
+  return ParseBuffer(file.GetData(), file.GetSize());
+}
+
+bool M3u8Reader::Parse(const common::file_system::ascii_file_string_path& path) {
+  return Parse(path.GetPath());
+}
+
+bool M3u8Reader::ParseBuffer(const char* data, size_t size) {
+  Clear();
+
+  if (!data || !size) {
+    return false;
+  }
+
+  // tags of next chunk
+  bool have_extinf = false;
+  uint64_t duration = 0;
+  bool discontinuity = false;
+  int64_t program_date_time = -1;
+  uint64_t byterange_length = 0;
+  uint64_t byterange_offset = 0;
+  bool have_byterange = false;
+  bool have_byterange_offset = false;
+
+  const char* pos = data;
+  const char* end = data + size;
+  Line line;
+  while (GetNonEmptyLine(&pos, end, &line)) {
+    if (*line.data != '#') {
+      if (!have_extinf) {
+        return false;
+      }
+
+      ChunkInfo chunk;
+      chunk.path.assign(line.data, line.end - line.data);
+      chunk.duration = duration;
+      if (!GetChunkIndex(line, &chunk.index)) {
+        chunk.index = (media_sequence_ == -1 ? 0 : media_sequence_) + chunks_.size();
+      }
+      chunk.discontinuity = discontinuity;
+      chunk.program_date_time = program_date_time;
+
+      const ChunkInfo* prev = chunks_.empty() ? nullptr : &chunks_.back();
+      if (chunk.program_date_time == -1 && !discontinuity && prev && prev->program_date_time != -1) {
+        chunk.program_date_time = prev->program_date_time + prev->duration / (SECOND / 1000);
+      }
+      if (have_byterange) {
+        chunk.byterange_length = byterange_length;
+        if (have_byterange_offset) {
+          chunk.byterange_offset = byterange_offset;
+        } else if (prev && prev->byterange_length && prev->path == chunk.path) {
+          chunk.byterange_offset = prev->byterange_offset + prev->byterange_length;
+        }
+      }
+      chunks_.push_back(chunk);
+
+      have_extinf = false;
+      discontinuity = false;
+      program_date_time = -1;
+      have_byterange = false;
+      continue;
+    }
+
+    if (CONSUME_TAG(&line, M3U8_CHUNK_HEADER)) {
+      if (!ParseDuration(&line, &duration) || !ConsumeChar(&line, ',')) {  // title after comma is ignored
+        return false;
+      }
+      have_extinf = true;
+    } else if (CONSUME_TAG(&line, M3U8_BYTERANGE)) {
+      if (!ParseByteRange(line, &byterange_length, &byterange_offset, &have_byterange_offset)) {
+        return false;
+      }
+      have_byterange = true;
+    } else if (IS_TAG(line, M3U8_DISCONTINUITY)) {
+      discontinuity = true;
+    } else if (CONSUME_TAG(&line, M3U8_PROGRAM_DATE_TIME)) {
+      if (!ParseProgramDateTime(line, &program_date_time)) {
+        return false;
+      }
+    } else if (CONSUME_TAG(&line, M3U8_MEDIA_SEQUENCE)) {
+      if (!ParseWholeInt(line, &media_sequence_)) {
+        return false;
+      }
+    } else if (CONSUME_TAG(&line, M3U8_TARGET_DURATION)) {
+      if (!ParseWholeInt(line, &target_duration_)) {
+        return false;
+      }
+    } else if (CONSUME_TAG(&line, M3U8_VERSION)) {
+      if (!ParseWholeInt(line, &version_)) {
+        return false;
+      }
+    } else if (CONSUME_TAG(&line, M3U8_ALLOW_CACHE)) {
+      if (IS_TAG(line, "YES")) {
+        allow_cache_ = true;
+      } else if (IS_TAG(line, "NO")) {
+        allow_cache_ = false;
+      } else {
+        return false;
+      }
+    } else if (IS_TAG(line, M3U8_FOOTER)) {
+      end_list_ = true;
+      break;
+    }
+    // #EXTM3U, comments and not used tags are skipped
+  }
+
+  if (have_extinf) {
+    return false;
   }
+
+  return end_list_ || !chunks_.empty();
 }
 
 int M3u8Reader::GetVersion() const {
@@ -198,6 +476,10 @@ int M3u8Reader::GetTargetDuration() const {
   return target_duration_;
 }
 
+bool M3u8Reader::IsEndList() const {
+  return end_list_;
+}
+
 std::vector<ChunkInfo> M3u8Reader::GetChunks() const {
   return chunks_;
 }
@@ -207,6 +489,7 @@ void M3u8Reader::Clear() {
   allow_cache_ = false;
   media_sequence_ = -1;
   target_duration_ = -1;
+  end_list_ = false;
 
   chunks_.clear();
 }
@@ -24,29 +24,30 @@
 namespace iptv_cloud {
 namespace utils {
 
+// Single pass parser over mmaped playlist, lines are never copied, only chunk uris are stored.
 class M3u8Reader {
  public:
   M3u8Reader();
 
   bool Parse(const std::string& path);
   bool Parse(const common::file_system::ascii_file_string_path& path);
+  bool ParseBuffer(const char* data, size_t size);
 
   int GetVersion() const;
   bool IsAllowCache() const;
   int GetMediaSequence() const;
   int GetTargetDuration() const;
+  bool IsEndList() const;
   std::vector<ChunkInfo> GetChunks() const;
 
  private:
   void Clear();
 
-  bool ParseFile(FILE* file);
-  bool ParseChunks(FILE* file);
-
   int version_;
   bool allow_cache_;
   int media_sequence_;
   int target_duration_;
+  bool end_list_;
 
   std::vector<ChunkInfo> chunks_;
 };
@@ -14,17 +14,69 @@
 
 #include "utils/m3u8_writer.h"
 
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <common/sprintf.h>
+#include <common/types.h>
+
 #include "utils/chunk_info.h"
 
+#define TEMP_PLAYLIST_SUFFIX ".tmp"
+
 namespace iptv_cloud {
 namespace utils {
 
-M3u8Writer::M3u8Writer() : file_() {}
+namespace {
+// data should be on disk before rename, otherwise crash can leave empty playlist under real name
+common::ErrnoError SyncFile(const std::string& path) {
+  descriptor_t fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == INVALID_DESCRIPTOR) {
+    return common::make_errno_error(errno);
+  }
+
+  common::ErrnoError err;
+  if (fsync(fd) == -1) {
+    err = common::make_errno_error(errno);
+  }
+  close(fd);
+  return err;
+}
+}  // namespace
+
+M3u8Writer::M3u8Writer() : file_(), atomic_path_() {}
+
+M3u8Writer::~M3u8Writer() {
+  if (atomic_path_.empty()) {
+    return;
+  }
+
+  // not closed, playlist is left untouched
+  ignore_result(file_.Close());
+  const std::string temp_path = atomic_path_ + TEMP_PLAYLIST_SUFFIX;
+  unlink(temp_path.c_str());
+}
 
 common::ErrnoError M3u8Writer::Open(const common::file_system::ascii_file_string_path& file_path, uint32_t flags) {
   return file_.Open(file_path, flags);
 }
 
+common::ErrnoError M3u8Writer::OpenAtomic(const common::file_system::ascii_file_string_path& file_path) {
+  const std::string temp_path = file_path.GetPath() + TEMP_PLAYLIST_SUFFIX;
+  unlink(temp_path.c_str());  // leftover of crashed writer
+  common::ErrnoError err = file_.Open(common::file_system::ascii_file_string_path(temp_path),
+                                      common::file_system::File::FLAG_CREATE | common::file_system::File::FLAG_WRITE);
+  if (err) {
+    return err;
+  }
+
+  atomic_path_ = file_path.GetPath();
+  return common::ErrnoError();
+}
+
 common::ErrnoError M3u8Writer::WriteHeader(uint64_t first_index, size_t target_duration) {
   size_t writed;
   return file_.WriteBuffer(common::MemSPrintf("#EXTM3U\n#EXT-X-MEDIA-SEQUENCE:%llu\n#EXT-X-ALLOW-"
@@ -34,6 +86,11 @@ common::ErrnoError M3u8Writer::WriteHeader(uint64_t first_index, size_t target_d
                            &writed);
 }
 
+common::ErrnoError M3u8Writer::WritePlaylistType(const std::string& type) {
+  size_t writed;
+  return file_.WriteBuffer(common::MemSPrintf("#EXT-X-PLAYLIST-TYPE:%s\n", type), &writed);
+}
+
 common::ErrnoError M3u8Writer::WriteLine(const ChunkInfo& chunk) {
   double ftime = chunk.GetDurationInSecconds();
   size_t writed;
@@ -45,8 +102,43 @@ common::ErrnoError M3u8Writer::WriteFooter() {
   return file_.WriteBuffer("#EXT-X-ENDLIST", &writed);
 }
 
+common::ErrnoError M3u8Writer::WriteMasterHeader() {
+  size_t writed;
+  return file_.WriteBuffer("#EXTM3U\n#EXT-X-VERSION:3\n", &writed);
+}
+
+common::ErrnoError M3u8Writer::WriteStreamInf(size_t bandwidth,
+                                              const common::draw::Size& resolution,
+                                              const std::string& uri) {
+  size_t writed;
+  return file_.WriteBuffer(common::MemSPrintf("#EXT-X-STREAM-INF:BANDWIDTH=%llu,RESOLUTION=%dx%d\n%s\n", bandwidth,
+                                              resolution.width, resolution.height, uri),
+                           &writed);
+}
+
 common::ErrnoError M3u8Writer::Close() {
-  return file_.Close();
+  common::ErrnoError err = file_.Close();
+  if (atomic_path_.empty()) {
+    return err;
+  }
+
+  const std::string path = atomic_path_;
+  const std::string temp_path = path + TEMP_PLAYLIST_SUFFIX;
+  atomic_path_.clear();
+  if (!err) {
+    err = SyncFile(temp_path);
+  }
+  if (err) {
+    unlink(temp_path.c_str());
+    return err;
+  }
+
+  if (rename(temp_path.c_str(), path.c_str()) == -1) {
+    err = common::make_errno_error(errno);
+    unlink(temp_path.c_str());
+    return err;
+  }
+  return common::ErrnoError();
 }
 
 }  // namespace utils
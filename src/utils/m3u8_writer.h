@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <string>
+
+#include <common/draw/types.h>
 #include <common/file_system/file.h>
 
 namespace iptv_cloud {
@@ -24,17 +27,29 @@ struct ChunkInfo;
 class M3u8Writer {
  public:
   M3u8Writer();
+  ~M3u8Writer();
 
   common::ErrnoError Open(const common::file_system::ascii_file_string_path& file_path,
                           uint32_t flags) WARN_UNUSED_RESULT;
+  // writes into temporary file next to playlist, Close renames it over playlist,
+  // so readers and restarted writers never see partially written playlist
+  common::ErrnoError OpenAtomic(const common::file_system::ascii_file_string_path& file_path) WARN_UNUSED_RESULT;
 
   common::ErrnoError WriteHeader(uint64_t first_index, size_t target_duration) WARN_UNUSED_RESULT;
+  common::ErrnoError WritePlaylistType(const std::string& type) WARN_UNUSED_RESULT;  // EVENT or VOD
   common::ErrnoError WriteLine(const ChunkInfo& chunks) WARN_UNUSED_RESULT;
   common::ErrnoError WriteFooter() WARN_UNUSED_RESULT;
+
+  // master playlist
+  common::ErrnoError WriteMasterHeader() WARN_UNUSED_RESULT;
+  common::ErrnoError WriteStreamInf(size_t bandwidth,
+                                    const common::draw::Size& resolution,
+                                    const std::string& uri) WARN_UNUSED_RESULT;
   common::ErrnoError Close() WARN_UNUSED_RESULT;
 
  private:
   common::file_system::File file_;
+  std::string atomic_path_;  // target of temporary file, empty if opened directly
 };
 
 }  // namespace utils
@@ -0,0 +1,233 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "utils/ts_chunker.h"
+
+#include <string>
+
+#include "utils/ts_packet_filter.h"
+
+#define TS_PCR_UNKNOWN UINT64_MAX
+#define TS_CHUNKER_NO_RAI_FACTOR 2  // chunk duration multiplier after which video is split without random access
+
+namespace iptv_cloud {
+namespace utils {
+
+namespace {
+uint16_t GetPid(const uint8_t* packet) {
+  return ((packet[1] & 0x1F) << 8) | packet[2];
+}
+
+bool IsPayloadStart(const uint8_t* packet) {
+  return packet[1] & 0x40;
+}
+
+bool HaveAdaptationField(const uint8_t* packet) {
+  return (packet[3] & 0x20) && packet[4] > 0;
+}
+
+bool IsRandomAccess(const uint8_t* packet) {
+  return HaveAdaptationField(packet) && (packet[5] & 0x40);
+}
+
+uint64_t GetPcr(const uint8_t* packet) {
+  if (!HaveAdaptationField(packet) || !(packet[5] & 0x10) || packet[4] < 7) {
+    return TS_PCR_UNKNOWN;
+  }
+
+  const uint64_t base = (uint64_t(packet[6]) << 25) | (uint64_t(packet[7]) << 17) | (uint64_t(packet[8]) << 9) |
+                        (uint64_t(packet[9]) << 1) | (packet[10] >> 7);
+  const uint64_t ext = ((packet[10] & 0x01) << 8) | packet[11];
+  return base * 300 + ext;
+}
+
+bool IsVideoStreamType(uint8_t stream_type) {
+  switch (stream_type) {
+    case 0x01:  // mpeg1
+    case 0x02:  // mpeg2
+    case 0x10:  // mpeg4 part 2
+    case 0x1B:  // h264
+    case 0x24:  // h265
+    case 0x42:  // avs
+    case 0xEA:  // vc1
+      return true;
+    default:
+      return false;
+  }
+}
+}  // namespace
+
+TsChunker::TsChunker(uint64_t chunk_duration_msec)
+    : chunk_duration_(chunk_duration_msec * TS_PCR_CLOCK_HZ / 1000),
+      pmt_pid_(TS_NULL_PID),
+      pcr_pid_(TS_NULL_PID),
+      split_pid_(TS_NULL_PID),
+      split_on_rai_(false),
+      pat_packet_(),
+      pmt_packet_(),
+      last_pcr_(TS_PCR_UNKNOWN),
+      chunk_pcr_(TS_PCR_UNKNOWN),
+      started_(false),
+      rai_missing_(false) {}
+
+size_t TsChunker::FindChunkStart(const uint8_t* data, size_t size) {
+  if (!data) {
+    return size;
+  }
+
+  for (size_t pos = 0; pos + TS_PACKET_SIZE <= size; pos += TS_PACKET_SIZE) {
+    if (IsChunkStart(data + pos)) {
+      return pos;
+    }
+  }
+  return size;
+}
+
+bool TsChunker::IsStarted() const {
+  return started_;
+}
+
+bool TsChunker::IsRandomAccessMissing() const {
+  return rai_missing_;
+}
+
+std::string TsChunker::GetPsiPackets() const {
+  return pat_packet_ + pmt_packet_;
+}
+
+void TsChunker::Reset() {
+  pmt_pid_ = TS_NULL_PID;
+  pcr_pid_ = TS_NULL_PID;
+  split_pid_ = TS_NULL_PID;
+  split_on_rai_ = false;
+  pat_packet_.clear();
+  pmt_packet_.clear();
+  last_pcr_ = TS_PCR_UNKNOWN;
+  chunk_pcr_ = TS_PCR_UNKNOWN;
+  started_ = false;
+}
+
+bool TsChunker::IsChunkStart(const uint8_t* packet) {
+  if (packet[0] != TS_SYNC_BYTE) {
+    return false;
+  }
+
+  const uint16_t pid = GetPid(packet);
+  if (pid == 0) {
+    ParsePat(packet);
+    return false;
+  }
+
+  if (pid == pmt_pid_) {
+    ParsePmt(packet);
+    return false;
+  }
+
+  if (pid == pcr_pid_) {
+    const uint64_t pcr = GetPcr(packet);
+    if (pcr != TS_PCR_UNKNOWN) {
+      last_pcr_ = pcr;
+      if (chunk_pcr_ == TS_PCR_UNKNOWN) {
+        chunk_pcr_ = pcr;
+      }
+    }
+  }
+
+  if (pid != split_pid_ || !IsPayloadStart(packet)) {
+    return false;
+  }
+
+  const bool random_access = !split_on_rai_ || IsRandomAccess(packet);
+  if (started_ || !random_access) {
+    if (chunk_pcr_ == TS_PCR_UNKNOWN || last_pcr_ == TS_PCR_UNKNOWN) {
+      return false;
+    }
+
+    const uint64_t elapsed = (last_pcr_ + TS_PCR_WRAP - chunk_pcr_) % TS_PCR_WRAP;  // went back is huge elapsed
+    if (elapsed < (random_access ? chunk_duration_ : chunk_duration_ * TS_CHUNKER_NO_RAI_FACTOR)) {
+      return false;
+    }
+
+    rai_missing_ |= !random_access;
+  }
+
+  started_ = true;
+  chunk_pcr_ = last_pcr_;
+  return true;
+}
+
+void TsChunker::ParsePat(const uint8_t* packet) {
+  const uint8_t* section = nullptr;
+  size_t size = 0;
+  if (!GetTsSection(packet, TS_PAT_TABLE_ID, &section, &size)) {
+    return;
+  }
+
+  uint16_t pmt_pid = TS_NULL_PID;
+  for (size_t i = 8; i + 4 <= size - 4; i += 4) {
+    const uint16_t program_number = (section[i] << 8) | section[i + 1];
+    if (program_number != 0) {  // 0 is network pid
+      pmt_pid = ((section[i + 2] & 0x1F) << 8) | section[i + 3];
+      break;
+    }
+  }
+
+  if (pmt_pid == TS_NULL_PID) {
+    return;
+  }
+
+  pat_packet_.assign(reinterpret_cast<const char*>(packet), TS_PACKET_SIZE);
+  if (pmt_pid != pmt_pid_) {
+    pmt_pid_ = pmt_pid;
+    pmt_packet_.clear();
+    split_pid_ = TS_NULL_PID;
+  }
+}
+
+void TsChunker::ParsePmt(const uint8_t* packet) {
+  const uint8_t* section = nullptr;
+  size_t size = 0;
+  if (!GetTsSection(packet, TS_PMT_TABLE_ID, &section, &size)) {
+    return;
+  }
+
+  uint16_t split_pid = TS_NULL_PID;
+  bool split_on_rai = false;
+  size_t i = 12 + (((section[10] & 0x0F) << 8) | section[11]);  // after program info
+  while (i + 5 <= size - 4) {
+    const uint8_t stream_type = section[i];
+    const uint16_t pid = ((section[i + 1] & 0x1F) << 8) | section[i + 2];
+    if (IsVideoStreamType(stream_type)) {
+      split_pid = pid;
+      split_on_rai = true;
+      break;
+    }
+    if (split_pid == TS_NULL_PID) {
+      split_pid = pid;
+    }
+    i += 5 + (((section[i + 3] & 0x0F) << 8) | section[i + 4]);
+  }
+
+  if (split_pid == TS_NULL_PID) {
+    return;
+  }
+
+  pmt_packet_.assign(reinterpret_cast<const char*>(packet), TS_PACKET_SIZE);
+  pcr_pid_ = ((section[8] & 0x1F) << 8) | section[9];
+  split_pid_ = split_pid;
+  split_on_rai_ = split_on_rai;
+}
+
+}  // namespace utils
+}  // namespace iptv_cloud
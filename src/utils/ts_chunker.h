@@ -0,0 +1,66 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace iptv_cloud {
+namespace utils {
+
+// Finds chunk boundaries in aligned mpeg-ts without demuxing. PAT and PMT are parsed to know pcr and split pids
+// of first program, chunk starts on packet which begins video access unit with random access indicator
+// (any access unit if program has no video) once chunk duration by pcr elapsed. Sources which never set
+// random access indicator are split on any video access unit once twice chunk duration elapsed.
+// Not thread safe, should be fed from one streaming thread.
+class TsChunker {
+ public:
+  explicit TsChunker(uint64_t chunk_duration_msec);
+
+  // offset of packet which starts next chunk, size if chunk continues, trailing partial packet is ignored,
+  // packets up to and including returned one are consumed, so search continues after it
+  size_t FindChunkStart(const uint8_t* data, size_t size);
+  bool IsStarted() const;  // first chunk start was found, data before it is not decodable
+  // some chunk was split without random access indicator, it may start without key frame
+  bool IsRandomAccessMissing() const;
+
+  // last PAT and PMT packets, chunk is prefixed by them to be playable on its own,
+  // same continuity counters, so for receivers of whole stream they are duplicates
+  std::string GetPsiPackets() const;
+
+  void Reset();  // discontinuity of input, program is searched again
+
+ private:
+  bool IsChunkStart(const uint8_t* packet);
+  void ParsePat(const uint8_t* packet);
+  void ParsePmt(const uint8_t* packet);
+
+  const uint64_t chunk_duration_;  // 27 MHz
+  uint16_t pmt_pid_;               // TS_NULL_PID if unknown
+  uint16_t pcr_pid_;
+  uint16_t split_pid_;
+  bool split_on_rai_;  // split pid is video
+  std::string pat_packet_;
+  std::string pmt_packet_;
+  uint64_t last_pcr_;
+  uint64_t chunk_pcr_;  // pcr at start of current chunk or of first chunk search
+  bool started_;
+  bool rai_missing_;
+};
+
+}  // namespace utils
+}  // namespace iptv_cloud
@@ -0,0 +1,312 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "utils/ts_packet_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#define TS_PCR_UNKNOWN UINT64_MAX
+#define TS_PROGRAM_PMT_PID 0x01
+#define TS_PROGRAM_PCR_PID 0x02
+
+namespace iptv_cloud {
+namespace utils {
+
+namespace {
+uint16_t GetPid(const uint8_t* packet) {
+  return ((packet[1] & 0x1F) << 8) | packet[2];
+}
+}  // namespace
+
+bool GetTsSection(const uint8_t* packet, uint8_t table_id, const uint8_t** section, size_t* size) {
+  if (!packet || !section || !size) {
+    return false;
+  }
+
+  if (!(packet[1] & 0x40) || !(packet[3] & 0x10)) {  // payload unit start with payload
+    return false;
+  }
+
+  size_t offset = 4;
+  if (packet[3] & 0x20) {
+    offset += 1 + packet[4];
+  }
+  if (offset >= TS_PACKET_SIZE) {
+    return false;
+  }
+
+  offset += 1 + packet[offset];  // pointer field
+  if (offset + 3 > TS_PACKET_SIZE || packet[offset] != table_id) {
+    return false;
+  }
+
+  const size_t section_size = 3 + (((packet[offset + 1] & 0x0F) << 8) | packet[offset + 2]);
+  if (section_size < 12 || offset + section_size > TS_PACKET_SIZE) {  // header and crc
+    return false;
+  }
+
+  *section = packet + offset;
+  *size = section_size;
+  return true;
+}
+
+TsCheckStats::TsCheckStats() : packets(0), dropped(0), sync_errors(0), cc_errors(0), pcr_errors(0) {}
+
+TsPacketFilter::TsPacketFilter()
+    : allowed_(),
+      program_pids_(),
+      pmt_pids_(),
+      last_cc_(TS_PIDS_COUNT, -1),
+      last_pcr_(TS_PIDS_COUNT, TS_PCR_UNKNOWN),
+      stats_() {}
+
+TsPacketFilter::TsPacketFilter(const ts_pids_t& pids) : TsPacketFilter() {
+  if (pids.empty()) {
+    return;
+  }
+
+  allowed_.assign(TS_PIDS_COUNT, false);
+  program_pids_.assign(TS_PIDS_COUNT, 0);
+  for (uint16_t pid : pids) {
+    if (pid < TS_PIDS_COUNT) {
+      allowed_[pid] = true;
+    }
+  }
+}
+
+bool TsPacketFilter::IsFiltering() const {
+  return !allowed_.empty();
+}
+
+void TsPacketFilter::Check(const uint8_t* data, size_t size) {
+  if (!data) {
+    return;
+  }
+
+  for (size_t pos = 0; pos + TS_PACKET_SIZE <= size; pos += TS_PACKET_SIZE) {
+    CheckPacket(data + pos);
+  }
+}
+
+size_t TsPacketFilter::Filter(uint8_t* data, size_t size) {
+  if (!data) {
+    return 0;
+  }
+
+  size_t writed = 0;
+  for (size_t pos = 0; pos + TS_PACKET_SIZE <= size; pos += TS_PACKET_SIZE) {
+    uint8_t* packet = data + pos;
+    if (IsFiltering() && packet[0] == TS_SYNC_BYTE) {
+      const uint16_t pid = GetPid(packet);
+      if (pid == 0) {
+        ParsePat(packet);
+      } else if (program_pids_[pid] & TS_PROGRAM_PMT_PID) {
+        ParsePmt(packet);
+      }
+    }
+
+    if (!CheckPacket(packet) || !IsAllowed(GetPid(packet))) {
+      stats_.dropped++;
+      continue;
+    }
+
+    if (writed != pos) {
+      memmove(data + writed, packet, TS_PACKET_SIZE);
+    }
+    writed += TS_PACKET_SIZE;
+  }
+  return writed;
+}
+
+void TsPacketFilter::Reset() {
+  last_cc_.assign(TS_PIDS_COUNT, -1);
+  last_pcr_.assign(TS_PIDS_COUNT, TS_PCR_UNKNOWN);
+}
+
+TsCheckStats TsPacketFilter::GetStats() const {
+  return stats_;
+}
+
+bool TsPacketFilter::IsAllowed(uint16_t pid) const {
+  if (allowed_.empty()) {
+    return true;
+  }
+
+  if (pid <= TS_MAX_PSI_PID || program_pids_[pid]) {  // tables are needed by receivers to find programs
+    return true;
+  }
+
+  return allowed_[pid];
+}
+
+bool TsPacketFilter::CheckPacket(const uint8_t* packet) {
+  stats_.packets++;
+  if (packet[0] != TS_SYNC_BYTE) {
+    stats_.sync_errors++;
+    return false;
+  }
+
+  const uint16_t pid = GetPid(packet);
+  if (pid == TS_NULL_PID || !IsAllowed(pid)) {  // stuffing has no counters, filtered pids are not checked
+    return true;
+  }
+
+  const uint8_t adaptation_field_control = (packet[3] >> 4) & 0x03;
+  const bool have_payload = adaptation_field_control & 0x01;
+  bool discontinuity = false;
+  uint64_t pcr = TS_PCR_UNKNOWN;
+  if ((adaptation_field_control & 0x02) && packet[4] > 0) {
+    const uint8_t adaptation_length = packet[4];
+    const uint8_t flags = packet[5];
+    discontinuity = flags & 0x80;
+    if ((flags & 0x10) && adaptation_length >= 7) {
+      const uint64_t base = (uint64_t(packet[6]) << 25) | (uint64_t(packet[7]) << 17) | (uint64_t(packet[8]) << 9) |
+                            (uint64_t(packet[9]) << 1) | (packet[10] >> 7);
+      const uint64_t ext = ((packet[10] & 0x01) << 8) | packet[11];
+      pcr = base * 300 + ext;
+    }
+  }
+
+  if (discontinuity) {
+    last_cc_[pid] = -1;
+    last_pcr_[pid] = TS_PCR_UNKNOWN;
+  }
+
+  if (have_payload) {  // counter is incremented only by packets with payload, one duplicate is allowed
+    const int8_t cc = packet[3] & 0x0F;
+    const int8_t last_cc = last_cc_[pid];
+    if (last_cc != -1 && cc != last_cc && cc != ((last_cc + 1) & 0x0F)) {
+      stats_.cc_errors++;
+    }
+    last_cc_[pid] = cc;
+  }
+
+  if (pcr != TS_PCR_UNKNOWN) {
+    const uint64_t last_pcr = last_pcr_[pid];
+    if (last_pcr != TS_PCR_UNKNOWN) {
+      const uint64_t diff = (pcr + TS_PCR_WRAP - last_pcr) % TS_PCR_WRAP;  // went back is huge diff
+      if (diff > TS_PCR_CLOCK_HZ * TS_PCR_MAX_INTERVAL_MSEC / 1000) {
+        stats_.pcr_errors++;
+      }
+    }
+    last_pcr_[pid] = pcr;
+  }
+  return true;
+}
+
+void TsPacketFilter::ParsePat(const uint8_t* packet) {
+  const uint8_t* section = nullptr;
+  size_t size = 0;
+  if (!GetTsSection(packet, TS_PAT_TABLE_ID, &section, &size)) {
+    return;
+  }
+
+  ts_pids_t pmt_pids;
+  for (size_t i = 8; i + 4 <= size - 4; i += 4) {
+    const uint16_t program_number = (section[i] << 8) | section[i + 1];
+    if (program_number != 0) {  // 0 is network pid
+      pmt_pids.push_back(((section[i + 2] & 0x1F) << 8) | section[i + 3]);
+    }
+  }
+
+  if (pmt_pids == pmt_pids_) {  // table is repeated
+    return;
+  }
+
+  // programs changed, pcr pids are found again in their PMT
+  pmt_pids_ = pmt_pids;
+  program_pids_.assign(TS_PIDS_COUNT, 0);
+  for (uint16_t pid : pmt_pids_) {
+    program_pids_[pid] = TS_PROGRAM_PMT_PID;
+  }
+}
+
+void TsPacketFilter::ParsePmt(const uint8_t* packet) {
+  const uint8_t* section = nullptr;
+  size_t size = 0;
+  if (!GetTsSection(packet, TS_PMT_TABLE_ID, &section, &size)) {
+    return;
+  }
+
+  const uint16_t pcr_pid = ((section[8] & 0x1F) << 8) | section[9];
+  program_pids_[pcr_pid] |= TS_PROGRAM_PCR_PID;
+}
+
+}  // namespace utils
+}  // namespace iptv_cloud
+
+namespace common {
+
+std::string ConvertToString(const iptv_cloud::utils::ts_pids_t& value) {
+  std::string result;
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (i != 0) {
+      result += ",";
+    }
+    result += std::to_string(value[i]);
+  }
+  return result;
+}
+
+bool ConvertFromString(const std::string& from, iptv_cloud::utils::ts_pids_t* out) {
+  if (!out) {
+    return false;
+  }
+
+  std::string list = from;
+  const size_t begin = list.find_first_not_of(" \t");
+  const size_t end = list.find_last_not_of(" \t");
+  if (begin == std::string::npos) {
+    return false;
+  }
+
+  list = list.substr(begin, end - begin + 1);
+  if (list.front() == '[') {
+    if (list.back() != ']') {
+      return false;
+    }
+    list = list.substr(1, list.size() - 2);
+  }
+
+  iptv_cloud::utils::ts_pids_t res;
+  const char* ptr = list.c_str();
+  while (true) {
+    char* pid_end = nullptr;
+    const long pid = strtol(ptr, &pid_end, 0);  // 256 or 0x100
+    if (pid_end == ptr || pid <= 0 || pid >= TS_NULL_PID) {
+      return false;
+    }
+    res.push_back(static_cast<uint16_t>(pid));
+
+    ptr = pid_end;
+    while (*ptr == ' ' || *ptr == '\t') {
+      ptr++;
+    }
+    if (*ptr == 0) {
+      break;
+    }
+    if (*ptr != ',') {
+      return false;
+    }
+    ptr++;
+  }
+
+  *out = res;
+  return true;
+}
+
+}  // namespace common
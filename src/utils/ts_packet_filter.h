@@ -0,0 +1,92 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#define TS_PACKET_SIZE 188
+#define TS_SYNC_BYTE 0x47
+#define TS_PIDS_COUNT 0x2000
+#define TS_NULL_PID 0x1FFF
+#define TS_MAX_PSI_PID 0x1F           // PAT, CAT, NIT, SDT, EIT etc are never filtered
+#define TS_PAT_TABLE_ID 0x00
+#define TS_PMT_TABLE_ID 0x02
+#define TS_PCR_MAX_INTERVAL_MSEC 100  // ISO/IEC 13818-1 2.7.2
+#define TS_PCR_CLOCK_HZ 27000000ULL
+#define TS_PCR_WRAP ((1ULL << 33) * 300)  // 33 bits base, 9 bits extension
+
+namespace iptv_cloud {
+namespace utils {
+
+typedef std::vector<uint16_t> ts_pids_t;
+
+// section which starts and ends in packet, tables of one program almost always fit into one packet
+bool GetTsSection(const uint8_t* packet, uint8_t table_id, const uint8_t** section, size_t* size);
+
+struct TsCheckStats {
+  TsCheckStats();
+
+  uint64_t packets;  // checked packets
+  uint64_t dropped;  // filtered out packets
+  uint64_t sync_errors;
+  uint64_t cc_errors;   // continuity counter gaps
+  uint64_t pcr_errors;  // pcr went back or jumped without discontinuity indicator
+};
+
+// Checks aligned mpeg-ts packets without demuxing, optionally keeps only allowed pids.
+// While filtering PAT and PMT are parsed, so PMT and PCR pids of programs always pass too.
+// Not thread safe, should be fed from one streaming thread.
+class TsPacketFilter {
+ public:
+  TsPacketFilter();
+  explicit TsPacketFilter(const ts_pids_t& pids);  // empty pids, all packets pass
+
+  bool IsFiltering() const;
+
+  // data is forwarded as is
+  void Check(const uint8_t* data, size_t size);
+  // checks and moves allowed packets to the front, returns their size, trailing partial packet is dropped
+  size_t Filter(uint8_t* data, size_t size);
+
+  void Reset();  // discontinuity of input, counters of pids are forgotten, stats are kept
+
+  TsCheckStats GetStats() const;
+
+ private:
+  bool IsAllowed(uint16_t pid) const;
+  bool CheckPacket(const uint8_t* packet);  // false if packet is broken
+  void ParsePat(const uint8_t* packet);
+  void ParsePmt(const uint8_t* packet);
+
+  std::vector<bool> allowed_;          // empty if not filtering
+  std::vector<uint8_t> program_pids_;  // PMT and PCR flags of pids found in tables, empty if not filtering
+  ts_pids_t pmt_pids_;                 // from last PAT
+  std::vector<int8_t> last_cc_;        // -1 unknown
+  std::vector<uint64_t> last_pcr_;     // 27 MHz, UINT64_MAX unknown
+  TsCheckStats stats_;
+};
+
+}  // namespace utils
+}  // namespace iptv_cloud
+
+namespace common {
+// comma separated pids like 256,257, json array is also accepted
+std::string ConvertToString(const iptv_cloud::utils::ts_pids_t& value);
+bool ConvertFromString(const std::string& from, iptv_cloud::utils::ts_pids_t* out);
+}  // namespace common
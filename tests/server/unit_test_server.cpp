@@ -16,6 +16,8 @@
 
 #include "base/constants.h"
 
+#include "server/base/http_range.h"
+#include "server/http/timeshift_playlist.h"
 #include "server/options/options.h"
 #include "utils/arg_converter.h"
 
@@ -44,3 +46,88 @@ TEST(Options, cfgs) {
   auto args = iptv_cloud::server::options::ValidateConfig(kTimeshiftRecorderConfig);
   ASSERT_EQ(args.size(), 4);
 }
+
+TEST(HttpRange, parse) {
+  using namespace iptv_cloud::server::base;
+  std::vector<HttpRange> ranges;
+  ASSERT_EQ(ParseHttpRange("bytes=0-99", 1000, &ranges), HTTP_RANGE_SATISFIABLE);
+  ASSERT_EQ(ranges.size(), 1);
+  ASSERT_EQ(ranges[0].first, 0);
+  ASSERT_EQ(ranges[0].last, 99);
+
+  ASSERT_EQ(ParseHttpRange("bytes=900-, -50, 10-2000", 1000, &ranges), HTTP_RANGE_SATISFIABLE);
+  ASSERT_EQ(ranges.size(), 3);
+  ASSERT_EQ(ranges[0].first, 900);
+  ASSERT_EQ(ranges[0].last, 999);
+  ASSERT_EQ(ranges[1].first, 950);
+  ASSERT_EQ(ranges[1].last, 999);
+  ASSERT_EQ(ranges[2].first, 10);
+  ASSERT_EQ(ranges[2].last, 999);
+
+  ASSERT_EQ(ParseHttpRange("bytes=-5000", 1000, &ranges), HTTP_RANGE_SATISFIABLE);
+  ASSERT_EQ(ranges[0].first, 0);
+
+  ASSERT_EQ(ParseHttpRange("bytes=1000-", 1000, &ranges), HTTP_RANGE_NOT_SATISFIABLE);
+  ASSERT_EQ(ParseHttpRange("bytes=5-1", 1000, &ranges), HTTP_RANGE_NONE);
+  ASSERT_EQ(ParseHttpRange("items=0-1", 1000, &ranges), HTTP_RANGE_NONE);
+  ASSERT_EQ(ParseHttpRange("bytes=a-b", 1000, &ranges), HTTP_RANGE_NONE);
+}
+
+TEST(TimeShiftPlaylist, window) {
+  using namespace iptv_cloud::server;
+  TimeShiftWindow window;
+  ASSERT_TRUE(ParseTimeShiftWindow("delay=3600", &window));
+  ASSERT_EQ(window.delay, 3600);
+  ASSERT_EQ(window.start, 0);
+  ASSERT_TRUE(ParseTimeShiftWindow("token=abc&start=1571234567", &window));
+  ASSERT_EQ(window.delay, 0);
+  ASSERT_EQ(window.start, 1571234567);
+  ASSERT_TRUE(ParseTimeShiftWindow("", &window));
+  ASSERT_FALSE(ParseTimeShiftWindow("delay=1h", &window));
+  ASSERT_FALSE(ParseTimeShiftWindow("delay=-10", &window));
+
+  // 20 chunks of 10 sec, last one finished at 200 sec
+  std::vector<iptv_cloud::stream::TimeShiftIndexEntry> entries(20);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    entries[i].index = i + 100;
+    entries[i].start_time = i * 10000;
+    entries[i].duration = 10000000000;
+  }
+
+  window = TimeShiftWindow();
+  window.delay = 60;
+  auto chunks = SelectTimeShiftChunks(entries.data(), entries.size(), window, 205000);
+  ASSERT_EQ(chunks.size(), TIMESHIFT_PLAYLIST_CHUNKS_COUNT);
+  ASSERT_EQ(chunks.back().index, 113);  // ends at 140 sec
+
+  window.delay = 190;
+  chunks = SelectTimeShiftChunks(entries.data(), entries.size(), window, 205000);
+  ASSERT_EQ(chunks.size(), 1);
+  ASSERT_EQ(chunks[0].index, 100);
+
+  window.delay = 3600;
+  chunks = SelectTimeShiftChunks(entries.data(), entries.size(), window, 205000);
+  ASSERT_TRUE(chunks.empty());
+
+  window = TimeShiftWindow();
+  window.start = 55;
+  chunks = SelectTimeShiftChunks(entries.data(), entries.size(), window, 205000);
+  ASSERT_EQ(chunks.size(), 15);
+  ASSERT_EQ(chunks[0].index, 105);
+
+  std::vector<TimeShiftSegment> segments(3);
+  for (size_t i = 0; i < segments.size(); ++i) {
+    segments[i].index = i + 7;
+    segments[i].sequence = i + 40;  // chunk indexes have gaps, sequence numbers don't
+    segments[i].discontinuity = 2;
+    segments[i].duration = 9500000000;
+  }
+  segments[2].index = 20;
+  segments[2].discontinuity = 3;
+  const std::string playlist = MakeTimeShiftPlaylist(segments, false);
+  ASSERT_NE(playlist.find("#EXT-X-VERSION:3\n#EXT-X-MEDIA-SEQUENCE:40\n#EXT-X-DISCONTINUITY-SEQUENCE:2\n"
+                          "#EXT-X-TARGETDURATION:10\n"),
+            std::string::npos);
+  ASSERT_NE(playlist.find("#EXTINF:9.50,\n8.ts\n#EXT-X-DISCONTINUITY\n#EXTINF:9.50,\n20.ts\n"), std::string::npos);
+  ASSERT_EQ(playlist.find("PLAYLIST-TYPE"), std::string::npos);
+}
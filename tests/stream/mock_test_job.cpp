@@ -65,7 +65,7 @@ TEST(Job, Status) {
 
   FakeObserver cl;
   iptv_cloud::stream::streams_init(0, NULL);
-  iptv_cloud::StreamStruct st(iptv_cloud::StreamInfo{"screen", iptv_cloud::SCREEN, {}, {0}});
+  iptv_cloud::SharedStreamStruct st(iptv_cloud::StreamInfo{"screen", iptv_cloud::SCREEN, {}, {0}});
   iptv_cloud::stream::IBaseStream* job = new iptv_cloud::stream::streams::ScreenStream(nullptr, &cl, &st);
   std::thread th(&quit_job, job);
   EXPECT_CALL(cl, OnStatusChanged(job, _)).Times(4);
@@ -14,7 +14,18 @@
 
 #include <gtest/gtest.h>
 
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <gst/gst.h>
+
+#include "stream/catchup_cut.h"
+#include "stream/playlist_feeder.h"
 #include "stream/stypes.h"
+#include "stream/timeshift_index.h"
+#include "stream/timeshift_ring.h"
 
 TEST(element_id_t, GetElementId) {
   iptv_cloud::stream::element_id_t id;
@@ -60,3 +71,200 @@ TEST(m3u8, GetIndexFromHttpTsTemplate) {
   uint64_t ind3;
   ASSERT_FALSE(iptv_cloud::stream::GetIndexFromHttpTsTemplate("123_g.ts", &ind3));
 }
+
+TEST(TimeShiftIndex, AppendAndFind) {
+  char dir[] = "/tmp/timeshift_index_XXXXXX";
+  ASSERT_TRUE(mkdtemp(dir));
+  const std::string path = std::string(dir) + "/" TIMESHIFT_INDEX_NAME;
+
+  iptv_cloud::stream::TimeShiftIndexWriter writer;
+  ASSERT_FALSE(writer.Open(path));
+  for (uint64_t i = 0; i < 10; ++i) {
+    iptv_cloud::stream::TimeShiftIndexEntry entry;
+    entry.index = i + 100;
+    entry.start_time = 1000000 + i * 10000;
+    entry.duration = 10000000000;
+    entry.size = 1024;
+    ASSERT_FALSE(writer.Append(entry));
+  }
+
+  iptv_cloud::stream::TimeShiftIndexReader reader;
+  ASSERT_FALSE(reader.Open(path));
+  ASSERT_EQ(reader.GetCount(), 10u);
+  iptv_cloud::stream::TimeShiftIndexEntry entry;
+  ASSERT_TRUE(reader.GetLast(&entry));
+  ASSERT_EQ(entry.index, 109u);
+  ASSERT_EQ(entry.GetEndTime(), 1100000);
+  ASSERT_FALSE(reader.FindByTime(999999, &entry));
+  ASSERT_TRUE(reader.FindByTime(1000000, &entry));
+  ASSERT_EQ(entry.index, 100u);
+  ASSERT_TRUE(reader.FindByTime(1055000, &entry));
+  ASSERT_EQ(entry.index, 105u);
+  ASSERT_TRUE(reader.FindByTime(2000000, &entry));
+  ASSERT_EQ(entry.index, 109u);
+  reader.Close();
+
+  ASSERT_FALSE(writer.RemoveOlderThan(1030000));  // chunks finished before are dropped
+  ASSERT_FALSE(reader.Open(path));
+  ASSERT_EQ(reader.GetCount(), 8u);
+  ASSERT_EQ(reader.GetEntries()[0].index, 102u);
+  ASSERT_EQ(reader.GetEntries()[0].sequence, 2u);  // numbering is not shifted by trimming
+  ASSERT_EQ(reader.GetEntries()[7].discontinuity, 0u);
+  reader.Close();
+
+  writer.Close();
+  FILE* file = fopen(path.c_str(), "a");  // torn record after crash
+  ASSERT_TRUE(file);
+  ASSERT_EQ(fwrite("xyz", 1, 3, file), 3u);
+  fclose(file);
+  ASSERT_FALSE(reader.Open(path));
+  ASSERT_EQ(reader.GetCount(), 8u);
+  reader.Close();
+  ASSERT_FALSE(writer.Open(path));
+  ASSERT_FALSE(writer.Append(entry));
+  ASSERT_FALSE(reader.Open(path));
+  ASSERT_EQ(reader.GetCount(), 9u);
+  ASSERT_TRUE(reader.GetLast(&entry));
+  ASSERT_EQ(entry.index, 109u);
+  ASSERT_EQ(entry.sequence, 10u);      // continued after reopen
+  ASSERT_EQ(entry.discontinuity, 1u);  // same index again is not next one
+  reader.Close();
+  writer.Close();
+
+  unlink(path.c_str());
+  rmdir(dir);
+}
+
+TEST(TimeShiftRing, WriteAndRead) {
+  char dir[] = "/tmp/timeshift_ring_XXXXXX";
+  ASSERT_TRUE(mkdtemp(dir));
+  const std::string path = std::string(dir) + "/" TIMESHIFT_RING_NAME;
+  const uint64_t data_size = 16 * TIMESHIFT_RING_ALIGN;
+
+  iptv_cloud::stream::TimeShiftRingWriter writer;
+  ASSERT_FALSE(writer.Open(path, data_size));
+  iptv_cloud::stream::TimeShiftRingReader reader;
+  ASSERT_FALSE(reader.Open(path));
+  uint64_t last_index;
+  ASSERT_FALSE(reader.GetLastIndex(&last_index));
+
+  char data[10000];
+  iptv_cloud::stream::TimeShiftRingChunk chunk;
+  for (uint64_t i = 0; i < 3; ++i) {
+    memset(data, 'a' + i, sizeof(data));
+    ASSERT_FALSE(writer.BeginChunk(i));
+    ASSERT_FALSE(writer.Write(data, sizeof(data)));
+    ASSERT_FALSE(writer.FinishChunk(&chunk));
+    ASSERT_EQ(chunk.index, i);
+    ASSERT_EQ(chunk.offset % TIMESHIFT_RING_ALIGN, 0u);
+    ASSERT_EQ(chunk.size, sizeof(data));
+  }
+  ASSERT_TRUE(reader.GetLastIndex(&last_index));
+  ASSERT_EQ(last_index, 2u);
+  ASSERT_FALSE(reader.FindChunk(3, &chunk));
+  ASSERT_TRUE(reader.FindChunk(1, &chunk));
+
+  char buffer[4096];
+  size_t readed = 0;
+  ASSERT_FALSE(reader.Read(chunk, 9000, buffer, sizeof(buffer), &readed));
+  ASSERT_EQ(readed, 1000u);
+  ASSERT_EQ(buffer[0], 'b');
+  ASSERT_EQ(buffer[999], 'b');
+  ASSERT_FALSE(reader.Read(chunk, sizeof(data), buffer, sizeof(buffer), &readed));
+  ASSERT_EQ(readed, 0u);
+
+  // no space for new chunk at data end, it starts from begin and evicts first chunk
+  ASSERT_FALSE(writer.BeginChunk(3));
+  ASSERT_FALSE(writer.Write(data, sizeof(data)));
+  ASSERT_FALSE(writer.FinishChunk(&chunk));
+  ASSERT_EQ(chunk.offset, data_size);
+  ASSERT_FALSE(reader.FindChunk(0, &chunk));
+  ASSERT_TRUE(reader.FindChunk(1, &chunk));
+  ASSERT_TRUE(reader.IsAlive(chunk));
+
+  writer.Close();  // restarted recorder continues archive
+  ASSERT_FALSE(writer.Open(path, data_size));
+  ASSERT_TRUE(reader.FindChunk(3, &chunk));
+  ASSERT_FALSE(reader.Read(chunk, 0, buffer, sizeof(buffer), &readed));
+  ASSERT_EQ(readed, sizeof(buffer));
+  ASSERT_EQ(buffer[0], 'c');
+  reader.Close();
+  writer.Close();
+
+  unlink(path.c_str());
+  rmdir(dir);
+}
+
+TEST(CatchupCut, SelectChunks) {
+  using namespace iptv_cloud::stream;
+  // 10 sec chunks, first one starts at 100 sec
+  std::vector<TimeShiftIndexEntry> entries(10);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    entries[i].index = i;
+    entries[i].start_time = 100000 + i * 10000;
+    entries[i].duration = 10000000000;
+  }
+
+  // program from 125 to 150 sec, chunks 2, 3, 4 overlap it
+  auto chunks = SelectCatchupChunks(entries.data(), entries.size(), 125000, 150000, INT64_MIN);
+  ASSERT_EQ(chunks.size(), 3);
+  ASSERT_EQ(chunks[0].index, 2);
+  ASSERT_EQ(chunks[2].index, 4);
+
+  // next update returns only new chunks
+  chunks = SelectCatchupChunks(entries.data(), entries.size(), 125000, 150000, 130000);
+  ASSERT_EQ(chunks.size(), 1);
+  ASSERT_EQ(chunks[0].index, 4);
+
+  // without stop time up to the last finished chunk
+  chunks = SelectCatchupChunks(entries.data(), entries.size(), 125000, 0, INT64_MIN);
+  ASSERT_EQ(chunks.size(), 8);
+  ASSERT_EQ(chunks.back().index, 9);
+
+  chunks = SelectCatchupChunks(entries.data(), entries.size(), 300000, 400000, INT64_MIN);
+  ASSERT_TRUE(chunks.empty());
+}
+
+TEST(PlaylistFileFeeder, ReadBlocks) {
+  gst_init(nullptr, nullptr);
+  char path[] = "/tmp/playlist_feeder_XXXXXX";
+  const int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  char data[10000];
+  for (size_t i = 0; i < sizeof(data); ++i) {
+    data[i] = i % 251;
+  }
+  ASSERT_EQ(write(fd, data, sizeof(data)), static_cast<ssize_t>(sizeof(data)));
+  close(fd);
+
+  for (bool zero_copy : {false, true}) {
+    iptv_cloud::stream::PlaylistFileFeeder feeder(100, zero_copy);  // at least one page
+    ASSERT_EQ(feeder.GetBlockSize() % 4096, 0u);
+    ASSERT_TRUE(feeder.Open("/tmp/not_existing_playlist_file.ts"));
+    ASSERT_FALSE(feeder.IsOpen());
+    ASSERT_FALSE(feeder.Open(path));
+
+    std::string readed;
+    std::vector<GstBuffer*> buffers;
+    while (GstBuffer* buffer = feeder.ReadBuffer()) {
+      ASSERT_EQ(GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT), buffers.empty());
+      ASSERT_EQ(GST_BUFFER_OFFSET(buffer), readed.size());
+      GstMapInfo map;
+      ASSERT_TRUE(gst_buffer_map(buffer, &map, GST_MAP_READ));
+      readed.append(reinterpret_cast<const char*>(map.data), map.size);
+      gst_buffer_unmap(buffer, &map);
+      buffers.push_back(buffer);
+    }
+    ASSERT_EQ(readed, std::string(data, sizeof(data)));
+    feeder.Close();  // mapping lives while buffers are in pipeline, copies anyway
+
+    GstMapInfo map;
+    ASSERT_TRUE(gst_buffer_map(buffers.back(), &map, GST_MAP_READ));
+    ASSERT_EQ(map.data[0], static_cast<uint8_t>(data[sizeof(data) - map.size]));
+    gst_buffer_unmap(buffers.back(), &map);
+    for (GstBuffer* buffer : buffers) {
+      gst_buffer_unref(buffer);
+    }
+  }
+  unlink(path);
+}
@@ -63,7 +63,7 @@ void check_screen() {
       std::make_pair(FEEDBACK_DIR_FIELD, "~"), std::make_pair(INPUT_FIELD, iuri_str),
       std::make_pair(OUTPUT_FIELD, ouri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct screen(
+    iptv_cloud::SharedStreamStruct screen(
         iptv_cloud::StreamInfo{common::MemSPrintf("screen_%llu", i), iptv_cloud::SCREEN, {0}, {0}});
     iptv_cloud::stream::IBaseStream* job_screen = new iptv_cloud::stream::streams::ScreenStream(
         static_cast<iptv_cloud::stream::streams::AudioVideoConfig*>(iptv_cloud::stream::make_config(args_screen)),
@@ -88,7 +88,7 @@ void check_relay(const iptv_cloud::input_t& input) {
       std::make_pair(FEEDBACK_DIR_FIELD, "~"), std::make_pair(INPUT_FIELD, iuri_str),
       std::make_pair(OUTPUT_FIELD, remux_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct remux(
+    iptv_cloud::SharedStreamStruct remux(
         iptv_cloud::StreamInfo{common::MemSPrintf("remux_%llu", i), iptv_cloud::RELAY, {0}, {0}});
     iptv_cloud::stream::IBaseStream* job_remux = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args_remux, nullptr, &remux, iptv_cloud::stream::invalid_chunk_index);
@@ -115,7 +115,7 @@ void check_relay_playlist() {
                                                  std::make_pair(INPUT_FIELD, iuri_str),
                                                  std::make_pair(OUTPUT_FIELD, relay_playlist_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct relay_playlist(
+    iptv_cloud::SharedStreamStruct relay_playlist(
         iptv_cloud::StreamInfo{common::MemSPrintf("relay_playlist_%llu", i), iptv_cloud::RELAY, {0}, {0}});
     iptv_cloud::stream::IBaseStream* job_relay_playlist =
         iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(args_relay, nullptr, &relay_playlist,
@@ -143,7 +143,7 @@ void check_encoding(const iptv_cloud::input_t& input) {
       std::make_pair(INPUT_FIELD, iuri_str),
       std::make_pair(OUTPUT_FIELD, enc_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct encoding(
+    iptv_cloud::SharedStreamStruct encoding(
         iptv_cloud::StreamInfo{common::MemSPrintf("encoding_%llu", i), iptv_cloud::ENCODING, {0}, {0}});
     iptv_cloud::stream::IBaseStream* job_enc = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args_enc, nullptr, &encoding, iptv_cloud::stream::invalid_chunk_index);
@@ -166,7 +166,7 @@ void check_timeshift(const iptv_cloud::input_t& input) {
   args_rec.push_back(std::make_pair(ID_FIELD, "timeshift_rec"));
   args_rec.push_back(std::make_pair(INPUT_FIELD, iuri_str));
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct timeshift_rec(
+    iptv_cloud::SharedStreamStruct timeshift_rec(
         iptv_cloud::StreamInfo{common::MemSPrintf("timeshift_rec_%llu", i), iptv_cloud::TIMESHIFT_RECORDER, {0}, {}});
     iptv_cloud::stream::IBaseStream* job_timeshift_rec = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args_rec, nullptr, &timeshift_rec, iptv_cloud::stream::invalid_chunk_index);
@@ -190,7 +190,7 @@ void check_timeshift(const iptv_cloud::input_t& input) {
   args_play.push_back(std::make_pair(INPUT_FIELD, common::ConvertToString(iuris)));
   args_play.push_back(std::make_pair(OUTPUT_FIELD, enc_uri_str));
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct timeshift_play(
+    iptv_cloud::SharedStreamStruct timeshift_play(
         iptv_cloud::StreamInfo{common::MemSPrintf("timeshift_play_%llu", i), iptv_cloud::TIMESHIFT_PLAYER, {0}, {0}});
     iptv_cloud::stream::IBaseStream* job_timeshift_play =
         iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(args_play, nullptr, &timeshift_play, 0);
@@ -216,7 +216,7 @@ void check_catchup(const iptv_cloud::input_t& input) {
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
     common::ErrnoError err = common::file_system::create_directory(test_dir, true);
     CHECK(!err);
-    iptv_cloud::StreamStruct jobstr(
+    iptv_cloud::SharedStreamStruct jobstr(
         iptv_cloud::StreamInfo{common::MemSPrintf("catchup_%llu", i), iptv_cloud::CATCHUP, {0}, {}});
     iptv_cloud::stream::IBaseStream* catchup_job = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args, nullptr, &jobstr, iptv_cloud::stream::invalid_chunk_index);
@@ -251,7 +251,7 @@ void check_playlist() {
       std::make_pair(INPUT_FIELD, iuri_str),
       std::make_pair(OUTPUT_FIELD, playlist_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct playlist(
+    iptv_cloud::SharedStreamStruct playlist(
         iptv_cloud::StreamInfo{common::MemSPrintf("playlist_%llu", i), iptv_cloud::ENCODING, {0, 1}, {0}});
     iptv_cloud::stream::IBaseStream* job_playlist = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args_enc, nullptr, &playlist, iptv_cloud::stream::invalid_chunk_index);
@@ -278,7 +278,7 @@ void check_mosaic() {
       std::make_pair(ID_FIELD, "mosaic"), std::make_pair(TYPE_FIELD, common::ConvertToString(iptv_cloud::ENCODING)),
       std::make_pair(INPUT_FIELD, iuri_str), std::make_pair(OUTPUT_FIELD, mos_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct mosaic(
+    iptv_cloud::SharedStreamStruct mosaic(
         iptv_cloud::StreamInfo{common::MemSPrintf("mosaic_%llu", i), iptv_cloud::ENCODING, {0, 1}, {0}});
     iptv_cloud::stream::IBaseStream* mosaic_job = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args, nullptr, &mosaic, iptv_cloud::stream::invalid_chunk_index);
@@ -305,7 +305,7 @@ void check_relay_audio() {
                                            std::make_pair(INPUT_FIELD, iuri_str),
                                            std::make_pair(OUTPUT_FIELD, relay_audio_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct relay_audio(
+    iptv_cloud::SharedStreamStruct relay_audio(
         iptv_cloud::StreamInfo{common::MemSPrintf("relay_audio_%llu", i), iptv_cloud::ENCODING, {0}, {0}});
     iptv_cloud::stream::IBaseStream* relay_audio_job = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args, nullptr, &relay_audio, iptv_cloud::stream::invalid_chunk_index);
@@ -332,7 +332,7 @@ void check_relay_video() {
                                            std::make_pair(INPUT_FIELD, iuri_str),
                                            std::make_pair(OUTPUT_FIELD, relay_video_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct relay_video(
+    iptv_cloud::SharedStreamStruct relay_video(
         iptv_cloud::StreamInfo{common::MemSPrintf("relay_video_%llu", i), iptv_cloud::ENCODING, {0}, {0}});
     iptv_cloud::stream::IBaseStream* relay_video_job = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args, nullptr, &relay_video, iptv_cloud::stream::invalid_chunk_index);
@@ -357,7 +357,7 @@ void check_static_image() {
                                            std::make_pair(INPUT_FIELD, iuri_str),
                                            std::make_pair(OUTPUT_FIELD, static_image_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct static_image(
+    iptv_cloud::SharedStreamStruct static_image(
         iptv_cloud::StreamInfo{common::MemSPrintf("static_image_%llu", i), iptv_cloud::ENCODING, {0}, {0}});
     iptv_cloud::stream::IBaseStream* static_image_job = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args, nullptr, &static_image, iptv_cloud::stream::invalid_chunk_index);
@@ -380,7 +380,7 @@ void check_ad_feature(const iptv_cloud::input_t& input) {
       std::make_pair(ID_FIELD, "ad"), std::make_pair(TYPE_FIELD, common::ConvertToString(iptv_cloud::ENCODING)),
       std::make_pair(INPUT_FIELD, iuri_str), std::make_pair(OUTPUT_FIELD, enc_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct encoding(
+    iptv_cloud::SharedStreamStruct encoding(
         iptv_cloud::StreamInfo{common::MemSPrintf("ad_%llu", i), iptv_cloud::ENCODING, {0}, {0}});
     iptv_cloud::stream::IBaseStream* job_enc = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args_enc, nullptr, &encoding, iptv_cloud::stream::invalid_chunk_index);
@@ -406,7 +406,7 @@ void check_test() {
       std::make_pair(ID_FIELD, "test"), std::make_pair(TYPE_FIELD, common::ConvertToString(iptv_cloud::ENCODING)),
       std::make_pair(INPUT_FIELD, iuri_str), std::make_pair(OUTPUT_FIELD, test_uri_str)};
   for (size_t i = 0; i < STREAMS_TRY_COUNT; ++i) {
-    iptv_cloud::StreamStruct test(
+    iptv_cloud::SharedStreamStruct test(
         iptv_cloud::StreamInfo{common::MemSPrintf("test_%llu", i), iptv_cloud::ENCODING, {0}, {0}});
     iptv_cloud::stream::IBaseStream* test_job = iptv_cloud::stream::StreamsFactory::GetInstance().CreateStream(
         args, nullptr, &test, iptv_cloud::stream::invalid_chunk_index);
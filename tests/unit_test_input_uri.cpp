@@ -23,6 +23,7 @@
 #define DEVICE_VIDEO "/dev/video3"
 #define DEVICE_AUDIO "audio=hw:3,0"
 #define DEVICE_INPUT "dev://" DEVICE_VIDEO "?" DEVICE_AUDIO
+#define UDP_INPUT "udp://239.1.1.1:5000"
 
 TEST(InputUri, ConvertFromString) {
   const std::string invalid_uri_json =
@@ -66,4 +67,16 @@ TEST(InputUri, ConvertFromString) {
   common::uri::Upath dpath = dev_ro.GetPath();
   ASSERT_EQ(dpath.GetPath(), DEVICE_VIDEO);
   ASSERT_EQ(dpath.GetQuery(), DEVICE_AUDIO);
+
+  const std::string udp_uri_json = "{ \"id\": 3, \"uri\": \"" UDP_INPUT
+                                   "\", \"rcvbuf_size\": 8388608, \"multicast_iface\": \"eth1\", "
+                                   "\"multicast_source\": \"10.0.0.1\"}";
+  iptv_cloud::InputUri udp_uri;
+  err = udp_uri.DeSerializeFromString(udp_uri_json);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(udp_uri.GetRecvBufferSize(), 8388608);
+  ASSERT_EQ(udp_uri.GetMulticastIface(), "eth1");
+  ASSERT_EQ(udp_uri.GetMulticastSource(), "10.0.0.1");
+  ASSERT_EQ(file_uri.GetRecvBufferSize(), 0);
+  ASSERT_TRUE(file_uri.GetMulticastIface().empty());
 }
@@ -21,6 +21,7 @@
 
 #define RTMP_OUTPUT "rtmp://4.31.30.153:1935/devapp/tokengenffmpeg1"
 #define HTTP_OUTPUT "/home/sasha/123/"
+#define UDP_OUTPUT "udp://239.1.1.1:5000"
 
 TEST(OutputUri, ConvertFromString) {
   const std::string invalid_uri_json = "{ \"id\": 0, \"uri\": \"\", \"http_root\": \"\", \"size\": \"0x0\" }";
@@ -45,4 +46,30 @@ TEST(OutputUri, ConvertFromString) {
   err = uri.SerializeToString(&conv);
   ASSERT_FALSE(err);
   // ASSERT_EQ(conv, uri_json);
+  ASSERT_EQ(uri.GetUdpMode(), iptv_cloud::OutputUri::RTP_ES);
+  ASSERT_EQ(uri.GetMuxRate(), 0);
+
+  const std::string udp_uri_json =
+      "{ \"id\": 2, \"uri\": \"" UDP_OUTPUT "\", \"http_root\": \"\", \"udp_mode\": 2, \"muxrate\": 6000000 }";
+  iptv_cloud::OutputUri udp_uri;
+  err = udp_uri.DeSerializeFromString(udp_uri_json);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(udp_uri.GetUdpMode(), iptv_cloud::OutputUri::RTP_TS);
+  ASSERT_EQ(udp_uri.GetMuxRate(), 6000000);
+  err = udp_uri.SerializeToString(&conv);
+  ASSERT_FALSE(err);
+  iptv_cloud::OutputUri udp_uri2;
+  err = udp_uri2.DeSerializeFromString(conv);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(udp_uri2.GetUdpMode(), iptv_cloud::OutputUri::RTP_TS);
+  ASSERT_EQ(udp_uri2.GetMuxRate(), 6000000);
+  ASSERT_TRUE(udp_uri2.Equals(udp_uri));
+  udp_uri2.SetMuxRate(0);
+  ASSERT_FALSE(udp_uri2.Equals(udp_uri));
+
+  iptv_cloud::OutputUri invalid_udp_uri;
+  err = invalid_udp_uri.DeSerializeFromString("{ \"id\": 3, \"uri\": \"" UDP_OUTPUT "\", \"udp_mode\": 3 }");
+  ASSERT_TRUE(err);
+  err = invalid_udp_uri.DeSerializeFromString("{ \"id\": 3, \"uri\": \"" UDP_OUTPUT "\", \"muxrate\": -1 }");
+  ASSERT_TRUE(err);
 }
@@ -0,0 +1,82 @@
+/*  Copyright (C) 2014-2019 FastoGT. All right reserved.
+    This file is part of iptv_cloud.
+    iptv_cloud is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    iptv_cloud is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with iptv_cloud.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include "base/stream_commands.h"
+#include "protocol/pipe_protocol.h"
+
+TEST(PipeProtocol, EncodeDecode) {
+  const std::string payload = "{\"id\":\"test\"}";
+  iptv_cloud::protocol::PipeMessage msg = iptv_cloud::ChangedSourcesStreamPipeNotification(payload);
+  msg.seq = 0x0102030405060708;
+
+  std::string data;
+  common::ErrnoError err = iptv_cloud::protocol::EncodePipeMessage(msg, &data);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(data.size(), PIPE_MESSAGE_HEADER_SIZE + payload.size());
+  ASSERT_EQ(data.substr(PIPE_MESSAGE_HEADER_SIZE), payload);
+
+  iptv_cloud::protocol::PipeMessageHeader hdr;
+  err = iptv_cloud::protocol::DecodePipeMessageHeader(data.data(), data.size(), &hdr);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(hdr.type, iptv_cloud::protocol::PIPE_NOTIFICATION);
+  ASSERT_EQ(hdr.command, iptv_cloud::protocol::PIPE_CHANGED_SOURCES_STREAM);
+  ASSERT_EQ(hdr.payload_size, payload.size());
+  ASSERT_EQ(hdr.seq, msg.seq);
+
+  iptv_cloud::protocol::PipeMessage stop = iptv_cloud::StopStreamPipeResponceSuccess(7);
+  err = iptv_cloud::protocol::EncodePipeMessage(stop, &data);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(data.size(), PIPE_MESSAGE_HEADER_SIZE);
+  err = iptv_cloud::protocol::DecodePipeMessageHeader(data.data(), data.size(), &hdr);
+  ASSERT_FALSE(err);
+  ASSERT_EQ(hdr.type, iptv_cloud::protocol::PIPE_RESPONSE);
+  ASSERT_EQ(hdr.command, iptv_cloud::protocol::PIPE_STOP_STREAM);
+  ASSERT_EQ(hdr.payload_size, 0u);
+  ASSERT_EQ(hdr.seq, 7u);
+}
+
+TEST(PipeProtocol, InvalidHeader) {
+  iptv_cloud::protocol::PipeMessageHeader hdr;
+  std::string data;
+  common::ErrnoError err = iptv_cloud::protocol::EncodePipeMessage(iptv_cloud::RestartStreamPipeRequest(1), &data);
+  ASSERT_FALSE(err);
+
+  err = iptv_cloud::protocol::DecodePipeMessageHeader(data.data(), PIPE_MESSAGE_HEADER_SIZE - 1, &hdr);
+  ASSERT_TRUE(err);
+
+  std::string bad_magic = data;
+  bad_magic[0] = 0;  // json-rpc frame starts with size prefix
+  err = iptv_cloud::protocol::DecodePipeMessageHeader(bad_magic.data(), bad_magic.size(), &hdr);
+  ASSERT_TRUE(err);
+
+  std::string bad_command = data;
+  bad_command[3] = 0x7F;
+  err = iptv_cloud::protocol::DecodePipeMessageHeader(bad_command.data(), bad_command.size(), &hdr);
+  ASSERT_TRUE(err);
+
+  std::string too_big = data;
+  too_big[4] = 0x7F;
+  err = iptv_cloud::protocol::DecodePipeMessageHeader(too_big.data(), too_big.size(), &hdr);
+  ASSERT_TRUE(err);
+
+  iptv_cloud::protocol::PipeMessage huge = iptv_cloud::ChangedSourcesStreamPipeNotification(
+      std::string(MAX_PIPE_MESSAGE_PAYLOAD_SIZE + 1, 'x'));
+  err = iptv_cloud::protocol::EncodePipeMessage(huge, &data);
+  ASSERT_TRUE(err);
+
+  ASSERT_TRUE(iptv_cloud::protocol::IsValidPipeProtocol(iptv_cloud::protocol::BINARY_PIPE_PROTOCOL));
+  ASSERT_FALSE(iptv_cloud::protocol::IsValidPipeProtocol(42));
+}
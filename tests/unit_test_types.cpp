@@ -14,6 +14,11 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
+#include "base/abr_ladder.h"
+#include "base/shared_ingest_ring.h"
+#include "base/shared_stream_struct.h"
 #include "stream_commands_info/statistic_info.h"
 
 TEST(StreamStructInfo, SerializeDeSerialize) {
@@ -45,3 +50,260 @@ TEST(StreamStructInfo, SerializeDeSerialize) {
 
   json_object_put(serialized);
 }
+
+TEST(AbrLadder, ConvertFromString) {
+  iptv_cloud::abr_ladder_t ladder;
+  ASSERT_TRUE(common::ConvertFromString(
+      "[{\"size\": \"1920x1080\", \"video_bitrate\": 5000}, {\"size\": \"1280x720\", \"video_bitrate\": 3000}]",
+      &ladder));
+  ASSERT_EQ(ladder.size(), 2u);
+  ASSERT_EQ(ladder[0].GetSize(), common::draw::Size(1920, 1080));
+  ASSERT_EQ(ladder[0].GetVideoBitrate(), 5000);
+  ASSERT_EQ(ladder[1].GetName(), "720p");
+
+  iptv_cloud::abr_ladder_t ladder2;
+  ASSERT_TRUE(common::ConvertFromString(common::ConvertToString(ladder), &ladder2));
+  ASSERT_EQ(ladder, ladder2);
+
+  // same height twice, missing bitrate, not array
+  ASSERT_FALSE(common::ConvertFromString(
+      "[{\"size\": \"1280x720\", \"video_bitrate\": 3000}, {\"size\": \"960x720\", \"video_bitrate\": 2000}]",
+      &ladder2));
+  ASSERT_FALSE(common::ConvertFromString("[{\"size\": \"1280x720\"}]", &ladder2));
+  ASSERT_FALSE(common::ConvertFromString("{\"size\": \"1280x720\", \"video_bitrate\": 3000}", &ladder2));
+}
+
+TEST(SharedStreamStruct, Snapshot) {
+  iptv_cloud::StreamInfo sha;
+  sha.id = "test";
+  sha.type = iptv_cloud::RELAY;
+  sha.input = {0, 1};
+  sha.output = {4};
+  ASSERT_TRUE(iptv_cloud::SharedStreamStruct::IsFitInfo(sha));
+
+  iptv_cloud::SharedStreamStruct mem(sha);
+  ASSERT_TRUE(mem.IsValid());
+  ASSERT_EQ(mem.GetID(), sha.id);
+  ASSERT_EQ(mem.GetInputCount(), 2u);
+  ASSERT_EQ(mem.GetOutputCount(), 1u);
+  ASSERT_FALSE(mem.GetOutput(1));
+
+  mem.GetInput(1)->AddTotalBytes(100);
+  mem.GetInput(1)->AddTotalBytes(28);
+  mem.GetOutput(0)->AddTotalBytes(64);
+  mem.SetStatus(iptv_cloud::PLAYING);
+  mem.IncreaseRestarts();
+  mem.UpdateBps(2);
+  mem.SetProcessStats(0.5, 1024);
+
+  iptv_cloud::StreamStruct str;
+  iptv_cloud::SharedStreamStruct::cpu_load_t cpu_load = 0;
+  iptv_cloud::SharedStreamStruct::rss_t rss = 0;
+  ASSERT_TRUE(mem.GetSnapshot(&str, &cpu_load, &rss));
+  ASSERT_EQ(str.id, sha.id);
+  ASSERT_EQ(str.status, iptv_cloud::PLAYING);
+  ASSERT_EQ(str.restarts, 1u);
+  ASSERT_EQ(str.input.size(), 2u);
+  ASSERT_EQ(str.input[1].GetID(), 1u);
+  ASSERT_EQ(str.input[1].GetTotalBytes(), 128u);
+  ASSERT_EQ(str.input[1].GetBps(), 64u);
+  ASSERT_EQ(str.output[0].GetTotalBytes(), 64u);
+  ASSERT_EQ(cpu_load, 0.5);
+  ASSERT_EQ(rss, 1024u);
+
+  mem.ResetDataWait();
+  ASSERT_EQ(mem.GetInput(1)->GetDiffTotalBytes(), 0u);
+
+  sha.input.resize(MAX_SHARED_CHANNELS_COUNT + 1);
+  ASSERT_FALSE(iptv_cloud::SharedStreamStruct::IsFitInfo(sha));
+}
+
+TEST(SharedStreamStruct, Histograms) {
+  ASSERT_EQ(iptv_cloud::GetHistogramBucket(0), 0u);
+  ASSERT_EQ(iptv_cloud::GetHistogramBucket(1), 0u);
+  ASSERT_EQ(iptv_cloud::GetHistogramBucket(188), 7u);
+  ASSERT_EQ(iptv_cloud::GetHistogramBucket(1316), 10u);
+  ASSERT_EQ(iptv_cloud::GetHistogramBucket(UINT64_MAX), CHANNEL_HISTOGRAM_BUCKETS - 1);
+
+  iptv_cloud::StreamInfo sha;
+  sha.id = "test";
+  sha.input = {0};
+  sha.output = {1};
+  iptv_cloud::SharedStreamStruct mem(sha);
+  iptv_cloud::SharedChannelStats* in = mem.GetInput(0);
+  in->AddBuffer(1316);
+  in->AddArrival(1000000, -1);
+  in->AddBuffer(1316);
+  in->AddBuffer(188);
+  in->AddArrival(1040000, 40000);
+
+  iptv_cloud::ChannelStats stats = in->MakeChannelStats();
+  ASSERT_EQ(stats.GetTotalBytes(), 2820u);
+  ASSERT_EQ(stats.GetBuffersCount(), 3u);
+  ASSERT_EQ(stats.GetLastUpdateTime(), 1040u);
+  ASSERT_EQ(stats.GetSizeHistogram()[10], 2u);
+  ASSERT_EQ(stats.GetSizeHistogram()[7], 1u);
+  ASSERT_EQ(stats.GetIntervalHistogram()[15], 1u);  // 40 msec
+  uint64_t intervals = 0;
+  for (uint64_t count : stats.GetIntervalHistogram()) {
+    intervals += count;
+  }
+  ASSERT_EQ(intervals, 1u);
+
+  iptv_cloud::StreamStruct str;
+  iptv_cloud::SharedStreamStruct::cpu_load_t cpu_load = 0;
+  iptv_cloud::SharedStreamStruct::rss_t rss = 0;
+  ASSERT_TRUE(mem.GetSnapshot(&str, &cpu_load, &rss));
+  iptv_cloud::StatisticInfo sinf(str, cpu_load, rss, 10);
+  json_object* serialized = NULL;
+  common::Error err = sinf.Serialize(&serialized);
+  ASSERT_FALSE(err);
+
+  iptv_cloud::StatisticInfo sinf2;
+  err = sinf2.DeSerialize(serialized);
+  ASSERT_FALSE(err);
+  json_object_put(serialized);
+  const iptv_cloud::ChannelStats in2 = sinf2.GetStreamStruct().input[0];
+  ASSERT_EQ(in2.GetBuffersCount(), 3u);
+  ASSERT_TRUE(in2.GetSizeHistogram() == stats.GetSizeHistogram());
+  ASSERT_TRUE(in2.GetIntervalHistogram() == stats.GetIntervalHistogram());
+}
+
+TEST(SharedStreamStruct, LatencyPercentiles) {
+  for (uint64_t msec = 0; msec < 200000; msec += 7) {
+    const size_t bucket = iptv_cloud::GetLatencyBucket(msec);
+    ASSERT_LT(bucket, static_cast<size_t>(CHANNEL_LATENCY_BUCKETS));
+    ASSERT_LE(iptv_cloud::GetLatencyBucketLowerBound(bucket), msec);
+    if (bucket + 1 < CHANNEL_LATENCY_BUCKETS) {
+      ASSERT_GT(iptv_cloud::GetLatencyBucketLowerBound(bucket + 1), msec);
+    }
+  }
+
+  iptv_cloud::StreamInfo sha;
+  sha.id = "test";
+  sha.input = {0};
+  sha.output = {1};
+  iptv_cloud::SharedStreamStruct mem(sha);
+  iptv_cloud::SharedChannelStats* out = mem.GetOutput(0);
+  for (size_t i = 0; i < 90; ++i) {
+    out->AddLatency(5);
+  }
+  for (size_t i = 0; i < 9; ++i) {
+    out->AddLatency(100);
+  }
+  out->AddLatency(2000);
+  mem.UpdateLatency();
+
+  iptv_cloud::ChannelStats stats = out->MakeChannelStats();
+  ASSERT_EQ(stats.GetLatencyP50(), 5u);
+  ASSERT_GE(stats.GetLatencyP95(), 100u);
+  ASSERT_LT(stats.GetLatencyP95(), 128u);
+  ASSERT_GE(stats.GetLatencyP99(), 2000u);
+  ASSERT_LT(stats.GetLatencyP99(), 2048u);
+
+  mem.UpdateLatency();  // only new buffers are counted
+  stats = out->MakeChannelStats();
+  ASSERT_EQ(stats.GetLatencyP50(), 0u);
+  ASSERT_EQ(stats.GetLatencyP99(), 0u);
+}
+
+TEST(SharedStreamStruct, InputErrors) {
+  iptv_cloud::StreamInfo sha;
+  sha.id = "test";
+  sha.input = {0};
+  sha.output = {1};
+  iptv_cloud::SharedStreamStruct mem(sha);
+  iptv_cloud::SharedChannelStats* in = mem.GetInput(0);
+  in->AddKernelDrops(10);
+  in->AddKernelDrops(5);
+  in->AddContinuityErrors(2);
+
+  iptv_cloud::ChannelStats stats = in->MakeChannelStats();
+  ASSERT_EQ(stats.GetKernelDrops(), 15u);
+  ASSERT_EQ(stats.GetContinuityErrors(), 2u);
+  stats = mem.GetOutput(0)->MakeChannelStats();
+  ASSERT_EQ(stats.GetKernelDrops(), 0u);
+  ASSERT_EQ(stats.GetContinuityErrors(), 0u);
+}
+
+TEST(SharedHlsStore, PublishFind) {
+  const size_t data_size = 1024;
+  std::vector<uint64_t> mem((iptv_cloud::SharedHlsStore::CalcSize(data_size) + 7) / 8);
+  iptv_cloud::SharedHlsStore* store = new (mem.data()) iptv_cloud::SharedHlsStore(data_size);
+  ASSERT_TRUE(store->IsValid());
+
+  iptv_cloud::SharedHlsStore::File file;
+  ASSERT_FALSE(store->Find("/hls/1/master.m3u8", &file));
+
+  const std::string playlist = "#EXTM3U\n";
+  common::ErrnoError err = store->Publish("/hls/1/master.m3u8", playlist.data(), playlist.size(), 1);
+  ASSERT_FALSE(err);
+  const std::string playlist2 = "#EXTM3U\n#EXT-X-VERSION:3\n";
+  err = store->Publish("/hls/1/master.m3u8", playlist2.data(), playlist2.size(), 2);
+  ASSERT_FALSE(err);
+  ASSERT_TRUE(store->Find("/hls/1/master.m3u8", &file));
+  ASSERT_EQ(std::string(file.data, file.size), playlist2);
+  ASSERT_EQ(file.mtime, 2);
+
+  const std::string chunk(400, 'a');
+  err = store->Publish("/hls/1/00001.ts", chunk.data(), chunk.size(), 3);
+  ASSERT_FALSE(err);
+  ASSERT_TRUE(store->Find("/hls/1/00001.ts", &file));
+  ASSERT_EQ(std::string(file.data, file.size), chunk);
+
+  // ring wraps around and reuses first chunk data
+  const std::string chunk2(400, 'b');
+  err = store->Publish("/hls/1/00002.ts", chunk2.data(), chunk2.size(), 4);
+  ASSERT_FALSE(err);
+  err = store->Publish("/hls/1/00003.ts", chunk2.data(), chunk2.size(), 5);
+  ASSERT_FALSE(err);
+  ASSERT_FALSE(store->IsAlive(file));
+  ASSERT_FALSE(store->Find("/hls/1/00001.ts", &file));
+  ASSERT_TRUE(store->Find("/hls/1/00003.ts", &file));
+  ASSERT_EQ(std::string(file.data, file.size), chunk2);
+
+  store->Remove("/hls/1/00003.ts");
+  ASSERT_FALSE(store->Find("/hls/1/00003.ts", &file));
+
+  const std::string big(data_size, 'c');
+  err = store->Publish("/hls/1/00004.ts", big.data(), big.size(), 6);
+  ASSERT_TRUE(err);
+}
+
+TEST(SharedIngestRing, WriteRead) {
+  const size_t data_size = 1024;
+  std::vector<uint64_t> mem((iptv_cloud::SharedIngestRing::CalcSize(data_size) + 7) / 8);
+  iptv_cloud::SharedIngestRing* ring = new (mem.data()) iptv_cloud::SharedIngestRing(data_size);
+  ASSERT_TRUE(ring->IsValid());
+
+  uint64_t offset = ring->GetWriteOffset();
+  char out[512];
+  bool lost = true;
+  ASSERT_EQ(ring->Read(&offset, out, sizeof(out), &lost), 0u);
+  ASSERT_FALSE(lost);
+
+  const std::string packets(376, 'a');
+  ASSERT_FALSE(ring->Write(packets.data(), packets.size()));
+  ASSERT_FALSE(ring->Write(packets.data(), packets.size()));
+  ASSERT_EQ(ring->Read(&offset, out, sizeof(out), &lost), sizeof(out));
+  ASSERT_EQ(ring->Read(&offset, out, sizeof(out), &lost), 2 * packets.size() - sizeof(out));
+  ASSERT_EQ(offset, 2 * packets.size());
+
+  // wraps around ring end
+  const std::string packets2(376, 'b');
+  ASSERT_FALSE(ring->Write(packets2.data(), packets2.size()));
+  ASSERT_EQ(ring->Read(&offset, out, sizeof(out), &lost), packets2.size());
+  ASSERT_EQ(std::string(out, packets2.size()), packets2);
+
+  // slow reader is lapped and skips to live edge
+  uint64_t slow_offset = offset;
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_FALSE(ring->Write(packets.data(), packets.size()));
+  }
+  ASSERT_EQ(ring->Read(&slow_offset, out, sizeof(out), &lost), 0u);
+  ASSERT_TRUE(lost);
+  ASSERT_EQ(slow_offset, ring->GetWriteOffset());
+
+  const std::string big(data_size + 1, 'c');
+  ASSERT_TRUE(ring->Write(big.data(), big.size()));
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "utils/m3u8_reader.h"
+
+#define BENCHMARK_CHUNKS_COUNT 8640  // day of 10 second chunks
+#define BENCHMARK_ITERATIONS 50
+
+namespace {
+
+// previous fgets and std::regex based reader, kept as baseline (with fclose added)
+bool RegexParse(const std::string& path, std::vector<iptv_cloud::utils::ChunkInfo>* chunks) {
+  static const std::regex m3u8_chunk_header_re("^#EXTINF:([0-9.]+),$");
+  static const std::regex m3u8_chunk_re("^[A-Za-z0-9_]*?([0-9]+)\\.ts$");
+  static const std::regex m3u8_header_re("^#EXT-X-[A-Z-]+:([A-Z0-9]+)$");
+
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file) {
+    return false;
+  }
+
+  chunks->clear();
+  char buff[255];
+  std::string header_line;
+  std::smatch match;
+  while (fgets(buff, sizeof(buff), file)) {
+    std::string line = buff;
+    while (!line.empty() && isspace(line.back())) {
+      line.pop_back();
+    }
+    if (line.empty() || line == "#EXTM3U" || line == "#EXT-X-ENDLIST") {
+      continue;
+    }
+    if (std::regex_match(line, match, m3u8_header_re)) {
+      continue;
+    }
+    if (std::regex_match(line, match, m3u8_chunk_header_re)) {
+      header_line = match.str(1);
+      continue;
+    }
+    if (!std::regex_match(line, match, m3u8_chunk_re)) {
+      fclose(file);
+      return false;
+    }
+    const double duration = strtod(header_line.c_str(), nullptr);
+    const uint64_t index = strtoull(match.str(1).c_str(), nullptr, 10);
+    chunks->push_back(iptv_cloud::utils::ChunkInfo(
+        line, static_cast<uint64_t>(duration * iptv_cloud::utils::ChunkInfo::SECOND), index));
+  }
+
+  fclose(file);
+  return !chunks->empty();
+}
+
+template <typename F>
+double Measure(F func) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < BENCHMARK_ITERATIONS; ++i) {
+    if (!func()) {
+      return -1;
+    }
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / BENCHMARK_ITERATIONS;
+}
+
+}  // namespace
+
+int main() {
+  char path[] = "/tmp/m3u8_benchmark_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd == -1) {
+    return EXIT_FAILURE;
+  }
+
+  std::string playlist = "#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-MEDIA-SEQUENCE:0\n#EXT-X-TARGETDURATION:10\n";
+  for (size_t i = 0; i < BENCHMARK_CHUNKS_COUNT; ++i) {
+    playlist += "#EXTINF:10.000000,\n1497615343667_segment" + std::to_string(i) + ".ts\n";
+  }
+  playlist += "#EXT-X-ENDLIST\n";
+  const bool written = write(fd, playlist.data(), playlist.size()) == static_cast<ssize_t>(playlist.size());
+  close(fd);
+  if (!written) {
+    unlink(path);
+    return EXIT_FAILURE;
+  }
+
+  const std::string spath = path;
+  std::vector<iptv_cloud::utils::ChunkInfo> chunks;
+  const double regex_usec = Measure([&spath, &chunks]() { return RegexParse(spath, &chunks); });
+  const double mmap_usec = Measure([&spath]() {
+    iptv_cloud::utils::M3u8Reader reader;
+    return reader.Parse(spath);
+  });
+  unlink(path);
+
+  if (regex_usec < 0 || mmap_usec < 0) {
+    return EXIT_FAILURE;
+  }
+
+  printf("chunks: %d, regex reader: %.1f usec, mmap reader: %.1f usec, speedup: %.1fx\n", BENCHMARK_CHUNKS_COUNT,
+         regex_usec, mmap_usec, regex_usec / mmap_usec);
+  return EXIT_SUCCESS;
+}
@@ -1,11 +1,319 @@
 #include <gtest/gtest.h>
 
+#include <string.h>
+#include <unistd.h>
+
 #include "utils/chunk_info.h"
+#include "utils/m3u8_reader.h"
+#include "utils/m3u8_writer.h"
+#include "utils/ts_chunker.h"
+#include "utils/ts_packet_filter.h"
 
 #define TEST_PLAYLIST PROJECT_TEST_SOURCES_DIR "/playlist.m3u8"
 #define NEW_PLAYLIST PROJECT_TEST_SOURCES_DIR "/test_write.m3u8"
 
+namespace {
+void MakeTsPacket(uint16_t pid, uint8_t cc, uint64_t pcr_base, uint8_t* packet) {  // pcr_base 0 => without pcr
+  memset(packet, 0xFF, TS_PACKET_SIZE);
+  packet[0] = TS_SYNC_BYTE;
+  packet[1] = (pid >> 8) & 0x1F;
+  packet[2] = pid & 0xFF;
+  packet[3] = (pcr_base ? 0x30 : 0x10) | (cc & 0x0F);
+  if (pcr_base) {
+    packet[4] = 7;
+    packet[5] = 0x10;
+    packet[6] = (pcr_base >> 25) & 0xFF;
+    packet[7] = (pcr_base >> 17) & 0xFF;
+    packet[8] = (pcr_base >> 9) & 0xFF;
+    packet[9] = (pcr_base >> 1) & 0xFF;
+    packet[10] = ((pcr_base & 0x01) << 7) | 0x7E;
+    packet[11] = 0;
+  }
+}
+
+void MakeTsSectionPacket(uint16_t pid, const uint8_t* section, size_t size, uint8_t* packet) {
+  MakeTsPacket(pid, 0, 0, packet);
+  packet[1] |= 0x40;  // payload unit start
+  packet[4] = 0;      // pointer field
+  memcpy(packet + 5, section, size);
+}
+
+void MakeTsVideoPacket(uint64_t pcr_base, bool random_access, uint8_t* packet) {
+  MakeTsPacket(0x101, 0, pcr_base, packet);
+  packet[1] |= 0x40;
+  if (random_access) {
+    packet[5] |= 0x40;
+  }
+}
+}  // namespace
+
 TEST(ChunkInfo, double) {
   iptv_cloud::utils::ChunkInfo ch("1497615343667_segment10012.ts", 11.43 * iptv_cloud::utils::ChunkInfo::SECOND, 10012);
   ASSERT_EQ(ch.GetDurationInSecconds(), 11.43);
 }
+
+TEST(M3u8Reader, vod) {
+  const std::string playlist =
+      "#EXTM3U\n"
+      "#EXT-X-VERSION:3\n"
+      "#EXT-X-ALLOW-CACHE:YES\n"
+      "#EXT-X-MEDIA-SEQUENCE:10012\n"
+      "#EXT-X-TARGETDURATION:12\n"
+      "#EXTINF:11.43,\n"
+      "1497615343667_segment10012.ts\n"
+      "\n"
+      "#EXTINF:10.000,title\r\n"
+      "1497615343667_segment10013.ts\r\n"
+      "#EXT-X-ENDLIST\n";
+
+  iptv_cloud::utils::M3u8Reader reader;
+  ASSERT_TRUE(reader.ParseBuffer(playlist.data(), playlist.size()));
+  ASSERT_EQ(reader.GetVersion(), 3);
+  ASSERT_TRUE(reader.IsAllowCache());
+  ASSERT_EQ(reader.GetMediaSequence(), 10012);
+  ASSERT_EQ(reader.GetTargetDuration(), 12);
+  ASSERT_TRUE(reader.IsEndList());
+
+  std::vector<iptv_cloud::utils::ChunkInfo> chunks = reader.GetChunks();
+  ASSERT_EQ(chunks.size(), 2u);
+  ASSERT_EQ(chunks[0].path, "1497615343667_segment10012.ts");
+  ASSERT_EQ(chunks[0].duration, 11430000000u);
+  ASSERT_EQ(chunks[0].index, 10012u);
+  ASSERT_FALSE(chunks[0].discontinuity);
+  ASSERT_EQ(chunks[0].program_date_time, -1);
+  ASSERT_EQ(chunks[1].path, "1497615343667_segment10013.ts");
+  ASSERT_EQ(chunks[1].duration, 10000000000u);
+  ASSERT_EQ(chunks[1].index, 10013u);
+
+  const std::string live = "#EXTM3U\n#EXTINF:5,\n5.ts";  // no endlist and no trailing newline
+  ASSERT_TRUE(reader.ParseBuffer(live.data(), live.size()));
+  ASSERT_FALSE(reader.IsEndList());
+  ASSERT_EQ(reader.GetChunks().size(), 1u);
+  ASSERT_EQ(reader.GetMediaSequence(), -1);
+}
+
+TEST(M3u8Reader, tags) {
+  const std::string long_uri =
+      "http://example.com/" + std::string(1024, 'a') + "/chunk.ts?token=" + std::string(512, 'b');
+  const std::string playlist =
+      "#EXTM3U\n"
+      "#EXT-X-MEDIA-SEQUENCE:7\n"
+      "#EXT-X-PROGRAM-DATE-TIME:2019-03-01T10:00:00.500Z\n"
+      "#EXTINF:4.5,\n"
+      "media.ts\n"
+      "#EXT-X-BYTERANGE:1000@0\n"
+      "#EXTINF:4,\n"
+      "media.ts\n"
+      "#EXT-X-BYTERANGE:500\n"
+      "#EXTINF:4,\n"
+      "media.ts\n"
+      "#EXT-X-DISCONTINUITY\n"
+      "#EXT-X-PROGRAM-DATE-TIME:2019-03-01T12:00:00+02:00\n"
+      "#EXTINF:2,\n" +
+      long_uri + "\n";
+
+  iptv_cloud::utils::M3u8Reader reader;
+  ASSERT_TRUE(reader.ParseBuffer(playlist.data(), playlist.size()));
+  std::vector<iptv_cloud::utils::ChunkInfo> chunks = reader.GetChunks();
+  ASSERT_EQ(chunks.size(), 4u);
+
+  ASSERT_EQ(chunks[0].index, 7u);  // no number in name, index from media sequence
+  ASSERT_EQ(chunks[0].program_date_time, 1551434400500);
+  ASSERT_EQ(chunks[0].byterange_length, 0u);
+
+  ASSERT_EQ(chunks[1].index, 8u);
+  ASSERT_EQ(chunks[1].program_date_time, 1551434405000);
+  ASSERT_EQ(chunks[1].byterange_length, 1000u);
+  ASSERT_EQ(chunks[1].byterange_offset, 0u);
+
+  ASSERT_EQ(chunks[2].byterange_length, 500u);
+  ASSERT_EQ(chunks[2].byterange_offset, 1000u);
+  ASSERT_FALSE(chunks[2].discontinuity);
+
+  ASSERT_TRUE(chunks[3].discontinuity);
+  ASSERT_EQ(chunks[3].program_date_time, 1551434400000);
+  ASSERT_EQ(chunks[3].path, long_uri);
+}
+
+TEST(M3u8Reader, invalid) {
+  iptv_cloud::utils::M3u8Reader reader;
+  ASSERT_FALSE(reader.ParseBuffer(nullptr, 0));
+  ASSERT_FALSE(reader.Parse(std::string(PROJECT_TEST_SOURCES_DIR "/not_exists.m3u8")));
+
+  const std::string without_extinf = "#EXTM3U\n1.ts\n";
+  ASSERT_FALSE(reader.ParseBuffer(without_extinf.data(), without_extinf.size()));
+  const std::string without_uri = "#EXTM3U\n#EXTINF:1,\n";
+  ASSERT_FALSE(reader.ParseBuffer(without_uri.data(), without_uri.size()));
+  const std::string bad_duration = "#EXTM3U\n#EXTINF:abc,\n1.ts\n";
+  ASSERT_FALSE(reader.ParseBuffer(bad_duration.data(), bad_duration.size()));
+  const std::string bad_date = "#EXTM3U\n#EXT-X-PROGRAM-DATE-TIME:2019-13-01T00:00:00Z\n#EXTINF:1,\n1.ts\n";
+  ASSERT_FALSE(reader.ParseBuffer(bad_date.data(), bad_date.size()));
+  const std::string bad_cache = "#EXTM3U\n#EXT-X-ALLOW-CACHE:MAYBE\n";
+  ASSERT_FALSE(reader.ParseBuffer(bad_cache.data(), bad_cache.size()));
+  const std::string empty = "#EXTM3U\n";
+  ASSERT_FALSE(reader.ParseBuffer(empty.data(), empty.size()));
+}
+
+TEST(M3u8Reader, file) {
+  char path[] = "/tmp/m3u8_reader_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  const std::string playlist = "#EXTM3U\n#EXT-X-TARGETDURATION:5\n#EXTINF:5,\nsegment1.ts\n#EXT-X-ENDLIST\n";
+  ASSERT_EQ(write(fd, playlist.data(), playlist.size()), static_cast<ssize_t>(playlist.size()));
+  close(fd);
+
+  iptv_cloud::utils::M3u8Reader reader;
+  ASSERT_TRUE(reader.Parse(std::string(path)));
+  ASSERT_TRUE(reader.Parse(common::file_system::ascii_file_string_path(path)));
+  ASSERT_EQ(reader.GetTargetDuration(), 5);
+  ASSERT_EQ(reader.GetChunks().size(), 1u);
+  ASSERT_EQ(reader.GetChunks()[0].index, 1u);
+  unlink(path);
+}
+
+TEST(M3u8Writer, atomic) {
+  const common::file_system::ascii_file_string_path path(NEW_PLAYLIST);
+  const std::string temp_path = path.GetPath() + ".tmp";
+  unlink(path.GetPath().c_str());
+  {
+    iptv_cloud::utils::M3u8Writer writer;
+    ASSERT_FALSE(writer.OpenAtomic(path));
+    ASSERT_FALSE(writer.WriteHeader(0, 5));
+    ASSERT_FALSE(writer.WriteLine(iptv_cloud::utils::ChunkInfo("0.ts", 5 * iptv_cloud::utils::ChunkInfo::SECOND, 0)));
+    ASSERT_NE(access(path.GetPath().c_str(), F_OK), 0);  // not visible until closed
+  }
+  ASSERT_NE(access(temp_path.c_str(), F_OK), 0);  // discarded without close
+
+  iptv_cloud::utils::M3u8Writer writer;
+  ASSERT_FALSE(writer.OpenAtomic(path));
+  ASSERT_FALSE(writer.WriteHeader(0, 5));
+  ASSERT_FALSE(writer.WritePlaylistType("EVENT"));
+  ASSERT_FALSE(writer.WriteLine(iptv_cloud::utils::ChunkInfo("0.ts", 5 * iptv_cloud::utils::ChunkInfo::SECOND, 0)));
+  ASSERT_FALSE(writer.Close());
+  ASSERT_NE(access(temp_path.c_str(), F_OK), 0);
+
+  iptv_cloud::utils::M3u8Reader reader;
+  ASSERT_TRUE(reader.Parse(path));
+  ASSERT_FALSE(reader.IsEndList());
+  ASSERT_EQ(reader.GetChunks().size(), 1u);
+  unlink(path.GetPath().c_str());
+}
+
+TEST(TsPacketFilter, check) {
+  uint8_t data[TS_PACKET_SIZE * 6];
+  MakeTsPacket(0x100, 0, 90000, data);  // pcr at 1 sec, 90 kHz base
+  MakeTsPacket(0x100, 1, 0, data + TS_PACKET_SIZE);
+  MakeTsPacket(0x100, 1, 0, data + TS_PACKET_SIZE * 2);  // duplicate
+  MakeTsPacket(0x100, 3, 90000 + 900, data + TS_PACKET_SIZE * 3);  // cc gap, pcr +10 msec
+  MakeTsPacket(0x100, 4, 90000, data + TS_PACKET_SIZE * 4);  // pcr went back
+  MakeTsPacket(0x101, 0, 0, data + TS_PACKET_SIZE * 5);
+  const std::string copy(reinterpret_cast<char*>(data), sizeof(data));
+
+  iptv_cloud::utils::TsPacketFilter filter;
+  ASSERT_FALSE(filter.IsFiltering());
+  filter.Check(data, sizeof(data) + 10);  // partial packet is ignored
+  ASSERT_EQ(copy, std::string(reinterpret_cast<char*>(data), sizeof(data)));
+  iptv_cloud::utils::TsCheckStats stats = filter.GetStats();
+  ASSERT_EQ(stats.packets, 6u);
+  ASSERT_EQ(stats.dropped, 0u);
+  ASSERT_EQ(stats.sync_errors, 0u);
+  ASSERT_EQ(stats.cc_errors, 1u);
+  ASSERT_EQ(stats.pcr_errors, 1u);
+
+  filter.Reset();  // after discontinuity counters start again
+  filter.Check(data + TS_PACKET_SIZE * 3, TS_PACKET_SIZE);
+  ASSERT_EQ(filter.GetStats().cc_errors, 1u);
+}
+
+TEST(TsPacketFilter, filter) {
+  uint8_t data[TS_PACKET_SIZE * 5];
+  MakeTsPacket(0x0, 0, 0, data);  // pat
+  MakeTsPacket(0x100, 0, 0, data + TS_PACKET_SIZE);
+  MakeTsPacket(0x101, 0, 0, data + TS_PACKET_SIZE * 2);
+  MakeTsPacket(TS_NULL_PID, 0, 0, data + TS_PACKET_SIZE * 3);
+  MakeTsPacket(0x101, 1, 0, data + TS_PACKET_SIZE * 4);
+  data[TS_PACKET_SIZE * 4] = 0;  // lost sync
+
+  iptv_cloud::utils::ts_pids_t pids;
+  ASSERT_TRUE(common::ConvertFromString("[0x101, 4096]", &pids));
+  ASSERT_EQ(pids, iptv_cloud::utils::ts_pids_t({0x101, 0x1000}));
+  ASSERT_EQ(common::ConvertToString(pids), "257,4096");
+  ASSERT_TRUE(common::ConvertFromString("257", &pids));
+  ASSERT_FALSE(common::ConvertFromString("", &pids));
+  ASSERT_FALSE(common::ConvertFromString("257,", &pids));
+  ASSERT_FALSE(common::ConvertFromString("8191", &pids));
+  ASSERT_FALSE(common::ConvertFromString("[257", &pids));
+
+  iptv_cloud::utils::TsPacketFilter filter(pids);
+  ASSERT_TRUE(filter.IsFiltering());
+  ASSERT_EQ(filter.Filter(data, sizeof(data)), TS_PACKET_SIZE * 2);
+  ASSERT_EQ(data[2], 0x00);
+  ASSERT_EQ(data[TS_PACKET_SIZE + 2], 0x01);
+  iptv_cloud::utils::TsCheckStats stats = filter.GetStats();
+  ASSERT_EQ(stats.packets, 5u);
+  ASSERT_EQ(stats.dropped, 3u);
+  ASSERT_EQ(stats.sync_errors, 1u);
+}
+
+TEST(TsPacketFilter, program) {
+  const uint8_t pat[] = {0x00, 0xB0, 0x0D, 0x00, 0x01, 0xC1, 0x00, 0x00,
+                         0x00, 0x01, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00};  // program 1, pmt pid 0x1000
+  const uint8_t pmt[] = {0x02, 0xB0, 0x17, 0x00, 0x01, 0xC1, 0x00, 0x00, 0xF0, 0x01, 0xF0, 0x00, 0x0F,
+                         0xE1, 0x02, 0xF0, 0x00, 0x1B, 0xE1, 0x01, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00};  // pcr 0x1001
+  uint8_t data[TS_PACKET_SIZE * 6];
+  MakeTsSectionPacket(0x1000, pmt, sizeof(pmt), data);  // program is unknown yet
+  MakeTsSectionPacket(0x0, pat, sizeof(pat), data + TS_PACKET_SIZE);
+  MakeTsSectionPacket(0x1000, pmt, sizeof(pmt), data + TS_PACKET_SIZE * 2);
+  MakeTsPacket(0x1001, 0, 90000, data + TS_PACKET_SIZE * 3);
+  MakeTsPacket(0x101, 0, 0, data + TS_PACKET_SIZE * 4);
+  MakeTsPacket(0x102, 0, 0, data + TS_PACKET_SIZE * 5);
+
+  iptv_cloud::utils::TsPacketFilter filter(iptv_cloud::utils::ts_pids_t({0x101}));
+  ASSERT_EQ(filter.Filter(data, sizeof(data)), TS_PACKET_SIZE * 4);
+  ASSERT_EQ(data[2], 0x00);                       // pat
+  ASSERT_EQ(data[TS_PACKET_SIZE + 1], 0x50);      // pmt, payload start
+  ASSERT_EQ(data[TS_PACKET_SIZE * 2 + 2], 0x01);  // pcr
+  ASSERT_EQ(data[TS_PACKET_SIZE * 3 + 1], 0x01);  // listed pid
+  ASSERT_EQ(filter.GetStats().dropped, 2u);
+}
+
+TEST(TsChunker, split) {
+  const uint8_t pat[] = {0x00, 0xB0, 0x0D, 0x00, 0x01, 0xC1, 0x00, 0x00,
+                         0x00, 0x01, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00};  // program 1, pmt pid 0x100
+  const uint8_t pmt[] = {0x02, 0xB0, 0x17, 0x00, 0x01, 0xC1, 0x00, 0x00, 0xE1, 0x01, 0xF0, 0x00, 0x0F,
+                         0xE1, 0x02, 0xF0, 0x00, 0x1B, 0xE1, 0x01, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00};  // aac, h264
+  uint8_t data[TS_PACKET_SIZE * 8];
+  MakeTsVideoPacket(90000, true, data);  // program is unknown yet
+  MakeTsSectionPacket(0x0, pat, sizeof(pat), data + TS_PACKET_SIZE);
+  MakeTsSectionPacket(0x100, pmt, sizeof(pmt), data + TS_PACKET_SIZE * 2);
+  MakeTsVideoPacket(90000, false, data + TS_PACKET_SIZE * 3);
+  MakeTsVideoPacket(90000, true, data + TS_PACKET_SIZE * 4);          // first chunk
+  MakeTsVideoPacket(90000 + 45000, true, data + TS_PACKET_SIZE * 5);  // half of second
+  MakeTsPacket(0x102, 0, 0, data + TS_PACKET_SIZE * 6);
+  data[TS_PACKET_SIZE * 6 + 1] |= 0x40;                               // audio frame is not split point
+  MakeTsVideoPacket(90000 + 90000, true, data + TS_PACKET_SIZE * 7);  // second chunk
+
+  iptv_cloud::utils::TsChunker chunker(1000);
+  ASSERT_EQ(chunker.FindChunkStart(data, TS_PACKET_SIZE * 4), TS_PACKET_SIZE * 4);
+  ASSERT_FALSE(chunker.IsStarted());
+  ASSERT_EQ(chunker.GetPsiPackets().size(), TS_PACKET_SIZE * 2);
+  ASSERT_EQ(chunker.FindChunkStart(data + TS_PACKET_SIZE * 4, TS_PACKET_SIZE * 4), 0u);
+  ASSERT_TRUE(chunker.IsStarted());
+  ASSERT_EQ(chunker.FindChunkStart(data + TS_PACKET_SIZE * 5, TS_PACKET_SIZE * 3 + 10), TS_PACKET_SIZE * 2);
+
+  chunker.Reset();
+  ASSERT_FALSE(chunker.IsStarted());
+  ASSERT_TRUE(chunker.GetPsiPackets().empty());
+  ASSERT_EQ(chunker.FindChunkStart(data + TS_PACKET_SIZE, TS_PACKET_SIZE * 7), TS_PACKET_SIZE * 3);
+
+  // source without random access indicators is split after twice chunk duration
+  MakeTsVideoPacket(90000 + 90000 * 2, false, data + TS_PACKET_SIZE * 4);  // first chunk
+  MakeTsVideoPacket(90000 + 90000 * 3, false, data + TS_PACKET_SIZE * 5);
+  MakeTsVideoPacket(90000 + 90000 * 4, false, data + TS_PACKET_SIZE * 6);  // second chunk
+  chunker.Reset();
+  ASSERT_FALSE(chunker.IsRandomAccessMissing());
+  ASSERT_EQ(chunker.FindChunkStart(data + TS_PACKET_SIZE, TS_PACKET_SIZE * 6), TS_PACKET_SIZE * 3);
+  ASSERT_TRUE(chunker.IsStarted());
+  ASSERT_TRUE(chunker.IsRandomAccessMissing());
+  ASSERT_EQ(chunker.FindChunkStart(data + TS_PACKET_SIZE * 5, TS_PACKET_SIZE * 2), TS_PACKET_SIZE);
+}